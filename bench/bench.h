@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "scidbase.h"
+
+/// Returns the SCID4 database used by the benchmarks, opened read-only.
+/// It is the database given on the command line or the test database.
+const scidBaseT& benchDatabase();
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include "game.h"
+#include "pgnparse.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Decode all the games of the database into the same Game object.
+static void BM_DecodeBase(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	Game game;
+	for (auto _ : state) {
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			const IndexEntry& ie = *dbase.getIndexEntry(gnum);
+			if (dbase.getGame(ie, game) != OK)
+				state.SkipWithError("Decode failed");
+		}
+		benchmark::DoNotOptimize(game.GetNumHalfMoves());
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+}
+BENCHMARK(BM_DecodeBase)->Unit(benchmark::kMillisecond);
+
+// Decode all the games of the database, using a new Game object each time.
+static void BM_DecodeBaseNewGame(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	for (auto _ : state) {
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			const IndexEntry& ie = *dbase.getIndexEntry(gnum);
+			Game game;
+			if (dbase.getGame(ie, game) != OK)
+				state.SkipWithError("Decode failed");
+			benchmark::DoNotOptimize(game.GetNumHalfMoves());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+}
+BENCHMARK(BM_DecodeBaseNewGame)->Unit(benchmark::kMillisecond);
+
+// Decode only the moves of all the games of the database.
+static void BM_DecodeMovesOnly(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	Game game;
+	for (auto _ : state) {
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			auto data = dbase.getGame(*dbase.getIndexEntry(gnum));
+			if (game.DecodeMovesOnly(data) != OK)
+				state.SkipWithError("Decode failed");
+		}
+		benchmark::DoNotOptimize(game.GetNumHalfMoves());
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+}
+BENCHMARK(BM_DecodeMovesOnly)->Unit(benchmark::kMillisecond);
+
+// Parse the PGN of all the games of the database.
+static void BM_PgnParseGame(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	std::vector<std::string> pgns;
+	Game game;
+	for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+		if (dbase.getGame(*dbase.getIndexEntry(gnum), game) != OK) {
+			state.SkipWithError("Decode failed");
+			return;
+		}
+		game.SetPgnFormat(PGN_FORMAT_Plain);
+		pgns.emplace_back(game.WriteToPGN().first);
+	}
+	for (auto _ : state) {
+		for (auto& pgn : pgns) {
+			PgnParseLog log;
+			game.Clear();
+			if (!pgnParseGame(pgn.data(), pgn.size(), game, log))
+				state.SkipWithError("Parse failed");
+		}
+		benchmark::DoNotOptimize(game.GetNumHalfMoves());
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+}
+BENCHMARK(BM_PgnParseGame)->Unit(benchmark::kMillisecond);
+
+// Export all the games of the database to PGN, decoding them into a Game.
+static void BM_ExportWriteToPGN(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	Game game;
+	game.SetPgnFormat(PGN_FORMAT_Plain);
+	size_t bytes = 0;
+	for (auto _ : state) {
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			const IndexEntry& ie = *dbase.getIndexEntry(gnum);
+			if (dbase.getGame(ie, game) != OK)
+				state.SkipWithError("Decode failed");
+			bytes += game.WriteToPGN(75, true).second;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ExportWriteToPGN)->Unit(benchmark::kMillisecond);
+
+// Export all the games of the database to PGN, directly from the encoded data.
+static void BM_ExportEncodePGN(benchmark::State& state) {
+	const auto& dbase = benchDatabase();
+	const auto nGames = dbase.numGames();
+	std::vector<char> pgn;
+	size_t bytes = 0;
+	for (auto _ : state) {
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			pgn.clear();
+			if (dbase.getGamePGN(*dbase.getIndexEntry(gnum), pgn) != OK)
+				state.SkipWithError("Encode failed");
+			bytes += pgn.size();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nGames);
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ExportEncodePGN)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+const char* g_database = SCID_TESTDIR "res_database";
+}
+
+const scidBaseT& benchDatabase() {
+	static const scidBaseT* dbase = [] {
+		auto res = new scidBaseT;
+		if (res->open("SCID4", FMODE_ReadOnly, g_database) != OK) {
+			std::fprintf(stderr, "Error opening database: %s\n", g_database);
+			std::exit(1);
+		}
+		return res;
+	}();
+	return *dbase;
+}
+
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+	if (argc > 2) {
+		std::fprintf(stderr, "Usage: %s [benchmark options] [database]\n",
+		             argv[0]);
+		return 1;
+	}
+	if (argc == 2)
+		g_database = argv[1];
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "position.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Positions and node counts from https://www.chessprogramming.org/Perft_Results
+const char* FEN_START =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const char* FEN_KIWIPETE =
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+const char* FEN_ENDGAME = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+const char* FEN_PROMOTIONS =
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
+const char* FEN_TALKCHESS =
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
+const char* FEN_MIDDLEGAME = "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/"
+                             "P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10";
+const char* FEN_CHESS960 =
+    "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9";
+
+const char* const POSITIONS[] = {FEN_START,      FEN_KIWIPETE,  FEN_ENDGAME,
+                                 FEN_PROMOTIONS, FEN_TALKCHESS, FEN_MIDDLEGAME,
+                                 FEN_CHESS960};
+
+unsigned long long perft(Position& pos, int depth) {
+	MoveList moves;
+	pos.GenerateMoves(&moves);
+	if (depth <= 1)
+		return moves.Size();
+
+	unsigned long long res = 0;
+	for (auto& sm : moves) {
+		pos.DoSimpleMove(sm);
+		res += perft(pos, depth - 1);
+		pos.UndoSimpleMove(&sm);
+	}
+	return res;
+}
+
+std::vector<Position> readPositions() {
+	std::vector<Position> res(std::size(POSITIONS));
+	for (size_t i = 0; i < res.size(); ++i) {
+		res[i].ReadFromFEN(POSITIONS[i]);
+	}
+	return res;
+}
+
+} // namespace
+
+// Count the leaf nodes of the legal move tree and verify the result.
+static void BM_Perft(benchmark::State& state, const char* fen, int depth,
+                     unsigned long long expected) {
+	Position pos;
+	if (pos.ReadFromFEN(fen) != OK) {
+		state.SkipWithError("Invalid FEN");
+		return;
+	}
+	unsigned long long nodes = 0;
+	for (auto _ : state) {
+		nodes = perft(pos, depth);
+		if (nodes != expected) {
+			state.SkipWithError("Wrong number of nodes");
+			break;
+		}
+	}
+	state.counters["nodes"] = static_cast<double>(nodes);
+	state.counters["nps"] = benchmark::Counter(
+	    static_cast<double>(nodes) * state.iterations(),
+	    benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_Perft, start, FEN_START, 5, 4865609)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, kiwipete, FEN_KIWIPETE, 4, 4085603)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, endgame, FEN_ENDGAME, 6, 11030083)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, promotions, FEN_PROMOTIONS, 4, 422333)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, talkchess, FEN_TALKCHESS, 4, 2103487)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, middlegame, FEN_MIDDLEGAME, 4, 3894594)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Perft, chess960, FEN_CHESS960, 4, 326672)
+    ->Unit(benchmark::kMillisecond);
+
+// Generate all the legal moves of each position.
+static void BM_GenerateMoves(benchmark::State& state) {
+	auto positions = readPositions();
+	MoveList moves;
+	for (auto _ : state) {
+		for (auto& pos : positions) {
+			pos.GenerateMoves(&moves);
+			benchmark::DoNotOptimize(moves.Size());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GenerateMoves);
+
+// Generate only the captures of each position.
+static void BM_GenerateCaptures(benchmark::State& state) {
+	auto positions = readPositions();
+	MoveList moves;
+	for (auto _ : state) {
+		for (auto& pos : positions) {
+			pos.GenerateCaptures(&moves);
+			benchmark::DoNotOptimize(moves.Size());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GenerateCaptures);
+
+// Make and unmake every legal move of each position.
+static void BM_DoUndoMove(benchmark::State& state) {
+	auto positions = readPositions();
+	std::vector<MoveList> moves(positions.size());
+	size_t nMoves = 0;
+	for (size_t i = 0; i < positions.size(); ++i) {
+		positions[i].GenerateMoves(&moves[i]);
+		nMoves += moves[i].Size();
+	}
+	for (auto _ : state) {
+		for (size_t i = 0; i < positions.size(); ++i) {
+			for (auto& sm : moves[i]) {
+				positions[i].DoSimpleMove(sm);
+				positions[i].UndoSimpleMove(&sm);
+			}
+			benchmark::DoNotOptimize(positions[i].HashValue());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nMoves);
+}
+BENCHMARK(BM_DoUndoMove);
+
+// Check the legality of every generated move of each position.
+static void BM_IsLegalMove(benchmark::State& state) {
+	auto positions = readPositions();
+	std::vector<MoveList> moves(positions.size());
+	size_t nMoves = 0;
+	for (size_t i = 0; i < positions.size(); ++i) {
+		positions[i].GenerateMoves(&moves[i]);
+		nMoves += moves[i].Size();
+	}
+	for (auto _ : state) {
+		for (size_t i = 0; i < positions.size(); ++i) {
+			for (auto& sm : moves[i]) {
+				benchmark::DoNotOptimize(
+				    positions[i].IsLegalMove(sm.from, sm.to, sm.promote));
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nMoves);
+}
+BENCHMARK(BM_IsLegalMove);
+
+// Convert every legal move of each position to SAN.
+static void BM_MakeSANString(benchmark::State& state) {
+	const sanFlagT flag = static_cast<sanFlagT>(state.range(0));
+	auto positions = readPositions();
+	std::vector<MoveList> moves(positions.size());
+	size_t nMoves = 0;
+	for (size_t i = 0; i < positions.size(); ++i) {
+		positions[i].GenerateMoves(&moves[i]);
+		nMoves += moves[i].Size();
+	}
+	sanStringT san;
+	for (auto _ : state) {
+		for (size_t i = 0; i < positions.size(); ++i) {
+			for (auto& sm : moves[i]) {
+				positions[i].MakeSANString(&sm, san, flag);
+				benchmark::DoNotOptimize(san[0]);
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * nMoves);
+}
+BENCHMARK(BM_MakeSANString)
+    ->Arg(SAN_NO_CHECKTEST)
+    ->Arg(SAN_CHECKTEST)
+    ->Arg(SAN_MATETEST);
+
+// Parse the SAN of every legal move of each position.
+static void BM_ParseMove(benchmark::State& state) {
+	auto positions = readPositions();
+	std::vector<std::vector<std::string>> sans(positions.size());
+	size_t nMoves = 0;
+	for (size_t i = 0; i < positions.size(); ++i) {
+		MoveList moves;
+		positions[i].GenerateMoves(&moves);
+		for (auto& sm : moves) {
+			sanStringT san;
+			positions[i].MakeSANString(&sm, san, SAN_CHECKTEST);
+			sans[i].emplace_back(san);
+		}
+		nMoves += moves.Size();
+	}
+	simpleMoveT sm;
+	for (auto _ : state) {
+		for (size_t i = 0; i < positions.size(); ++i) {
+			for (auto& san : sans[i]) {
+				if (positions[i].ParseMove(&sm, san.data(),
+				                           san.data() + san.size()) != OK) {
+					state.SkipWithError("Invalid SAN");
+					return;
+				}
+			}
+		}
+		benchmark::DoNotOptimize(sm.to);
+	}
+	state.SetItemsProcessed(state.iterations() * nMoves);
+}
+BENCHMARK(BM_ParseMove);
+
+// Read each position from its FEN.
+static void BM_ReadFromFEN(benchmark::State& state) {
+	Position pos;
+	for (auto _ : state) {
+		for (auto fen : POSITIONS) {
+			if (pos.ReadFromFEN(fen) != OK) {
+				state.SkipWithError("Invalid FEN");
+				return;
+			}
+		}
+		benchmark::DoNotOptimize(pos.HashValue());
+	}
+	state.SetItemsProcessed(state.iterations() * std::size(POSITIONS));
+}
+BENCHMARK(BM_ReadFromFEN);
+
+// Write the FEN of each position.
+static void BM_PrintFEN(benchmark::State& state) {
+	auto positions = readPositions();
+	char fen[256];
+	for (auto _ : state) {
+		for (auto& pos : positions) {
+			pos.PrintFEN(fen);
+			benchmark::DoNotOptimize(fen[0]);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_PrintFEN);
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include <benchmark/benchmark.h>
+
+// Copy all the games of the database into a new memory database.
+static void BM_ImportGames(benchmark::State& state) {
+	const auto& src = benchDatabase();
+	const auto filter = src.getFilter("dbfilter");
+	for (auto _ : state) {
+		scidBaseT dbase;
+		if (dbase.open("MEMORY", FMODE_Create, "Memory") != OK ||
+		    dbase.importGames(&src, filter, Progress()) != OK) {
+			state.SkipWithError("Import failed");
+			break;
+		}
+		benchmark::DoNotOptimize(dbase.numGames());
+	}
+	state.SetItemsProcessed(state.iterations() * src.numGames());
+}
+BENCHMARK(BM_ImportGames)->Unit(benchmark::kMillisecond);
@@ -16,7 +16,7 @@
 
 // types
 
-struct entry_t {
+struct book_entry_t {
    uint64 key;
    uint16 move;
    uint16 count;
@@ -33,7 +33,7 @@ static int BookSize;
 
 static int    find_pos     (uint64 key);
 
-static void   read_entry   (entry_t * entry, int n);
+static void   read_entry   (book_entry_t * entry, int n);
 static uint64 read_integer (FILE * file, int size);
 
 // functions
@@ -81,7 +81,7 @@ int book_move(board_t * board) {
    int best_move;
    int best_score;
    int pos;
-   entry_t entry[1];
+   book_entry_t entry[1];
    int move;
    int score;
    list_t list[1];
@@ -133,7 +133,7 @@ int book_move(board_t * board) {
 static int find_pos(uint64 key) {
 
    int left, right, mid;
-   entry_t entry[1];
+   book_entry_t entry[1];
 
    // binary search (finds the leftmost entry)
 
@@ -165,7 +165,7 @@ static int find_pos(uint64 key) {
 
 // read_entry()
 
-static void read_entry(entry_t * entry, int n) {
+static void read_entry(book_entry_t * entry, int n) {
 
    ASSERT(entry!=NULL);
    ASSERT(n>=0&&n<BookSize);
@@ -49,7 +49,7 @@ static int lazy_eval_cutoff = 200; /* Thomas */
 static bool LazyEval = false; // true
 static bool KingSafety = false; // true
 static int KingSafetyMargin = 1600;
-static bool king_is_safe[ColourNb];
+static thread_local bool king_is_safe[ColourNb];
 
 static /* const */ int PieceActivityWeight = 256; // 100%
 static /* const */ int KingSafetyWeight = 256; // 100%
@@ -52,6 +52,13 @@ int main(int argc, char * argv[]) {
    trans_init(Trans);
    book_init();
 
+   // "togaII bench [depth] [hash]" runs the benchmark and exits (used for PGO)
+
+   if (argc >= 2 && my_string_equal(argv[1],"bench")) {
+      bench((argc >= 3) ? atoi(argv[2]) : 0,(argc >= 4) ? atoi(argv[3]) : 0);
+      return EXIT_SUCCESS;
+   }
+
    // loop
 
    loop();
@@ -68,7 +68,7 @@ struct material_t {
 
 // variables
 
-static material_t Material[1];
+static thread_local material_t Material[1]; // per search thread
 
 // prototypes
 
@@ -134,6 +134,19 @@ void material_clear() {
    Material->write_collision = 0;
 }
 
+// material_free()
+
+void material_free() {
+
+   if (Material->table != NULL) {
+      my_free(Material->table);
+      Material->table = NULL;
+   }
+
+   Material->size = 0;
+   Material->mask = 0;
+}
+
 // material_get_info()
 
 void material_get_info(material_info_t * info, const board_t * board) {
@@ -57,6 +57,7 @@ extern void material_init     ();
 extern void material_parameter();
 
 extern void material_alloc    ();
+extern void material_free     ();
 extern void material_clear    ();
 
 extern void material_get_info (material_info_t * info, const board_t * board);
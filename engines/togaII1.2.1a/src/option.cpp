@@ -24,7 +24,9 @@ struct option_t {
 
 static option_t Option[] = {
 
-   { "Hash", true, "16", "spin", "min 4 max 1024", NULL },
+   { "Hash", true, "16", "spin", "min 4 max 65536", NULL },
+   { "Large Pages", true, "true", "check", "", NULL },
+   { "Threads", true, "1", "spin", "min 1 max 64", NULL },
 
    // JAS
    // search X seconds for the best move, equal to "go movetime"
@@ -79,7 +79,7 @@ int BitLast[0x100];
 int BitCount[0x100];
 int BitRev[0x100];
 
-static pawn_t Pawn[1];
+static thread_local pawn_t Pawn[1]; // per search thread
 
 static int BitRank1[RankNb];
 static int BitRank2[RankNb];
@@ -221,6 +221,19 @@ void pawn_clear() {
    Pawn->write_collision = 0;
 }
 
+// pawn_free()
+
+void pawn_free() {
+
+   if (Pawn->table != NULL) {
+      my_free(Pawn->table);
+      Pawn->table = NULL;
+   }
+
+   Pawn->size = 0;
+   Pawn->mask = 0;
+}
+
 // pawn_get_info()
 
 void pawn_get_info(pawn_info_t * info, const board_t * board) {
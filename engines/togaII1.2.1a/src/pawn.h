@@ -54,6 +54,7 @@ extern void pawn_parameter();
 extern void pawn_init     ();
 
 extern void pawn_alloc    ();
+extern void pawn_free     ();
 extern void pawn_clear    ();
 
 extern void pawn_get_info (pawn_info_t * info, const board_t * board);
@@ -32,10 +32,33 @@
 static const double NormalRatio = 1.0;
 static const double PonderRatio = 1.25;
 
+static const int BenchDepth = 10;
+static const int BenchHash = 16;
+
+// fixed positions searched by "bench", the total nodes are the signature of the build
+
+static const char * const BenchFen[] = {
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+   "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+   "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+   "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+   "r1bqkb1r/pp3ppp/2nppn2/8/3NP3/2N5/PPP1BPPP/R1BQK2R w KQkq - 0 7",
+   "2r2rk1/1bqnbpp1/1p1ppn1p/pP6/N1P1P3/P2B1N1P/1B2QPP1/R2R2K1 b - - 0 19",
+   "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+   "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+   "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   "8/8/8/5k2/8/3P4/3K4/8 w - - 0 1",
+   "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+   "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+};
+
 // variables
 
 static bool Init;
 
+static bool Bench; // benchmark in progress? (the input is not read)
 static bool Searching; // search in progress?
 static bool Infinite; // infinite or ponder mode?
 static bool Delay; // postpone "bestmove" in infinite/ponder mode?
@@ -45,6 +68,7 @@ static bool Delay; // postpone "bestmove" in infinite/ponder mode?
 static void init              ();
 static void loop_step         ();
 
+static void parse_bench       (char string[]);
 static void parse_go          (char string[]);
 static void parse_position    (char string[]);
 static void parse_setoption   (char string[]);
@@ -121,7 +145,7 @@ static void init() {
 
 void event() {
 
-   while (!SearchInfo->stop && input_available()) loop_step();
+   while (!Bench && !SearchInfo->stop && input_available()) loop_step();
 }
 
 // loop_step()
@@ -138,6 +162,14 @@ static void loop_step() {
 
    if (false) {
 
+   } else if (string_equal(string,"bench") || string_start_with(string,"bench ")) {
+
+      if (!Searching && !Delay) {
+         parse_bench(string);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"debug ")) {
 
       // dummy
@@ -242,6 +274,98 @@ static void loop_step() {
    }
 }
 
+// parse_bench()
+
+static void parse_bench(char string[]) {
+
+   const char * ptr;
+   int depth, hash;
+
+   depth = 0;
+   hash = 0;
+
+   ptr = strtok(string," "); // skip "bench"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) depth = atoi(ptr);
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) hash = atoi(ptr);
+
+   bench(depth,hash);
+}
+
+// bench()
+
+void bench(int depth, int hash) {
+
+   char old_hash[256], old_book[256], old_multipv[256];
+   char value[16];
+   sint64 node_nb;
+   double time;
+   int pos;
+
+   if (depth <= 0) depth = BenchDepth;
+   if (hash < 4) hash = BenchHash;
+
+   init();
+
+   // the searches do not depend on the book, MultiPV and the previous searches
+
+   strcpy(old_hash,option_get_string("Hash"));
+   strcpy(old_book,option_get_string("OwnBook"));
+   strcpy(old_multipv,option_get_string("MultiPV"));
+
+   sprintf(value,"%d",hash);
+   option_set("Hash",value);
+   option_set("OwnBook","false");
+   option_set("MultiPV","1");
+
+   trans_free(Trans);
+   trans_alloc(Trans);
+
+   node_nb = 0;
+   time = 0.0;
+
+   Bench = true;
+
+   for (pos = 0; pos < int(sizeof(BenchFen)/sizeof(BenchFen[0])); pos++) {
+
+      send("info string position %d %s",pos+1,BenchFen[pos]);
+
+      trans_clear(Trans);
+      search_clear();
+
+      board_from_fen(SearchInput->board,BenchFen[pos]);
+
+      SearchInput->depth_is_limited = true;
+      SearchInput->depth_limit = depth;
+
+      search();
+      search_update_current();
+
+      node_nb += SearchCurrent->total_node_nb;
+      time += SearchCurrent->time;
+   }
+
+   Bench = false;
+
+   // restore the options
+
+   option_set("Hash",old_hash);
+   option_set("OwnBook",old_book);
+   option_set("MultiPV",old_multipv);
+
+   trans_free(Trans);
+   trans_alloc(Trans);
+
+   search_clear();
+   board_from_fen(SearchInput->board,StartFen);
+
+   send("info string bench depth %d hash %d threads %d",depth,hash,option_get_int("Threads"));
+   send("info string bench nodes " S64_FORMAT " time %.0f nps %.0f",node_nb,time*1000.0,(time>=0.001)?double(node_nb)/time:0.0);
+}
+
 // parse_go()
 
 static void parse_go(char string[]) {
@@ -554,7 +678,7 @@ static void parse_setoption(char string[]) {
 
    // update transposition-table size if needed
 
-   if (Init && my_string_equal(name,"Hash")) { // Init => already allocated
+   if (Init && (my_string_equal(name,"Hash") || my_string_equal(name,"Large Pages"))) { // Init => already allocated
 
       ASSERT(!Searching);
 
@@ -583,7 +707,7 @@ static void send_best_move() {
    time = SearchCurrent->time;
    speed = SearchCurrent->speed;
    cpu = SearchCurrent->cpu;
-   node_nb = SearchCurrent->node_nb;
+   node_nb = SearchCurrent->total_node_nb;
 
    send("info time %.0f nodes " S64_FORMAT " nps %.0f cpuload %.0f",time*1000.0,node_nb,speed,cpu*1000.0);
 
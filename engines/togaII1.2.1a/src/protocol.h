@@ -12,6 +12,7 @@
 
 extern void loop  ();
 extern void event ();
+extern void bench (int depth, int hash);
 extern void book_parameter();
 
 extern void get   (char string[], int size);
@@ -3,8 +3,12 @@
 
 // includes
 
+#include <atomic>
+#include <condition_variable>
 #include <csetjmp>
 #include <cstring>
+#include <mutex>
+#include <thread>
 
 #include "attack.h"
 #include "board.h"
@@ -51,22 +55,60 @@ static const bool UseBad = true;
 static const int BadThreshold = 50; // 50
 static const bool UseExtension = true;
 
+static const int ThreadMax = 64;
+
+// types
+
+// Lazy SMP: the helper threads search the same root position as the main
+// thread, with their own board, history and pawn/material tables, and share
+// only the transposition table. They do not manage the time and stop when the
+// main thread stops.
+
+struct search_thread_t {
+   std::thread thread;
+   std::atomic<sint64> node_nb;
+   int depth; // last completed iteration
+   search_best_t best[1];
+};
+
 // variables
 
 static search_multipv_t save_multipv[MultiPVMax];
 
 bool trans_endgame;
-search_param_t SearchStack[HeightMax];
 
 search_input_t SearchInput[1];
-search_info_t SearchInfo[1];
-search_root_t SearchRoot[1];
-search_current_t SearchCurrent[1];
-search_best_t SearchBest[MultiPVMax];
+
+thread_local search_param_t SearchStack[HeightMax];
+thread_local search_info_t SearchInfo[1];
+thread_local search_root_t SearchRoot[1];
+thread_local search_current_t SearchCurrent[1];
+thread_local search_best_t SearchBest[MultiPVMax];
+
+static thread_local int ThreadId; // 0 = main thread
+
+static search_thread_t * Threads[ThreadMax]; // helpers, ThreadId = index + 1
+static int ThreadNb;
+
+// never destroyed: the helpers may still wait on them at exit
+static std::mutex & ThreadMutex = *new std::mutex;
+static std::condition_variable & ThreadCond = *new std::condition_variable;
+static int ThreadGeneration;
+static int ThreadBusy;
+static bool ThreadQuit;
+static std::atomic<bool> ThreadStop;
 
 // prototypes
 
-static void search_send_stat ();
+static void search_clear_thread  ();
+static void search_iterate       ();
+static void search_send_stat     ();
+
+static void search_threads_init  (int thread_nb);
+static void search_threads_start ();
+static void search_threads_stop  ();
+static void search_thread_loop   (int id, int generation);
+static void search_thread_select ();
 
 // functions
 
@@ -97,6 +139,13 @@ void search_clear() {
    SearchInput->time_limit_1 = 0.0;
    SearchInput->time_limit_2 = 0.0;
 
+   search_clear_thread();
+}
+
+// search_clear_thread()
+
+static void search_clear_thread() {
+
    // SearchInfo
 
    SearchInfo->can_stop = false;
@@ -129,6 +178,7 @@ void search_clear() {
 
    SearchCurrent->max_depth = 0;
    SearchCurrent->node_nb = 0;
+   SearchCurrent->total_node_nb = 0;
    SearchCurrent->time = 0.0;
    SearchCurrent->speed = 0.0;
    SearchCurrent->cpu = 0.0;
@@ -139,9 +189,7 @@ void search_clear() {
 void search() {
 
    int move;
-   int depth;
    int i;
-   bool search_ready;
 
      
    for (i = 0; i < MultiPVMax; i++){
@@ -196,11 +244,44 @@ void search() {
       SearchInput->depth_limit = 4; // was 1
    }
 
+   // init
+
+   trans_inc_date(Trans);
+
+   sort_init();
+   search_full_parameter();
+
+   // analyze game for evaluation
+   
+   if (SearchInput->board->piece_size[White] < 3 && SearchInput->board->piece_size[Black] < 3){
+	   trans_endgame = true;
+   }
+   else{
+	   trans_endgame = false;
+   }
+
+   // search
+
+   search_threads_init(option_get_int("Threads"));
+   search_threads_start();
+
+   search_iterate();
+
+   search_threads_stop();
+}
+
+// search_iterate()
+
+static void search_iterate() {
+
+   int depth;
+   bool search_ready;
+
    // SearchInfo
 
    if (setjmp(SearchInfo->buf) != 0) {
-      ASSERT(SearchInfo->can_stop);
-      ASSERT(SearchBest->move!=MoveNone);
+      ASSERT(SearchInfo->can_stop||ThreadId!=0);
+      ASSERT(SearchBest->move!=MoveNone||ThreadId!=0);
       search_update_current();
       return;
    }
@@ -217,26 +298,15 @@ void search() {
 
    // init
 
-   trans_inc_date(Trans);
-
-   sort_init();
    search_full_init(SearchRoot->list,SearchCurrent->board);
 
-   // analyze game for evaluation
-   
-   if (SearchCurrent->board->piece_size[White] < 3 && SearchCurrent->board->piece_size[Black] < 3){
-	   trans_endgame = true;
-   }
-   else{
-	   trans_endgame = false;
-   }
-
-   
    // iterative deepening
 
    search_ready = false;
 
-   for (depth = 1; depth < DepthMax; depth++) {
+   // the odd helper threads search one ply deeper
+
+   for (depth = 1 + (ThreadId & 1); depth < DepthMax; depth++) {
 	   for (SearchCurrent->multipv = 0; SearchCurrent->multipv <= SearchInput->multipv; SearchCurrent->multipv++){
 
 		  if (DispDepthStart && SearchCurrent->multipv == 0) send("info depth %d",depth);
@@ -255,8 +325,10 @@ void search() {
 
 		  search_update_current();
 
+		  if (ThreadId != 0) continue; // the helpers do not stop the search
+
 		  if (DispDepthEnd && SearchCurrent->multipv == SearchInput->multipv) {
-			 send("info depth %d seldepth %d time %.0f nodes " S64_FORMAT " nps %.0f",depth,SearchCurrent->max_depth,SearchCurrent->time*1000.0,SearchCurrent->node_nb,SearchCurrent->speed);
+			 send("info depth %d seldepth %d time %.0f nodes " S64_FORMAT " nps %.0f",depth,SearchCurrent->max_depth,SearchCurrent->time*1000.0,SearchCurrent->total_node_nb,SearchCurrent->speed);
 		  }
 
 		  // update search info
@@ -279,7 +351,7 @@ void search() {
 
 		  // stop search?
 		  if (SearchInput->nodes_is_limited //&& SearchCurrent->multipv >= SearchInput->multipv
-		   && SearchCurrent->node_nb >= SearchInput->nodes_limit) {
+		   && SearchCurrent->total_node_nb >= SearchInput->nodes_limit) {
 			 SearchRoot->flag = true;
 		  }
 
@@ -317,6 +389,10 @@ void search() {
 			  break;
 		  }
 	   }
+	   if (ThreadId != 0) {
+		   Threads[ThreadId-1]->depth = depth;
+		   *Threads[ThreadId-1]->best = SearchBest[0];
+	   }
 	   if (search_ready)
 		   break;
    }
@@ -333,6 +409,8 @@ void search_update_best() {
    int mate, i, z;
    bool found;
    char move_string[256], pv_string[512];
+
+   if (ThreadId != 0) return; // only the main thread reports
       
    search_update_current();
 
@@ -346,7 +424,7 @@ void search_update_best() {
 
       max_depth = SearchCurrent->max_depth;
       time = SearchCurrent->time;
-      node_nb = SearchCurrent->node_nb;
+      node_nb = SearchCurrent->total_node_nb;
 
       move_to_string(move,move_string,256);
       pv_to_string(pv,pv_string,512);
@@ -457,7 +535,7 @@ void search_update_root() {
    sint64 node_nb;
    char move_string[256];
 
-   if (DispRoot) {
+   if (DispRoot && ThreadId == 0) {
 
       search_update_current();
 
@@ -468,7 +546,7 @@ void search_update_root() {
          move_nb = SearchRoot->move_nb;
 
          time = SearchCurrent->time;
-         node_nb = SearchCurrent->node_nb;
+         node_nb = SearchCurrent->total_node_nb;
 
          move_to_string(move,move_string,256);
 
@@ -484,14 +562,19 @@ void search_update_current() {
    my_timer_t *timer;
    sint64 node_nb;
    double time, speed, cpu;
+   int i;
 
    timer = SearchCurrent->timer;
 
    node_nb = SearchCurrent->node_nb;
+   if (ThreadId == 0) {
+      for (i = 0; i < ThreadNb; i++) node_nb += Threads[i]->node_nb.load(std::memory_order_relaxed);
+   }
    time = (UseCpuTime) ? my_timer_elapsed_cpu(timer) : my_timer_elapsed_real(timer);
    speed = (time >= 1.0) ? double(node_nb) / time : 0.0;
    cpu = my_timer_cpu_usage(timer);
 
+   SearchCurrent->total_node_nb = node_nb;
    SearchCurrent->time = time;
    SearchCurrent->speed = speed;
    SearchCurrent->cpu = cpu;
@@ -501,6 +584,19 @@ void search_update_current() {
 
 void search_check() {
 
+   if (ThreadId != 0) {
+
+      // helper thread
+
+      Threads[ThreadId-1]->node_nb.store(SearchCurrent->node_nb,std::memory_order_relaxed);
+
+      if (ThreadStop.load(std::memory_order_relaxed)) {
+         longjmp(SearchInfo->buf,1);
+      }
+
+      return;
+   }
+
    search_send_stat();
 
    if (UseEvent) event();
@@ -545,7 +641,7 @@ static void search_send_stat() {
       time = SearchCurrent->time;
       speed = SearchCurrent->speed;
       cpu = SearchCurrent->cpu;
-      node_nb = SearchCurrent->node_nb;
+      node_nb = SearchCurrent->total_node_nb;
 
       send("info time %.0f nodes " S64_FORMAT " nps %.0f cpuload %.0f",time*1000.0,node_nb,speed,cpu*1000.0);
 
@@ -553,5 +649,163 @@ static void search_send_stat() {
    }
 }
 
+// search_threads_init()
+
+static void search_threads_init(int thread_nb) {
+
+   int i;
+
+   if (thread_nb < 1) thread_nb = 1;
+   if (thread_nb > ThreadMax) thread_nb = ThreadMax;
+
+   if (ThreadNb == thread_nb - 1) return;
+
+   // stop the current helpers
+
+   {
+      std::lock_guard<std::mutex> lock(ThreadMutex);
+      ThreadQuit = true;
+   }
+   ThreadCond.notify_all();
+
+   for (i = 0; i < ThreadNb; i++) {
+      Threads[i]->thread.join();
+      delete Threads[i];
+      Threads[i] = NULL;
+   }
+
+   ThreadQuit = false;
+
+   // start the new ones
+
+   ThreadNb = thread_nb - 1;
+
+   for (i = 0; i < ThreadNb; i++) {
+      Threads[i] = new search_thread_t;
+      Threads[i]->node_nb = 0;
+      Threads[i]->depth = 0;
+      Threads[i]->best->move = MoveNone;
+   }
+
+   for (i = 0; i < ThreadNb; i++) {
+      Threads[i]->thread = std::thread(search_thread_loop,i+1,ThreadGeneration);
+   }
+}
+
+// search_threads_start()
+
+static void search_threads_start() {
+
+   int i;
+
+   ThreadStop = false;
+
+   for (i = 0; i < ThreadNb; i++) Threads[i]->node_nb = 0;
+
+   {
+      std::lock_guard<std::mutex> lock(ThreadMutex);
+      ThreadBusy = ThreadNb;
+      ThreadGeneration++;
+   }
+   ThreadCond.notify_all();
+}
+
+// search_threads_stop()
+
+static void search_threads_stop() {
+
+   ThreadStop = true;
+
+   {
+      std::unique_lock<std::mutex> lock(ThreadMutex);
+      ThreadCond.wait(lock,[]{ return ThreadBusy == 0; });
+   }
+
+   search_update_current();
+   search_thread_select();
+}
+
+// search_thread_loop()
+
+static void search_thread_loop(int id, int generation) {
+
+   search_thread_t * thread;
+
+   ThreadId = id;
+   thread = Threads[id-1];
+
+   pawn_alloc();
+   material_alloc();
+
+   while (true) {
+
+      {
+         std::unique_lock<std::mutex> lock(ThreadMutex);
+         ThreadCond.wait(lock,[&]{ return ThreadQuit || ThreadGeneration != generation; });
+         if (ThreadQuit) break;
+         generation = ThreadGeneration;
+      }
+
+      thread->depth = 0;
+      thread->best->move = MoveNone;
+
+      search_clear_thread();
+      sort_clear();
+
+      search_iterate();
+
+      thread->node_nb.store(SearchCurrent->node_nb,std::memory_order_relaxed);
+
+      {
+         std::lock_guard<std::mutex> lock(ThreadMutex);
+         ThreadBusy--;
+      }
+      ThreadCond.notify_all();
+   }
+
+   pawn_free();
+   material_free();
+}
+
+// search_thread_select()
+
+static void search_thread_select() {
+
+   const search_thread_t * best;
+   int depth, value, mate;
+   int i;
+   char pv_string[512];
+
+   // with a single PV, play the move of the thread with the deepest search
+   // if it has also a better score
+
+   if (SearchInput->multipv != 0 || SearchBest[0].move == MoveNone) return;
+
+   best = NULL;
+   depth = SearchBest[0].depth;
+   value = SearchBest[0].value;
+
+   for (i = 0; i < ThreadNb; i++) {
+      if (Threads[i]->depth > depth && Threads[i]->best->move != MoveNone && Threads[i]->best->value > value) {
+         best = Threads[i];
+         depth = best->depth;
+         value = best->best->value;
+      }
+   }
+
+   if (best == NULL) return;
+
+   SearchBest[0] = *best->best;
+
+   pv_to_string(SearchBest[0].pv,pv_string,512);
+   mate = value_to_mate(SearchBest[0].value);
+
+   if (mate == 0) {
+      send("info depth %d score cp %d nodes " S64_FORMAT " pv %s",SearchBest[0].depth,SearchBest[0].value,SearchCurrent->total_node_nb,pv_string);
+   } else {
+      send("info depth %d score mate %d nodes " S64_FORMAT " pv %s",SearchBest[0].depth,mate,SearchCurrent->total_node_nb,pv_string);
+   }
+}
+
 // end of search.cpp
 
@@ -53,7 +53,7 @@ struct search_input_t {
    list_t list[1];
    bool infinite;
    bool depth_is_limited;
-   int depth_limit;
+   int depth_limit;
    bool nodes_is_limited;
    int nodes_limit;   
    int multipv;
@@ -100,6 +100,7 @@ struct search_current_t {
    int max_extensions; // Thomas
    int multipv;
    sint64 node_nb;
+   sint64 total_node_nb; // nodes of all the threads
    double time;
    double speed;
    double cpu;
@@ -107,12 +108,15 @@ struct search_current_t {
 
 // variables
 
-extern search_param_t SearchStack[HeightMax]; // Thomas
-extern search_input_t SearchInput[1];
-extern search_info_t SearchInfo[1];
-extern search_best_t SearchBest[MultiPVMax];
-extern search_root_t SearchRoot[1];
-extern search_current_t SearchCurrent[1];
+extern search_input_t SearchInput[1]; // shared by all the threads
+
+// per search thread
+
+extern thread_local search_param_t SearchStack[HeightMax]; // Thomas
+extern thread_local search_info_t SearchInfo[1];
+extern thread_local search_best_t SearchBest[MultiPVMax];
+extern thread_local search_root_t SearchRoot[1];
+extern thread_local search_current_t SearchCurrent[1];
 
 // functions
 
@@ -125,15 +125,11 @@ static bool passed_pawn_move     (int move, const board_t * board);
 
 // functions
 
-// search_full_init()
+// search_full_parameter()
 
-void search_full_init(list_t * list, board_t * board) {
+void search_full_parameter() {
 
    const char * string;
-   int trans_move, trans_min_depth, trans_max_depth, trans_min_value, trans_max_value;
-
-   ASSERT(list_is_ok(list));
-   ASSERT(board_is_ok(board));
 
    // null-move options
 
@@ -201,6 +197,16 @@ void search_full_init(list_t * list, board_t * board) {
 
    CheckNb = option_get_int("Quiescence Check Plies");
    CheckDepth = 1 - CheckNb;
+}
+
+// search_full_init()
+
+void search_full_init(list_t * list, board_t * board) {
+
+   int trans_move, trans_min_depth, trans_max_depth, trans_min_value, trans_max_value;
+
+   ASSERT(list_is_ok(list));
+   ASSERT(board_is_ok(board));
 
    // standard sort
 
@@ -560,6 +566,7 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 		 //new_depth = depth - R_adpt(board->piece_size[board->turn]+board->pawn_size[board->turn],depth,NullReduction) - 1;
 		 
 	     move_do_null(board,undo);
+         if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key);
          value = -full_search(board,-beta,-beta+1,new_depth,height+1,new_pv,NODE_OPP(node_type));
          move_undo_null(board,undo);
 
@@ -746,6 +753,7 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
       // recursive search
 
 	  move_do(board,move,undo);
+      if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key); // probed by the child
 
       if (node_type != NodePV || best_value == ValueNone) { // first move
 		 value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
@@ -902,6 +910,7 @@ static int full_no_null(board_t * board, int alpha, int beta, int depth, int hei
       new_depth = full_new_depth(depth,move,board,false,false,false,height);
 
       move_do(board,move,undo);
+      if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key);
       value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
       move_undo(board,move,undo);
 
@@ -78,12 +78,14 @@ static int PosCaptureQS;
 
 static int Code[CODE_SIZE];
 
-static uint16 Killer[HeightMax][KillerNb];
+// per search thread
 
-static fail_high_stats_t FailHighStats[HistorySize];
-static uint16 History[HistorySize];
-static uint16 HistHit[HistorySize];
-static uint16 HistTot[HistorySize];
+static thread_local uint16 Killer[HeightMax][KillerNb];
+
+static thread_local fail_high_stats_t FailHighStats[HistorySize];
+static thread_local uint16 History[HistorySize];
+static thread_local uint16 HistHit[HistorySize];
+static thread_local uint16 HistTot[HistorySize];
 
 // prototypes
 
@@ -111,25 +113,9 @@ static int  history_index     (int move, const board_t * board);
 
 void sort_init() {
 
-   int i, height;
    int pos;
 
-   // killer
-
-   for (height = 0; height < HeightMax; height++) {
-      for (i = 0; i < KillerNb; i++) Killer[height][i] = MoveNone;
-   }
-
-   // history
-
-   for (i = 0; i < HistorySize; i++) History[i] = 0;
-
-   for (i = 0; i < HistorySize; i++) {
-      HistHit[i] = 1;
-      HistTot[i] = 1;
-	  FailHighStats[i].success = 1;
-	  FailHighStats[i].tried = 1;
-   }
+   sort_clear();
 
    // Code[]
 
@@ -169,6 +155,30 @@ void sort_init() {
    ASSERT(pos<CODE_SIZE);
 }
 
+// sort_clear()
+
+void sort_clear() {
+
+   int i, height;
+
+   // killer
+
+   for (height = 0; height < HeightMax; height++) {
+      for (i = 0; i < KillerNb; i++) Killer[height][i] = MoveNone;
+   }
+
+   // history
+
+   for (i = 0; i < HistorySize; i++) History[i] = 0;
+
+   for (i = 0; i < HistorySize; i++) {
+      HistHit[i] = 1;
+      HistTot[i] = 1;
+	  FailHighStats[i].success = 1;
+	  FailHighStats[i].tried = 1;
+   }
+}
+
 // sort_init()
 
 void sort_init(sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer) {
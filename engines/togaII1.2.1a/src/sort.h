@@ -40,6 +40,7 @@ struct sort_t {
 // functions
 
 extern void sort_init    ();
+extern void sort_clear   ();
 
 extern void sort_init    (sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer);
 extern int  sort_next    (sort_t * sort);
@@ -3,6 +3,13 @@
 
 // includes
 
+#include <atomic>
+#include <cstdlib>
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
 #include "hash.h"
 #include "move.h"
 #include "option.h"
@@ -24,8 +31,12 @@ static const int DateSize = 16;
 
 static const int ClusterSize = 4; // TODO: unsigned?
 
+static const uint64 PageSize = 2 * 1024 * 1024; // huge-page size
+
 static const int DepthNone = -128;
 
+static const uint32 StatSize = 4096; // entries sampled by trans_stats()
+
 // types
 
 struct entry_t {
@@ -41,18 +52,29 @@ struct entry_t {
    sint16 max_value;
 };
 
+// the table is shared by the search threads without locks: an entry is stored
+// as two 64-bit words, and the word with the lock is XORed with the data word.
+// An entry written concurrently by two threads does not match any key.
+
+struct slot_t {
+   std::atomic<uint64> key; // lock (32 bits) and values (32 bits) ^ data
+   std::atomic<uint64> data;
+};
+
+// a cluster fills exactly one cache line, a probe touches a single line
+
+struct alignas(64) cluster_t {
+   slot_t slot[ClusterSize];
+};
+
 struct trans { // HACK: typedef'ed in trans.h
-   entry_t * table;
-   uint32 size;
-   uint32 mask;
+   cluster_t * table;
+   uint64 size; // clusters
+   uint64 mask;
+   void * memory; // NULL if mapped with explicit huge pages
+   uint64 mapped;
    int date;
    int age[DateSize];
-   uint32 used;
-   sint64 read_nb;
-   sint64 read_hit;
-   sint64 write_nb;
-   sint64 write_hit;
-   sint64 write_collision;
 };
 
 // variables
@@ -64,7 +86,13 @@ trans_t Trans[1];
 static void      trans_set_date (trans_t * trans, int date);
 static int       trans_age      (const trans_t * trans, int date);
 
-static entry_t * trans_entry    (trans_t * trans, uint64 key);
+static cluster_t * trans_entry  (const trans_t * trans, uint64 key);
+
+static void      table_alloc    (trans_t * trans, uint64 bytes);
+static void      table_free     (trans_t * trans);
+
+static void      entry_load     (const slot_t * slot, entry_t * entry);
+static void      entry_save     (slot_t * slot, const entry_t * entry);
 
 // static bool      entry_is_ok    (const entry_t * entry);
 
@@ -96,11 +124,14 @@ void trans_init(trans_t * trans) {
 
    ASSERT(trans!=NULL);
 
-   ASSERT(sizeof(entry_t)==16);
+   ASSERT(sizeof(slot_t)==16);
+   ASSERT(sizeof(cluster_t)==64);
 
    trans->size = 0;
    trans->mask = 0;
    trans->table = NULL;
+   trans->memory = NULL;
+   trans->mapped = 0;
 
    trans_set_date(trans,0);
 
@@ -113,17 +144,17 @@ void trans_init(trans_t * trans) {
 
 void trans_alloc(trans_t * trans) {
 
-   uint32 size, target;
+   uint64 size, target;
 
    ASSERT(trans!=NULL);
 
-   // calculate size
+   // calculate size (64-bit, the table may be larger than 4 GB)
 
    target = option_get_int("Hash");
    if (target < 4) target = 16;
    target *= 1024 * 1024;
 
-   for (size = 1; size != 0 && size <= target; size *= 2)
+   for (size = 1; size <= target; size *= 2)
       ;
 
    size /= 2;
@@ -131,14 +162,14 @@ void trans_alloc(trans_t * trans) {
 
    // allocate table
 
-   size /= sizeof(entry_t);
+   table_alloc(trans,size);
+
+   size /= sizeof(cluster_t);
    ASSERT(size!=0&&(size&(size-1))==0); // power of 2
 
-   trans->size = size + (ClusterSize - 1); // HACK to avoid testing for end of table
+   trans->size = size;
    trans->mask = size - 1;
 
-   trans->table = (entry_t *) my_malloc(trans->size*sizeof(entry_t));
-
    trans_clear(trans);
 
    ASSERT(trans_is_ok(trans));
@@ -150,7 +181,7 @@ void trans_free(trans_t * trans) {
 
    ASSERT(trans_is_ok(trans));
 
-   my_free(trans->table);
+   table_free(trans);
 
    trans->table = NULL;
    trans->size = 0;
@@ -162,8 +193,8 @@ void trans_free(trans_t * trans) {
 void trans_clear(trans_t * trans) {
 
    entry_t clear_entry[1];
-   entry_t * entry;
-   uint32 index;
+   uint64 index;
+   int i;
 
    ASSERT(trans!=NULL);
 
@@ -182,10 +213,10 @@ void trans_clear(trans_t * trans) {
 
 //    ASSERT(entry_is_ok(clear_entry));
 
-   entry = trans->table;
-
    for (index = 0; index < trans->size; index++) {
-      *entry++ = *clear_entry;
+      for (i = 0; i < ClusterSize; i++) {
+         entry_save(&trans->table[index].slot[i],clear_entry);
+      }
    }
 }
 
@@ -210,13 +241,6 @@ static void trans_set_date(trans_t * trans, int date) {
    for (date = 0; date < DateSize; date++) {
       trans->age[date] = trans_age(trans,date);
    }
-
-   trans->used = 0;
-   trans->read_nb = 0;
-   trans->read_hit = 0;
-   trans->write_nb = 0;
-   trans->write_hit = 0;
-   trans->write_collision = 0;
 }
 
 // trans_age()
@@ -240,7 +264,8 @@ static int trans_age(const trans_t * trans, int date) {
 
 void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value, int max_value) {
 
-   entry_t * entry, * best_entry;
+   slot_t * slot, * best_slot;
+   entry_t entry[1];
    int score, best_score;
    int i;
 
@@ -251,26 +276,21 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
    ASSERT(max_value>=-ValueInf&&max_value<=+ValueInf);
    ASSERT(min_value<=max_value);
 
-   // init
-
-   trans->write_nb++;
-
    // probe
 
-   best_entry = NULL;
+   best_slot = NULL;
    best_score = -32767;
 
-   entry = trans_entry(trans,key);
+   slot = trans_entry(trans,key)->slot;
+
+   for (i = 0; i < ClusterSize; i++, slot++) {
 
-   for (i = 0; i < ClusterSize; i++, entry++) {
+      entry_load(slot,entry);
 
       if (entry->lock == KEY_LOCK(key)) {
 
          // hash hit => update existing entry
 
-         trans->write_hit++;
-         if (entry->date != trans->date) trans->used++;
-
          entry->date = trans->date;
 
          if (trans_endgame || depth > entry->depth) entry->depth = depth; 
@@ -296,6 +316,8 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
 
 //          ASSERT(entry_is_ok(entry));
 
+         entry_save(slot,entry);
+
          return;
       }
 
@@ -305,27 +327,17 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
       ASSERT(score>-32767);
 
       if (score > best_score) {
-         best_entry = entry;
+         best_slot = slot;
          best_score = score;
       }
    }
 
    // "best" entry found
 
-   entry = best_entry;
-   ASSERT(entry!=NULL);
-   ASSERT(entry->lock!=KEY_LOCK(key));
-
-   if (entry->date == trans->date) {
-      trans->write_collision++;
-   } else {
-      trans->used++;
-   }
+   ASSERT(best_slot!=NULL);
 
    // store
 
-   ASSERT(entry!=NULL);
-
    entry->lock = KEY_LOCK(key);
    entry->date = trans->date;
 
@@ -340,13 +352,16 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
    entry->max_value = max_value;
 
 //    ASSERT(entry_is_ok(entry));
+
+   entry_save(best_slot,entry);
 }
 
 // trans_retrieve()
 
 bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, int * max_depth, int * min_value, int * max_value) {
 
-   entry_t * entry;
+   slot_t * slot;
+   entry_t entry[1];
    int i;
 
    ASSERT(trans_is_ok(trans));
@@ -356,22 +371,22 @@ bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, in
    ASSERT(min_value!=NULL);
    ASSERT(max_value!=NULL);
 
-   // init
-
-   trans->read_nb++;
-
    // probe
 
-   entry = trans_entry(trans,key);
+   slot = trans_entry(trans,key)->slot;
 
-   for (i = 0; i < ClusterSize; i++, entry++) {
+   for (i = 0; i < ClusterSize; i++, slot++) {
+
+      entry_load(slot,entry);
 
       if (entry->lock == KEY_LOCK(key)) {
 
          // found
 
-         trans->read_hit++;
-         if (entry->date != trans->date) entry->date = trans->date;
+         if (entry->date != trans->date) {
+            entry->date = trans->date;
+            entry_save(slot,entry);
+         }
 
          *move = entry->move;
 
@@ -393,30 +408,47 @@ bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, in
 
 void trans_stats(const trans_t * trans) {
 
-   double full;
-   // double hit, collision;
+   entry_t entry[1];
+   uint32 index, size, used;
 
    ASSERT(trans_is_ok(trans));
 
-   full = double(trans->used) / double(trans->size);
-   // hit = double(trans->read_hit) / double(trans->read_nb);
-   // collision = double(trans->write_collision) / double(trans->write_nb);
+   // sample the beginning of the table, the threads do not count the entries
 
-   send("info hashfull %.0f",full*1000.0);
+   size = uint32(MIN(trans->size*ClusterSize,StatSize));
+   used = 0;
+
+   for (index = 0; index < size; index++) {
+      entry_load(&trans->table[index/ClusterSize].slot[index%ClusterSize],entry);
+      if (entry->date == trans->date && entry->depth != DepthNone) used++;
+   }
+
+   send("info hashfull %.0f",double(used)*1000.0/double(size));
+}
+
+// trans_prefetch()
+
+void trans_prefetch(const trans_t * trans, uint64 key) {
+
+#if defined(__GNUC__)
+   __builtin_prefetch(trans_entry(trans,key));
+#endif
 }
 
 // trans_entry()
 
-static entry_t * trans_entry(trans_t * trans, uint64 key) {
+static cluster_t * trans_entry(const trans_t * trans, uint64 key) {
 
-   uint32 index;
+   uint64 index;
 
    ASSERT(trans_is_ok(trans));
 
+   // the high bits of the index overlap the lock only with more than 2^32 clusters (256 GB)
+
    if (UseModulo) {
-      index = KEY_INDEX(key) % (trans->mask + 1);
+      index = key % (trans->mask + 1);
    } else {
-      index = KEY_INDEX(key) & trans->mask;
+      index = key & trans->mask;
    }
 
    ASSERT(index<=trans->mask);
@@ -424,6 +456,119 @@ static entry_t * trans_entry(trans_t * trans, uint64 key) {
    return &trans->table[index];
 }
 
+// table_alloc()
+
+static void table_alloc(trans_t * trans, uint64 bytes) {
+
+   uint64 align;
+   char * address;
+
+   ASSERT(trans!=NULL);
+   ASSERT(bytes>=sizeof(cluster_t));
+
+   trans->memory = NULL;
+   trans->mapped = 0;
+
+#ifdef __linux__
+
+   // explicit huge pages, if reserved by the administrator (vm.nr_hugepages)
+
+   if (option_get_bool("Large Pages") && bytes % PageSize == 0) {
+
+      void * map = mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+
+      if (map != MAP_FAILED) {
+         trans->table = (cluster_t *) map;
+         trans->mapped = bytes;
+         return;
+      }
+   }
+
+#endif
+
+   // otherwise transparent huge pages: align the table on a huge page
+
+   align = (option_get_bool("Large Pages") && bytes >= PageSize) ? PageSize : sizeof(cluster_t);
+
+   trans->memory = malloc(size_t(bytes + align));
+   if (trans->memory == NULL) my_fatal("trans_alloc(): not enough memory for %.0f MB\n",double(bytes)/(1024.0*1024.0));
+
+   address = (char *) trans->memory;
+   address += align - uint64(address) % align;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if (align == PageSize) madvise(address,bytes,MADV_HUGEPAGE);
+#endif
+
+   trans->table = (cluster_t *) address;
+}
+
+// table_free()
+
+static void table_free(trans_t * trans) {
+
+   ASSERT(trans!=NULL);
+
+#ifdef __linux__
+   if (trans->mapped != 0) munmap(trans->table,trans->mapped);
+#endif
+
+   free(trans->memory);
+
+   trans->memory = NULL;
+   trans->mapped = 0;
+}
+
+// entry_load()
+
+static void entry_load(const slot_t * slot, entry_t * entry) {
+
+   uint64 key, data;
+
+   ASSERT(slot!=NULL);
+   ASSERT(entry!=NULL);
+
+   data = slot->data.load(std::memory_order_relaxed);
+   key = slot->key.load(std::memory_order_relaxed) ^ data;
+
+   entry->lock = uint32(key >> 32);
+   entry->min_value = sint16(key >> 16);
+   entry->max_value = sint16(key);
+
+   entry->move = uint16(data);
+   entry->depth = sint8(data >> 16);
+   entry->date = uint8(data >> 24);
+   entry->move_depth = sint8(data >> 32);
+   entry->flags = uint8(data >> 40);
+   entry->min_depth = sint8(data >> 48);
+   entry->max_depth = sint8(data >> 56);
+}
+
+// entry_save()
+
+static void entry_save(slot_t * slot, const entry_t * entry) {
+
+   uint64 key, data;
+
+   ASSERT(slot!=NULL);
+   ASSERT(entry!=NULL);
+
+   data = uint64(entry->move)
+        | uint64(uint8(entry->depth)) << 16
+        | uint64(entry->date) << 24
+        | uint64(uint8(entry->move_depth)) << 32
+        | uint64(entry->flags) << 40
+        | uint64(uint8(entry->min_depth)) << 48
+        | uint64(uint8(entry->max_depth)) << 56;
+
+   key = uint64(entry->lock) << 32
+       | uint64(uint16(entry->min_value)) << 16
+       | uint64(uint16(entry->max_value));
+
+   slot->key.store(key ^ data,std::memory_order_relaxed);
+   slot->data.store(data,std::memory_order_relaxed);
+}
+
 // entry_is_ok()
 
 // static bool entry_is_ok(const entry_t * entry) {
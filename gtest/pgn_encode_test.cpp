@@ -23,9 +23,12 @@
 #include "game.h"
 #include "pgn_encode.h"
 #include "pgnparse.h"
+#include "scidbase.h"
+#include <cstring>
 #include <gtest/gtest.h>
 #include <string>
 #include <string_view>
+#include <vector>
 
 TEST(Test_PgnEncode, break_lines) {
 	using namespace std::literals;
@@ -284,3 +287,82 @@ TEST(Test_PgnEncode, encode) {
 		EXPECT_STREQ(pgn.c_str(), expected);
 	}
 }
+
+TEST(Test_PgnEncode, encodePGN) {
+	auto expect_same = [](scidBaseT const& dbase) {
+		Game game;
+		std::string expected;
+		std::vector<char> pgn;
+		for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+			const IndexEntry& ie = *dbase.getIndexEntry(i);
+			ASSERT_EQ(OK, dbase.getGame(ie, game));
+			SAN_hack(game);
+			expected.clear();
+			pgn::encode(game, expected);
+
+			pgn.assign(3, 'x'); // the game is appended
+			ASSERT_EQ(OK, dbase.getGamePGN(ie, pgn));
+			ASSERT_EQ(expected, std::string_view(pgn.data() + 3, pgn.size() - 3))
+			    << "game " << i;
+		}
+	};
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly,
+		                         SCID_TESTDIR "res_database"));
+		expect_same(dbase);
+	}
+
+	const char* games[] = {
+	    R"([Event "Comments, variations and nags"]
+[WhiteElo "2400"]
+[BlackElo "2300"]
+[BlackType "fide"]
+[ECO "C20"]
+[Annotator "Someone"]
+[EventDate "2020.01.01"]
+
+{pre} 1. e4 {comm} ({pre var} 1. d4 d5 {end var with comm}) 1... e5 $1 {nag}
+(1... c5 $2 (1... c6 {nested} 2. d4) 2. Nf3 {var end}) (1... e6) 2. Nf3 $14
+{last} 1-0
+)",
+	    R"([Event "Start position"]
+[SetUp "1"]
+[FEN "4k3/P7/8/8/8/8/8/4K3 w - - 0 40"]
+
+40. a8=Q+ {promotion} Kd7 41. Qb7+ (41. Qa4+ $6) 41... Kd6 *
+)",
+	    R"([Event "Chess960"]
+[Variant "Chess960"]
+[FEN "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9"]
+
+9. Nb4 Nd7 {knight} 10. c3 Qc7 1/2-1/2
+)",
+	    R"([Event "Mate"]
+
+1. f3 e5 2. g4 Qh4# 0-1
+)",
+	    R"([Event "Empty"]
+
+{Only a comment} *
+)"};
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	for (auto pgn : games) {
+		Game game;
+		PgnParseLog parseLog;
+		ASSERT_TRUE(pgnParseGame(pgn, std::strlen(pgn), game, parseLog))
+		    << pgn;
+		ASSERT_EQ(OK, dbase.saveGame(&game));
+	}
+	expect_same(dbase);
+
+	// In case of errors the destination is not modified.
+	const IndexEntry& ie = *dbase.getIndexEntry(0);
+	auto data = dbase.getGame(ie);
+	std::vector<byte> truncated(data.data(), data.data() + data.size() / 2);
+	std::vector<char> pgn = {'x'};
+	EXPECT_NE(OK, encodePGN(ie, dbase.tagRoster(ie),
+	                        {truncated.data(), truncated.size()}, pgn));
+	EXPECT_EQ(std::vector<char>{'x'}, pgn);
+}
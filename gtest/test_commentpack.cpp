@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "codec.h"
+#include "commentpack.h"
+#include "game.h"
+#include "index.h"
+#include "namebase.h"
+#include "scidbase.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* comments[] = {
+    "",
+    "[%clk 0:03:00]",
+    "[%clk 1:40:57]",
+    "[%clk 0:09:58.2]",
+    "[%clk 100:00:00]",
+    "[%eval 0.17] [%clk 0:03:00]",
+    "[%clk 0:03:00] [%eval -1.5]",
+    "[%eval #-3] [%clk 0:00:59]",
+    "[%eval #12]",
+    "[%eval -0.05]",
+    "[%eval 12.345]",
+    "[%eval 3]",
+    "Good move [%clk 0:01:02]",
+    "[%clk 0:01:02] Good move",
+    "[%eval 0.3] [%clk 0:01:02] A [%clk 0:01:02]",
+    "Just text",
+    // Not packable: kept as text
+    "[%clk 01:40:57]",
+    "[%clk 0:3:00]",
+    "[%eval +0.5]",
+    "[%eval -0.00]",
+    "[%eval 1.]",
+    "[%clk 0:03:00]  double space",
+    "[%clk 0:03:00] ",
+    " [%clk 0:03:00]",
+    "[%clk 0:03:00] [%clk 0:03:00]",
+    "[%csl Ga4] [%clk 0:03:00]",
+    "[%clk 0:03:00",
+    "[%",
+};
+
+std::vector<unsigned char> makeSection(std::vector<std::string> const& vec) {
+	std::vector<unsigned char> res;
+	for (auto const& str : vec) {
+		res.insert(res.end(), str.begin(), str.end());
+		res.push_back(0);
+	}
+	return res;
+}
+
+} // namespace
+
+TEST(Test_CommentPack, roundtrip) {
+	std::vector<std::string> all;
+	for (auto comment : comments) {
+		all.emplace_back(comment);
+		const auto section = makeSection({comment});
+		std::vector<unsigned char> packed;
+		ASSERT_TRUE(commentpack::pack(section.data(),
+		                              section.data() + section.size(), packed));
+		std::vector<unsigned char> unpacked;
+		ASSERT_TRUE(commentpack::unpack(packed.data(),
+		                                packed.data() + packed.size(), unpacked));
+		EXPECT_EQ(section, unpacked) << comment;
+	}
+
+	const auto section = makeSection(all);
+	std::vector<unsigned char> packed;
+	ASSERT_TRUE(commentpack::pack(section.data(),
+	                              section.data() + section.size(), packed));
+	std::vector<unsigned char> unpacked;
+	ASSERT_TRUE(commentpack::unpack(packed.data(),
+	                                packed.data() + packed.size(), unpacked));
+	EXPECT_EQ(section, unpacked);
+
+	// Corrupted data
+	for (size_t i = 0; i < packed.size(); ++i) {
+		unpacked.clear();
+		EXPECT_FALSE(commentpack::unpack(packed.data(), packed.data() + i,
+		                                 unpacked));
+	}
+
+	// A comments section must be null-terminated
+	EXPECT_FALSE(commentpack::pack(section.data(),
+	                               section.data() + section.size() - 1, packed));
+}
+
+TEST(Test_CommentPack, clocks) {
+	std::vector<std::string> vec;
+	for (int i = 0; i < 80; ++i) {
+		const int sec = 180 - i;
+		vec.push_back("[%eval 0." + std::to_string(i % 8) + "] [%clk 0:0" +
+		              std::to_string(sec / 60) + ":" +
+		              std::to_string(sec % 60 / 10) +
+		              std::to_string(sec % 10) + "]");
+	}
+	const auto section = makeSection(vec);
+	std::vector<unsigned char> packed;
+	ASSERT_TRUE(commentpack::pack(section.data(),
+	                              section.data() + section.size(), packed));
+	// 1 byte for the kind, 1 byte for the clock, 1 byte for the eval
+	// (the first two clocks are not deltas and need 2 bytes).
+	EXPECT_EQ(1 + vec.size() * 3 + 2, packed.size());
+
+	std::vector<unsigned char> unpacked;
+	ASSERT_TRUE(commentpack::unpack(packed.data(),
+	                                packed.data() + packed.size(), unpacked));
+	EXPECT_EQ(section, unpacked);
+}
+
+TEST(Test_CommentPack, codecSCID5) {
+	const char* filename = "test_commentpack";
+	Index idx;
+	NameBase nb;
+	auto err = ICodecDatabase::open(ICodecDatabase::SCID5, FMODE_Create,
+	                                filename, Progress(), &idx, &nb);
+	auto codec = std::unique_ptr<ICodecDatabase>(err.first);
+	ASSERT_NE(nullptr, codec);
+	ASSERT_EQ(OK, err.second);
+	const auto filenames = codec->getFilenames();
+
+	std::vector<std::vector<byte>> native;
+	Game game;
+	for (int i = 0; i < 3; ++i) {
+		game.Clear();
+		int ply = 0;
+		for (auto san : {"e4", "e5", "Nf3", "Nc6", "Bb5", "a6", "Ba4"}) {
+			simpleMoveT sm;
+			ASSERT_EQ(OK, game.GetCurrentPos()->ParseMove(&sm, san));
+			ASSERT_EQ(OK, game.AddMove(sm));
+			const auto clk = std::to_string(59 - ply++);
+			if (i == 0)
+				game.SetMoveComment(("[%clk 1:00:" + clk + "]").c_str());
+			else if (i == 1)
+				game.SetMoveComment(comments[ply]);
+		}
+		auto& data = native.emplace_back();
+		auto [ie, tags] = game.Encode(data);
+		EXPECT_EQ(OK, codec->addGame(ie, tags, {data.data(), data.size()}));
+	}
+	ASSERT_EQ(OK, codec->flush());
+
+	ASSERT_EQ(native.size(), idx.GetNumGames());
+	// The clocks are packed
+	EXPECT_LT(idx.GetEntry(0)->GetLength(), native[0].size());
+	// No comments
+	EXPECT_EQ(idx.GetEntry(2)->GetLength(), native[2].size());
+
+	for (gamenumT i = 0; i < idx.GetNumGames(); ++i) {
+		const IndexEntry& ie = *idx.GetEntry(i);
+		auto data = codec->getGameData(ie.GetOffset(), ie.GetLength());
+		ASSERT_TRUE(data);
+		EXPECT_TRUE(std::equal(data.data(), data.data() + data.size(),
+		                       native[i].begin(), native[i].end()));
+
+		auto moves = codec->getGameMoves(ie);
+		ASSERT_TRUE(moves);
+		EXPECT_EQ(OK, moves.decodeStartBoard().first);
+		int nMoves = 0;
+		while (moves.nextLineMove().first == OK)
+			++nMoves;
+		EXPECT_EQ(7, nMoves);
+	}
+
+	codec = nullptr;
+	for (auto const& fname : filenames) {
+		EXPECT_EQ(0, std::remove(fname.c_str()));
+	}
+}
+
+namespace {
+/// Returns true if the SCID5 namebase file contains the VERSION 2 string.
+bool hasVersion2(std::string const& nbfile) {
+	std::ifstream file(nbfile, std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(file)),
+	                 std::istreambuf_iterator<char>());
+	return data.find("\x0D"
+	                 "2") != data.npos;
+}
+
+/// Adds some moves, each with a clock comment, to @e game.
+void addClockMoves(Game& game) {
+	for (auto san : {"e4", "e5", "Nf3", "Nc6", "Bb5", "a6", "Ba4"}) {
+		simpleMoveT sm;
+		EXPECT_EQ(OK, game.GetCurrentPos()->ParseMove(&sm, san));
+		EXPECT_EQ(OK, game.AddMove(sm));
+		game.SetMoveComment("[%clk 1:00:00]");
+	}
+}
+} // namespace
+
+TEST(Test_CommentPack, codecSCID5Version) {
+	const char* filename = "test_commentpack_version";
+	auto open = [&](fileModeT fmode, Index& idx, NameBase& nb) {
+		auto res = ICodecDatabase::open(ICodecDatabase::SCID5, fmode,
+		                                filename, Progress(), &idx, &nb);
+		return std::make_pair(std::unique_ptr<ICodecDatabase>(res.first),
+		                      res.second);
+	};
+
+	std::vector<byte> native;
+	Game game;
+	addClockMoves(game);
+	auto [ie, tags] = game.Encode(native);
+
+	std::vector<byte> plain;
+	Game plainGame;
+	auto [plainIe, plainTags] = plainGame.Encode(plain);
+
+	// A new database is not versioned until a game needs the packed encoding.
+	std::vector<std::string> filenames;
+	{
+		Index idx;
+		NameBase nb;
+		auto [codec, err] = open(FMODE_Create, idx, nb);
+		ASSERT_EQ(OK, err);
+		filenames = codec->getFilenames();
+		ASSERT_EQ(OK, codec->addGame(plainIe, plainTags,
+		                             {plain.data(), plain.size()}));
+	}
+	const auto& nbfile = filenames[2];
+	EXPECT_FALSE(hasVersion2(nbfile));
+
+	// A version 1 namebase (without the VERSION string): the comments are
+	// not packed, otherwise older programs would read them incorrectly.
+	{
+		Index idx;
+		NameBase nb;
+		auto [codec, err] = open(FMODE_Both, idx, nb);
+		ASSERT_EQ(OK, err);
+		ASSERT_EQ(OK, codec->addGame(ie, tags, {native.data(), native.size()}));
+		EXPECT_EQ(native.size(), idx.GetEntry(1)->GetLength());
+	}
+	EXPECT_FALSE(hasVersion2(nbfile));
+
+	// A new database with packed comments is upgraded to version 2.
+	for (auto const& fname : filenames) {
+		EXPECT_EQ(0, std::remove(fname.c_str()));
+	}
+	{
+		Index idx;
+		NameBase nb;
+		auto [codec, err] = open(FMODE_Create, idx, nb);
+		ASSERT_EQ(OK, err);
+		ASSERT_EQ(OK, codec->addGame(ie, tags, {native.data(), native.size()}));
+		EXPECT_LT(idx.GetEntry(0)->GetLength(), native.size());
+	}
+	EXPECT_TRUE(hasVersion2(nbfile));
+	{
+		Index idx;
+		NameBase nb;
+		auto [codec, err] = open(FMODE_Both, idx, nb);
+		ASSERT_EQ(OK, err);
+		ASSERT_EQ(OK, codec->addGame(ie, tags, {native.data(), native.size()}));
+		EXPECT_LT(idx.GetEntry(1)->GetLength(), native.size());
+		for (gamenumT i = 0; i < 2; ++i) {
+			auto data = codec->getGameData(idx.GetEntry(i)->GetOffset(),
+			                               idx.GetEntry(i)->GetLength());
+			EXPECT_TRUE(std::equal(data.data(), data.data() + data.size(),
+			                       native.begin(), native.end()));
+		}
+	}
+
+	// A future version is refused.
+	std::ofstream(nbfile, std::ios::binary | std::ios::app)
+	    .write("\x0D"
+	           "3",
+	           2);
+	{
+		Index idx;
+		NameBase nb;
+		EXPECT_EQ(ERROR_FileVersion, open(FMODE_ReadOnly, idx, nb).second);
+	}
+
+	for (auto const& fname : filenames) {
+		EXPECT_EQ(0, std::remove(fname.c_str()));
+	}
+}
+
+TEST(Test_CommentPack, compactSCID5Version) {
+	const std::string filename = "test_commentpack_compact";
+	const std::string nbfile = filename + ".sn5";
+	auto removeFiles = [&] {
+		for (auto ext : {".si5", ".sg5", ".sn5", ".sfp", ".stx"}) {
+			std::remove((filename + ext).c_str());
+		}
+	};
+
+	// Compacting a database without packed games does not version it.
+	Game plainGame;
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID5", FMODE_Create, filename.c_str()));
+		ASSERT_EQ(OK, dbase.saveGame(&plainGame));
+		ASSERT_EQ(OK, dbase.saveGame(&plainGame));
+		ASSERT_EQ(OK, dbase.compact(Progress()));
+		EXPECT_EQ(2U, dbase.numGames());
+	}
+	EXPECT_FALSE(hasVersion2(nbfile));
+	removeFiles();
+
+	// The packed games are still readable after compacting.
+	Game game;
+	addClockMoves(game);
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID5", FMODE_Create, filename.c_str()));
+		ASSERT_EQ(OK, dbase.saveGame(&game));
+		ASSERT_EQ(OK, dbase.saveGame(&plainGame));
+		ASSERT_EQ(OK, dbase.compact(Progress()));
+		EXPECT_EQ(2U, dbase.numGames());
+	}
+	EXPECT_TRUE(hasVersion2(nbfile));
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID5", FMODE_ReadOnly, filename.c_str()));
+		ASSERT_EQ(2U, dbase.numGames());
+		Game stored;
+		ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(0), stored));
+		std::vector<byte> expected, actual;
+		game.Encode(expected);
+		stored.Encode(actual);
+		EXPECT_EQ(expected, actual);
+	}
+	removeFiles();
+}
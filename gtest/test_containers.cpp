@@ -39,7 +39,15 @@ public:
 
 	RefCounted& operator=(const RefCounted&) = default;
 
-	RefCounted* clone() { return new RefCounted(*this); }
+	void saveState(std::vector<unsigned char>& dest) const {
+		dest.assign(ch, ch + sizeof ch);
+	}
+	int restoreState(const unsigned char* data, size_t size) {
+		if (size != sizeof ch)
+			return 1;
+		std::copy_n(data, size, ch);
+		return 0;
+	}
 
 	~RefCounted() { --nObjects; }
 };
@@ -119,63 +127,99 @@ TEST(Test_Containers, UndoRedo) {
 	UndoRedo<RefCounted, 10> cont; // max 10 elements
 
 	RefCounted* cur = new RefCounted();
+	cur->ch[1] = 'b';
+	cur->ch[2] = 'c';
 
 	for (char i = 0; i < 10; ++i) {
 		cur->ch[0] = i;
 		cont.store(cur);
-		EXPECT_EQ(i + 2, nObjects);
+		EXPECT_EQ(size_t(i + 1), cont.undoSize());
 	}
 
 	// Test max n. of elements
-	EXPECT_EQ(11, nObjects);
 	EXPECT_EQ(10U, cont.undoSize());
 	cur->ch[0] = 10;
 	cont.store(cur);
 	cur->ch[0] = 11;
-	EXPECT_EQ(11, nObjects);
 	EXPECT_EQ(10U, cont.undoSize());
 
 	// Test undo
 	for (char i = 10; i > 0; --i) {
 		EXPECT_EQ(size_t(i), cont.undoSize());
-		cur = cont.undo(cur);
+		EXPECT_EQ(0, cont.undo(cur));
 		EXPECT_EQ(i, cur->ch[0]);
-		EXPECT_EQ(11, nObjects);
+		EXPECT_EQ('b', cur->ch[1]);
+		EXPECT_EQ('c', cur->ch[2]);
 	}
 
 	// Test empty undo queue
 	for (int i = 0; i < 5; ++i) {
-		cur = cont.undo(cur);
+		EXPECT_EQ(0, cont.undo(cur));
 		EXPECT_EQ(1, cur->ch[0]);
-		EXPECT_EQ(11, nObjects);
 		EXPECT_EQ(0U, cont.undoSize());
 		EXPECT_EQ(10U, cont.redoSize());
 	}
 
 	// Test redo
 	for (char i = 2; i < 6; ++i) {
-		cur = cont.redo(cur);
+		EXPECT_EQ(0, cont.redo(cur));
 		EXPECT_EQ(i, cur->ch[0]);
-		EXPECT_EQ(11, nObjects);
 	}
+	EXPECT_EQ(0, cont.undo(cur));
+	EXPECT_EQ(4, cur->ch[0]);
+	EXPECT_EQ(0, cont.redo(cur));
+	EXPECT_EQ(5, cur->ch[0]);
 
 	// Test that store() clears redo queue
 	cur->ch[0] = 'a';
 	cont.store(cur);
-	EXPECT_EQ(6, nObjects);
 	EXPECT_EQ(5U, cont.undoSize());
 	EXPECT_EQ(0U, cont.redoSize());
 
-	// Test memory release
+	// The elements are never copied
+	EXPECT_EQ(1, nObjects);
+
 	cont.clear();
 	EXPECT_EQ(0U, cont.undoSize());
 	EXPECT_EQ(0U, cont.redoSize());
-	EXPECT_EQ(1, nObjects);
 	EXPECT_EQ('a', cur->ch[0]);
 
 	delete cur;
 }
 
+TEST(Test_Containers, UndoRedo_restoreError) {
+	struct Elem {
+		int value = 0;
+
+		void saveState(std::vector<unsigned char>& dest) const {
+			dest.assign(1, static_cast<unsigned char>(value));
+		}
+		int restoreState(const unsigned char* data, size_t) {
+			if (*data == 0xFF)
+				return 1;
+			value = *data;
+			return 0;
+		}
+	};
+	UndoRedo<Elem, 10> cont;
+	Elem elem;
+	cont.store(&elem);
+	elem.value = 0xFF;
+	cont.store(&elem);
+	elem.value = 2;
+
+	// The state is discarded and the element is not modified
+	EXPECT_EQ(1, cont.undo(&elem));
+	EXPECT_EQ(2, elem.value);
+	EXPECT_EQ(1U, cont.undoSize());
+	EXPECT_EQ(0U, cont.redoSize());
+
+	EXPECT_EQ(0, cont.undo(&elem));
+	EXPECT_EQ(0, elem.value);
+	EXPECT_EQ(0, cont.redo(&elem));
+	EXPECT_EQ(2, elem.value);
+}
+
 TEST(Test_Containers, ByteBuffer_GetTerminatedString) {
 	const char* test_data[] = {"abcd", "", "efg"};
 	auto v = [&] {
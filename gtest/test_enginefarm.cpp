@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "enginefarm.h"
+#include "pgnparse.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* pgnGame = R"([Event "Test"]
+
+1. e4 e5 2. Nf3 {A comment} Nc6 3. Bc4 Nd4 4. Nxe5 Qg5 *
+)";
+
+void parseGame(const char* pgn, Game& game) {
+	PgnParseLog parseLog;
+	ASSERT_TRUE(pgnParseGame(pgn, std::strlen(pgn), game, parseLog));
+}
+
+std::string movetext(Game& game) {
+	game.ResetPgnStyle();
+	game.AddPgnStyle(PGN_STYLE_COMMENTS);
+	game.AddPgnStyle(PGN_STYLE_VARS);
+	game.SetPgnFormat(PGN_FORMAT_Plain);
+	std::string pgn = game.WriteToPGN().first;
+	return pgn.substr(pgn.find("\n\n") + 2); // skip the tags
+}
+
+EngineEval makeEval(int cp, const char* pv) {
+	EngineEval res;
+	res.type = EngineEval::CP;
+	res.value = cp;
+	res.pv = pv;
+	return res;
+}
+
+} // namespace
+
+TEST(Test_EngineFarm, annotateGame) {
+	Game game;
+	parseGame(pgnGame, game);
+	std::vector<EngineEval> evals = {
+	    makeEval(30, "e2e4 e7e5"), makeEval(-30, "e7e5"),
+	    makeEval(40, "g1f3"),      makeEval(-40, "b8c6"),
+	    makeEval(35, "f1b5"),      makeEval(-30, "g8f6"),
+	    makeEval(30, "f3d4"),      makeEval(350, "d8g5"),
+	    makeEval(0, "")};
+	evals.back().type = EngineEval::NONE;
+	AnnotateOptions opt;
+	annotateGame(game, evals, opt);
+	EXPECT_TRUE(game.AtStart());
+	EXPECT_STREQ("Scid annotate", game.FindExtraTag("Annotator"));
+	EXPECT_TRUE(isAnnotated(game, opt));
+	EXPECT_EQ("1.e4 {[%eval 0.30]} 1...e5 {[%eval 0.40]} 2.Nf3 "
+	          "{[%eval 0.40] A comment} 2...Nc6 {[%eval 0.35]} 3.Bc4 "
+	          "{[%eval 0.30]} 3...Nd4 {[%eval 0.30]} 4.Nxe5 $4 {[%eval -3.50]} "
+	          "( 4.Nxd4 {[%eval 0.30]} ) 4...Qg5 *",
+	          movetext(game).substr(0, movetext(game).find('\n')));
+
+	// The [%eval] commands are replaced
+	evals[1] = makeEval(-100, "e7e5");
+	annotateGame(game, evals, opt);
+	EXPECT_NE(std::string::npos,
+	          movetext(game).find("1.e4 {[%eval 1.00]} 1...e5"));
+	EXPECT_STREQ("Scid annotate", game.FindExtraTag("Annotator"));
+
+	// The annotator is appended to the existing one
+	parseGame(pgnGame, game);
+	game.assignTagValue("Annotator", "Anand, V");
+	EXPECT_FALSE(isAnnotated(game, opt));
+	annotateGame(game, evals, opt);
+	EXPECT_STREQ("Anand, V, Scid annotate", game.FindExtraTag("Annotator"));
+	opt.annotator.clear();
+	EXPECT_FALSE(isAnnotated(game, opt));
+	opt = AnnotateOptions();
+
+	// Mates and the errors of lost positions
+	parseGame(pgnGame, game);
+	evals.assign(evals.size(), makeEval(-600, "a7a6"));
+	evals[0].type = evals[1].type = EngineEval::MATE;
+	evals[0].value = 2;
+	evals[0].pv = "a2a3";
+	evals[1].value = 1;
+	evals[3] = makeEval(600, "a2a3");
+	annotateGame(game, evals, opt);
+	EXPECT_EQ(0U, movetext(game).find(
+	                  "1.e4 $4 {[%eval #-1]} ( 1.a3 ) 1...e5 $4 {[%eval -6.00]} "
+	                  "( 1...a6 ) 2.Nf3 {[%eval -6.00] A comment} 2...Nc6"));
+}
+
+#if !defined(_WIN32)
+TEST(Test_EngineFarm, annotate) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	Game game;
+	parseGame(pgnGame, game);
+	for (int i = 0; i < 6; ++i) {
+		ASSERT_EQ(OK, dbase.saveGame(&game));
+	}
+	Game mate;
+	parseGame("[Event \"Mate\"]\n\n1. f3 e5 2. g4 Qh4# 0-1\n", mate);
+	ASSERT_EQ(OK, dbase.saveGame(&mate));
+	// The [%eval] comments written by other programs do not skip the game
+	Game evals;
+	parseGame("[Event \"Evals\"]\n\n1. e4 { [%eval 0.3] } e5 *\n", evals);
+	ASSERT_EQ(OK, dbase.saveGame(&evals));
+
+	const char* script = R"(while read -r cmd rest; do
+		case "$cmd" in
+			uci) echo "id name fake"; echo uciok;;
+			isready) echo readyok;;
+			go) echo "info depth 1 score cp 20 pv a2a3 h7h6"; echo "bestmove a2a3";;
+			quit) exit 0;;
+		esac
+	done)";
+	AnnotateOptions opt;
+	{
+		EngineFarm farm(opt);
+		ASSERT_EQ(OK, farm.open({"sh", "-c", script}, 3));
+		Progress progress;
+		auto [err, n] = farm.annotate(dbase, dbase.getFilter("dbfilter"), progress);
+		EXPECT_EQ(OK, err);
+		EXPECT_EQ(8U, n);
+	}
+	for (gamenumT gnum = 0; gnum < 6; ++gnum) {
+		ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(gnum), game));
+		EXPECT_EQ("1.e4 {[%eval -0.20]} 1...e5 {[%eval 0.20]} 2.Nf3 "
+		          "{[%eval -0.20] A comment} 2...Nc6 {[%eval 0.20]} 3.Bc4 "
+		          "{[%eval -0.20]} 3...Nd4 {[%eval 0.20]} 4.Nxe5 {[%eval -0.20]} "
+		          "4...Qg5 {[%eval 0.20]} *",
+		          movetext(game).substr(0, movetext(game).find('\n')));
+	}
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(6), game));
+	EXPECT_NE(std::string::npos,
+	          movetext(game).find("2.g4 {[%eval -0.20]} 2...Qh4# 0-1"));
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(7), game));
+	EXPECT_EQ(0U, movetext(game).find("1.e4 {[%eval -0.20]} 1...e5 "
+	                                  "{[%eval 0.20]} *"));
+
+	// The annotated games are skipped
+	{
+		EngineFarm farm(opt);
+		ASSERT_EQ(OK, farm.open({"sh", "-c", script}, 1));
+		Progress progress;
+		auto [err, n] =
+		    farm.annotate(dbase, dbase.getFilter("dbfilter"), progress);
+		EXPECT_EQ(OK, err);
+		EXPECT_EQ(0U, n);
+	}
+
+	// Unless the annotator is empty
+	opt.annotator.clear();
+	EngineFarm farm(opt);
+	ASSERT_EQ(OK, farm.open({"sh", "-c", script}, 1));
+	Progress progress;
+	auto [err, n] = farm.annotate(dbase, dbase.getFilter("dbfilter"), progress);
+	EXPECT_EQ(OK, err);
+	EXPECT_EQ(8U, n);
+
+	EngineFarm bad(opt);
+	EXPECT_EQ(ERROR_FileOpen, bad.open({"scid_nonexistent_engine"}, 1));
+	EXPECT_EQ(ERROR_FileRead, bad.open({"sh", "-c", "exit 0"}, 1));
+}
+#endif
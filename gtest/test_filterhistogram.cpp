@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filterhistogram.h"
+#include "scidbase.h"
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+TEST(Test_FilterHistogram, ranges) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly,
+	                         SCID_TESTDIR "res_database"));
+	HFilter filter = dbase.getFilter("dbfilter");
+	for (gamenumT gnum = 0, n = dbase.numGames(); gnum < n; gnum += 3) {
+		filter.set(gnum, 0);
+	}
+
+	auto ply = [&](gamenumT gnum) {
+		return dbase.getIndexEntry(gnum)->GetNumHalfMoves();
+	};
+	using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+	for (Ranges const& ranges : {
+	         Ranges{},
+	         Ranges{{0, 19}, {20, 39}, {40, 59}, {60, 79}, {80, 1023}},
+	         Ranges{{0, 49}, {40, 100}, {10, 10}, {30, 20}},
+	         Ranges{{50, 60}, {0, 0}, {61, 61}}}) {
+		std::vector<HistogramBucket> expected(ranges.size());
+		for (gamenumT gnum = 0, n = dbase.numGames(); gnum < n; ++gnum) {
+			for (size_t i = 0; i < ranges.size(); ++i) {
+				if (ply(gnum) < ranges[i].first || ply(gnum) > ranges[i].second)
+					continue;
+				++expected[i].all;
+				if (filter.get(gnum)) {
+					++expected[i].filtered;
+					++expected[i]
+					      .results[dbase.getIndexEntry(gnum)->GetResult()];
+				}
+			}
+		}
+
+		auto res = filterHistogram(dbase, filter, ranges, ply);
+		ASSERT_EQ(expected.size(), res.size());
+		for (size_t i = 0; i < ranges.size(); ++i) {
+			EXPECT_EQ(expected[i].all, res[i].all);
+			EXPECT_EQ(expected[i].filtered, res[i].filtered);
+			for (unsigned r = 0; r < NUM_RESULT_TYPES; ++r) {
+				EXPECT_EQ(expected[i].results[r], res[i].results[r]);
+			}
+		}
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fingerprint.h"
+#include "scidbase.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+class Test_Fingerprint : public ::testing::Test {
+protected:
+	static constexpr const char* database = SCID_TESTDIR "res_database";
+	static constexpr const char* filename = "test_fingerprint";
+
+	void TearDown() override {
+		for (auto ext : {".si4", ".sg4", ".sn4", ".sfp"}) {
+			std::remove((std::string(filename) + ext).c_str());
+		}
+	}
+};
+
+TEST_F(Test_Fingerprint, make) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+
+	Game game;
+	std::vector<byte> fp;
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		const IndexEntry& ie = *dbase.getIndexEntry(i);
+		fp.clear();
+		ASSERT_EQ(OK, GameFingerprints::make(game, dbase.getGame(ie), fp));
+
+		// Every position of the main line must be included.
+		ASSERT_EQ(OK, dbase.getGame(ie, game));
+		std::set<uint32_t> pawns;
+		std::set<matSigT> material;
+		game.MoveToStart();
+		do {
+			const Position* pos = game.currentPos();
+			pawns.insert(pos->PawnHashValue() & 0xFFFF);
+			material.insert(matsig_Make(pos->GetMaterial()));
+			EXPECT_TRUE(GameFingerprints::hasPawnHash(fp.data(),
+			                                          pos->PawnHashValue()));
+			EXPECT_TRUE(GameFingerprints::hasMatSig(
+			    fp.data(), matsig_Make(pos->GetMaterial())));
+		} while (game.MoveForward() == OK);
+
+		// And nothing else.
+		size_t nMaterial = 0;
+		GameFingerprints::anyMatSig(fp.data(), [&](matSigT msig) {
+			EXPECT_EQ(1U, material.count(msig));
+			++nMaterial;
+			return false;
+		});
+		EXPECT_EQ(material.size(), nMaterial);
+		for (uint32_t hash = 0; hash < 0x10000; hash += 97) {
+			EXPECT_EQ(pawns.count(hash) != 0,
+			          GameFingerprints::hasPawnHash(fp.data(), hash));
+		}
+	}
+}
+
+TEST_F(Test_Fingerprint, sidecar) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+	auto filter = src.getFilter("dbfilter");
+
+	std::vector<std::vector<byte>> expected;
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Create, filename));
+		ASSERT_EQ(OK, dbase.importGames(&src, filter, Progress()));
+		ASSERT_EQ(src.numGames(), dbase.numGames());
+
+		Game game;
+		for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+			const IndexEntry& ie = *dbase.getIndexEntry(i);
+			expected.emplace_back();
+			ASSERT_EQ(OK, GameFingerprints::make(game, dbase.getGame(ie),
+			                                     expected.back()));
+			const byte* fp = dbase.getFingerprint(i);
+			ASSERT_NE(nullptr, fp);
+			EXPECT_TRUE(std::equal(expected.back().begin(),
+			                       expected.back().end(), fp));
+		}
+
+		// Append the games again.
+		ASSERT_EQ(OK, dbase.importGames(&src, filter, Progress()));
+		for (gamenumT i = 0, n = src.numGames(); i < n; ++i) {
+			expected.push_back(expected[i]);
+		}
+	}
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Both, filename));
+	ASSERT_EQ(expected.size(), dbase.numGames());
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		const byte* fp = dbase.getFingerprint(i);
+		ASSERT_NE(nullptr, fp);
+		EXPECT_TRUE(std::equal(expected[i].begin(), expected[i].end(), fp));
+	}
+
+	// A replaced game is fingerprinted again.
+	Game game;
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(1), game));
+	ASSERT_EQ(OK, dbase.saveGame(&game, 0));
+	ASSERT_NE(nullptr, dbase.getFingerprint(0));
+	EXPECT_TRUE(std::equal(expected[1].begin(), expected[1].end(),
+	                       dbase.getFingerprint(0)));
+	EXPECT_NE(nullptr, dbase.getFingerprint(1));
+	{
+		scidBaseT reopened;
+		ASSERT_EQ(OK, reopened.open("SCID4", FMODE_ReadOnly, filename));
+		ASSERT_NE(nullptr, reopened.getFingerprint(0));
+		EXPECT_TRUE(std::equal(expected[1].begin(), expected[1].end(),
+		                       reopened.getFingerprint(0)));
+	}
+
+	// Compact rebuilds the sidecar file.
+	ASSERT_EQ(OK, dbase.compact(Progress()));
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		EXPECT_NE(nullptr, dbase.getFingerprint(i));
+	}
+}
+
+TEST_F(Test_Fingerprint, invalidGameNumber) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+	gamenumT nGames = 0;
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Create, filename));
+		ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"),
+		                                Progress()));
+		nGames = dbase.numGames();
+	}
+
+	// A record with a game number that is not in the database (that could
+	// force a huge allocation) invalidates the file, which is removed.
+	const std::string sfp = std::string(filename) + ".sfp";
+	for (gamenumT gnum : {nGames, gamenumT(0xFFFFFFF0)}) {
+		std::vector<byte> record;
+		sidecar::writeVarint(record, gnum);
+		sidecar::writeVarint(record, 0);
+		sidecar::writeVarint(record, 1);
+		record.insert(record.end(), {0, 0});
+		std::ofstream(sfp, std::ios::binary | std::ios::app)
+		    .write(reinterpret_cast<const char*>(record.data()), record.size());
+
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Both, filename));
+		EXPECT_EQ(nullptr, dbase.getFingerprint(0));
+		EXPECT_FALSE(std::ifstream(sfp));
+	}
+}
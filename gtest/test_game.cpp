@@ -14,6 +14,7 @@
  * along with Scid. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "containers.h"
 #include "game.h"
 #include "pgnparse.h"
 #include "scidbase.h"
@@ -23,6 +24,8 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -74,6 +77,94 @@ TEST(Test_Game, clone) {
 	}
 }
 
+TEST(Test_Game, saveState) {
+	auto pgn = [](Game& game) {
+		game.SetPgnFormat(PGN_FORMAT_Plain);
+		game.ResetPgnStyle(PGN_STYLE_TAGS | PGN_STYLE_VARS |
+		                   PGN_STYLE_COMMENTS | PGN_STYLE_SCIDFLAGS);
+		auto [buf, len] = game.WriteToPGN(75, true);
+		return std::string(buf, len);
+	};
+	for (auto filename : {gameUTF8, gameLatin1, gameLatin1Conv}) {
+
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("PGN", FMODE_Both, filename));
+		ASSERT_NE(nullptr, dbase.getIndexEntry_bounds(0));
+
+		Game game;
+		ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(0), game));
+		game.SetScidFlags("WB");
+		// Too long to be stored by Encode()
+		game.addTag(std::string(245, 'T'), "v");
+		std::mt19937 re(std::random_device{}());
+		game.MoveToLocationInPGN(std::uniform_int_distribution<>{0, 500}(re));
+		const auto location = game.GetLocationInPGN();
+		const auto expected = pgn(game);
+
+		std::vector<byte> state;
+		game.saveState(state);
+
+		Game restored;
+		ASSERT_EQ(OK, restored.restoreState(state.data(), state.size()));
+		EXPECT_EQ(location, restored.GetLocationInPGN());
+		EXPECT_EQ(game.GetPgnOffset(), restored.GetPgnOffset());
+		EXPECT_EQ(expected, pgn(restored));
+
+		// Corrupted data
+		for (size_t i = 0; i < state.size(); i += 7) {
+			restored.restoreState(state.data(), i);
+		}
+	}
+}
+
+TEST(Test_Game, undoRedo) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("PGN", FMODE_Both, gameUTF8));
+	ASSERT_NE(nullptr, dbase.getIndexEntry_bounds(0));
+
+	Game game;
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(0), game));
+	game.MoveToEnd();
+
+	UndoRedo<Game, 100> undo;
+	std::vector<std::string> history;
+	auto pgn = [&]() {
+		auto [buf, len] = game.WriteToPGN();
+		return std::string(buf, len) + std::to_string(game.GetLocationInPGN());
+	};
+	for (int i = 0; i < 20; ++i) {
+		history.push_back(pgn());
+		undo.store(&game);
+		switch (i % 4) {
+		case 0:
+			game.SetMoveComment(("Comment " + std::to_string(i)).c_str());
+			break;
+		case 1:
+			game.MoveBackup();
+			break;
+		case 2:
+			game.AddNag(static_cast<byte>(i));
+			break;
+		case 3:
+			game.SetWhiteStr("Player");
+			break;
+		}
+	}
+	const auto last = pgn();
+
+	for (auto it = history.rbegin(); it != history.rend(); ++it) {
+		ASSERT_EQ(OK, undo.undo(&game));
+		EXPECT_EQ(*it, pgn());
+	}
+	EXPECT_EQ(0U, undo.undoSize());
+	for (size_t i = 1; i < history.size(); ++i) {
+		ASSERT_EQ(OK, undo.redo(&game));
+		EXPECT_EQ(history[i], pgn());
+	}
+	EXPECT_EQ(OK, undo.redo(&game));
+	EXPECT_EQ(last, pgn());
+}
+
 TEST(Test_Game, locationInPGN) {
 	for (auto filename : {gameUTF8, gameLatin1, gameLatin1Conv}) {
 
@@ -91,6 +91,29 @@ TEST(Test_Filter, Filter) {
 	}
 }
 
+TEST(Test_Filter, WritableData) {
+	Filter filter(10);
+	ASSERT_EQ(nullptr, filter.data());
+	byte* values = filter.WritableData();
+	ASSERT_EQ(values, filter.data());
+	ASSERT_TRUE(std::all_of(values, values + 10, [](byte v) { return v == 1; }));
+
+	values[2] = 0;
+	values[5] = 0;
+	values[7] = 3;
+	ASSERT_EQ(10, filter.Count());
+	filter.UpdateCount();
+	ASSERT_EQ(8, filter.Count());
+	ASSERT_EQ(0, filter.Get(5));
+	ASSERT_EQ(3, filter.Get(7));
+
+	filter.Fill(0);
+	ASSERT_EQ(values, filter.WritableData());
+	values[9] = 1;
+	filter.UpdateCount();
+	ASSERT_EQ(1, filter.Count());
+}
+
 class Test_HFilter : public ::testing::TestWithParam<testParam> {
 protected:
 	const std::vector<byte>* main_;
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scidbase.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* database = SCID_TESTDIR "res_database";
+
+void checkColumns(scidBaseT const& dbase) {
+	const auto n = dbase.numGames();
+	auto column = [&](Index::ColumnT col, auto getter) {
+		std::vector<uint32_t> expected;
+		for (gamenumT gnum = 0; gnum < n; ++gnum) {
+			expected.push_back((dbase.getIndexEntry(gnum)->*getter)());
+		}
+		EXPECT_EQ(expected, dbase.getIndexColumn(col)) << col;
+	};
+	column(Index::COL_DATE, &IndexEntry::GetDate);
+	column(Index::COL_EVENTDATE, &IndexEntry::GetEventDate);
+	column(Index::COL_WHITEELO, &IndexEntry::GetWhiteElo);
+	column(Index::COL_BLACKELO, &IndexEntry::GetBlackElo);
+	column(Index::COL_ECO, &IndexEntry::GetEcoCode);
+	column(Index::COL_NUMHALFMOVES, &IndexEntry::GetNumHalfMoves);
+	column(Index::COL_RESULT, &IndexEntry::GetResult);
+	column(Index::COL_FLAGS, &IndexEntry::GetRawFlags);
+}
+
+} // namespace
+
+TEST(Test_IndexColumns, open) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+	ASSERT_NE(0, dbase.numGames());
+	checkColumns(dbase);
+
+	dbase.Close();
+	EXPECT_TRUE(Index().GetColumn(Index::COL_DATE).empty());
+}
+
+TEST(Test_IndexColumns, update) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	checkColumns(dbase);
+	ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"), {}));
+	ASSERT_EQ(src.numGames(), dbase.numGames());
+	checkColumns(dbase);
+
+	// Replace a game
+	Game game;
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(1), game));
+	game.SetDate(date_EncodeFromString("2026.10.19"));
+	game.SetWhiteElo(2850);
+	game.SetBlackElo(1200);
+	game.SetResult(RESULT_Draw);
+	ASSERT_EQ(OK, dbase.saveGame(&game, 1));
+	checkColumns(dbase);
+	EXPECT_EQ(2850U, dbase.getIndexColumn(Index::COL_WHITEELO)[1]);
+
+	// Change the flags
+	ASSERT_EQ(OK, dbase.setFlag(true, IndexEntry::StrToFlagMask("W"), 2));
+	checkColumns(dbase);
+
+	// Add a game
+	ASSERT_EQ(OK, dbase.saveGame(&game));
+	checkColumns(dbase);
+	EXPECT_EQ(1200U, dbase.getIndexColumn(Index::COL_BLACKELO).back());
+}
+
+TEST(Test_IndexColumns, concurrent) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+
+	// The columns can be requested for the first time by multiple threads.
+	std::vector<const std::vector<uint32_t>*> res(8);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < res.size(); ++i) {
+		threads.emplace_back([&, i]() {
+			res[i] = &dbase.getIndexColumn(Index::COL_WHITEELO);
+			dbase.getStats();
+		});
+	}
+	for (auto& th : threads) {
+		th.join();
+	}
+	for (auto column : res) {
+		EXPECT_EQ(&dbase.getIndexColumn(Index::COL_WHITEELO), column);
+	}
+	checkColumns(dbase);
+}
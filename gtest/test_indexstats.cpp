@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scidbase.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace {
+
+const char* database = SCID_TESTDIR "res_database";
+
+void expectEq(IndexStats const& expected, IndexStats const& stats) {
+	EXPECT_TRUE(std::equal(expected.flagCount,
+	                       expected.flagCount + IndexEntry::IDX_NUM_FLAGS,
+	                       stats.flagCount));
+	EXPECT_EQ(expected.nYears, stats.nYears);
+	EXPECT_EQ(expected.sumYears, stats.sumYears);
+	EXPECT_TRUE(std::equal(expected.nResults,
+	                       expected.nResults + NUM_RESULT_TYPES,
+	                       stats.nResults));
+	EXPECT_EQ(expected.nRatings, stats.nRatings);
+	EXPECT_EQ(expected.sumRatings, stats.sumRatings);
+	EXPECT_EQ(expected.minYear(), stats.minYear());
+	EXPECT_EQ(expected.maxYear(), stats.maxYear());
+	EXPECT_EQ(expected.minRating(), stats.minRating());
+	EXPECT_EQ(expected.maxRating(), stats.maxRating());
+	for (auto eco : {"", "A", "B2", "B22", "C42", "E99a", "E99z"}) {
+		auto a = expected.getEcoStats(eco);
+		auto b = stats.getEcoStats(eco);
+		ASSERT_TRUE(a && b);
+		EXPECT_EQ(a->count, b->count) << eco;
+		EXPECT_TRUE(std::equal(a->results, a->results + NUM_RESULT_TYPES,
+		                       b->results));
+	}
+}
+
+void checkStats(scidBaseT const& dbase) {
+	auto expected = std::make_unique<IndexStats>();
+	for (gamenumT gnum = 0, n = dbase.numGames(); gnum < n; ++gnum) {
+		expected->add(*dbase.getIndexEntry(gnum));
+	}
+	expectEq(*expected, dbase.getStats());
+}
+
+} // namespace
+
+TEST(Test_IndexStats, update) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	EXPECT_EQ(0U, dbase.getStats().minYear());
+	EXPECT_EQ(0U, dbase.getStats().maxRating());
+	ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"), {}));
+	checkStats(dbase);
+	EXPECT_NE(0U, dbase.getStats().minYear());
+	EXPECT_NE(0U, dbase.getStats().maxRating());
+
+	// Replace the game with the highest rating
+	const auto maxRating = dbase.getStats().maxRating();
+	gamenumT gnum = 0;
+	while (dbase.getIndexEntry(gnum)->GetWhiteElo() != maxRating &&
+	       dbase.getIndexEntry(gnum)->GetBlackElo() != maxRating) {
+		ASSERT_LT(++gnum, dbase.numGames());
+	}
+	Game game;
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(gnum), game));
+	game.SetWhiteElo(0);
+	game.SetBlackElo(0);
+	game.SetDate(date_EncodeFromString("1200.01.01"));
+	game.SetEco(eco_FromString("C42"));
+	game.SetResult(RESULT_None);
+	ASSERT_EQ(OK, dbase.saveGame(&game, gnum));
+	checkStats(dbase);
+	EXPECT_GE(maxRating, dbase.getStats().maxRating());
+	EXPECT_EQ(1200U, dbase.getStats().minYear());
+
+	// Change the flags and add a game
+	ASSERT_EQ(OK, dbase.setFlag(true, IndexEntry::StrToFlagMask("W"), 2));
+	ASSERT_EQ(OK, dbase.saveGame(&game));
+	checkStats(dbase);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "namebase.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Test_NameBase, add_find) {
+	NameBase nb;
+	EXPECT_EQ(0U, nb.namebase_add(NAME_PLAYER, "Carlsen, Magnus"));
+	EXPECT_EQ(1U, nb.namebase_add(NAME_PLAYER, "Anand, Viswanathan"));
+	EXPECT_EQ(0U, nb.namebase_add(NAME_EVENT, "Tata Steel"));
+	const std::string longName(100000, 'x');
+	EXPECT_EQ(2U, nb.namebase_add(NAME_PLAYER, longName));
+	EXPECT_STREQ("Anand, Viswanathan", nb.GetName(NAME_PLAYER, 1));
+	EXPECT_EQ(longName, nb.GetName(NAME_PLAYER, 2));
+
+	idNumberT id;
+	ASSERT_EQ(OK, nb.FindExactName(NAME_PLAYER, "Carlsen, Magnus", &id));
+	EXPECT_EQ(0U, id);
+	EXPECT_EQ(ERROR_NameNotFound, nb.FindExactName(NAME_EVENT, "Carlsen", &id));
+
+	// Names added after the index is created
+	EXPECT_EQ(1U, nb.namebase_find_or_add(NAME_PLAYER, "Anand, Viswanathan"));
+	EXPECT_EQ(3U, nb.namebase_find_or_add(NAME_PLAYER, "Caruana, Fabiano"));
+	EXPECT_EQ(3U, nb.namebase_find_or_add(NAME_PLAYER, "Caruana, Fabiano"));
+	EXPECT_EQ(std::vector<idNumberT>({0, 3}),
+	          nb.getFirstMatches(NAME_PLAYER, "Ca", 10));
+	EXPECT_EQ(4U, nb.getNames()[NAME_PLAYER].size());
+
+	nb.Clear();
+	EXPECT_EQ(0U, nb.GetNumNames(NAME_PLAYER));
+	EXPECT_EQ(ERROR_NameNotFound,
+	          nb.FindExactName(NAME_PLAYER, "Carlsen, Magnus", &id));
+}
+
+TEST(Test_NameBase, insert) {
+	// Sorted names
+	NameBase nb;
+	EXPECT_TRUE(nb.insert("Aronian", 7, NAME_PLAYER, 2));
+	EXPECT_TRUE(nb.insert("Carlsen", 7, NAME_PLAYER, 0));
+	EXPECT_TRUE(nb.insert("Giri", 4, NAME_PLAYER, 1));
+	EXPECT_FALSE(nb.insert("Ding", 4, NAME_PLAYER, 1));
+	EXPECT_STREQ("Aronian", nb.GetName(NAME_PLAYER, 2));
+	idNumberT id;
+	ASSERT_EQ(OK, nb.FindExactName(NAME_PLAYER, "Giri", &id));
+	EXPECT_EQ(1U, id);
+
+	// Not sorted names
+	NameBase unsorted;
+	EXPECT_TRUE(unsorted.insert("Giri", 4, NAME_PLAYER, 0));
+	EXPECT_TRUE(unsorted.insert("Carlsen", 7, NAME_PLAYER, 1));
+	EXPECT_TRUE(unsorted.insert("Aronian", 7, NAME_PLAYER, 2));
+	ASSERT_EQ(OK, unsorted.FindExactName(NAME_PLAYER, "Carlsen", &id));
+	EXPECT_EQ(1U, id);
+	EXPECT_FALSE(unsorted.insert("Giri", 4, NAME_PLAYER, 3));
+
+	// Duplicate names
+	NameBase duplicates;
+	EXPECT_TRUE(duplicates.insert("Carlsen", 7, NAME_PLAYER, 0));
+	EXPECT_FALSE(duplicates.insert("Carlsen", 7, NAME_PLAYER, 1));
+}
+
+TEST(Test_NameBase, concurrentFind) {
+	NameBase nb;
+	for (int i = 0; i < 1000; ++i) {
+		nb.namebase_add(NAME_PLAYER, "Player " + std::to_string(i));
+	}
+
+	// The first searches, which create the index, can be concurrent.
+	std::vector<std::thread> threads;
+	std::vector<idNumberT> found(8);
+	for (size_t i = 0; i < found.size(); ++i) {
+		threads.emplace_back([&, i]() {
+			const auto name = "Player " + std::to_string(i * 100);
+			if (nb.FindExactName(NAME_PLAYER, name.c_str(), &found[i]) != OK)
+				found[i] = 0xFFFFFFFF;
+		});
+	}
+	for (auto& th : threads) {
+		th.join();
+	}
+	for (size_t i = 0; i < found.size(); ++i) {
+		EXPECT_EQ(i * 100, found[i]);
+	}
+}
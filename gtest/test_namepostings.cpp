@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scidbase.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+const char* database = SCID_TESTDIR "res_database";
+
+std::vector<gamenumT> toVector(NamePostings::Games games) {
+	return {games.begin(), games.end()};
+}
+
+void checkPostings(scidBaseT const& dbase) {
+	const NameBase* nb = dbase.getNameBase();
+	for (nameT nt : {NAME_PLAYER, NAME_EVENT, NAME_SITE}) {
+		std::vector<std::vector<gamenumT>> expected(nb->GetNumNames(nt));
+		for (gamenumT gnum = 0, n = dbase.numGames(); gnum < n; ++gnum) {
+			IndexEntry const& ie = *dbase.getIndexEntry(gnum);
+			switch (nt) {
+			case NAME_PLAYER:
+				expected[ie.GetWhite()].push_back(gnum);
+				if (ie.GetBlack() != ie.GetWhite())
+					expected[ie.GetBlack()].push_back(gnum);
+				break;
+			case NAME_EVENT:
+				expected[ie.GetEvent()].push_back(gnum);
+				break;
+			case NAME_SITE:
+				expected[ie.GetSite()].push_back(gnum);
+				break;
+			}
+		}
+		for (idNumberT id = 0; id < expected.size(); ++id) {
+			EXPECT_EQ(expected[id], toVector(dbase.getNameGames(nt, id)));
+		}
+	}
+}
+
+} // namespace
+
+TEST(Test_NamePostings, open) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+	ASSERT_NE(0, dbase.numGames());
+	checkPostings(dbase);
+
+	// Unknown names and names that are not indexed have no games.
+	EXPECT_TRUE(dbase.getNameGames(NAME_PLAYER, 1 << 20).empty());
+	EXPECT_TRUE(dbase.getNameGames(NAME_ROUND, 0).empty());
+
+	dbase.Close();
+	EXPECT_TRUE(Index().GetNameGames(NAME_PLAYER, 0).empty());
+}
+
+TEST(Test_NamePostings, update) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"), {}));
+	ASSERT_EQ(src.numGames(), dbase.numGames());
+	checkPostings(dbase);
+
+	// Replace a game with new names
+	Game game;
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(1), game));
+	game.SetWhiteStr("New player");
+	game.SetBlackStr("New player");
+	game.SetEventStr("New event");
+	game.SetSiteStr("New site");
+	ASSERT_EQ(OK, dbase.saveGame(&game, 1));
+	checkPostings(dbase);
+	idNumberT id = 0;
+	ASSERT_EQ(OK, dbase.getNameBase()->FindExactName(NAME_PLAYER, "New player",
+	                                                  &id));
+	EXPECT_EQ(std::vector<gamenumT>{1},
+	          toVector(dbase.getNameGames(NAME_PLAYER, id)));
+
+	// Replace a game with existing names
+	ASSERT_EQ(OK, dbase.getGame(*dbase.getIndexEntry(0), game));
+	ASSERT_EQ(OK, dbase.saveGame(&game, 2));
+	checkPostings(dbase);
+
+	// Add a game
+	ASSERT_EQ(OK, dbase.saveGame(&game));
+	checkPostings(dbase);
+	EXPECT_EQ(dbase.numGames() - 1,
+	          dbase.getNameGames(NAME_EVENT, dbase.getIndexEntry(0)->GetEvent())
+	              .back());
+}
+
+TEST(Test_NamePostings, pendingChanges) {
+	std::vector<IndexEntry> entries(4);
+	auto setNames = [](IndexEntry& ie, idNumberT white, idNumberT black,
+	                   idNumberT event) {
+		ie.SetWhite(white);
+		ie.SetBlack(black);
+		ie.SetEvent(event);
+		ie.SetSite(0);
+	};
+	setNames(entries[0], 0, 1, 0);
+	setNames(entries[1], 1, 2, 0);
+	setNames(entries[2], 2, 0, 1);
+	setNames(entries[3], 1, 1, 1);
+
+	NamePostings postings;
+	auto getEntry = [&](gamenumT gnum) -> IndexEntry const& {
+		return entries[gnum];
+	};
+	auto players = [&](idNumberT id) {
+		return toVector(postings.games(NAME_PLAYER, id));
+	};
+	postings.update(NAME_PLAYER, 4, getEntry);
+	EXPECT_EQ(std::vector<gamenumT>({0, 2}), players(0));
+	EXPECT_EQ(std::vector<gamenumT>({0, 1, 3}), players(1));
+
+	// The existing lists are updated without reading the entries again.
+	auto noEntries = [](gamenumT) -> IndexEntry const& {
+		ADD_FAILURE() << "The postings are rebuilt";
+		static IndexEntry empty;
+		return empty;
+	};
+	entries.emplace_back();
+	setNames(entries[4], 3, 1, 0);
+	postings.add(entries[4], 4);
+	EXPECT_FALSE(postings.valid(NAME_PLAYER));
+	EXPECT_FALSE(postings.valid(NAME_EVENT));
+	postings.update(NAME_PLAYER, 5, noEntries);
+	EXPECT_EQ(std::vector<gamenumT>({0, 1, 3, 4}), players(1));
+	EXPECT_EQ(std::vector<gamenumT>({4}), players(3));
+
+	// Replaced games, with new, removed and unchanged names.
+	IndexEntry replaced = entries[1];
+	setNames(replaced, 1, 5, 0);
+	postings.replace(entries[1], replaced, 1);
+	entries[1] = replaced;
+	replaced = entries[3];
+	setNames(replaced, 0, 1, 1);
+	postings.replace(entries[3], replaced, 3);
+	entries[3] = replaced;
+	entries.emplace_back();
+	setNames(entries[5], 2, 2, 0);
+	postings.add(entries[5], 5);
+	postings.update(NAME_PLAYER, 6, noEntries);
+	EXPECT_EQ(std::vector<gamenumT>({0, 2, 3}), players(0));
+	EXPECT_EQ(std::vector<gamenumT>({0, 1, 3, 4}), players(1));
+	EXPECT_EQ(std::vector<gamenumT>({2, 5}), players(2));
+	EXPECT_EQ(std::vector<gamenumT>({4}), players(3));
+	EXPECT_EQ(std::vector<gamenumT>({}), players(4));
+	EXPECT_EQ(std::vector<gamenumT>({1}), players(5));
+
+	// The merged lists are equal to the rebuilt ones.
+	NamePostings rebuilt;
+	rebuilt.update(NAME_PLAYER, 6, getEntry);
+	for (idNumberT id = 0; id < 7; ++id) {
+		EXPECT_EQ(toVector(rebuilt.games(NAME_PLAYER, id)), players(id));
+	}
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pgnparse.h"
+#include "pgntextfilter.h"
+#include "scidbase.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* pgnAnnotated = R"([Event "Test"]
+[White "Carlsen, Magnus"]
+[Black "Hikaru"]
+[Annotator "Fritz, Deep"]
+
+1. e4 {Best by test} e5 $1 2. Qh5 {A Novelty!} (2. Nf3 {Normal} Nc6 $146)
+2... Nc6 3. Bc4 Nf6 $7 4. Qxf7# {Mate in 4} 1-0
+)";
+
+// Returns true if the PGN that sc_search header -pgn creates contains all
+// the terms.
+bool searchPgn(Game& game, std::vector<std::string> const& terms) {
+	game.ResetPgnStyle();
+	game.AddPgnStyle(PGN_STYLE_TAGS);
+	game.AddPgnStyle(PGN_STYLE_COMMENTS);
+	game.AddPgnStyle(PGN_STYLE_VARS);
+	game.AddPgnStyle(PGN_STYLE_SYMBOLS);
+	game.SetPgnFormat(PGN_FORMAT_Plain);
+	const char* pgn = game.WriteToPGN().first;
+	for (auto const& term : terms) {
+		if (!std::strstr(pgn, term.c_str()))
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+TEST(Test_PgnTextFilter, multiPatternMatcher) {
+	MultiPatternMatcher matcher({"he", "she", "his", "hers", "he"});
+	std::vector<size_t> found;
+	EXPECT_TRUE(matcher.find("ushers ahishe", [&](size_t idx) {
+		found.push_back(idx);
+		return true;
+	}));
+	// she, he, he, hers, his, she, he, he
+	EXPECT_EQ(std::vector<size_t>({1, 0, 4, 3, 2, 1, 0, 4}), found);
+
+	size_t count = 0;
+	EXPECT_FALSE(matcher.find("ushers", [&](size_t) { return ++count < 2; }));
+	EXPECT_EQ(2U, count);
+	EXPECT_TRUE(MultiPatternMatcher({}).find("text", [](size_t) {
+		return false;
+	}));
+}
+
+TEST(Test_PgnTextFilter, game) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("MEMORY", FMODE_Create, "Memory"));
+	Game game;
+	PgnParseLog parseLog;
+	ASSERT_TRUE(pgnParseGame(pgnAnnotated, std::strlen(pgnAnnotated), game,
+	                         parseLog));
+	ASSERT_EQ(OK, dbase.saveGame(&game));
+	IndexEntry const& ie = *dbase.getIndexEntry(0);
+	ASSERT_EQ(OK, dbase.getGame(ie, game));
+
+	auto mayMatch = [&](std::vector<std::string> terms) {
+		PgnTextFilter filter(terms);
+		return filter.mayMatch(dbase.getGame(ie), ie, *dbase.getNameBase());
+	};
+	const std::vector<std::vector<std::string>> found = {
+	    {"Novelty!"}, {"Carlsen,"}, {"Hikaru", "Fritz,"}, {"Best", "test"},
+	    {"forced"},   {"Nf3"},      {"Normal}"},          {"Event"},
+	    {"1-0"},      {"Hik", "Nor", "Mate"}};
+	for (auto const& terms : found) {
+		EXPECT_TRUE(searchPgn(game, terms)) << terms[0];
+		EXPECT_TRUE(mayMatch(terms)) << terms[0];
+	}
+
+	const std::vector<std::vector<std::string>> notFound = {
+	    {"novelty"}, {"Hikaru", "Kasparov"}, {"Bestbytest"}, {"Fritz;"}};
+	for (auto const& terms : notFound) {
+		EXPECT_FALSE(searchPgn(game, terms)) << terms[0];
+		EXPECT_FALSE(mayMatch(terms)) << terms[0];
+	}
+
+	// The terms that may be in the movetext or in the tag names, and the
+	// terms that span multiple words, are left to the PGN search
+	for (auto term : {"Nh3", "Qxh7", "Date", "vent", "by test", "{Best"}) {
+		EXPECT_TRUE(mayMatch({term})) << term;
+	}
+}
+
+TEST(Test_PgnTextFilter, database) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly,
+	                         SCID_TESTDIR "res_database"));
+	ASSERT_NE(0U, dbase.numGames());
+
+	const std::vector<std::vector<std::string>> searches = {
+	    {"the"}, {"Kasparov"}, {"Karpov", "Kasparov"}, {"Sicilian"},
+	    {"!"},   {"Rxe"},      {"with"},               {"is", "a"},
+	    {"2"},   {"unclear"},  {"Site"},               {"B2"}};
+	Game game;
+	unsigned nRejected = 0;
+	for (auto const& terms : searches) {
+		PgnTextFilter filter(terms);
+		for (gamenumT gnum = 0, n = dbase.numGames(); gnum < n; ++gnum) {
+			IndexEntry const& ie = *dbase.getIndexEntry(gnum);
+			ASSERT_EQ(OK, dbase.getGame(ie, game));
+			const bool expected = searchPgn(game, terms);
+			if (filter.mayMatch(dbase.getGame(ie), ie, *dbase.getNameBase())) {
+				auto [pgn, len] = game.WriteToPGN();
+				EXPECT_EQ(expected, filter.match({pgn, len}));
+			} else {
+				EXPECT_FALSE(expected) << terms[0] << " game " << gnum;
+				++nRejected;
+			}
+		}
+	}
+	EXPECT_NE(0U, nRejected);
+}
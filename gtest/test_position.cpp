@@ -20,6 +20,8 @@
 #include "searchpos.h"
 #include <cstring>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <string>
 #include <unordered_set>
 
 TEST(Test_movegen, attack) {
@@ -659,6 +661,195 @@ TEST(Test_PositionIsLegalMove, en_passant) {
 	}
 }
 
+namespace {
+unsigned long long perft(Position& pos, int depth) {
+	MoveList moves;
+	pos.GenerateMoves(&moves);
+	if (depth <= 1)
+		return moves.Size();
+
+	unsigned long long res = 0;
+	for (auto& sm : moves) {
+		pos.DoSimpleMove(sm);
+		res += perft(pos, depth - 1);
+		pos.UndoSimpleMove(&sm);
+	}
+	return res;
+}
+
+// Verify that IsLegalMove() accepts exactly the moves of GenerateMoves().
+void checkIsLegalMove(Position& pos) {
+	MoveList moves;
+	pos.GenerateMoves(&moves);
+	unsigned nMoves = 0;
+	for (auto& sm : moves) {
+		if (sm.isCastle()) {
+			EXPECT_EQ(sm.to > sm.from ? 2 : -2,
+			          pos.IsLegalMove(sm.from, sm.to, EMPTY));
+		} else {
+			EXPECT_EQ(1, pos.IsLegalMove(sm.from, sm.to, sm.promote));
+			++nMoves;
+		}
+	}
+	unsigned nLegal = 0;
+	const auto list = pos.GetList(pos.GetToMove());
+	for (unsigned i = 0, n = pos.GetCount(pos.GetToMove()); i < n; ++i) {
+		for (squareT to = A1; to <= H8; ++to) {
+			for (auto promo : {EMPTY, QUEEN, ROOK, BISHOP, KNIGHT}) {
+				if (pos.IsLegalMove(list[i], to, promo) == 1)
+					++nLegal;
+			}
+		}
+	}
+	EXPECT_EQ(nMoves, nLegal);
+}
+} // namespace
+
+TEST(Test_MoveGeneration, perft) {
+	// Reference values from https://www.chessprogramming.org/Perft_Results
+	const struct {
+		const char* fen;
+		unsigned long long nodes[4];
+	} positions[] = {
+	    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	     {20, 400, 8902, 197281}},
+	    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	     {48, 2039, 97862, 0}},
+	    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", {14, 191, 2812, 43238}},
+	    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	     {6, 264, 9467, 0}},
+	    {"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+	     {6, 264, 9467, 0}},
+	    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	     {44, 1486, 62379, 0}},
+	    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - "
+	     "0 10",
+	     {46, 2079, 89890, 0}},
+	    // Chess960
+	    {"bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9",
+	     {21, 528, 12189, 326672}},
+	    {"2nnrbkr/p1qppppp/8/1ppb4/6PP/3PP3/PPP2P2/BQNNRBKR w HEhe - 1 9",
+	     {21, 807, 18002, 0}},
+	};
+	for (auto& [fen, nodes] : positions) {
+		Position pos;
+		ASSERT_EQ(OK, pos.ReadFromFEN(fen));
+		const auto hash = pos.HashValue();
+		for (int depth = 1; depth <= 4 && nodes[depth - 1]; ++depth) {
+			EXPECT_EQ(nodes[depth - 1], perft(pos, depth)) << fen;
+		}
+		EXPECT_EQ(hash, pos.HashValue());
+	}
+}
+
+TEST(Test_MoveGeneration, IsLegalMove) {
+	const char* positions[] = {
+	    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	    "8/8/8/2k5/3Pp3/8/8/4K2B b - d3 0 1",
+	    "8/8/3k4/8/1q6/8/3P4/3K4 w - - 0 1",
+	};
+	for (auto fen : positions) {
+		Position pos;
+		ASSERT_EQ(OK, pos.ReadFromFEN(fen));
+		checkIsLegalMove(pos);
+		MoveList moves;
+		pos.GenerateMoves(&moves);
+		for (auto& sm : moves) {
+			pos.DoSimpleMove(sm);
+			checkIsLegalMove(pos);
+			pos.UndoSimpleMove(&sm);
+		}
+	}
+}
+
+TEST(Test_MoveGeneration, GenerateCaptures) {
+	Position pos;
+	ASSERT_EQ(OK, pos.ReadFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/"
+	                              "PPPBBPPP/R3K2R w KQkq - 0 1"));
+	MoveList moves;
+	pos.GenerateCaptures(&moves);
+	EXPECT_EQ(8U, moves.Size());
+	for (auto& sm : moves) {
+		EXPECT_NE(EMPTY, sm.capturedPiece);
+	}
+	pos.GenerateMoves(&moves, KNIGHT, GEN_ALL_MOVES, true);
+	EXPECT_EQ(11U, moves.Size());
+
+	// Double check: only the king can move
+	ASSERT_EQ(OK, pos.ReadFromFEN("4k3/8/8/8/8/3n4/8/r3K2N w - - 0 1"));
+	pos.GenerateMoves(&moves);
+	EXPECT_EQ(2U, moves.Size());
+	EXPECT_TRUE(pos.IsKingInCheck());
+	EXPECT_FALSE(pos.IsKingInMate());
+}
+
+TEST(Test_PositionParseMove, san) {
+	// Every legal move is read back from its SAN
+	auto checkSAN = [](Position& pos) {
+		MoveList moves;
+		pos.GenerateMoves(&moves);
+		for (auto& sm : moves) {
+			sanStringT san;
+			pos.MakeSANString(&sm, san, SAN_CHECKTEST);
+			simpleMoveT res;
+			ASSERT_EQ(OK, pos.ParseMove(&res, san, san + std::strlen(san)))
+			    << san;
+			EXPECT_EQ(sm.from, res.from) << san;
+			EXPECT_EQ(sm.to, res.to) << san;
+			EXPECT_EQ(sm.promote, res.promote) << san;
+		}
+	};
+	const char* positions[] = {
+	    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	    "8/8/8/2k5/3Pp3/8/8/4K2B b - d3 0 1",
+	    "1k6/8/8/2N1N3/8/2N1N3/6b1/K7 w - - 0 1",
+	};
+	for (auto fen : positions) {
+		Position pos;
+		ASSERT_EQ(OK, pos.ReadFromFEN(fen));
+		checkSAN(pos);
+		MoveList moves;
+		pos.GenerateMoves(&moves);
+		for (auto& sm : moves) {
+			pos.DoSimpleMove(sm);
+			checkSAN(pos);
+			pos.UndoSimpleMove(&sm);
+		}
+	}
+
+	auto parse = [](const char* fen, const char* san) {
+		Position pos;
+		EXPECT_EQ(OK, pos.ReadFromFEN(fen));
+		simpleMoveT sm;
+		std::string res;
+		if (pos.ParseMove(&sm, san) == OK)
+			sm.toLongNotation(std::back_inserter(res));
+		return res;
+	};
+	// The disambiguation of pinned pieces can be omitted
+	const char* pinned = "4k3/8/8/8/1b6/8/3N1N2/4K3 w - - 0 1";
+	EXPECT_EQ("f2e4", parse(pinned, "Ne4"));
+	EXPECT_EQ("f2e4", parse(pinned, "Nfe4"));
+	EXPECT_EQ("", parse(pinned, "Nde4"));
+	EXPECT_EQ("", parse("4k3/8/8/8/8/8/3N1N2/4K3 w - - 0 1", "Ne4"));
+
+	// Pawn moves
+	const char* ep = "4k3/8/8/KPp4r/8/8/4P3/8 w - c6 0 1";
+	EXPECT_EQ("", parse(ep, "bxc6"));
+	EXPECT_EQ("e2e4", parse(ep, "e4"));
+	EXPECT_EQ("", parse(ep, "e5"));
+	EXPECT_EQ("b5c6", parse("4k3/8/8/1Pp5/K7/8/8/8 w - c6 0 1", "bxc6"));
+	EXPECT_EQ("", parse("4k3/8/8/1Pp5/K7/8/8/8 w - c6 0 1", "dxc6"));
+	EXPECT_EQ("", parse("3k4/1P6/8/8/8/8/8/K7 w - - 0 1", "b8"));
+	EXPECT_EQ("b7b8q", parse("3k4/1P6/8/8/8/8/8/K7 w - - 0 1", "b8=Q"));
+	EXPECT_EQ("", parse("4k3/P7/8/8/8/8/8/K7 w - - 0 1", "axb8=Q"));
+}
+
 TEST(Test_PositionIsKingInCheck, last_move_optimization) {
 	simpleMoveT sm;
 
@@ -780,8 +971,8 @@ TEST(Test_PrintFen, illegal_castling_flag) {
 	std::unordered_set<std::string> flags;
 	flags.insert("KQkq");
 	std::string str = "KQkq";
-	for (int len = 1; len <= 3; len++) {
-		for (int i = 0; i <= str.length() - len; i++) {
+	for (size_t len = 1; len <= 3; len++) {
+		for (size_t i = 0; i <= str.length() - len; i++) {
 			flags.insert(str.substr(i, len));
 		}
 	}
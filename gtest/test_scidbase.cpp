@@ -16,6 +16,9 @@
 
 #include "scidbase.h"
 #include "pgnparse.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <string>
 #include <vector>
 #include <map>
@@ -381,3 +384,102 @@ TEST_F(Test_Scidbase, new_compose_delete_get_Filter) {
 		check();
 	}
 }
+
+TEST_F(Test_Scidbase, importGames) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, SCID_TESTDIR "res_database"));
+	const auto nGames = src.numGames();
+	ASSERT_GT(nGames, 10U);
+
+	const char* filename = "test_importgames";
+	for (auto dbtype : {"MEMORY", "SCID4", "SCID5", "PGN"}) {
+		SCOPED_TRACE(dbtype);
+		const auto fname = std::strcmp(dbtype, "PGN") == 0
+		                       ? std::string(filename) + ".pgn"
+		                       : std::string(filename);
+		{
+			scidBaseT dbase;
+			ASSERT_EQ(OK, dbase.open(dbtype, FMODE_Create, fname.c_str()));
+
+			// Some of the names already exist in the destination database.
+			Game game;
+			ASSERT_EQ(OK, src.getGame(*src.getIndexEntry(nGames / 2), game));
+			ASSERT_EQ(OK, dbase.saveGame(&game));
+			ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"),
+			                                Progress()));
+			ASSERT_EQ(nGames + 1, dbase.numGames());
+
+			for (gamenumT i = 0; i < nGames; ++i) {
+				const IndexEntry& ie_src = *src.getIndexEntry(i);
+				const IndexEntry& ie = *dbase.getIndexEntry(i + 1);
+				auto tags_src = src.tagRoster(ie_src);
+				auto tags = dbase.tagRoster(ie);
+				EXPECT_STREQ(tags_src.event, tags.event);
+				EXPECT_STREQ(tags_src.site, tags.site);
+				EXPECT_STREQ(tags_src.round, tags.round);
+				EXPECT_STREQ(tags_src.white, tags.white);
+				EXPECT_STREQ(tags_src.black, tags.black);
+				EXPECT_EQ(ie_src.GetDate(), ie.GetDate());
+				EXPECT_EQ(ie_src.GetWhiteElo(), ie.GetWhiteElo());
+
+				auto data_src = src.getGame(ie_src);
+				auto data = dbase.getGame(ie);
+				ASSERT_EQ(data_src.size(), data.size());
+				EXPECT_TRUE(std::equal(data_src.data(),
+				                       data_src.data() + data_src.size(),
+				                       data.data()));
+			}
+
+			// The names are not duplicated
+			auto nb = dbase.getNameBase();
+			const auto& names = nb->getNames();
+			for (nameT nt = NAME_PLAYER; nt < NUM_NAME_TYPES; nt++) {
+				EXPECT_EQ(nb->GetNumNames(nt), names[nt].size());
+			}
+		}
+		for (auto ext : {".si4", ".sg4", ".sn4", ".si5", ".sg5", ".sn5",
+		                 ".sfp", ".stx", ".pgn"}) {
+			std::remove((std::string(filename) + ext).c_str());
+		}
+	}
+}
+
+TEST_F(Test_Scidbase, openTruncatedIndex) {
+	scidBaseT src;
+	ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, SCID_TESTDIR "res_database"));
+	const auto nGames = src.numGames();
+	ASSERT_GT(nGames, 10U);
+
+	const char* filename = "test_truncatedindex";
+	const auto si4 = std::string(filename) + ".si4";
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Create, filename));
+		ASSERT_EQ(OK, dbase.importGames(&src, src.getFilter("dbfilter"),
+		                                Progress()));
+	}
+	// The header declares nGames, but the last 2 entries (47 bytes each) are
+	// missing: they are decoded from zeros.
+	const auto fileSize = std::filesystem::file_size(si4);
+	std::filesystem::resize_file(si4, fileSize - 2 * 47);
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, filename));
+		ASSERT_EQ(nGames, dbase.numGames());
+		for (gamenumT i = 0; i < nGames - 2; ++i) {
+			EXPECT_EQ(src.getIndexEntry(i)->GetLength(),
+			          dbase.getIndexEntry(i)->GetLength());
+		}
+		EXPECT_EQ(0U, dbase.getIndexEntry(nGames - 1)->GetLength());
+	}
+	// A partial entry
+	std::filesystem::resize_file(si4, fileSize - 2 * 47 - 1);
+	{
+		scidBaseT dbase;
+		EXPECT_EQ(ERROR_FileRead,
+		          dbase.open("SCID4", FMODE_ReadOnly, filename));
+	}
+	for (auto ext : {".si4", ".sg4", ".sn4"}) {
+		std::remove((std::string(filename) + ext).c_str());
+	}
+}
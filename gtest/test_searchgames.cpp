@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scidbase.h"
+#include "searchgames.h"
+#include <cstdio>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+class Test_SearchGames : public ::testing::Test {
+protected:
+	static constexpr const char* database = SCID_TESTDIR "res_database";
+
+	// Decode the moves of the game and return the ply count of the main line.
+	static byte decodePly(Game& game, const IndexEntry&, ByteBuffer& data,
+	                      unsigned hint) {
+		EXPECT_EQ(hint, 7U);
+		if (game.DecodeMovesOnly(data) != OK)
+			return 0;
+
+		game.MoveToEnd();
+		return static_cast<byte>(game.GetCurrentPly() % 255 + 1);
+	}
+	static unsigned evenWhite(gamenumT, const IndexEntry& ie) {
+		return (ie.GetWhite() % 2) ? 0 : 7;
+	}
+};
+
+TEST_F(Test_SearchGames, filterOp) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+	ASSERT_NE(0U, dbase.numGames());
+
+	std::mt19937 re;
+	std::uniform_int_distribution<> rndVal(0, 3);
+	auto filter = dbase.getFilter(dbase.newFilter());
+	std::vector<byte> initial(dbase.numGames());
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		initial[i] = static_cast<byte>(rndVal(re));
+		filter.set(i, initial[i]);
+	}
+
+	for (auto filterOp : {FILTEROP_AND, FILTEROP_OR}) {
+		for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+			filter.set(i, initial[i]);
+		}
+		EXPECT_EQ(OK, searchGames(dbase, filter, filterOp, Progress(),
+		                          evenWhite, decodePly));
+
+		for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+			const auto ie = dbase.getIndexEntry(i);
+			const bool searched = (filterOp == FILTEROP_AND)
+			                          ? initial[i] != 0
+			                          : initial[i] == 0;
+			byte expected = initial[i];
+			if (searched) {
+				expected = evenWhite(i, *ie) == 0
+				               ? 0
+				               : static_cast<byte>(
+				                     ie->GetNumHalfMoves() % 255 + 1);
+			}
+			EXPECT_EQ(expected, filter.get(i));
+		}
+	}
+}
+
+TEST_F(Test_SearchGames, interrupt) {
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, database));
+	ASSERT_LT(1024U, dbase.numGames());
+
+	struct StopAfter : public Progress::Impl {
+		bool report(size_t done, size_t, const char*) final {
+			return done < 1024;
+		}
+	};
+
+	auto filter = dbase.getFilter("dbfilter");
+	EXPECT_EQ(ERROR_UserCancel,
+	          searchGames(dbase, filter, FILTEROP_AND,
+	                      Progress(new StopAfter()), evenWhite, decodePly));
+
+	// Games after the interruption are not modified.
+	for (gamenumT i = 1024, n = dbase.numGames(); i < n; ++i) {
+		EXPECT_EQ(1, filter.get(i));
+	}
+}
+
+TEST_F(Test_SearchGames, skipUnreadable) {
+	const char* filename = "test_searchgames";
+	for (auto ext : {".si4", ".sg4", ".sn4"}) {
+		std::filesystem::copy_file(
+		    std::string(database) + ext, std::string(filename) + ext,
+		    std::filesystem::copy_options::overwrite_existing);
+	}
+	gamenumT last = 0;
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, filename));
+		for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+			if (dbase.getIndexEntry(i)->GetOffset() >
+			    dbase.getIndexEntry(last)->GetOffset())
+				last = i;
+		}
+		std::filesystem::resize_file(std::string(filename) + ".sg4",
+		                             dbase.getIndexEntry(last)->GetOffset());
+	}
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, filename));
+	auto filter = dbase.getFilter("dbfilter");
+	auto all = [](gamenumT, const IndexEntry&) { return 7U; };
+	EXPECT_EQ(ERROR_FileRead, searchGames(dbase, filter, FILTEROP_AND,
+	                                      Progress(), all, decodePly));
+
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		filter.set(i, 1);
+	}
+	EXPECT_EQ(OK, searchGames(dbase, filter, FILTEROP_AND, Progress(), all,
+	                          decodePly, true));
+	for (gamenumT i = 0, n = dbase.numGames(); i < n; ++i) {
+		const auto nPlies = dbase.getIndexEntry(i)->GetNumHalfMoves();
+		EXPECT_EQ(i == last ? 1 : nPlies % 255 + 1, filter.get(i));
+	}
+
+	for (auto ext : {".si4", ".sg4", ".sn4"}) {
+		std::remove((std::string(filename) + ext).c_str());
+	}
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scidbase.h"
+#include <algorithm>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Declared in tkscid.h, which requires Tcl.
+errorT search_index(const scidBaseT* base, HFilter& filter, int argc,
+                    const char** argv, const Progress& progress,
+                    unsigned nThreads);
+
+namespace {
+
+struct Criteria {
+	std::string op;
+	std::string value;
+};
+
+/// The result of search_index, evaluated one game at a time.
+/// Every criteria restricts the games that matched the previous criteria,
+/// except the '|' criteria that extend them.
+class ExpectedSearch {
+	const scidBaseT& base_;
+
+	bool eval(std::string_view name, std::string const& value, gamenumT gnum,
+	          const IndexEntry& ie) const {
+		long min = 0, max = 0;
+		std::sscanf(value.c_str(), "%ld %ld", &min, &max);
+		auto inRange = [&](long v) { return v >= min && v <= max; };
+		if (name == "player") {
+			auto nb = base_.getNameBase();
+			return strAlphaContains(nb->GetName(NAME_PLAYER, ie.GetWhite()),
+			                        value.c_str()) ||
+			       strAlphaContains(nb->GetName(NAME_PLAYER, ie.GetBlack()),
+			                        value.c_str());
+		}
+		if (name == "welo")
+			return inRange(ie.GetWhiteElo());
+		if (name == "belo")
+			return inRange(ie.GetBlackElo());
+		if (name == "length")
+			return inRange(ie.GetNumHalfMoves());
+		if (name == "gnum")
+			return inRange(gnum + 1);
+		if (name == "result")
+			return value.find(RESULT_CHAR[ie.GetResult()]) != value.npos;
+
+		ADD_FAILURE() << "Unknown criteria " << name;
+		return false;
+	}
+
+public:
+	explicit ExpectedSearch(const scidBaseT& base) : base_(base) {}
+
+	bool match(std::vector<Criteria> const& search, gamenumT gnum) const {
+		const IndexEntry& ie = *base_.getIndexEntry(gnum);
+		bool res = true;
+		bool group = true;
+		for (auto const& criteria : search) {
+			std::string_view name = criteria.op;
+			name.remove_prefix(1);
+			const auto extra = name.find_first_of("!|");
+			const bool isOr = name.find('|', extra) != name.npos;
+			const bool isNot = name.find('!', extra) != name.npos;
+			if (extra != name.npos)
+				name.remove_suffix(name.size() - extra);
+
+			const bool value = eval(name, criteria.value, gnum, ie) != isNot;
+			if (isOr) {
+				group = group || value;
+			} else {
+				res = res && group;
+				group = value;
+			}
+		}
+		return res && group;
+	}
+};
+
+class Test_SearchIndex : public ::testing::Test {
+protected:
+	static constexpr const char* database = SCID_TESTDIR "res_database";
+
+	// Enough games for several chunks of 4096 games.
+	static constexpr unsigned N_COPIES = 7;
+	scidBaseT dbase_;
+	std::string player_;
+	std::vector<byte> initial_;
+
+	void SetUp() override {
+		scidBaseT src;
+		ASSERT_EQ(OK, src.open("SCID4", FMODE_ReadOnly, database));
+		ASSERT_EQ(OK, dbase_.open("MEMORY", FMODE_Create, "Memory"));
+		for (unsigned i = 0; i < N_COPIES; ++i) {
+			ASSERT_EQ(OK, dbase_.importGames(&src, src.getFilter("dbfilter"),
+			                                 Progress()));
+		}
+		ASSERT_LT(2 * 4096U, dbase_.numGames());
+
+		auto ie = dbase_.getIndexEntry(0);
+		player_ = dbase_.getNameBase()->GetName(NAME_PLAYER, ie->GetWhite());
+
+		std::mt19937 re;
+		std::uniform_int_distribution<> rndVal(0, 3);
+		for (gamenumT i = 0, n = dbase_.numGames(); i < n; ++i) {
+			initial_.push_back(static_cast<byte>(rndVal(re)));
+		}
+	}
+
+	/// Searches with the filter operation @e filterOp and compares the
+	/// resulting filter with the expected one.
+	void checkSearch(std::vector<Criteria> const& search, const char* filterOp,
+	                 unsigned nThreads) {
+		SCOPED_TRACE(std::string("filter ") + filterOp + " threads " +
+		             std::to_string(nThreads));
+		std::vector<const char*> argv;
+		for (auto const& criteria : search) {
+			argv.push_back(criteria.op.c_str());
+			argv.push_back(criteria.value.c_str());
+		}
+		argv.push_back("-filter");
+		argv.push_back(filterOp);
+
+		const auto filterId = dbase_.newFilter();
+		auto filter = dbase_.getFilter(filterId);
+		for (gamenumT i = 0, n = dbase_.numGames(); i < n; ++i) {
+			filter.set(i, initial_[i]);
+		}
+		ASSERT_EQ(OK, search_index(&dbase_, filter, int(argv.size()),
+		                           argv.data(), Progress(), nThreads));
+
+		const std::string_view op = filterOp;
+		ExpectedSearch expected(dbase_);
+		gamenumT count = 0;
+		for (gamenumT i = 0, n = dbase_.numGames(); i < n; ++i) {
+			const bool match = expected.match(search, i);
+			byte value = initial_[i];
+			if (op == "RESET")
+				value = match ? 1 : 0;
+			else if (op == "AND" && !match)
+				value = 0;
+			else if (op == "OR" && match && value == 0)
+				value = 1;
+
+			EXPECT_EQ(value, filter.get(i)) << "game " << i;
+			count += (value != 0);
+		}
+		EXPECT_EQ(count, filter.size());
+		dbase_.deleteFilter(filterId.c_str());
+	}
+
+	void checkSearch(std::vector<Criteria> const& search) {
+		for (auto filterOp : {"RESET", "AND", "OR"}) {
+			for (unsigned nThreads : {1, 4}) {
+				checkSearch(search, filterOp, nThreads);
+			}
+		}
+	}
+};
+
+} // namespace
+
+TEST_F(Test_SearchIndex, and) {
+	checkSearch({{"-welo", "2400 4000"}});
+	checkSearch({{"-result", "1="}, {"-length", "60 120"}});
+	checkSearch({{"-player", player_}, {"-belo", "2300 4000"}});
+}
+
+TEST_F(Test_SearchIndex, or) {
+	checkSearch({{"-welo", "2500 4000"}, {"-belo|", "2500 4000"}});
+	checkSearch({{"-result", "1"},
+	             {"-welo", "2600 4000"},
+	             {"-belo|", "2600 4000"},
+	             {"-length|", "0 40"}});
+}
+
+TEST_F(Test_SearchIndex, not) {
+	checkSearch({{"-result!", "="}, {"-player!", player_}});
+	checkSearch({{"-welo!", "0 2500"}, {"-belo|!", "0 2500"}});
+	checkSearch({{"-gnum", "100 9000"},
+	             {"-welo", "0 2000"},
+	             {"-welo|!", "0 2700"},
+	             {"-length!", "0 20"}});
+}
+
+TEST_F(Test_SearchIndex, groupsOrder) {
+	// The groups are evaluated from the most selective, but the result
+	// does not depend on the order of the criteria.
+	std::vector<Criteria> search = {{"-length", "0 999"},
+	                                {"-welo", "2400 4000"},
+	                                {"-belo|", "2400 4000"},
+	                                {"-result!", "*"},
+	                                {"-gnum", "4000 4200"}};
+	checkSearch(search);
+	std::rotate(search.begin(), search.begin() + 3, search.end());
+	checkSearch(search);
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pgnparse.h"
+#include "scidbase.h"
+#include "textindex.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+const char* pgnAnnotated = R"([Event "Test"]
+[Annotator "Fritz, Deep"]
+
+1. e4 {Best by test} e5 $1 2. Qh5 {A Novelty!} (2. Nf3 {Normal} Nc6 $146)
+2... Nc6 3. Bc4 Nf6 4. Qxf7# {Mate in 4} 1-0
+)";
+
+const char* pgnPlain = R"([Event "Test"]
+
+1. d4 d5 2. c4 {Queen's gambit} 1/2-1/2
+)";
+
+std::vector<std::string> words(std::string_view text) {
+	std::vector<std::string> res;
+	GameTextIndex::forEachWord(
+	    text, [&](std::string_view word) { res.emplace_back(word); });
+	return res;
+}
+
+void parse(const char* pgn, Game& game) {
+	PgnParseLog parseLog;
+	ASSERT_TRUE(pgnParseGame(pgn, std::strlen(pgn), game, parseLog));
+}
+
+} // namespace
+
+TEST(Test_TextIndex, forEachWord) {
+	using vec = std::vector<std::string>;
+	EXPECT_EQ(vec(), words(""));
+	EXPECT_EQ(vec(), words(" ,.!? "));
+	EXPECT_EQ(vec({"a", "novelty"}), words("A Novelty!"));
+	EXPECT_EQ(vec({"queen", "s", "gambit"}), words("Queen's gambit"));
+	EXPECT_EQ(vec({"$146", "n"}), words("$146 N"));
+	EXPECT_EQ(vec({"ståle", "1", "0"}), words("Ståle 1-0"));
+}
+
+TEST(Test_TextIndex, forEachGameWord) {
+	Game game;
+	parse(pgnAnnotated, game);
+	std::vector<byte> buf;
+	game.Encode(buf);
+
+	std::vector<std::string> res;
+	ASSERT_EQ(OK, GameTextIndex::forEachGameWord(
+	                  {buf.data(), buf.size()},
+	                  [&](std::string_view word) { res.emplace_back(word); }));
+	std::vector<std::string> expected = {
+	    "fritz", "deep",    "$1",     "$146", "n",  "best", "by",
+	    "test",  "a",    "novelty", "normal", "mate", "in", "4"};
+	std::sort(res.begin(), res.end());
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ(expected, res);
+
+	ByteBuffer data(buf.data(), buf.size());
+	EXPECT_TRUE(GameTextIndex::findWords(data, {"novelty"}));
+	EXPECT_TRUE(GameTextIndex::findWords(data, {"novelty", "deep", "$146"}));
+	EXPECT_FALSE(GameTextIndex::findWords(data, {"novelty", "gambit"}));
+	EXPECT_FALSE(GameTextIndex::findWords(data, {"novel"}));
+
+	// Corrupted data
+	for (size_t i = 0; i < buf.size(); ++i) {
+		std::vector<uint32_t> hashes;
+		GameTextIndex::make({buf.data(), i}, hashes);
+	}
+	std::vector<uint32_t> hashes;
+	EXPECT_NE(OK, GameTextIndex::make({buf.data(), buf.size() - 1}, hashes));
+}
+
+TEST(Test_TextIndex, sidecar) {
+	const char* filename = "test_textindex";
+	auto cleanup = [&]() {
+		for (auto ext : {".si4", ".sg4", ".sn4", ".sfp", ".stx"}) {
+			std::remove((std::string(filename) + ext).c_str());
+		}
+	};
+	cleanup();
+
+	Game annotated, plain;
+	parse(pgnAnnotated, annotated);
+	parse(pgnPlain, plain);
+	const std::vector<std::string> novelty = {"novelty"};
+	const std::vector<std::string> gambit = {"queen", "gambit"};
+	{
+		scidBaseT dbase;
+		ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Create, filename));
+		ASSERT_EQ(OK, dbase.saveGame(&annotated));
+		ASSERT_EQ(OK, dbase.saveGame(&plain));
+		ASSERT_EQ(OK, dbase.saveGame(&annotated));
+		EXPECT_EQ(std::vector<bool>({true, false, true}),
+		          dbase.textCandidates(novelty));
+		EXPECT_EQ(std::vector<bool>({false, true, false}),
+		          dbase.textCandidates(gambit));
+		EXPECT_EQ(std::vector<bool>({false, false, false}),
+		          dbase.textCandidates({"unknown"}));
+	}
+
+	scidBaseT dbase;
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_Both, filename));
+	EXPECT_EQ(std::vector<bool>({true, false, true}),
+	          dbase.textCandidates(novelty));
+
+	// A replaced game is re-indexed
+	ASSERT_EQ(OK, dbase.saveGame(&plain, 0));
+	EXPECT_TRUE(dbase.textCandidates(novelty)[2]);
+	EXPECT_EQ(std::vector<bool>({true, true, false}),
+	          dbase.textCandidates(gambit));
+
+	// Games that are not indexed are always included
+	ASSERT_EQ(OK, dbase.stripGames(dbase.getFilter("dbfilter"), {},
+	                               {"Annotator"})
+	                  .first);
+	EXPECT_EQ(std::vector<bool>({true, true, true}),
+	          dbase.textCandidates(gambit));
+
+	dbase.Close();
+
+	// A record with a game number that is not in the database (that could
+	// force a huge allocation) invalidates the file, which is removed.
+	const std::string stx = std::string(filename) + ".stx";
+	ASSERT_TRUE(std::ifstream(stx));
+	std::vector<byte> record;
+	sidecar::writeVarint(record, 0xFFFFFFF0);
+	sidecar::writeVarint(record, 0);
+	sidecar::writeVarint(record, 1);
+	sidecar::writeVarint(record, 0);
+	std::ofstream(stx, std::ios::binary | std::ios::app)
+	    .write(reinterpret_cast<const char*>(record.data()), record.size());
+	ASSERT_EQ(OK, dbase.open("SCID4", FMODE_ReadOnly, filename));
+	EXPECT_EQ(std::vector<bool>({true, true, true}),
+	          dbase.textCandidates(gambit));
+	EXPECT_FALSE(std::ifstream(stx));
+
+	dbase.Close();
+	cleanup();
+}
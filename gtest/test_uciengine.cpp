@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uciengine.h"
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST(Test_UCIEngine, parseInfoPV) {
+	UCIInfoPV info;
+	EXPECT_FALSE(info.parse("bestmove e2e4"));
+	EXPECT_FALSE(info.parse("info depth 10 currmove e2e4 currmovenumber 1"));
+	EXPECT_FALSE(info.parse("info string pv e2e4"));
+
+	ASSERT_TRUE(info.parse("info depth 12 seldepth 18 multipv 2 score cp -35 "
+	                       "wdl 10 900 90 nodes 123456 nps 1000000 hashfull 5 "
+	                       "tbhits 0 time 123 pv e2e4 e7e5  g1f3 string x"));
+	EXPECT_EQ("2", info.multipv);
+	EXPECT_EQ("12", info.depth);
+	EXPECT_EQ("18", info.seldepth);
+	EXPECT_EQ("123456", info.nodes);
+	EXPECT_EQ("1000000", info.nps);
+	EXPECT_EQ("5", info.hashfull);
+	EXPECT_EQ("0", info.tbhits);
+	EXPECT_EQ("123", info.time);
+	EXPECT_EQ("-35", info.score);
+	EXPECT_EQ("cp", info.score_type);
+	EXPECT_EQ("10", info.wdl[0]);
+	EXPECT_EQ("900", info.wdl[1]);
+	EXPECT_EQ("90", info.wdl[2]);
+	EXPECT_EQ("e2e4 e7e5  g1f3", info.pv);
+
+	ASSERT_TRUE(info.parse("info score mate 3 lowerbound pv d1h5 depth 7"));
+	EXPECT_EQ("1", info.multipv);
+	EXPECT_EQ("7", info.depth);
+	EXPECT_EQ("3", info.score);
+	EXPECT_EQ("lowerbound", info.score_type);
+	EXPECT_TRUE(info.wdl[0].empty());
+	EXPECT_TRUE(info.nodes.empty());
+	EXPECT_EQ("d1h5", info.pv);
+}
+
+TEST(Test_UCIEngine, parseUCIInfo) {
+	std::vector<std::pair<std::string, std::string>> values;
+	auto parse = [&](std::string_view line) {
+		values.clear();
+		return parseUCIInfo(line, [&](auto token, auto value) {
+			values.emplace_back(token, value);
+		});
+	};
+	using Values = decltype(values);
+	EXPECT_FALSE(parse("bestmove e2e4"));
+	EXPECT_FALSE(parse("infodepth 1"));
+	EXPECT_TRUE(parse("info "));
+	EXPECT_TRUE(values.empty());
+
+	ASSERT_TRUE(parse("info depth 12 seldepth 18 multipv 2 score cp -35 wdl 10 "
+	                  "900 90 nodes 123456 nps 1000000 hashfull 5 tbhits 0 "
+	                  "sbhits 1 cpuload 900 time 123 currmove e2e4 "
+	                  "currmovenumber 1 pv e2e4 e7e5  g1f3 refutation d1h5 "
+	                  "g6h5 currline 1 e2e4 string a  pv b"));
+	EXPECT_EQ((Values{{"depth", "12"},
+	                  {"seldepth", "18"},
+	                  {"multipv", "2"},
+	                  {"score", "cp -35"},
+	                  {"wdl", "10 900 90"},
+	                  {"nodes", "123456"},
+	                  {"nps", "1000000"},
+	                  {"hashfull", "5"},
+	                  {"tbhits", "0"},
+	                  {"sbhits", "1"},
+	                  {"cpuload", "900"},
+	                  {"time", "123"},
+	                  {"currmove", "e2e4"},
+	                  {"currmovenumber", "1"},
+	                  {"pv", "e2e4 e7e5  g1f3"},
+	                  {"refutation", "d1h5 g6h5"},
+	                  {"currline", "1 e2e4"},
+	                  {"string", "a  pv b"}}),
+	          values);
+
+	ASSERT_TRUE(parse("info  score mate -3 upperbound pv d1h5  depth 7 score"));
+	EXPECT_EQ((Values{{"score", "mate -3 upperbound"},
+	                  {"pv", "d1h5"},
+	                  {"depth", "7"}}),
+	          values);
+
+	ASSERT_TRUE(parse("info pv depth 7 string"));
+	EXPECT_EQ((Values{{"depth", "7"}, {"string", ""}}), values);
+}
+
+TEST(Test_UCIEngine, coordToSAN) {
+	Position pos;
+	pos.StdStart();
+	EXPECT_EQ("", coordToSAN(pos, "", false));
+	EXPECT_EQ("e4 e5 Qh5 Nc6 Bc4 Nf6 Qxf7#",
+	          coordToSAN(pos, "e2e4 e7e5 d1h5 b8c6  f1c4 g8f6 h5f7", false));
+	EXPECT_EQ("1.e4 f6 2.Qh5+", coordToSAN(pos, " e2e4 f7f6 d1h5 ", true));
+	EXPECT_EQ("e4 e5", coordToSAN(pos, "e2e4 e7e5 e1e3 d1h5", false));
+	EXPECT_EQ("", coordToSAN(pos, "e7e5 e2e4", true));
+
+	ASSERT_EQ(OK, pos.ReadFromFENorUCI(
+	                  "position startpos moves e2e4 e7e5 g1f3 b8c6 f1c4 g8f6"));
+	EXPECT_EQ("O-O Nxe4", coordToSAN(pos, "e1g1 f6e4", false));
+	EXPECT_EQ("4.O-O Nxe4", coordToSAN(pos, "e1h1 f6e4", true));
+
+	ASSERT_EQ(OK, pos.ReadFromFEN("8/1P6/8/8/8/8/k7/7K b - - 0 40"));
+	EXPECT_EQ("40...Ka3 41.b8=N", coordToSAN(pos, "a2a3 b7b8n", true));
+
+	// The moves are played in the same way by playCoordMoves()
+	std::vector<bool> last;
+	EXPECT_FALSE(playCoordMoves(pos, "a2a3 b7b8q a3a4 a1a1",
+	                            [&](auto&, auto&, bool isLast) {
+		                            last.push_back(isLast);
+	                            }));
+	EXPECT_EQ(std::vector<bool>({false, false, false}), last);
+	char fen[256];
+	pos.PrintFEN(fen);
+	EXPECT_STREQ("1Q6/8/8/8/k7/8/8/7K w - - 1 42", fen);
+	EXPECT_TRUE(playCoordMoves(pos, "b8b5", [](auto&, auto&, bool) {}));
+}
+
+TEST(Test_UCIEngine, engineOutput) {
+	EngineOutput output(60 * 1000);
+	output.setPosition("position startpos moves e2e4");
+
+	// Before "uciok" the info lines are not parsed
+	EXPECT_EQ(0, output.push("info depth 1 pv e7e5"));
+	EXPECT_EQ(-1, output.push("uciok"));
+	auto [lines, eof] = output.take();
+	EXPECT_FALSE(eof);
+	ASSERT_EQ(2U, lines.size());
+	EXPECT_EQ(0, lines[0].multipv);
+	EXPECT_EQ("uciok", lines[1].line);
+
+	// The PVs with the same multipv replace the previous ones
+	EXPECT_LT(0, output.push("info depth 1 pv e7e5"));
+	EXPECT_EQ(-1, output.push("info depth 1 multipv 2 pv c7c5"));
+	EXPECT_EQ(-1, output.push("info depth 2 pv e7e5 g1f3"));
+	std::tie(lines, eof) = output.take();
+	ASSERT_EQ(2U, lines.size());
+	EXPECT_EQ("info depth 2 pv e7e5 g1f3", lines[0].line);
+	EXPECT_EQ("1...e5 2.Nf3", lines[0].san);
+	EXPECT_EQ(1, lines[0].multipv);
+	EXPECT_EQ("1...c5", lines[1].san);
+	EXPECT_EQ(2, lines[1].multipv);
+
+	// The other lines are kept in order and notified immediately
+	EXPECT_LT(0, output.push("info depth 3 pv e7e5"));
+	EXPECT_EQ(0, output.push("info string hello"));
+	EXPECT_EQ(-1, output.push("info depth 4 pv e7e6"));
+	EXPECT_EQ(-1, output.push("bestmove e7e6"));
+	EXPECT_EQ(-1, output.pushEOF());
+	std::tie(lines, eof) = output.take();
+	EXPECT_TRUE(eof);
+	ASSERT_EQ(4U, lines.size());
+	EXPECT_EQ("info depth 3 pv e7e5", lines[0].line);
+	EXPECT_EQ("info string hello", lines[1].line);
+	EXPECT_EQ("1...e6", lines[2].san);
+	EXPECT_EQ("bestmove e7e6", lines[3].line);
+
+	// Illegal PVs are not converted
+	output.setPosition("position fen 8/8/8/8/8/8/k7/7K w - - 0 1");
+	output.push("info depth 1 pv e2e4");
+	std::tie(lines, eof) = output.take();
+	ASSERT_EQ(1U, lines.size());
+	EXPECT_TRUE(lines[0].san.empty());
+}
+
+#if !defined(_WIN32)
+TEST(Test_UCIEngine, engineProcess) {
+	std::mutex mtx;
+	std::condition_variable cond;
+	std::vector<std::string> lines;
+	bool eof = false;
+	EngineProcess process;
+	ASSERT_EQ(ERROR_FileOpen,
+	          process.open({"scid_nonexistent_engine"}, {}, {}));
+	ASSERT_EQ(OK, process.open(
+	                  {"cat"},
+	                  [&](std::string_view line) {
+		                  std::lock_guard lock(mtx);
+		                  lines.emplace_back(line);
+	                  },
+	                  [&] {
+		                  std::lock_guard lock(mtx);
+		                  eof = true;
+		                  cond.notify_all();
+	                  }));
+	EXPECT_TRUE(process.isOpen());
+	EXPECT_LT(0, process.pid());
+	EXPECT_TRUE(process.write("uci"));
+	EXPECT_TRUE(process.write(std::string(100000, 'x') + "\r"));
+	EXPECT_TRUE(process.write(""));
+	process.close();
+	EXPECT_FALSE(process.isOpen());
+
+	std::unique_lock lock(mtx);
+	EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(1), [&] { return eof; }));
+	ASSERT_EQ(3U, lines.size());
+	EXPECT_EQ("uci", lines[0]);
+	EXPECT_EQ(std::string(100000, 'x'), lines[1]);
+	EXPECT_EQ("", lines[2]);
+}
+#endif
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Sets of squares stored in 64-bit integers and the tables of the squares
+ * attacked by each type of piece.
+ * The attacks of the sliding pieces are looked up with the PEXT instruction
+ * when the compiler targets BMI2 (-mbmi2 or -march=native), and with magic
+ * multipliers otherwise.
+ */
+
+#pragma once
+
+#include "board_def.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace bitboard {
+
+/// Bit N is set if the square N (A1 == 0, H8 == 63) belongs to the set.
+typedef uint64_t Bitboard;
+
+constexpr Bitboard FYLE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+constexpr Bitboard LIGHT_SQUARES_BB = 0x55AA55AA55AA55AAULL;
+
+constexpr Bitboard square_bb(squareT sq) { return Bitboard(1) << sq; }
+constexpr Bitboard fyle_bb(fyleT fyle) { return FYLE_A_BB << fyle; }
+constexpr Bitboard rank_bb(rankT rank) { return RANK_1_BB << (8 * rank); }
+
+/// Returns the squares with the same square_Color() (WHITE for light squares).
+constexpr Bitboard square_color_bb(colorT color) {
+	return color == WHITE ? LIGHT_SQUARES_BB : ~LIGHT_SQUARES_BB;
+}
+
+inline int popcount(Bitboard b) {
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt64(b));
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+/// Returns the lowest square of a non-empty set.
+inline squareT lsb(Bitboard b) {
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward64(&idx, b);
+	return static_cast<squareT>(idx);
+#else
+	return static_cast<squareT>(__builtin_ctzll(b));
+#endif
+}
+
+/// Removes and returns the lowest square of a non-empty set.
+inline squareT pop_lsb(Bitboard& b) {
+	const auto sq = lsb(b);
+	b &= b - 1;
+	return sq;
+}
+
+/// Returns true if the set contains more than one square.
+constexpr bool more_than_one(Bitboard b) { return b & (b - 1); }
+
+/// Moves all the squares of a set one rank up (WHITE) or down (BLACK).
+constexpr Bitboard pawn_push(colorT color, Bitboard b) {
+	return color == WHITE ? b << 8 : b >> 8;
+}
+
+class Tables {
+	struct Magic {
+		Bitboard mask;
+		Bitboard magic;
+		Bitboard* attacks;
+		unsigned shift;
+
+		unsigned index(Bitboard occupied) const {
+#if defined(__BMI2__)
+			return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+			return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+		}
+	};
+
+	Magic rook_[64];
+	Magic bishop_[64];
+	Bitboard knight_[64];
+	Bitboard king_[64];
+	Bitboard pawn_[2][64];
+	Bitboard between_[64][64];
+	Bitboard line_[64][64];
+	Bitboard leftDiag_[15];
+	Bitboard rightDiag_[15];
+	Bitboard sliders_[102400 + 5248]; // rooks + bishops
+
+	// The squares attacked by a piece moving in the given directions,
+	// computed one square at a time.
+	static Bitboard slow_attacks(int sq, const int (&dirs)[4][2],
+	                             Bitboard occupied) {
+		Bitboard res = 0;
+		for (auto [df, dr] : dirs) {
+			int f = sq % 8 + df;
+			int r = sq / 8 + dr;
+			for (; f >= 0 && f < 8 && r >= 0 && r < 8; f += df, r += dr) {
+				res |= square_bb(static_cast<squareT>(r * 8 + f));
+				if (occupied & square_bb(static_cast<squareT>(r * 8 + f)))
+					break;
+			}
+		}
+		return res;
+	}
+
+	template <size_t N>
+	static Bitboard steps(int sq, const int (&deltas)[N][2]) {
+		Bitboard res = 0;
+		for (auto [df, dr] : deltas) {
+			const int f = sq % 8 + df;
+			const int r = sq / 8 + dr;
+			if (f >= 0 && f < 8 && r >= 0 && r < 8)
+				res |= square_bb(static_cast<squareT>(r * 8 + f));
+		}
+		return res;
+	}
+
+	// Fills the magic entries and their attacks, starting at @e table.
+	// Returns the end of the used part of the table.
+	static Bitboard* init_magics(Magic* magics, const int (&dirs)[4][2],
+	                             Bitboard* table) {
+		// Seeds that quickly find the magics with the xorshift generator.
+		const uint64_t seeds[8] = {728,   10316, 55013, 32803,
+		                           12281, 15100, 16645, 255};
+		Bitboard occupancy[4096];
+		Bitboard reference[4096];
+		int epoch[4096] = {};
+		int cnt = 0;
+		for (int sq = 0; sq < 64; ++sq) {
+			const Bitboard edges =
+			    ((rank_bb(RANK_1) | rank_bb(RANK_8)) & ~rank_bb(sq / 8)) |
+			    ((fyle_bb(A_FYLE) | fyle_bb(H_FYLE)) & ~fyle_bb(sq % 8));
+			auto& m = magics[sq];
+			m.mask = slow_attacks(sq, dirs, 0) & ~edges;
+			m.shift = 64 - popcount(m.mask);
+			m.attacks = table;
+
+			// Enumerate all the subsets of the mask (Carry-Rippler).
+			int size = 0;
+			Bitboard b = 0;
+			do {
+				occupancy[size] = b;
+				reference[size] = slow_attacks(sq, dirs, b);
+#if defined(__BMI2__)
+				m.attacks[m.index(b)] = reference[size];
+#endif
+				++size;
+				b = (b - m.mask) & m.mask;
+			} while (b);
+			table += size;
+
+#if !defined(__BMI2__)
+			uint64_t seed = seeds[sq / 8];
+			auto rand = [&seed]() {
+				seed ^= seed >> 12;
+				seed ^= seed << 25;
+				seed ^= seed >> 27;
+				return seed * 2685821657736338717ULL;
+			};
+			for (int i = 0; i < size;) {
+				do {
+					m.magic = rand() & rand() & rand();
+				} while (popcount((m.magic * m.mask) >> 56) < 6);
+
+				// A candidate magic is verified by building the table:
+				// the epoch avoids clearing it after every failure.
+				for (++cnt, i = 0; i < size; ++i) {
+					const auto idx = m.index(occupancy[i]);
+					if (epoch[idx] < cnt) {
+						epoch[idx] = cnt;
+						m.attacks[idx] = reference[i];
+					} else if (m.attacks[idx] != reference[i]) {
+						break;
+					}
+				}
+			}
+#else
+			(void)seeds;
+			(void)occupancy;
+			(void)epoch;
+			(void)cnt;
+#endif
+		}
+		return table;
+	}
+
+public:
+	Tables() {
+		const int rookDirs[4][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}};
+		const int bishopDirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+		const int knightDeltas[8][2] = {{1, 2},  {2, 1},  {2, -1}, {1, -2},
+		                                {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+		const int kingDeltas[8][2] = {{0, 1},  {1, 1},   {1, 0},  {1, -1},
+		                              {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+		const int wpawnDeltas[2][2] = {{-1, 1}, {1, 1}};
+		const int bpawnDeltas[2][2] = {{-1, -1}, {1, -1}};
+
+		auto table = init_magics(rook_, rookDirs, sliders_);
+		init_magics(bishop_, bishopDirs, table);
+
+		for (int d = 0; d < 15; ++d) {
+			leftDiag_[d] = rightDiag_[d] = 0;
+		}
+		for (int sq = 0; sq < 64; ++sq) {
+			knight_[sq] = steps(sq, knightDeltas);
+			king_[sq] = steps(sq, kingDeltas);
+			pawn_[WHITE][sq] = steps(sq, wpawnDeltas);
+			pawn_[BLACK][sq] = steps(sq, bpawnDeltas);
+			leftDiag_[sq / 8 + sq % 8] |= square_bb(static_cast<squareT>(sq));
+			rightDiag_[7 + sq / 8 - sq % 8] |=
+			    square_bb(static_cast<squareT>(sq));
+		}
+
+		for (int s1 = 0; s1 < 64; ++s1) {
+			const auto sq1 = static_cast<squareT>(s1);
+			for (int s2 = 0; s2 < 64; ++s2) {
+				const auto sq2 = static_cast<squareT>(s2);
+				between_[s1][s2] = line_[s1][s2] = 0;
+				for (auto pt : {ROOK, BISHOP}) {
+					if (attacks(pt, sq1, 0) & square_bb(sq2)) {
+						line_[s1][s2] =
+						    (attacks(pt, sq1, 0) & attacks(pt, sq2, 0)) |
+						    square_bb(sq1) | square_bb(sq2);
+						between_[s1][s2] =
+						    attacks(pt, sq1, square_bb(sq2)) &
+						    attacks(pt, sq2, square_bb(sq1));
+					}
+				}
+			}
+		}
+	}
+
+	Bitboard rook(squareT sq, Bitboard occupied) const {
+		return rook_[sq].attacks[rook_[sq].index(occupied)];
+	}
+	Bitboard bishop(squareT sq, Bitboard occupied) const {
+		return bishop_[sq].attacks[bishop_[sq].index(occupied)];
+	}
+	Bitboard knight(squareT sq) const { return knight_[sq]; }
+	Bitboard king(squareT sq) const { return king_[sq]; }
+	Bitboard pawn(colorT color, squareT sq) const { return pawn_[color][sq]; }
+	Bitboard between(squareT sq1, squareT sq2) const {
+		return between_[sq1][sq2];
+	}
+	Bitboard line(squareT sq1, squareT sq2) const { return line_[sq1][sq2]; }
+	Bitboard leftDiag(unsigned diag) const { return leftDiag_[diag]; }
+	Bitboard rightDiag(unsigned diag) const { return rightDiag_[diag]; }
+
+	/// Returns the squares attacked by a QUEEN, ROOK, BISHOP, KNIGHT or KING.
+	Bitboard attacks(pieceT pieceType, squareT sq, Bitboard occupied) const {
+		switch (pieceType) {
+		case QUEEN:
+			return rook(sq, occupied) | bishop(sq, occupied);
+		case ROOK:
+			return rook(sq, occupied);
+		case BISHOP:
+			return bishop(sq, occupied);
+		case KNIGHT:
+			return knight(sq);
+		case KING:
+			return king(sq);
+		}
+		return 0;
+	}
+};
+
+/// Returns the attack tables, which are built the first time they are used.
+inline const Tables& tables() {
+	static const Tables res;
+	return res;
+}
+
+} // namespace bitboard
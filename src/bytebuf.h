@@ -287,6 +287,35 @@ public:
 		return {ERROR_Decode, 0}; // ERROR: missing ENCODE_END_GAME
 	}
 
+	/// Skips the moves section, without decoding the moves: the position is
+	/// not needed. Must be called after decodeStartBoard().
+	/// @param addNag: a function that will be called for each NAG.
+	template <typename NagFn> errorT skipMoves(NagFn addNag) {
+		const auto err = nextMove(
+		                     0, [](auto) { return false; }, [] {},
+		                     [](auto) { return true; },
+		                     [&](auto nag) {
+			                     addNag(nag);
+			                     return true;
+		                     })
+		                     .first;
+		return err == ERROR_EndOfMoveList ? OK : err;
+	}
+
+	/// Decodes the comments section, which follows the moves section.
+	/// @param fn: a function that should accept a std::string_view parameter
+	///            and that will be called for each comment.
+	template <typename FuncT> errorT decodeComments(FuncT fn) {
+		while (data_ != end_) {
+			const char* comment = GetTerminatedString();
+			if (!comment)
+				return ERROR_Decode;
+
+			fn(std::string_view(comment));
+		}
+		return OK;
+	}
+
 	/// Find the next move in the current line.
 	/// Ignore variations, comments and nags.
 	std::pair<errorT, unsigned char> nextLineMove() {
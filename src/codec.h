@@ -108,6 +108,19 @@ public:
 	virtual errorT addGame(IndexEntry const& ie, TagRoster const& tags,
 	                       ByteBuffer const& data) = 0;
 
+	/**
+	 * Add a game whose names were already added with addName().
+	 * Used to copy many games, when the IDs of the names can be translated
+	 * without searching them.
+	 * @param ie:   the header data of the source game, referring to the IDs
+	 *              returned by addName().
+	 * @param tags: the names referred by @e ie.
+	 * @param data: the data (encoded in native format) of the game.
+	 * @returns OK if successful or an error code.
+	 */
+	virtual errorT addGameMapped(IndexEntry const& ie, TagRoster const& tags,
+	                             ByteBuffer const& data) = 0;
+
 	/**
 	 * Replaces a game in the database.
 	 * @param ie:   the header data of the source game.
@@ -135,6 +135,22 @@ public:
 	 */
 	const char* parseErrors() { return parseLog_.log.c_str(); }
 
+	/**
+	 * Add a game into the database.
+	 * The encoded game is converted directly to pgn format, without decoding
+	 * it into a Game object, and appended at the end of @e file_.
+	 * @returns OK in case of success, an @e errorT code otherwise.
+	 */
+	errorT gameAddEncoded(IndexEntry const& ie, TagRoster const& tags,
+	                      ByteBuffer const& data) {
+		buf_.clear();
+		if (errorT err = encodePGN(ie, tags, data, buf_))
+			return err;
+
+		buf_.push_back('\n');
+		return file_.append(buf_.data(), buf_.size());
+	}
+
 	/**
 	 * Add a game into the database.
 	 * The @e game is encoded in pgn format and appended at the end of @e file_.
@@ -88,6 +88,23 @@ public:
 	 */
 	errorT gameAdd(Game*) { return ERROR_CodecUnsupFeat; }
 
+	/**
+	 * Adds a game, encoded in the native format, into the database.
+	 * If not overridden, decodes the game and invokes gameAdd().
+	 * @param ie:   the IndexEntry of the game.
+	 * @param tags: the tags referred by the IndexEntry.
+	 * @param data: the encoded data of the game.
+	 * @returns OK in case of success, an @p errorT code otherwise.
+	 */
+	errorT gameAddEncoded(IndexEntry const& ie, TagRoster const& tags,
+	                      ByteBuffer const& data) {
+		Game game;
+		if (errorT err = game.Decode(ie, tags, data))
+			return err;
+
+		return getDerived()->gameAdd(&game);
+	}
+
 	/**
 	 * Replaces a game in the database.
 	 * @param Game*:    valid pointer to a Game object with the new data.
@@ -115,16 +132,17 @@ private:
 
 	errorT addGame(IndexEntry const& ie, TagRoster const& tags,
 	               ByteBuffer const& data) final {
-		Game game;
-		if (errorT err = game.Decode(ie, tags, data))
-			return err;
-
-		if (errorT err = getDerived()->gameAdd(&game))
+		if (errorT err = getDerived()->gameAddEncoded(ie, tags, data))
 			return err;
 
 		return CodecMemory::addGame(ie, tags, data);
 	}
 
+	errorT addGameMapped(IndexEntry const&, TagRoster const&,
+	                     ByteBuffer const&) final {
+		return ERROR_CodecUnsupFeat;
+	}
+
 	errorT saveIndexEntry(const IndexEntry& ie, gamenumT replaced) final {
 		if (CodecMemory::equalExceptFlags(ie, replaced))
 			return CodecMemory::saveIndexEntry(ie, replaced);
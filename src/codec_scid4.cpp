@@ -23,8 +23,10 @@
  */
 
 #include "codec_scid4.h"
+#include "parallel.h"
 #include <algorithm>
 #include <string_view>
+#include <vector>
 
 namespace {
 
@@ -669,28 +671,42 @@ errorT CodecSCID4::readIndex(gamenumT nGames, Progress const& progress) {
 		return true;
 	};
 
+	// The file is read in blocks, which are decoded by multiple threads.
+	// The name IDs are then validated sequentially, because the invalid ones
+	// are replaced with new names.
 	idx_->entries_.resize(nGames);
-	const auto nBytes = (header_.version < 400) ? OLD_INDEX_ENTRY_SIZE
-	                                            : INDEX_ENTRY_SIZE;
-	for (gamenumT gNum = 0; idxfile_.sgetc() != EOF; ++gNum) {
-		if (gNum == nGames)
-			return ERROR_CorruptData;
-
-		if ((gNum % 8192) == 0) {
-			if (!progress.report(gNum, nGames))
-				return ERROR_UserCancel;
-		}
-
-		char buf[INDEX_ENTRY_SIZE];
-		if (idxfile_.sgetn(buf, nBytes) != nBytes)
+	const auto version = header_.version;
+	const size_t nBytes = (version < 400) ? OLD_INDEX_ENTRY_SIZE
+	                                      : INDEX_ENTRY_SIZE;
+	constexpr gamenumT BLOCK_GAMES = 1 << 16;
+	std::vector<char> buf(BLOCK_GAMES * nBytes);
+	for (gamenumT block = 0; block < nGames; block += BLOCK_GAMES) {
+		if (!progress.report(block, nGames))
+			return ERROR_UserCancel;
+
+		const auto n = std::min(BLOCK_GAMES, nGames - block);
+		const auto blockBytes = static_cast<std::streamsize>(n * nBytes);
+		const auto nRead = idxfile_.sgetn(buf.data(), blockBytes);
+		if (nRead < 0 || nRead % nBytes != 0)
 			return ERROR_FileRead;
 
-		IndexEntry& ie = idx_->entries_[gNum];
-		decodeIndexEntry(buf, header_.version, &ie);
-
-		if (!validateNameIDs(&ie))
-			return ERROR_CorruptData;
+		// A truncated file is accepted: the missing entries are decoded
+		// from zeros.
+		std::fill(buf.begin() + nRead, buf.begin() + blockBytes, 0);
+		parallelFor(n, 4096, [&](size_t begin, size_t end) {
+			for (auto i = begin; i < end; ++i) {
+				decodeIndexEntry(buf.data() + i * nBytes, version,
+				                 &idx_->entries_[block + i]);
+			}
+		});
+		for (gamenumT i = 0; i < n; ++i) {
+			if (!validateNameIDs(&idx_->entries_[block + i]))
+				return ERROR_CorruptData;
+		}
 	}
+	if (idxfile_.sgetc() != EOF)
+		return ERROR_CorruptData;
+
 	progress.report(1, 1);
 
 	idx_->nInvalidNameId_ = nUnknowIDs;
@@ -119,6 +119,18 @@ public: // ICodecDatabase interface
 		return dyn_addIndexEntry(ie);
 	}
 
+	errorT addGameMapped(IndexEntry const& ie_src, TagRoster const&,
+	                     ByteBuffer const& data) final {
+		if (!ie_src.isChessStd())
+			return ERROR_CodecChess960;
+
+		IndexEntry ie = ie_src;
+		if (auto err = addGameData(ie, data.data(), data.size()))
+			return err;
+
+		return dyn_addIndexEntry(ie);
+	}
+
 	errorT saveGame(IndexEntry const& ie_src, TagRoster const& tags,
 	                ByteBuffer const& data, gamenumT replaced) final {
 		IndexEntry ie = ie_src;
@@ -249,6 +261,11 @@ private:
 		if (errNames)
 			return errNames;
 
+		return addGameData(ie, srcData, dataLen);
+	}
+
+	/// Add the gamedata to the database and set the reference in @e ie.
+	errorT addGameData(IndexEntry& ie, const byte* srcData, size_t dataLen) {
 		auto [err, offset] = dyn_addGameData(srcData, dataLen);
 		if (!err) {
 			ie.SetOffset(offset);
@@ -27,11 +27,14 @@
 #pragma once
 
 #include "codec.h"
+#include "commentpack.h"
 #include "filebuf.h"
 #include "index.h"
 #include "namebase.h"
+#include "parallel.h"
 #include <algorithm>
 #include <array>
+#include <charconv>
 #include <cstdint>
 #include <filesystem>
 #include <future>
@@ -105,11 +108,15 @@
 //
 // Namebase
 // The NameBase file (extension .sn5) is a sequence of strings with an
-// associated type (PLAYER, EVENT, SITE, ROUND, DB_INFO).
+// associated type (PLAYER, EVENT, SITE, ROUND, DB_INFO, VERSION).
 // The string are encoded as a varint (length * 8 + type) followed by the data.
 // The last 3 bits of the varint store the name type.
 // The file is append only. When a game is modified with a new name, it is added
 // to the NameBase and the new ID is written in the game's IndexEntry.
+// The VERSION string is the decimal number of the format version. It is
+// written when the first game that requires the version 2 (packed comments)
+// is stored and it is missing in version 1 files.
+// Older programs consider the type VERSION corrupted and refuse the file.
 //
 // 1) number of characters for tags.
 //    The tag name must consist of at least one character and at most 240 (range
@@ -117,10 +124,9 @@
 //    255] ).
 // The IDs are sequentially increasing values ​​starting with value 0
 // The tag values ​​cannot contain the null char ('\0').
-// 10) The most important limitation in my opinion is that neither the tags nor
-//     the comments are compressed in any way. It is now common to have games
-//     where the clock and the eventual evaluation of each position are stored
-//     as comments, and it would be possible to save a lot of space.
+// 10) The tags are not compressed in any way. The comments are stored using
+//     the packed encoding (see below) which reduces the size of the clock and
+//     evaluation commands, but the remaining text is not compressed.
 //
 // Games
 // The Games file (extension .sg5) contains blobs of data; for each game:
@@ -148,6 +154,18 @@
 // data. An empty tag name is not allowed.
 // The tag name can have at most 240 characters (range [1:240] ).
 // The tag value can have at most 255 characters (range [0:255] ).
+// Packed comments
+// If the bit 3 of the start board flags (see encodeStartBoard()) is set, the
+// comments are stored using the encoding described in commentpack.h,
+// followed by 3 bytes (little-endian) with the size of the packed comments.
+// The packed encoding is used only if it reduces the size of the game's data
+// and only in databases of version 2 or greater, or created by the current
+// session (which are upgraded to version 2 when the first packed game is
+// stored): older programs ignore the flag and would read the packed data as
+// normal comments.
+// When reading the game's data the comments are converted back to the normal
+// encoding, while getGameMoves() returns the stored data (the moves are not
+// modified and the comments are never read).
 
 // This class manages databases encoded in SCID format v5.
 class CodecSCID5 final : public ICodecDatabase {
@@ -164,6 +182,10 @@ class CodecSCID5 final : public ICodecDatabase {
 	Filebuf idxfile_;
 	gamenumT idx_seqwrite_ = 0;
 	char gcache_[1ULL << 17];
+	std::vector<byte> unpacked_;
+	std::vector<byte> packed_;
+	unsigned version_ = 1;
+	bool packComments_ = false; // if the packed encoding can be used
 
 	enum : unsigned long long {
 		LIMIT_GAMEOFFSET = 1ULL << 47,
@@ -176,6 +198,9 @@ class CodecSCID5 final : public ICodecDatabase {
 
 	static constexpr auto INDEX_ENTRY_SIZE = 56;
 	static constexpr unsigned NAME_INFO = 4;
+	static constexpr unsigned NAME_VERSION = 5;
+	static constexpr unsigned FORMAT_VERSION = 2;
+	static constexpr byte PACKED_COMMENTS = 8;
 
 public: // ICodecDatabase interface
 	Codec getType() const final { return ICodecDatabase::SCID5; }
@@ -194,21 +219,11 @@ public: // ICodecDatabase interface
 	};
 
 	ByteBuffer getGameData(uint64_t offset, uint32_t length) final {
-		if (offset >= gfile_.size())
-			return {nullptr, 0};
-		if (length >= LIMIT_GAMELEN)
-			return {nullptr, 0};
-
-		if (gfile_.pubseekpos(offset) < 0)
-			return {nullptr, 0};
-		if (gfile_.sgetn(gcache_, length) != length)
-			return {nullptr, 0};
-
-		return {reinterpret_cast<const byte*>(gcache_), length};
+		return unpack_comments(read_game_data(offset, length));
 	}
 
 	ByteBuffer getGameMoves(IndexEntry const& ie) final {
-		auto data = getGameData(ie.GetOffset(), ie.GetLength());
+		auto data = read_game_data(ie.GetOffset(), ie.GetLength());
 		if (data && OK == data.decodeTags([](auto, auto) {}))
 			return data;
 
@@ -232,6 +247,23 @@ public: // ICodecDatabase interface
 		return OK;
 	}
 
+	errorT addGameMapped(IndexEntry const& ie_src, TagRoster const&,
+	                     ByteBuffer const& data) final {
+		const auto nGames = idx_->GetNumGames();
+		if (nGames >= LIMIT_NUMGAMES)
+			return ERROR_NumGamesLimit;
+
+		IndexEntry ie = ie_src;
+		if (auto err = add_data(ie, pack_comments(data)))
+			return err;
+
+		if (auto err = write_IndexEntry(ie, nGames))
+			return err;
+
+		idx_->addEntry(ie);
+		return OK;
+	}
+
 	errorT saveGame(IndexEntry const& ie_src, TagRoster const& tags,
 	                ByteBuffer const& data, gamenumT replaced) final {
 		IndexEntry ie = ie_src;
@@ -311,7 +343,11 @@ public: // ICodecDatabase interface
 			if (auto err = gfile_.open(filenames_[1], fmode))
 				return err;
 
-			return nbfile_.open(filenames_[2], fmode);
+			if (auto err = nbfile_.open(filenames_[2], fmode))
+				return err;
+
+			packComments_ = true;
+			return OK;
 		}
 
 		auto read_names = std::async(std::launch::async,
@@ -327,18 +363,116 @@ public: // ICodecDatabase interface
 	}
 
 private:
+	/// Reads the stored data of a game.
+	ByteBuffer read_game_data(uint64_t offset, uint32_t length) {
+		if (offset >= gfile_.size())
+			return {nullptr, 0};
+		if (length >= LIMIT_GAMELEN)
+			return {nullptr, 0};
+
+		if (gfile_.pubseekpos(offset) < 0)
+			return {nullptr, 0};
+		if (gfile_.sgetn(gcache_, length) != length)
+			return {nullptr, 0};
+
+		return {reinterpret_cast<const byte*>(gcache_), length};
+	}
+
+	/// Returns the offset of the start board flags (0 on error).
+	static size_t start_board_offset(ByteBuffer data) {
+		const auto begin = data.data();
+		if (data.decodeTags([](auto, auto) {}) != OK || !data)
+			return 0;
+
+		return data.data() - begin;
+	}
+
+	/// Converts the comments of the stored data into the normal encoding.
+	ByteBuffer unpack_comments(ByteBuffer const& data) {
+		const auto flags = start_board_offset(data);
+		if (flags == 0 || (data.data()[flags] & PACKED_COMMENTS) == 0)
+			return data;
+
+		const auto end = data.data() + data.size();
+		const size_t packed_sz = end[-3] | (end[-2] << 8) | (end[-1] << 16);
+		if (data.size() < flags + 4 + packed_sz)
+			return {nullptr, 0};
+
+		const auto packed = end - 3 - packed_sz;
+		unpacked_.assign(data.data(), packed);
+		unpacked_[flags] &= ~PACKED_COMMENTS;
+		if (!commentpack::unpack(packed, end - 3, unpacked_))
+			return {nullptr, 0};
+
+		return {unpacked_.data(), unpacked_.size()};
+	}
+
+	/// Converts the comments of a game's data into the packed encoding.
+	/// @returns the data to be stored: the original data if the game has no
+	/// comments, if the packed encoding is not smaller or if the database's
+	/// version does not support it.
+	ByteBuffer pack_comments(ByteBuffer const& data) {
+		if (!packComments_)
+			return data;
+
+		const auto flags = start_board_offset(data);
+		if (flags == 0 || (data.data()[flags] & PACKED_COMMENTS))
+			return data;
+
+		// The position is not needed to find the comments section: skip the
+		// moves' bytes without decoding them.
+		ByteBuffer moves = data;
+		if (moves.decodeTags([](auto, auto) {}) != OK ||
+		    moves.decodeStartBoard().first != OK ||
+		    moves.skipMoves([](auto) {}) != OK || !moves)
+			return data;
+
+		packed_.assign(data.data(), moves.data());
+		packed_[flags] |= PACKED_COMMENTS;
+		const auto packed = packed_.size();
+		const auto end = data.data() + data.size();
+		if (!commentpack::pack(moves.data(), end, packed_))
+			return data;
+
+		const auto packed_sz = packed_.size() - packed;
+		packed_.push_back(static_cast<byte>(packed_sz));
+		packed_.push_back(static_cast<byte>(packed_sz >> 8));
+		packed_.push_back(static_cast<byte>(packed_sz >> 16));
+		if (packed_.size() >= data.size() || packed_sz >= LIMIT_GAMELEN)
+			return data;
+
+		return {packed_.data(), packed_.size()};
+	}
+
 	/// Add the game's roster tags and gamedata to the database.
 	/// Set the references to the new data in @e ie.
 	errorT add_names_and_data(IndexEntry& ie, TagRoster const& tags,
-	                          ByteBuffer const& data) {
-		const auto data_sz = data.size();
-		if (data_sz >= LIMIT_GAMELEN)
+	                          ByteBuffer const& game_data) {
+		const auto data = pack_comments(game_data);
+		if (data.size() >= LIMIT_GAMELEN)
 			return ERROR_GameLengthLimit;
 
 		if (auto err = tags.map(
 		        ie, [&](auto nt, auto name) { return addName(nt, name); }))
 			return err;
 
+		return add_data(ie, data);
+	}
+
+	/// Add the packed gamedata to the database and set the reference in @e ie.
+	/// The first game with packed comments upgrades the database's version.
+	errorT add_data(IndexEntry& ie, ByteBuffer const& data) {
+		const auto data_sz = data.size();
+		if (data_sz >= LIMIT_GAMELEN)
+			return ERROR_GameLengthLimit;
+
+		if (data.data() == packed_.data() && version_ < FORMAT_VERSION) {
+			if (auto err = append_nbfile(NAME_VERSION,
+			                             std::to_string(FORMAT_VERSION)))
+				return err;
+			version_ = FORMAT_VERSION;
+		}
+
 		// The SCID5 format stores games into blocks of 128KB.
 		// If the current block does not have enough space, we fill it with
 		// random data and use the next one.
@@ -370,20 +504,26 @@ private:
 			return ERROR_Corrupt;
 		}
 
+		// The file is read in blocks, which are decoded by multiple threads.
 		const size_t n_games = file_size / INDEX_ENTRY_SIZE;
 		idx_->entries_.resize(n_games);
-		constexpr auto eof = Filebuf::traits_type::eof();
-		for (size_t gnum = 0; idxfile_.sgetc() != eof; ++gnum) {
-			if ((gnum % 8192) == 0) {
-				if (!progress.report(gnum, n_games))
-					return ERROR_UserCancel;
-			}
-
-			char buf[INDEX_ENTRY_SIZE];
-			if (idxfile_.sgetn(buf, INDEX_ENTRY_SIZE) != INDEX_ENTRY_SIZE)
+		constexpr size_t BLOCK_GAMES = 1 << 16;
+		std::vector<char> buf(BLOCK_GAMES * INDEX_ENTRY_SIZE);
+		for (size_t block = 0; block < n_games; block += BLOCK_GAMES) {
+			if (!progress.report(block, n_games))
+				return ERROR_UserCancel;
+
+			const auto n = std::min(BLOCK_GAMES, n_games - block);
+			const auto n_bytes = static_cast<std::streamsize>(n * INDEX_ENTRY_SIZE);
+			if (idxfile_.sgetn(buf.data(), n_bytes) != n_bytes)
 				return ERROR_FileRead;
 
-			idx_->entries_[gnum] = decode_IndexEntry(buf);
+			parallelFor(n, 4096, [&](size_t begin, size_t end) {
+				for (auto i = begin; i < end; ++i) {
+					idx_->entries_[block + i] =
+					    decode_IndexEntry(buf.data() + i * INDEX_ENTRY_SIZE);
+				}
+			});
 		}
 		return OK;
 	}
@@ -519,7 +659,7 @@ private:
 		auto ch = Filebuf::traits_type::eof();
 		while ((ch = nbfile_.sbumpc()) != Filebuf::traits_type::eof()) {
 			auto [nt, len] = read_nbvarint(ch);
-			if (nt > NAME_INFO || len > nbfile_.size())
+			if (nt > NAME_VERSION || len > nbfile_.size())
 				return ERROR_Corrupt;
 
 			if (len > buf.size()) {
@@ -530,6 +670,13 @@ private:
 
 			if (nt < NUM_NAME_TYPES) {
 				nb_->namebase_add(nt, {buf.data(), len});
+			} else if (nt == NAME_VERSION) {
+				const auto end = buf.data() + len;
+				if (std::from_chars(buf.data(), end, version_).ptr != end)
+					return ERROR_Corrupt;
+				if (version_ > FORMAT_VERSION)
+					return ERROR_FileVersion;
+				packComments_ = version_ >= 2;
 			} else {
 				// Ignore unknown extra info. This way, new fields can be added
 				// without breaking compatibility with old versions.
@@ -562,7 +709,7 @@ private:
 	// Add a new name to the NameBase file. The string is encoded as a varint
 	// (length + type in the least significant 3 bits) followed by the data.
 	errorT append_nbfile(unsigned nt, std::string_view name) {
-		ASSERT(nt <= NAME_INFO);
+		ASSERT(nt <= NAME_VERSION);
 
 		uint64_t val = name.size();
 		val = (val << 3) | (nt & 0b111);
@@ -0,0 +1,472 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Packed encoding of the comments section of the games' data.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Packed comments.
+// -----------------------------------------------------------------------------
+//
+// The comments section of a game's data is a sequence of null-terminated
+// strings. Games from online servers and broadcasts usually have a comment
+// for every move containing the clock and the evaluation of the position:
+//   {[%eval 0.17] [%clk 0:03:00]}
+// The packed encoding stores the [%clk] and [%eval] commands as numbers,
+// in separated per-ply arrays, followed by the remaining text:
+//   varint: number of comments
+//   for each comment: 1 byte with the kind of the comment (see below)
+//   for each comment with a clock: varint with the zigzag difference (in
+//                                  tenths of a second) from the clock of the
+//                                  second-last comment with a clock
+//   for each comment with an eval: varint with (zigzag(value) << 3) | format
+//                                  format 0-3 are the number of decimals of
+//                                  a value in pawns, 4 is a mate in value
+//   for each comment with text: the null-terminated text.
+// The kind of a comment is a combination of the flags:
+//   1 -> has [%clk]
+//   2 -> has [%eval]
+//   4 -> [%eval] is before [%clk]
+//   8 -> has text
+//  16 -> the text is before the commands
+//  32 -> [%clk] has tenths of a second
+// Commands and text are separated by a single space.
+// A comment is packed only if it can be recreated exactly, otherwise it is
+// stored as text.
+namespace commentpack {
+
+namespace detail {
+
+enum : unsigned char {
+	HAS_CLK = 1,
+	HAS_EVAL = 2,
+	EVAL_FIRST = 4,
+	HAS_TEXT = 8,
+	TEXT_FIRST = 16,
+	CLK_TENTHS = 32,
+};
+enum { EVAL_MATE = 4 };
+
+struct Comment {
+	unsigned char kind = 0;
+	int64_t clk = 0;
+	int64_t eval = 0;
+	unsigned evalFmt = 0;
+	std::string_view text;
+};
+
+template <typename DestT> void write_varint(uint64_t val, DestT& dest) {
+	while (val >= 128) {
+		dest.push_back(static_cast<unsigned char>(val | 128));
+		val >>= 7;
+	}
+	dest.push_back(static_cast<unsigned char>(val));
+}
+
+inline bool read_varint(const unsigned char*& it, const unsigned char* end,
+                        uint64_t& res) {
+	res = 0;
+	for (int shift = 0; shift < 64 && it != end; shift += 7) {
+		const auto val = *it++;
+		res |= static_cast<uint64_t>(val & 127) << shift;
+		if (val < 128)
+			return true;
+	}
+	return false;
+}
+
+inline uint64_t zigzag(int64_t val) {
+	return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63);
+}
+
+inline int64_t unzigzag(uint64_t val) {
+	return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+}
+
+// Parses an unsigned number with at most 9 digits.
+inline bool parse_digits(std::string_view& str, size_t min_len, size_t max_len,
+                         int64_t& res) {
+	size_t n = 0;
+	res = 0;
+	while (n < str.size() && n < max_len && str[n] >= '0' && str[n] <= '9') {
+		res = res * 10 + (str[n] - '0');
+		++n;
+	}
+	str.remove_prefix(n);
+	return n >= min_len;
+}
+
+// Parses "H:MM:SS" or "H:MM:SS.D"
+inline bool parse_clk(std::string_view str, Comment& dest) {
+	int64_t h, m, s, tenths = 0;
+	if (!parse_digits(str, 1, 4, h) || str.empty() || str[0] != ':')
+		return false;
+	str.remove_prefix(1);
+	if (!parse_digits(str, 2, 2, m) || str.empty() || str[0] != ':')
+		return false;
+	str.remove_prefix(1);
+	if (!parse_digits(str, 2, 2, s))
+		return false;
+	if (!str.empty()) {
+		if (str[0] != '.')
+			return false;
+		str.remove_prefix(1);
+		if (!parse_digits(str, 1, 1, tenths) || !str.empty())
+			return false;
+		dest.kind |= CLK_TENTHS;
+	}
+	dest.clk = ((h * 60 + m) * 60 + s) * 10 + tenths;
+	return true;
+}
+
+// Parses "#N", "#-N", "N", "-N", "N.D", "-N.DDD"
+inline bool parse_eval(std::string_view str, Comment& dest) {
+	bool mate = false;
+	if (!str.empty() && str[0] == '#') {
+		mate = true;
+		str.remove_prefix(1);
+	}
+	bool negative = false;
+	if (!str.empty() && str[0] == '-') {
+		negative = true;
+		str.remove_prefix(1);
+	}
+	int64_t val;
+	if (!parse_digits(str, 1, 9, val))
+		return false;
+
+	dest.evalFmt = mate ? EVAL_MATE : 0;
+	if (!mate && !str.empty() && str[0] == '.') {
+		str.remove_prefix(1);
+		const auto len = str.size();
+		int64_t decimals;
+		if (!parse_digits(str, 1, 3, decimals))
+			return false;
+		dest.evalFmt = static_cast<unsigned>(len - str.size());
+		for (unsigned i = 0; i < dest.evalFmt; ++i)
+			val *= 10;
+		val += decimals;
+	}
+	dest.eval = negative ? -val : val;
+	return str.empty();
+}
+
+// Parses a sequence of [%clk] and [%eval] commands separated by a space.
+inline bool parse_commands(std::string_view str, Comment& dest) {
+	bool first = true;
+	while (!str.empty()) {
+		if (!first) {
+			if (str[0] != ' ')
+				return false;
+			str.remove_prefix(1);
+		}
+		first = false;
+
+		const auto end = str.find(']');
+		if (end == std::string_view::npos)
+			return false;
+
+		auto cmd = str.substr(0, end);
+		str.remove_prefix(end + 1);
+		if (cmd.substr(0, 6) == "[%clk " && !(dest.kind & HAS_CLK)) {
+			if (!parse_clk(cmd.substr(6), dest))
+				return false;
+			dest.kind |= HAS_CLK;
+		} else if (cmd.substr(0, 7) == "[%eval " && !(dest.kind & HAS_EVAL)) {
+			if (!parse_eval(cmd.substr(7), dest))
+				return false;
+			if (!(dest.kind & HAS_CLK))
+				dest.kind |= EVAL_FIRST;
+			dest.kind |= HAS_EVAL;
+		} else {
+			return false;
+		}
+	}
+	return !first;
+}
+
+template <typename DestT>
+void append_commands(Comment const& comment, DestT& dest) {
+	auto append = [&](std::string_view str) {
+		dest.insert(dest.end(), str.begin(), str.end());
+	};
+	auto append_clk = [&]() {
+		const auto clk = comment.clk;
+		const auto s = (clk / 10) % 60;
+		const auto m = (clk / 600) % 60;
+		append("[%clk ");
+		append(std::to_string(clk / 36000));
+		dest.push_back(':');
+		dest.push_back(static_cast<char>('0' + m / 10));
+		dest.push_back(static_cast<char>('0' + m % 10));
+		dest.push_back(':');
+		dest.push_back(static_cast<char>('0' + s / 10));
+		dest.push_back(static_cast<char>('0' + s % 10));
+		if (comment.kind & CLK_TENTHS) {
+			dest.push_back('.');
+			dest.push_back(static_cast<char>('0' + clk % 10));
+		}
+		dest.push_back(']');
+	};
+	auto append_eval = [&]() {
+		append("[%eval ");
+		if (comment.evalFmt == EVAL_MATE) {
+			dest.push_back('#');
+			append(std::to_string(comment.eval));
+		} else {
+			auto val = comment.eval;
+			if (val < 0) {
+				dest.push_back('-');
+				val = -val;
+			}
+			int64_t scale = 1;
+			for (unsigned i = 0; i < comment.evalFmt; ++i)
+				scale *= 10;
+			append(std::to_string(val / scale));
+			if (comment.evalFmt) {
+				dest.push_back('.');
+				auto decimals = std::to_string(val % scale);
+				dest.insert(dest.end(), comment.evalFmt - decimals.size(), '0');
+				append(decimals);
+			}
+		}
+		dest.push_back(']');
+	};
+
+	if ((comment.kind & (HAS_CLK | HAS_EVAL)) == (HAS_CLK | HAS_EVAL)) {
+		if (comment.kind & EVAL_FIRST) {
+			append_eval();
+			dest.push_back(' ');
+			append_clk();
+		} else {
+			append_clk();
+			dest.push_back(' ');
+			append_eval();
+		}
+	} else if (comment.kind & HAS_CLK) {
+		append_clk();
+	} else if (comment.kind & HAS_EVAL) {
+		append_eval();
+	}
+}
+
+/// Recreates the original comment.
+template <typename DestT> void unparse(Comment const& comment, DestT& dest) {
+	const bool commands = comment.kind & (HAS_CLK | HAS_EVAL);
+	const bool text = comment.kind & HAS_TEXT;
+	if (text && (comment.kind & TEXT_FIRST)) {
+		dest.insert(dest.end(), comment.text.begin(), comment.text.end());
+		if (commands)
+			dest.push_back(' ');
+	}
+	append_commands(comment, dest);
+	if (text && !(comment.kind & TEXT_FIRST)) {
+		if (commands)
+			dest.push_back(' ');
+		dest.insert(dest.end(), comment.text.begin(), comment.text.end());
+	}
+}
+
+/// Splits a comment into the [%clk] and [%eval] commands and the text.
+inline Comment parse(std::string_view str) {
+	Comment res;
+	auto try_split = [&](std::string_view commands, std::string_view text,
+	                     bool text_first) {
+		Comment tmp;
+		if (!parse_commands(commands, tmp))
+			return false;
+
+		if (!text.empty()) {
+			tmp.kind |= HAS_TEXT;
+			if (text_first)
+				tmp.kind |= TEXT_FIRST;
+			tmp.text = text;
+		}
+		std::string check;
+		unparse(tmp, check);
+		if (check != str)
+			return false;
+
+		res = tmp;
+		return true;
+	};
+
+	if (str.substr(0, 2) == "[%") {
+		// Commands followed by text
+		size_t pos = 0;
+		for (;;) {
+			const auto end = str.find(']', pos);
+			if (end == std::string_view::npos)
+				break;
+
+			pos = end + 1;
+			if (pos == str.size()) {
+				if (try_split(str, {}, false))
+					return res;
+				break;
+			}
+			if (str[pos] != ' ')
+				break;
+
+			if (str.substr(pos + 1, 2) != "[%") {
+				if (try_split(str.substr(0, pos), str.substr(pos + 1), false))
+					return res;
+				break;
+			}
+		}
+	} else {
+		// Text followed by commands
+		auto pos = str.find(" [%");
+		if (pos != std::string_view::npos &&
+		    try_split(str.substr(pos + 1), str.substr(0, pos), true))
+			return res;
+	}
+
+	if (!str.empty()) {
+		res.kind = HAS_TEXT;
+		res.text = str;
+	}
+	return res;
+}
+
+} // namespace detail
+
+/// Converts a sequence of null-terminated comments into the packed format.
+/// @param begin: the first byte of the comments section.
+/// @param end:   one past the last byte of the comments section.
+/// @param dest:  the container where the packed data will be appended.
+/// @returns false if the data is not a valid comments section.
+template <typename DestT>
+bool pack(const unsigned char* begin, const unsigned char* end, DestT& dest) {
+	using namespace detail;
+
+	std::vector<Comment> comments;
+	for (auto it = begin; it != end;) {
+		auto next = std::find(it, end, 0);
+		if (next == end)
+			return false;
+
+		comments.push_back(parse(
+		    {reinterpret_cast<const char*>(it), static_cast<size_t>(next - it)}));
+		it = next + 1;
+	}
+
+	write_varint(comments.size(), dest);
+	for (auto const& comment : comments) {
+		dest.push_back(comment.kind);
+	}
+	int64_t prevClk[2] = {0, 0};
+	for (auto const& comment : comments) {
+		if (comment.kind & HAS_CLK) {
+			write_varint(zigzag(comment.clk - prevClk[0]), dest);
+			prevClk[0] = prevClk[1];
+			prevClk[1] = comment.clk;
+		}
+	}
+	for (auto const& comment : comments) {
+		if (comment.kind & HAS_EVAL)
+			write_varint((zigzag(comment.eval) << 3) | comment.evalFmt, dest);
+	}
+	for (auto const& comment : comments) {
+		if (comment.kind & HAS_TEXT) {
+			dest.insert(dest.end(), comment.text.begin(), comment.text.end());
+			dest.push_back(0);
+		}
+	}
+	return true;
+}
+
+/// Converts packed comments back into a sequence of null-terminated strings.
+/// @param begin: the first byte of the packed data.
+/// @param end:   one past the last byte of the packed data.
+/// @param dest:  the container where the comments will be appended.
+/// @returns false if the packed data is corrupted.
+template <typename DestT>
+bool unpack(const unsigned char* begin, const unsigned char* end,
+            DestT& dest) {
+	using namespace detail;
+
+	uint64_t n;
+	auto it = begin;
+	if (!read_varint(it, end, n) || n > static_cast<size_t>(end - it))
+		return false;
+
+	const auto kinds = it;
+	it += n;
+
+	// Find the start of the columns
+	auto clocks = it;
+	for (uint64_t i = 0, val; i < n; ++i) {
+		if ((kinds[i] & HAS_CLK) && !read_varint(it, end, val))
+			return false;
+	}
+	auto evals = it;
+	for (uint64_t i = 0, val; i < n; ++i) {
+		if ((kinds[i] & HAS_EVAL) && !read_varint(it, end, val))
+			return false;
+	}
+	auto texts = it;
+
+	int64_t prevClk[2] = {0, 0};
+	for (uint64_t i = 0; i < n; ++i) {
+		Comment comment;
+		comment.kind = kinds[i];
+		uint64_t val;
+		if (comment.kind & HAS_CLK) {
+			read_varint(clocks, end, val);
+			comment.clk = prevClk[0] + unzigzag(val);
+			prevClk[0] = prevClk[1];
+			prevClk[1] = comment.clk;
+			if (comment.clk < 0)
+				return false;
+		}
+		if (comment.kind & HAS_EVAL) {
+			read_varint(evals, end, val);
+			comment.evalFmt = val & 7;
+			comment.eval = unzigzag(val >> 3);
+			if (comment.evalFmt > EVAL_MATE)
+				return false;
+		}
+		if (comment.kind & HAS_TEXT) {
+			auto text_end = std::find(texts, end, 0);
+			if (text_end == end)
+				return false;
+			comment.text = {reinterpret_cast<const char*>(texts),
+			                static_cast<size_t>(text_end - texts)};
+			texts = text_end + 1;
+		}
+		unparse(comment, dest);
+		dest.push_back(0);
+	}
+	return texts == end;
+}
+
+} // namespace commentpack
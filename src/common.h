@@ -68,6 +68,18 @@ typedef char            ecoStringT [6];   /* "A00j1" */
 
 const ecoT ECO_None = 0;
 
+// Name types:
+
+using nameT = unsigned;
+enum {
+    NAME_PLAYER,
+    NAME_EVENT,
+    NAME_SITE,
+    NAME_ROUND,
+    NUM_NAME_TYPES,
+    NAME_INVALID = 99
+};
+
 // Rating types:
 
 const byte RATING_Elo = 0;
@@ -25,76 +25,143 @@
 
 /**
  * A container useful for implementing a undo-redo behavior.
- * @e UNDOMAX: max number of copies to store.
+ * The elements are not copied: their state is saved into a compact sequence of
+ * bytes by TElem::saveState(std::vector<unsigned char>&) and restored by
+ * TElem::restoreState(const unsigned char*, size_t), which returns 0 on
+ * success. Only the last state of each queue is stored entirely; the others
+ * store just the bytes that differ from the following state, so that the
+ * memory used is proportional to the size of the changes.
+ * @e UNDOMAX: max number of states to store.
  * Typical use:
  * store(obj_ptr); // (1)
  * modify obj;
- * obj_ptr = undo(obj_ptr); // obj_ptr now contains the copy of (1)
+ * undo(obj_ptr); // obj_ptr now contains the state of (1)
  */
 template <class TElem, size_t UNDOMAX> class UndoRedo {
-	std::vector<TElem*> undo_;
-	std::vector<TElem*> redo_;
+	class StateStack {
+		// The bytes of an older state: the first @e prefix and the last
+		// @e suffix bytes are equal to the following state.
+		struct Delta {
+			size_t prefix;
+			size_t suffix;
+			std::vector<unsigned char> bytes;
+		};
+		std::vector<Delta> deltas_;
+		std::vector<unsigned char> last_;
+		bool empty_ = true;
+
+	public:
+		size_t size() const { return empty_ ? 0 : deltas_.size() + 1; }
+
+		void clear() {
+			deltas_.clear();
+			last_.clear();
+			empty_ = true;
+		}
+
+		void push(std::vector<unsigned char>&& state) {
+			if (!empty_) {
+				const auto prefix = static_cast<size_t>(
+				    std::mismatch(last_.begin(), last_.end(), state.begin(),
+				                  state.end())
+				        .first -
+				    last_.begin());
+				const auto maxSuffix = std::min(last_.size(), state.size()) -
+				                       prefix;
+				const auto suffix = static_cast<size_t>(
+				    std::mismatch(last_.rbegin(), last_.rbegin() + maxSuffix,
+				                  state.rbegin())
+				        .first -
+				    last_.rbegin());
+				deltas_.push_back(
+				    {prefix, suffix,
+				     {last_.begin() + prefix, last_.end() - suffix}});
+				if (deltas_.size() >= UNDOMAX)
+					deltas_.erase(deltas_.begin());
+			}
+			last_ = std::move(state);
+			empty_ = false;
+		}
+
+		std::vector<unsigned char> pop() {
+			assert(!empty_);
+			auto res = std::move(last_);
+			if (deltas_.empty()) {
+				clear();
+				return res;
+			}
+			auto const& delta = deltas_.back();
+			last_.assign(res.begin(), res.begin() + delta.prefix);
+			last_.insert(last_.end(), delta.bytes.begin(), delta.bytes.end());
+			last_.insert(last_.end(), res.end() - delta.suffix, res.end());
+			deltas_.pop_back();
+			return res;
+		}
+	};
+	StateStack undo_;
+	StateStack redo_;
 
 public:
-	~UndoRedo() { clear(); }
 	void clear() {
-		clear(undo_);
-		clear(redo_);
+		undo_.clear();
+		redo_.clear();
 	}
 	size_t undoSize() const { return undo_.size(); }
 	size_t redoSize() const { return redo_.size(); }
 
 	/**
-	 * Stores a copy of an element into the undo queue.
-	 * Deletes all the objects of the redo queue.
-	 * @param current: the element to clone and store.
+	 * Stores the state of an element into the undo queue.
+	 * Clears the redo queue.
+	 * @param current: the element whose state is stored.
 	 */
 	void store(TElem* current) {
-		clear(redo_);
-		undo_.push_back(current->clone());
-		if (undo_.size() > UNDOMAX) {
-			delete undo_.front();
-			undo_.erase(undo_.begin());
-		}
+		redo_.clear();
+		undo_.push(saveState(current));
 	}
 
 	/**
-	 * Retrieve the last element from the undo queue.
-	 * @param current: pointer to the current element; it will be stored into
-	 *                 the redo queue.
-	 * @returns the pointer to the last element of the undo queue (the pointer
-	 * will be removed from the queue). If the queue is empty returns @e current
+	 * Restores the last state of the undo queue (the state will be removed
+	 * from the queue).
+	 * @param current: pointer to the current element; its state will be
+	 *                 stored into the redo queue.
+	 * @returns 0 on success, or the error returned by TElem::restoreState():
+	 * in that case the state is discarded and @e current is not modified.
 	 */
-	TElem* undo(TElem* current) { return doUndoRedo(undo_, redo_, current); }
+	auto undo(TElem* current) { return doUndoRedo(undo_, redo_, current); }
 
 	/**
-	 * Retrieve the last element from the redo queue.
-	 * @param current: pointer to the current element; it will be stored into
-	 *                 the undo queue.
-	 * @returns the pointer to the last element of the redo queue (the pointer
-	 * will be removed from the queue). If the queue is empty returns @e current
+	 * Restores the last state of the redo queue (the state will be removed
+	 * from the queue).
+	 * @param current: pointer to the current element; its state will be
+	 *                 stored into the undo queue.
+	 * @returns 0 on success, or the error returned by TElem::restoreState():
+	 * in that case the state is discarded and @e current is not modified.
 	 */
-	TElem* redo(TElem* current) { return doUndoRedo(redo_, undo_, current); }
+	auto redo(TElem* current) { return doUndoRedo(redo_, undo_, current); }
 
 private:
-	// Store current into cont2; remove and return the last element of cont1
-	template <typename TCont>
-	TElem* doUndoRedo(TCont& cont1, TCont& cont2, TElem* current) {
-		if (cont1.empty())
-			return current;
-
-		if (cont2.empty() || cont2.back() != current)
-			cont2.push_back(current);
-
-		auto res = cont1.back();
-		cont1.pop_back();
+	static std::vector<unsigned char> saveState(TElem* current) {
+		std::vector<unsigned char> res;
+		current->saveState(res);
 		return res;
 	}
 
-	template <typename TCont> void clear(TCont& cont) {
-		for (auto& e : cont)
-			delete e;
-		cont.clear();
+	// Store current into cont2; restore current from the last state of cont1
+	auto doUndoRedo(StateStack& cont1, StateStack& cont2, TElem* current)
+	    -> decltype(current->restoreState(nullptr, 0)) {
+		if (cont1.size() == 0)
+			return {};
+
+		cont2.push(saveState(current));
+		const auto state = cont1.pop();
+		const auto err = current->restoreState(state.data(), state.size());
+		if (err) {
+			const auto prev = cont2.pop();
+			[[maybe_unused]] const auto errPrev =
+			    current->restoreState(prev.data(), prev.size());
+			assert(!errPrev);
+		}
+		return err;
 	}
 };
 
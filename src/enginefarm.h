@@ -0,0 +1,572 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the UCIAnalyzer and EngineFarm classes, which annotate the
+ * games of a database with a pool of chess engines.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "game.h"
+#include "hfilter.h"
+#include "misc.h"
+#include "movelist.h"
+#include "position.h"
+#include "scidbase.h"
+#include "uciengine.h"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// The evaluation of a position, from the point of view of the side to move.
+struct EngineEval {
+	enum { NONE, CP, MATE } type = NONE;
+	int value = 0;  // centipawns or moves to mate (0 if checkmated)
+	std::string pv; // the best line in coordinate notation
+
+	/// Returns the value in pawns from the point of view of white; the mates
+	/// are +/-327.67, like the UCI scores of the other annotation functions.
+	double whitePawns(bool whiteToMove) const {
+		const double res = (type == MATE) ? (value > 0 ? 327.67 : -327.67)
+		                                  : value / 100.0;
+		return whiteToMove ? res : -res;
+	}
+
+	/// Returns the value of a PGN [%eval] command (from white's point of view).
+	std::string toPgnEval(bool whiteToMove) const {
+		const int val = whiteToMove ? value : -value;
+		if (type == MATE)
+			return "#" + std::to_string(val);
+
+		char buf[32];
+		std::snprintf(buf, sizeof buf, "%.2f", val / 100.0);
+		return buf;
+	}
+};
+
+/// The parameters of the analysis.
+struct AnnotateOptions {
+	std::string go = "go nodes 200000"; // the same for every position
+	std::vector<std::string> setoption; // "name X value Y"
+	double blunder = 1.0; // the loss (in pawns) that makes a move an error
+	// Appended to the Annotator tag of the annotated games. The games whose
+	// Annotator tag already contains it are skipped, so that an interrupted
+	// run can be resumed; if empty, every game is annotated.
+	std::string annotator = "Scid annotate";
+};
+
+/// Returns true if the Annotator tag of @e game contains @e opt.annotator.
+inline bool isAnnotated(Game const& game, AnnotateOptions const& opt) {
+	const char* tag = game.FindExtraTag("Annotator");
+	return !opt.annotator.empty() && tag &&
+	       std::string_view(tag).find(opt.annotator) != std::string_view::npos;
+}
+
+/**
+ * Adds to the main line of a game the results of the analysis:
+ * - an [%eval] command at the start of the comment of each move; existing
+ *   [%eval] commands are replaced.
+ * - a NAG (?!, ? or ??) to the moves that lose more than @e opt.blunder pawns,
+ *   unless the position was already lost, and a variation with the best line.
+ * - @e opt.annotator to the Annotator tag.
+ * The thresholds of the NAGs are the defaults of the Tcl annotation.
+ * @param game:  the game, whose location will be at the start.
+ * @param evals: the evaluations of the positions of the main line, starting
+ *               from the initial position.
+ */
+inline void annotateGame(Game& game, std::vector<EngineEval> const& evals,
+                         AnnotateOptions const& opt) {
+	game.MoveToStart();
+	for (size_t i = 1; i < evals.size(); ++i) {
+		char played[16];
+		game.GetNextMoveUCI(played);
+		Position before = *game.currentPos();
+		const bool moverWhite = before.WhiteToMove();
+		if (game.MoveForward() != OK)
+			break;
+
+		auto const& prev = evals[i - 1];
+		auto const& eval = evals[i];
+		if (eval.type == EngineEval::NONE ||
+		    (eval.type == EngineEval::MATE && eval.value == 0))
+			continue;
+
+		std::string& comment = game.accessMoveComment();
+		const auto cmd = "[%eval " + eval.toPgnEval(!moverWhite) + "]";
+		const auto pos = comment.find("[%eval ");
+		const auto end = comment.find(']', pos);
+		if (pos != comment.npos && end != comment.npos) {
+			comment.replace(pos, end + 1 - pos, cmd);
+		} else {
+			comment.insert(0, comment.empty() ? cmd : cmd + ' ');
+		}
+
+		if (prev.type == EngineEval::NONE ||
+		    std::string_view(prev.pv).substr(0, prev.pv.find(' ')) == played)
+			continue;
+
+		const double before_pawns = prev.whitePawns(moverWhite);
+		const double after_pawns = eval.whitePawns(!moverWhite);
+		const double loss = moverWhite ? before_pawns - after_pawns
+		                               : after_pawns - before_pawns;
+		const bool lost = moverWhite ? before_pawns < -5.5 : before_pawns > 5.5;
+		if (loss <= opt.blunder || lost)
+			continue;
+
+		game.AddNag(loss > 3.0   ? NAG_Blunder
+		            : loss > 1.5 ? NAG_PoorMove
+		                         : NAG_DubiousMove);
+
+		// The legal moves of the best line
+		std::vector<simpleMoveT> line;
+		playCoordMoves(before, prev.pv, [&](auto&, auto const& sm, bool) {
+			line.push_back(sm);
+		});
+		if (line.empty() || game.AddVariation() != OK)
+			continue;
+
+		for (auto const& sm : line) {
+			if (game.AddMove(sm) != OK)
+				break;
+			if (&sm == &line.front() && prev.type != EngineEval::MATE)
+				game.SetMoveComment(
+				    ("[%eval " + prev.toPgnEval(moverWhite) + "]").c_str());
+		}
+		game.MoveExitVariation();
+		game.MoveForward();
+	}
+	game.MoveToStart();
+
+	if (!opt.annotator.empty() && !isAnnotated(game, opt)) {
+		const char* tag = game.FindExtraTag("Annotator");
+		if (tag && *tag)
+			game.assignTagValue("Annotator", std::string(tag) + ", " +
+			                                     opt.annotator);
+		else
+			game.assignTagValue("Annotator", opt.annotator);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// A UCI engine that analyzes one position at a time.
+// -----------------------------------------------------------------------------
+class UCIAnalyzer {
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	std::deque<std::string> lines_;
+	bool eof_ = false;
+	EngineProcess process_; // Must be the last: the reader uses the lines
+
+public:
+	~UCIAnalyzer() { close(); }
+
+	/// Starts the engine, waits for "uciok", sets the options and waits for
+	/// "readyok".
+	/// @returns OK, ERROR_FileOpen if the engine cannot be started or
+	/// ERROR_FileRead if the engine does not reply (within 10 seconds).
+	errorT open(std::vector<std::string> const& args,
+	            std::vector<std::string> const& setoption) {
+		auto err = process_.open(
+		    args,
+		    [this](std::string_view line) {
+			    std::lock_guard lock(mtx_);
+			    lines_.emplace_back(line);
+			    cond_.notify_one();
+		    },
+		    [this]() {
+			    std::lock_guard lock(mtx_);
+			    eof_ = true;
+			    cond_.notify_one();
+		    });
+		if (err != OK)
+			return err;
+
+		constexpr auto timeout = std::chrono::seconds(10);
+		if (!process_.write("uci") || !waitFor("uciok", timeout))
+			return ERROR_FileRead;
+
+		for (auto const& option : setoption) {
+			if (!process_.write("setoption " + option))
+				return ERROR_FileWrite;
+		}
+		return newGame();
+	}
+
+	/// Tells the engine that the next positions are from a different game.
+	errorT newGame() {
+		constexpr auto timeout = std::chrono::seconds(10);
+		if (!process_.write("ucinewgame") || !process_.write("isready"))
+			return ERROR_FileWrite;
+
+		return waitFor("readyok", timeout) ? OK : ERROR_FileRead;
+	}
+
+	/// Analyzes a position and waits for the "bestmove" reply.
+	/// @param position: the UCI "position" command.
+	/// @param go:       the UCI "go" command.
+	/// @param stop:     if it becomes true, the search is stopped.
+	/// @param res:      the last evaluation of multipv 1 (with an exact score).
+	errorT analyze(std::string_view position, std::string_view go,
+	               std::atomic<bool> const& stop, EngineEval& res) {
+		res = EngineEval();
+		if (!process_.write(position) || !process_.write(go))
+			return ERROR_FileWrite;
+
+		bool stopSent = false;
+		std::string line;
+		for (;;) {
+			if (!readLine(line, std::chrono::milliseconds(100))) {
+				if (closed())
+					return ERROR_FileRead;
+
+				if (stop && !stopSent) {
+					stopSent = true;
+					if (!process_.write("stop"))
+						return ERROR_FileWrite;
+				}
+				continue;
+			}
+			if (line.compare(0, 9, "bestmove ") == 0) {
+				if (res.pv.empty()) {
+					std::string_view move = line;
+					move.remove_prefix(9);
+					res.pv = move.substr(0, move.find(' '));
+				}
+				return OK;
+			}
+			UCIInfoPV info;
+			if (!info.parse(line) || info.multipv != "1")
+				continue;
+
+			const auto type = info.score_type == "cp"     ? EngineEval::CP
+			                  : info.score_type == "mate" ? EngineEval::MATE
+			                                              : EngineEval::NONE;
+			if (type == EngineEval::NONE || info.score.empty())
+				continue;
+
+			int value = 0;
+			const auto score = info.score.substr(info.score[0] == '+');
+			if (std::from_chars(score.data(), score.data() + score.size(), value)
+			        .ec != std::errc())
+				continue;
+
+			res.type = type;
+			res.value = value;
+			res.pv = info.pv;
+		}
+	}
+
+	/// Sends "quit" and waits for the engine to terminate.
+	void close() {
+		if (process_.isOpen()) {
+			process_.write("quit");
+			process_.close();
+		}
+	}
+
+private:
+	/// Returns true if the engine closed its output and all the lines were read.
+	bool closed() {
+		std::lock_guard lock(mtx_);
+		return eof_ && lines_.empty();
+	}
+
+	/// Waits for the next line.
+	/// @returns false if there are no lines after @e timeout or at EOF.
+	template <typename TDuration>
+	bool readLine(std::string& line, TDuration timeout) {
+		std::unique_lock lock(mtx_);
+		if (!cond_.wait_for(lock, timeout,
+		                    [&] { return !lines_.empty() || eof_; }) ||
+		    lines_.empty())
+			return false;
+
+		line = std::move(lines_.front());
+		lines_.pop_front();
+		return true;
+	}
+
+	/// Discards the lines until @e reply.
+	template <typename TDuration>
+	bool waitFor(std::string_view reply, TDuration timeout) {
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		std::string line;
+		while (readLine(line, deadline - std::chrono::steady_clock::now())) {
+			if (line == reply)
+				return true;
+		}
+		return false;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Annotates the games of a database with multiple engine processes.
+// -----------------------------------------------------------------------------
+//
+// The main thread decodes the games and puts the positions of their main
+// lines into a work queue. Each engine has a thread that analyzes the
+// positions with the same "go" command: the consecutive positions of a game
+// are assigned to the same engine (which can reuse its hash table) and when
+// there are no more new games the idle engines take the last positions of the
+// games in progress.
+// The annotated games are replaced as soon as all their positions have been
+// analyzed, in a single database transaction.
+// The games already annotated with the same AnnotateOptions::annotator are
+// skipped: an interrupted run can be resumed by running it again.
+class EngineFarm {
+	struct GameJob {
+		uint64_t id;
+		gamenumT gnum;
+		std::unique_ptr<Game> game;
+		std::vector<std::string> positions; // empty if there are no moves
+		std::vector<EngineEval> evals;
+		size_t next = 0;   // the first position not yet assigned
+		size_t end = 0;    // one past the last position not yet assigned
+		// The number of assigned positions whose engine has finished: when it
+		// is equal to evals.size() no worker refers to the job.
+		size_t nDone = 0;
+		bool owned = false; // assigned to an engine
+	};
+
+	AnnotateOptions const& opt_;
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	std::list<GameJob> jobs_;
+	std::atomic<bool> stop_ = false;
+	errorT error_ = OK;
+	std::vector<std::unique_ptr<UCIAnalyzer>> engines_;
+	std::vector<std::thread> workers_;
+
+public:
+	explicit EngineFarm(AnnotateOptions const& opt) : opt_(opt) {}
+	EngineFarm(EngineFarm const&) = delete;
+	EngineFarm& operator=(EngineFarm const&) = delete;
+	~EngineFarm() { stopWorkers(); }
+
+	/// Starts the engines.
+	/// @param args:     the executable of the engine and its arguments.
+	/// @param nEngines: the number of engine processes.
+	errorT open(std::vector<std::string> const& args, unsigned nEngines) {
+		for (unsigned i = 0; i < nEngines; ++i) {
+			auto engine = std::make_unique<UCIAnalyzer>();
+			if (auto err = engine->open(args, opt_.setoption))
+				return err;
+
+			engines_.push_back(std::move(engine));
+		}
+		return OK;
+	}
+
+	/// Annotates the games included in @e hfilter (see annotateGame()).
+	/// @returns a std::pair containing OK (or an error code) and the number of
+	/// games annotated.
+	std::pair<errorT, size_t>
+	annotate(scidBaseT& dbase, HFilter hfilter, const Progress& progress) {
+		if (engines_.empty())
+			return {ERROR_BadArg, 0};
+
+		for (auto& engine : engines_) {
+			workers_.emplace_back([&] { work(*engine); });
+		}
+
+		const size_t maxJobs = engines_.size() * 2;
+		auto it = hfilter.begin();
+		const auto itEnd = hfilter.end();
+		const size_t total = hfilter->size();
+		size_t nLoaded = 0;
+		uint64_t nextId = 0;
+		bool cancelled = false;
+		std::unique_ptr<Game> current;
+		auto res = dbase.replaceGames([&](gamenumT& gnum) -> Game* {
+			std::unique_lock lock(mtx_);
+			for (;;) {
+				if (stop_)
+					return nullptr;
+
+				auto done = std::find_if(jobs_.begin(), jobs_.end(), [](auto& job) {
+					return job.nDone == job.evals.size();
+				});
+				if (done != jobs_.end()) {
+					std::list<GameJob> job;
+					job.splice(job.begin(), jobs_, done);
+					lock.unlock();
+					gnum = job.front().gnum;
+					current = std::move(job.front().game);
+					annotateGame(*current, job.front().evals, opt_);
+					return current.get();
+				}
+				if (jobs_.size() < maxJobs && it != itEnd) {
+					lock.unlock();
+					auto job = makeJob(dbase, *it);
+					++it;
+					++nLoaded;
+					lock.lock();
+					if (job.game) {
+						job.id = nextId++;
+						jobs_.push_back(std::move(job));
+						cond_.notify_all();
+					}
+					continue;
+				}
+				if (jobs_.empty())
+					return nullptr;
+
+				cond_.wait_for(lock, std::chrono::milliseconds(100));
+				const size_t nDone = nLoaded - jobs_.size();
+				lock.unlock();
+				if (!progress.report(nDone, total)) {
+					cancelled = true;
+					return nullptr;
+				}
+				lock.lock();
+			}
+		});
+		stopWorkers();
+		if (res.first == OK)
+			res.first = error_ ? error_ : cancelled ? ERROR_UserCancel : OK;
+		return res;
+	}
+
+private:
+	/// Decodes a game and creates the list of positions to be analyzed.
+	/// The returned job has a null game if the game should be skipped.
+	GameJob makeJob(scidBaseT const& dbase, gamenumT gnum) const {
+		GameJob job;
+		job.gnum = gnum;
+		auto game = std::make_unique<Game>();
+		if (dbase.getGame(*dbase.getIndexEntry(gnum), *game) != OK ||
+		    isAnnotated(*game, opt_))
+			return job;
+
+		game->MoveToStart();
+		for (;;) {
+			job.positions.emplace_back(game->currentPosUCI());
+			auto& eval = job.evals.emplace_back();
+			Position pos = *game->currentPos();
+			MoveList moves;
+			pos.GenerateMoves(&moves);
+			if (moves.Size() == 0) {
+				job.positions.back().clear();
+				eval.type = pos.CalcNumChecks() ? EngineEval::MATE
+				                                : EngineEval::CP;
+			}
+			if (game->MoveForward() != OK)
+				break;
+		}
+		if (job.evals.size() < 2)
+			return job;
+
+		job.end = job.positions.size();
+		job.game = std::move(game);
+		return job;
+	}
+
+	/// Assigns a position to an engine.
+	/// @param lastId: the id of the game previously analyzed by the engine.
+	/// @returns the game and the index of the position, or a null game.
+	std::pair<GameJob*, size_t> assign(uint64_t lastId) {
+		GameJob* steal = nullptr;
+		for (auto& job : jobs_) {
+			if (job.next == job.end)
+				continue;
+			if (job.id == lastId || !job.owned) {
+				job.owned = true;
+				return {&job, job.next++};
+			}
+			if (!steal || job.end - job.next > steal->end - steal->next)
+				steal = &job;
+		}
+		if (steal)
+			return {steal, --steal->end};
+		return {nullptr, 0};
+	}
+
+	void work(UCIAnalyzer& engine) {
+		uint64_t lastId = UINT64_MAX;
+		std::unique_lock lock(mtx_);
+		for (;;) {
+			std::pair<GameJob*, size_t> task;
+			cond_.wait(lock, [&] {
+				return stop_ || (task = assign(lastId)).first != nullptr;
+			});
+			if (stop_)
+				return;
+
+			auto [job, ply] = task;
+			std::string_view position = job->positions[ply];
+			const bool newGame = job->id != lastId;
+			lastId = job->id;
+			lock.unlock();
+
+			EngineEval eval;
+			errorT err = OK;
+			if (!position.empty()) {
+				if (newGame)
+					err = engine.newGame();
+				if (err == OK)
+					err = engine.analyze(position, opt_.go, stop_, eval);
+			}
+
+			lock.lock();
+			if (err != OK) {
+				if (!stop_)
+					error_ = err;
+				stop_ = true;
+				cond_.notify_all();
+				return;
+			}
+			if (!position.empty())
+				job->evals[ply] = std::move(eval);
+
+			// The positions without moves are counted here too: the job can
+			// be destroyed as soon as the last one is counted.
+			if (++job->nDone == job->evals.size())
+				cond_.notify_all();
+		}
+	}
+
+	void stopWorkers() {
+		{
+			std::lock_guard lock(mtx_);
+			stop_ = true;
+		}
+		cond_.notify_all();
+		for (auto& th : workers_) {
+			th.join();
+		}
+		workers_.clear();
+		engines_.clear();
+	}
+};
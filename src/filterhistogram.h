@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/** @file
+ * Implements a single-pass histogram of the games of a filter.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "hfilter.h"
+#include "parallel.h"
+#include "scidbase.h"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/// The games with a value inside the range of a bucket.
+struct HistogramBucket {
+	uint64_t all = 0;      // The games of the database.
+	uint64_t filtered = 0; // The games included in the filter.
+	uint64_t results[NUM_RESULT_TYPES] = {}; // The results of the filtered
+	                                         // games.
+
+	HistogramBucket& operator+=(HistogramBucket const& other) {
+		all += other.all;
+		filtered += other.filtered;
+		for (uint i = 0; i < NUM_RESULT_TYPES; ++i) {
+			results[i] += other.results[i];
+		}
+		return *this;
+	}
+};
+
+/**
+ * Counts the games whose value is inside each of the @e ranges, with a single
+ * multi-threaded pass over all the games of the database.
+ * @param base:   the database.
+ * @param filter: the filter whose games are counted in
+ *                HistogramBucket::filtered and HistogramBucket::results.
+ * @param ranges: the inclusive ranges [first, second] of the buckets. They can
+ *                overlap, but sorted and disjoint ranges are faster.
+ * @param value:  function invoked concurrently with the parameter (gamenumT)
+ *                which must return the uint32_t value of a game.
+ * @returns a bucket for each range.
+ */
+template <typename TValue>
+std::vector<HistogramBucket>
+filterHistogram(scidBaseT const& base, HFilter const& filter,
+                std::vector<std::pair<uint32_t, uint32_t>> const& ranges,
+                TValue value) {
+	const auto nRanges = ranges.size();
+	bool disjoint = true;
+	for (size_t i = 0; i < nRanges; ++i) {
+		if (ranges[i].first > ranges[i].second ||
+		    (i > 0 && ranges[i - 1].second >= ranges[i].first))
+			disjoint = false;
+	}
+
+	std::vector<HistogramBucket> res(nRanges);
+	std::mutex mutex;
+	const uint32_t* gameResults =
+	    base.getIndexColumn(Index::COL_RESULT).data();
+	parallelFor(base.numGames(), 1 << 16, [&](size_t begin, size_t end) {
+		std::vector<HistogramBucket> buckets(nRanges);
+		auto count = [&](size_t idx, gamenumT gnum) {
+			auto& bucket = buckets[idx];
+			++bucket.all;
+			if (filter.get(gnum) != 0) {
+				++bucket.filtered;
+				++bucket.results[gameResults[gnum]];
+			}
+		};
+		for (auto gnum = static_cast<gamenumT>(begin); gnum < end; ++gnum) {
+			const uint32_t v = value(gnum);
+			if (disjoint) {
+				auto it = std::partition_point(
+				    ranges.begin(), ranges.end(),
+				    [&](auto const& range) { return range.second < v; });
+				if (it != ranges.end() && it->first <= v)
+					count(it - ranges.begin(), gnum);
+			} else {
+				for (size_t i = 0; i < nRanges; ++i) {
+					if (v >= ranges[i].first && v <= ranges[i].second)
+						count(i, gnum);
+				}
+			}
+		}
+		std::lock_guard lock(mutex);
+		for (size_t i = 0; i < nRanges; ++i) {
+			res[i] += buckets[i];
+		}
+	});
+	return res;
+}
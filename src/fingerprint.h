@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the GameFingerprints class.
+ */
+
+#pragma once
+
+#include "bytebuf.h"
+#include "common.h"
+#include "game.h"
+#include "indexentry.h"
+#include "matsig.h"
+#include "sidecar.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Fingerprints of the positions reached in the main line of the games.
+// -----------------------------------------------------------------------------
+//
+// The IndexEntry stores only the final material and the home pawns changes of
+// a game, and position and material searches must decode most of the games.
+// A fingerprint is a compact summary of all the positions of the main line:
+// - the set of the distinct pawn structures (lower 16 bits of the pawn hash)
+// - the set of the distinct material signatures (matSigT).
+// A game that does not contain the pawn structure or the material of the
+// searched position cannot match and does not need to be decoded.
+// The sets are sorted and delta-encoded as varints:
+//   varint: number of pawn hashes
+//   varint: first pawn hash, followed by the difference from the previous one
+//   varint: number of matsigs
+//   varint: first matsig, followed by the difference from the previous one
+//
+// The fingerprints are stored in an optional sidecar file (see sidecar.h)
+// with extension .sfp and magic "SCIDFP01": the payload of a record is the
+// fingerprint of the game.
+class GameFingerprints {
+	struct Entry {
+		uint64_t gameOffset = 0;
+		uint32_t gameLength = 0; // 0 = no fingerprint
+		uint32_t begin = 0;      // offset of the fingerprint in data_
+	};
+	std::vector<Entry> entries_;
+	std::vector<byte> data_;
+
+	static constexpr char MAGIC[8] = {'S', 'C', 'I', 'D', 'F', 'P', '0', '1'};
+
+public:
+	void clear() {
+		entries_.clear();
+		data_.clear();
+	}
+
+	/// Returns the fingerprint of a game, or nullptr if it is not available.
+	const byte* find(gamenumT gnum, IndexEntry const& ie) const {
+		if (gnum >= entries_.size())
+			return nullptr;
+
+		auto const& entry = entries_[gnum];
+		if (entry.gameLength == 0 || entry.gameLength != ie.GetLength() ||
+		    entry.gameOffset != ie.GetOffset())
+			return nullptr;
+
+		return data_.data() + entry.begin;
+	}
+
+	/// Returns true if the fingerprint contains the pawn hash @e pawnHash.
+	static bool hasPawnHash(const byte* fp, uint32_t pawnHash) {
+		const auto target = pawnHash & 0xFFFF;
+		uint64_t val = 0;
+		for (auto n = read_varint(fp); n > 0; --n) {
+			val += read_varint(fp);
+			if (val >= target)
+				return val == target;
+		}
+		return false;
+	}
+
+	/// Returns true if @e pred returns true for at least one of the material
+	/// signatures in the fingerprint.
+	template <typename TPred>
+	static bool anyMatSig(const byte* fp, TPred pred) {
+		for (auto n = read_varint(fp); n > 0; --n) {
+			read_varint(fp);
+		}
+		uint64_t val = 0;
+		for (auto n = read_varint(fp); n > 0; --n) {
+			val += read_varint(fp);
+			if (pred(static_cast<matSigT>(val)))
+				return true;
+		}
+		return false;
+	}
+
+	/// Returns true if the fingerprint contains the material signature @e msig.
+	static bool hasMatSig(const byte* fp, matSigT msig) {
+		return anyMatSig(fp, [&](matSigT val) { return val == msig; });
+	}
+
+	/// Decodes the main line of a game and appends its fingerprint to @e dest.
+	/// @param game: a Game object used to decode the moves.
+	/// @param data: the data of the game (encoded in native format).
+	static errorT make(Game& game, ByteBuffer data, std::vector<byte>& dest) {
+		if (auto err = game.DecodeSkipTags(&data))
+			return err;
+
+		std::vector<uint32_t> pawns;
+		std::vector<uint32_t> material;
+		errorT err = OK;
+		Position* pos = game.GetCurrentPos();
+		while (err == OK) {
+			pawns.push_back(pos->PawnHashValue() & 0xFFFF);
+			material.push_back(matsig_Make(pos->GetMaterial()));
+
+			simpleMoveT sm;
+			err = game.DecodeNextMove(&data, sm);
+			if (err == OK)
+				pos->DoSimpleMove(sm);
+		}
+		if (err != ERROR_EndOfMoveList)
+			return err;
+
+		auto encode_set = [&dest](auto& vec) {
+			std::sort(vec.begin(), vec.end());
+			vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+			sidecar::writeVarint(dest, vec.size());
+			uint32_t prev = 0;
+			for (auto val : vec) {
+				sidecar::writeVarint(dest, val - prev);
+				prev = val;
+			}
+		};
+		encode_set(pawns);
+		encode_set(material);
+		return OK;
+	}
+
+	/// Stores the fingerprint of a game.
+	/// @param gnum: the game number.
+	/// @param ie:   the IndexEntry of the game.
+	/// @param fp:   the fingerprint created with make().
+	errorT set(gamenumT gnum, IndexEntry const& ie,
+	           std::vector<byte> const& fp) {
+		const auto begin = data_.size();
+		if (begin + fp.size() > std::numeric_limits<uint32_t>::max())
+			return ERROR_Full;
+
+		if (gnum >= entries_.size())
+			entries_.resize(gnum + 1);
+
+		data_.insert(data_.end(), fp.begin(), fp.end());
+		auto& entry = entries_[gnum];
+		entry.gameOffset = ie.GetOffset();
+		entry.gameLength = ie.GetLength();
+		entry.begin = static_cast<uint32_t>(begin);
+		return OK;
+	}
+
+	/// Encodes a sidecar file record.
+	static void encodeRecord(gamenumT gnum, IndexEntry const& ie,
+	                         std::vector<byte> const& fp,
+	                         std::vector<byte>& dest) {
+		sidecar::encodeRecordHeader(gnum, ie, dest);
+		dest.insert(dest.end(), fp.begin(), fp.end());
+	}
+
+	/// Returns the header of a new sidecar file.
+	static std::string_view fileHeader() { return {MAGIC, sizeof MAGIC}; }
+
+	/// Reads the sidecar file of a database with @e numGames games.
+	/// Returns OK, ERROR_FileOpen if the file does not exists or
+	/// ERROR_BadMagic/ERROR_Corrupt (all the fingerprints are discarded).
+	errorT load(std::string const& filename, gamenumT numGames) {
+		clear();
+		auto err = sidecar::load(
+		    filename, fileHeader(), numGames,
+		    [&](gamenumT gnum, uint64_t gameOffset, uint32_t gameLength,
+		        const byte*& it, const byte* end) {
+			    const byte* fp = it;
+			    for (int i = 0; i < 2; ++i) {
+				    uint64_t n;
+				    if (!sidecar::readVarint(it, end, n) ||
+				        n > static_cast<uint64_t>(end - it))
+					    return false;
+
+				    for (uint64_t val; n > 0; --n) {
+					    if (!sidecar::readVarint(it, end, val))
+						    return false;
+				    }
+			    }
+			    if (data_.size() + (it - fp) >
+			        std::numeric_limits<uint32_t>::max())
+				    return false;
+
+			    if (gnum >= entries_.size())
+				    entries_.resize(gnum + 1);
+
+			    auto& entry = entries_[gnum];
+			    entry.gameOffset = gameOffset;
+			    entry.gameLength = gameLength;
+			    entry.begin = static_cast<uint32_t>(data_.size());
+			    data_.insert(data_.end(), fp, it);
+			    return true;
+		    });
+		if (err)
+			clear();
+		return err;
+	}
+
+private:
+	static uint64_t read_varint(const byte*& src) {
+		uint64_t res = 0;
+		for (int shift = 0;; shift += 7) {
+			const byte val = *src++;
+			res |= static_cast<uint64_t>(val & 127) << shift;
+			if (val < 128)
+				return res;
+		}
+	}
+};
@@ -18,11 +18,13 @@
 #include "dstring.h"
 #include "naglatex.h"
 #include "nagtext.h"
+#include "pgn_encode.h"
 #include "position.h"
 #include "stored.h"
 #include "textbuf.h"
 #include <algorithm>
 #include <cstring>
+#include <utility>
 
 // Piece letters translation
 int language = 0; // default to english
@@ -419,16 +421,21 @@ errorT Game::RemoveNag (bool isMoveNag) {
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Move allocation:
 //      moves are allocated in chunks to save memory and for faster
-//      performance.
+//      performance. The chunks are not freed when the game is cleared:
+//      decoding many games into the same Game object does not allocate
+//      memory once the chunks (and the comments' strings) are big enough.
 //
 constexpr int MOVE_CHUNKSIZE = 128;
 
 moveT* Game::allocMove() {
 	if (moveChunkUsed_ == MOVE_CHUNKSIZE) {
-		moveChunks_.emplace_front(new moveT[MOVE_CHUNKSIZE]);
+		if (moveChunksInUse_ == moveChunks_.size())
+			moveChunks_.emplace_back(new moveT[MOVE_CHUNKSIZE]);
+
+		++moveChunksInUse_;
 		moveChunkUsed_ = 0;
 	}
-	return moveChunks_.front().get() + moveChunkUsed_++;
+	return moveChunks_[moveChunksInUse_ - 1].get() + moveChunkUsed_++;
 }
 
 moveT* Game::NewMove(markerT marker) {
@@ -476,10 +483,10 @@ void Game::strip(bool variations, bool comments, bool NAGs) {
     while (variations && MoveExitVariation() == OK) { // Go to main line
     }
 
-    for (auto& chunk : moveChunks_) {
-        moveT* move = chunk.get();
-        moveT* end = (chunk == moveChunks_.front()) ? move + moveChunkUsed_
-                                                    : move + MOVE_CHUNKSIZE;
+    for (size_t i = 0; i < moveChunksInUse_; ++i) {
+        moveT* move = moveChunks_[i].get();
+        moveT* end = (i + 1 == moveChunksInUse_) ? move + moveChunkUsed_
+                                                 : move + MOVE_CHUNKSIZE;
         for (; move != end; ++move) {
             if (variations) {
                 move->numVariations = 0;
@@ -499,13 +506,9 @@ void Game::strip(bool variations, bool comments, bool NAGs) {
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Game::ClearMoves(): clear all moves.
 void Game::ClearMoves() {
-    // Delete any chunks of moves except the first:
-    if (moveChunks_.empty()) {
-        moveChunkUsed_ = MOVE_CHUNKSIZE;
-    } else {
-        moveChunks_.erase_after(moveChunks_.begin(), moveChunks_.end());
-        moveChunkUsed_ = 0;
-    }
+    // Release the moves, but keep the chunks for reuse:
+    moveChunksInUse_ = 0;
+    moveChunkUsed_ = MOVE_CHUNKSIZE;
     StartPos = nullptr;
     CurrentPos->StdStart();
 
@@ -2925,6 +2928,142 @@ std::pair<IndexEntry, TagRoster> Game::Encode(std::vector<byte>& dest) const {
     return {ie, tags};
 }
 
+static void saveStateUint(std::vector<byte>& dest, uint64_t val) {
+	while (val >= 128) {
+		dest.push_back(static_cast<byte>(val | 128));
+		val >>= 7;
+	}
+	dest.push_back(static_cast<byte>(val));
+}
+
+static void saveStateString(std::vector<byte>& dest, std::string_view str) {
+	saveStateUint(dest, str.size());
+	dest.insert(dest.end(), str.begin(), str.end());
+}
+
+static bool restoreStateUint(const byte*& it, const byte* end, uint64_t& res) {
+	res = 0;
+	for (int shift = 0; shift < 64 && it != end; shift += 7) {
+		const byte val = *it++;
+		res |= static_cast<uint64_t>(val & 127) << shift;
+		if (val < 128)
+			return true;
+	}
+	return false;
+}
+
+static bool restoreStateString(const byte*& it, const byte* end, std::string& res) {
+	uint64_t len;
+	if (!restoreStateUint(it, end, len) ||
+	    len > static_cast<uint64_t>(end - it))
+		return false;
+
+	res.assign(reinterpret_cast<const char*>(it), len);
+	it += len;
+	return true;
+}
+
+// The state is composed by:
+// - the header (tags, PGN styles and start position)
+// - the location in PGN (4 bytes)
+// - the moves and the comments, in the same format used by Encode().
+// Consecutive states of a game that is being edited usually differ only in
+// the location and in a few bytes of the moves or of the comments: the
+// location is stored before them, so that the bytes that follow the changed
+// ones are equal (see UndoRedo in containers.h).
+void Game::saveState(std::vector<byte>& dest) const {
+    for (uint64_t val : {uint64_t(Date), uint64_t(EventDate), uint64_t(EcoCode),
+                         uint64_t(WhiteElo), uint64_t(BlackElo),
+                         uint64_t(WhiteRatingType), uint64_t(BlackRatingType),
+                         uint64_t(Result), uint64_t(PgnStyle),
+                         uint64_t(PgnFormat), uint64_t(HtmlStyle)}) {
+        saveStateUint(dest, val);
+    }
+    saveStateString(dest, ScidFlags);
+    for (auto str : {&EventStr, &SiteStr, &RoundStr, &WhiteStr, &BlackStr}) {
+        saveStateString(dest, *str);
+    }
+    saveStateUint(dest, extraTags_.size());
+    for (auto const& [tag, value] : extraTags_) {
+        saveStateString(dest, tag);
+        saveStateString(dest, value);
+    }
+    char FEN[256] = {};
+    HasNonStandardStart(FEN);
+    saveStateString(dest, FEN);
+
+    const auto location = GetLocationInPGN();
+    for (int shift = 0; shift < 32; shift += 8) {
+        dest.push_back(static_cast<byte>(location >> shift));
+    }
+
+    encodeMovelist(true, FirstMove, dest);
+    encodeComments(true, FirstMove, dest);
+}
+
+errorT Game::restoreState(const byte* data, size_t size) {
+    Clear();
+    const byte* it = data;
+    const byte* const end = data + size;
+    uint64_t header[11];
+    for (auto& val : header) {
+        if (!restoreStateUint(it, end, val))
+            return ERROR_Decode;
+    }
+    Date = static_cast<dateT>(header[0]);
+    EventDate = static_cast<dateT>(header[1]);
+    EcoCode = static_cast<ecoT>(header[2]);
+    WhiteElo = static_cast<eloT>(header[3]);
+    BlackElo = static_cast<eloT>(header[4]);
+    WhiteRatingType = static_cast<byte>(header[5]);
+    BlackRatingType = static_cast<byte>(header[6]);
+    Result = static_cast<resultT>(header[7]);
+    PgnStyle = static_cast<uint>(header[8]);
+    PgnFormat = static_cast<gameFormatT>(header[9]);
+    HtmlStyle = static_cast<uint>(header[10]);
+
+    std::string str;
+    if (!restoreStateString(it, end, str))
+        return ERROR_Decode;
+    SetScidFlags(str.c_str(), str.size());
+
+    for (auto dest : {&EventStr, &SiteStr, &RoundStr, &WhiteStr, &BlackStr}) {
+        if (!restoreStateString(it, end, *dest))
+            return ERROR_Decode;
+    }
+    uint64_t nTags;
+    if (!restoreStateUint(it, end, nTags))
+        return ERROR_Decode;
+    for (; nTags > 0; --nTags) {
+        auto& [tag, value] = extraTags_.emplace_back();
+        if (!restoreStateString(it, end, tag) ||
+            !restoreStateString(it, end, value))
+            return ERROR_Decode;
+    }
+    if (!restoreStateString(it, end, str))
+        return ERROR_Decode;
+    if (!str.empty()) {
+        if (auto err = SetStartFen(str.c_str()))
+            return err;
+    }
+
+    if (std::distance(it, end) < 4)
+        return ERROR_Decode;
+    unsigned location = 0;
+    for (int i = 0; i < 4; ++i) {
+        location |= static_cast<unsigned>(*it++) << (i * 8);
+    }
+
+    ByteBuffer buf(it, std::distance(it, end));
+    commentMarks_.clear();
+    if (auto err = DecodeVariation(buf, commentMarks_))
+        return err;
+    if (auto err = decodeComments(buf, FirstMove, commentMarks_))
+        return err;
+
+    return MoveToLocationInPGN(location);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Game::DecodeNextMove():
 //      Decodes one more mainline move of the game from the bytebuffer.
@@ -2978,8 +3117,8 @@ errorT Game::DecodeMovesOnly(ByteBuffer& buf) {
 	if (errorT err = DecodeSkipTags(&buf))
 		return err;
 
-	std::vector<moveT*> comment_marks;
-	return DecodeVariation(buf, comment_marks);
+	commentMarks_.clear();
+	return DecodeVariation(buf, commentMarks_);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -3005,16 +3144,193 @@ errorT Game::Decode(IndexEntry const& ie, TagRoster const& tags, ByteBuffer buf)
     if (fen)
         err = SetStartFen(fen);
 
-    std::vector<moveT*> comment_marks;
+    commentMarks_.clear();
     if (err == OK)
-        err = DecodeVariation(buf, comment_marks);
+        err = DecodeVariation(buf, commentMarks_);
 
     if (err == OK)
-        err = decodeComments(buf, FirstMove, comment_marks);
+        err = decodeComments(buf, FirstMove, commentMarks_);
 
     return err;
 }
 
+errorT encodePGN(IndexEntry const& ie, TagRoster const& tags, ByteBuffer buf,
+                 std::vector<char>& dest) {
+    const auto dest_size = dest.size();
+    auto fail = [&](errorT err) {
+        dest.resize(dest_size);
+        return err;
+    };
+
+    // The tags are written in the order of Game::viewTagPairs(), and the
+    // stored ones are merged like Game::assignTagValue() does.
+    std::string_view stdTags[] = {tags.event, tags.site, tags.round,
+                                  tags.white, tags.black};
+    std::vector<std::pair<std::string_view, std::string_view>> extraTags;
+    if (!ie.isChessStd())
+        extraTags.emplace_back("Variant", "Chess960");
+    errorT err = buf.decodeTags([&](auto tag, auto value) {
+        const std::string_view stdNames[] = {"Event", "Site", "Round", "White",
+                                             "Black"};
+        auto it = std::find(std::begin(stdNames), std::end(stdNames), tag);
+        if (it != std::end(stdNames)) {
+            stdTags[std::distance(std::begin(stdNames), it)] = value;
+            return;
+        }
+        auto extra = std::find_if(extraTags.begin(), extraTags.end(),
+                                  [&](auto& e) { return e.first == tag; });
+        if (extra != extraTags.end()) {
+            extra->second = value;
+        } else {
+            extraTags.emplace_back(tag, value);
+        }
+    });
+    if (err)
+        return fail(err);
+
+    const auto [err_startpos, fen] = buf.decodeStartBoard();
+    if (err_startpos)
+        return fail(err_startpos);
+
+    Position pos = Position::getStdStart();
+    if (fen && (err = pos.ReadFromFEN(fen)))
+        return fail(err);
+
+    char strBuf[256];
+    pgn::encode_tag_pair("Event", stdTags[0], dest);
+    pgn::encode_tag_pair("Site", stdTags[1], dest);
+    date_DecodeToString(ie.GetDate(), strBuf);
+    pgn::encode_tag_pair("Date", strBuf, dest);
+    pgn::encode_tag_pair("Round", stdTags[2], dest);
+    pgn::encode_tag_pair("White", stdTags[3], dest);
+    pgn::encode_tag_pair("Black", stdTags[4], dest);
+    pgn::encode_tag_pair("Result", RESULT_LONGSTR[ie.GetResult()], dest);
+    if (auto elo = ie.GetWhiteElo()) {
+        std::string rType = "White";
+        rType.append(ratingTypeNames[ie.GetWhiteRatingType()]);
+        pgn::encode_tag_pair(rType, std::to_string(elo), dest);
+    }
+    if (auto elo = ie.GetBlackElo()) {
+        std::string rType = "Black";
+        rType.append(ratingTypeNames[ie.GetBlackRatingType()]);
+        pgn::encode_tag_pair(rType, std::to_string(elo), dest);
+    }
+    if (ie.GetEcoCode() != ECO_None) {
+        eco_ToExtendedString(ie.GetEcoCode(), strBuf);
+        pgn::encode_tag_pair("ECO", strBuf, dest);
+    }
+    if (ie.GetEventDate() != ZERO_DATE) {
+        date_DecodeToString(ie.GetEventDate(), strBuf);
+        pgn::encode_tag_pair("EventDate", strBuf, dest);
+    }
+    for (auto& [tag, value] : extraTags) {
+        pgn::encode_tag_pair(tag, value, dest);
+    }
+    if (fen) {
+        pos.PrintFEN(strBuf);
+        pgn::encode_tag_pair("FEN", strBuf, dest);
+    }
+
+    // The comments are stored after the moves. Like decodeComments(), they
+    // are assigned to the marked elements and then, sequentially, to all the
+    // elements (the start of the game, the moves, and the start and end of
+    // the variations) that follow the last mark.
+    std::vector<std::string_view> comments;
+    size_t nMarks = 0;
+    {
+        auto commentsBuf = buf;
+        auto [err_skip, val] = commentsBuf.nextMove(
+            0, [](auto) { return false; }, [&] { ++nMarks; },
+            [](auto) { return true; }, [](auto) { return true; });
+        if (err_skip != ERROR_EndOfMoveList)
+            return fail(err_skip);
+
+        while (auto comment = commentsBuf.GetTerminatedString()) {
+            comments.emplace_back(comment);
+        }
+        if (comments.size() < nMarks)
+            return fail(ERROR_Decode);
+    }
+    size_t nextComment = 0;
+    auto element = [&]() -> std::string_view {
+        if (nextComment < nMarks || nextComment == comments.size())
+            return {};
+        return comments[nextComment++];
+    };
+    std::string_view pending; // The comment of the last element
+
+    struct Line {
+        Position pos;
+        simpleMoveT lastMove;
+        bool hasMove;
+    };
+    std::vector<Line> lines;
+    lines.push_back({pos, {}, false});
+
+    pgn::MovetextWriter<std::vector<char>> writer(pos.GetPlyCounter(), dest);
+    pending = element(); // The start of the game
+    for (;;) {
+        auto [err_move, val] = buf.nextMove(
+            static_cast<int>(lines.size() - 1), [](auto) { return true; },
+            [&] {
+                if (nextComment < nMarks)
+                    pending = comments[nextComment++];
+            },
+            [&](auto newVariation) {
+                writer.comment(std::exchange(pending, {}));
+                if (newVariation) {
+                    auto& line = lines.back();
+                    if (!line.hasMove)
+                        return false;
+
+                    Line var = {line.pos, {}, false};
+                    var.pos.UndoSimpleMove(&line.lastMove);
+                    lines.push_back(var);
+                    writer.startVariation();
+                    pending = element();
+                } else {
+                    // The comments of the end markers are not written
+                    lines.pop_back();
+                    writer.endVariation();
+                    element();
+                }
+                return true;
+            },
+            [&](auto nag) {
+                writer.nag(nag);
+                return true;
+            });
+        writer.comment(std::exchange(pending, {}));
+        if (err_move) {
+            if (err_move != ERROR_EndOfMoveList)
+                return fail(err_move);
+
+            element(); // The end of the game
+            if (nextComment != comments.size())
+                return fail(ERROR_Decode);
+            break;
+        }
+
+        auto& line = lines.back();
+        if (auto errMove = decodeMove(&buf, &line.lastMove, val, &line.pos))
+            return fail(errMove);
+
+        sanStringT san;
+        line.pos.MakeSANString(&line.lastMove, san, SAN_MATETEST);
+        line.pos.DoSimpleMove(line.lastMove);
+        line.hasMove = true;
+        writer.move(san);
+        pending = element();
+    }
+    writer.finish();
+
+    const auto result = RESULT_LONGSTR[ie.GetResult()];
+    dest.insert(dest.end(), result, result + std::strlen(result));
+    dest.push_back('\n');
+    pgn::break_lines(dest.begin() + dest_size, dest.end());
+    return OK;
+}
+
 //////////////////////////////////////////////////////////////////////
 //  EOF:    game.cpp
 //////////////////////////////////////////////////////////////////////
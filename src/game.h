@@ -23,7 +23,6 @@
 #include "movetree.h"
 #include "namebase.h"
 #include "position.h"
-#include <forward_list>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -176,8 +175,12 @@ class Game {
     char        ScidFlags[22];
 
     // Position and moves
-    byte        moveChunkUsed_;
-    std::forward_list<std::unique_ptr<moveT[]> > moveChunks_;
+    // The moves are allocated from an arena of chunks, which are retained
+    // when the game is cleared and reused by the next game.
+    byte        moveChunkUsed_;      // Moves used in the current chunk.
+    size_t      moveChunksInUse_ = 0;
+    std::vector<std::unique_ptr<moveT[]> > moveChunks_;
+    std::vector<moveT*> commentMarks_; // Used by Decode()
     std::unique_ptr<Position> StartPos;
     std::unique_ptr<Position> CurrentPos{new Position};
     moveT*      FirstMove;
@@ -524,8 +527,23 @@ public:
     errorT    DecodeMovesOnly(ByteBuffer& buf);
 
     Game* clone();
+
+    /// Saves all the data of the game, including the current location, in a
+    /// compact format. Used to implement the undo/redo queues.
+    void saveState(std::vector<byte>& dest) const;
+    /// Restores the data saved by saveState().
+    errorT restoreState(const byte* data, size_t size);
 };
 
+/// Encodes a game, stored in the SCID4 format, into PGN text appended to @e dest.
+/// The SAN of the moves is generated while they are decoded, without building
+/// the move tree of a Game object. The output is the same of Game::Decode()
+/// followed by pgn::encode(), but a mate followed by more moves (i.e. by null
+/// moves) is marked with '#' instead of '+'.
+/// @returns OK on success; on error @e dest is not modified.
+errorT encodePGN(IndexEntry const& ie, TagRoster const& tags, ByteBuffer buf,
+                 std::vector<char>& dest);
+
 template <typename TFunc> void Game::viewTagPairs(TFunc visitor) const {
 	char strBuf[256];
 	visitor("Event", GetEventStr());
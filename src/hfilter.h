@@ -105,6 +105,26 @@ public:
 		}
 	}
 
+	/// Returns a pointer to the values, allocating them if necessary.
+	/// The values of different games can be modified concurrently, and then
+	/// UpdateCount() must be invoked.
+	byte* WritableData() {
+		if (!data_) {
+			allocate(size_);
+			std::fill(data_.get(), data_.get() + size_, 1);
+		}
+		return data_.get();
+	}
+
+	/// Updates the number of nonzero values after the values returned by
+	/// WritableData() were modified.
+	void UpdateCount() {
+		if (data_) {
+			nonzero_ = size_ - static_cast<gamenumT>(std::count(
+			                       data_.get(), data_.get() + size_, 0));
+		}
+	}
+
 	/// Sets all values.
 	void Fill(byte value) {
 		if (value == 1) {
@@ -274,6 +294,12 @@ public:
 	 *     insert_or_assign(gnum, value - 1);
 	 */
 	void set(gamenumT gnum, byte value) { return main_->Set(gnum, value); }
+
+	/// Returns the values of the main filter, indexed by game number, which
+	/// can be modified directly (also by multiple threads, for different
+	/// games). After the changes, updateCount() must be invoked.
+	byte* mainValues() { return main_->WritableData(); }
+	void updateCount() { return main_->UpdateCount(); }
 };
 
 /**
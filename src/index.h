@@ -24,6 +24,12 @@
 #include "common.h"
 #include "containers.h"
 #include "indexentry.h"
+#include "indexstats.h"
+#include "namepostings.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -39,6 +45,10 @@ private:
     // CHUNKSHIFT is the base-2 logarithm of the number of index entries allocated as one chunk.
     // i.e 16 = 2^16 = 65536 (total size of one chunk: 65536*48 = 3MB)
     VectorChunked<IndexEntry, 16> entries_; // A two-level array of the entire index.
+    mutable NamePostings postings_; // See GetNameGames()
+    mutable std::array<std::vector<uint32_t>, 8> columns_; // See GetColumn()
+    mutable std::unique_ptr<IndexStats> stats_;            // See GetStats()
+    mutable std::mutex cacheMutex_; // Guards the creation of the caches
     int nInvalidNameId_;
 
     friend class CodecSCID4;
@@ -73,19 +83,129 @@ public:
     }
 
     void addEntry(const IndexEntry& ie) {
+        postings_.add(ie, GetNumGames());
+        for (size_t col = 0; col < columns_.size(); ++col) {
+            if (columns_[col].size() == GetNumGames())
+                columns_[col].push_back(columnValue(ie, ColumnT(col)));
+        }
+        if (stats_)
+            stats_->add(ie);
         entries_.push_back(ie);
     }
 
     void replaceEntry(const IndexEntry& ie, gamenumT replaced) {
         ASSERT(replaced < this->GetNumGames());
 
+        postings_.replace(entries_[replaced], ie, replaced);
+        for (size_t col = 0; col < columns_.size(); ++col) {
+            if (columns_[col].size() == GetNumGames())
+                columns_[col][replaced] = columnValue(ie, ColumnT(col));
+        }
+        if (stats_) {
+            stats_->remove(entries_[replaced]);
+            stats_->add(ie);
+        }
         entries_[replaced] = ie;
     }
 
+    /**
+     * Returns the sorted list of the games that contain the name @e id.
+     * The lists of all the names of type @e nt are created the first time
+     * they are requested; the entries added or replaced later are merged
+     * into them by the next request. They can be requested concurrently,
+     * like GetColumn().
+     * @param nt: NAME_PLAYER, NAME_EVENT or NAME_SITE (the lists of the
+     *            other types are empty).
+     */
+    NamePostings::Games GetNameGames(nameT nt, idNumberT id) const {
+        if (!NamePostings::isIndexed(nt))
+            return {};
+
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (!postings_.valid(nt)) {
+            postings_.update(nt, GetNumGames(),
+                             [&](gamenumT gnum) -> const IndexEntry& {
+                                 return entries_[gnum];
+                             });
+        }
+        return postings_.games(nt, id);
+    }
+
+    /// The fields of the IndexEntry that are most often scanned.
+    enum ColumnT {
+        COL_DATE,
+        COL_EVENTDATE,
+        COL_WHITEELO,
+        COL_BLACKELO,
+        COL_ECO,
+        COL_NUMHALFMOVES,
+        COL_RESULT,
+        COL_FLAGS
+    };
+
+    /**
+     * Returns the values of the field @e col of all the entries.
+     * The values are stored contiguously, separated from the other fields:
+     * a scan of a column reads 4 bytes per game instead of the whole
+     * IndexEntry. A column is created the first time it is requested, so
+     * that only the columns that are actually used take memory, and is then
+     * updated by addEntry() and replaceEntry().
+     * Multiple threads can request the columns concurrently, but not while
+     * the entries are modified.
+     */
+    const std::vector<uint32_t>& GetColumn(ColumnT col) const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto& values = columns_[col];
+        if (values.size() != GetNumGames()) {
+            values.resize(GetNumGames());
+            for (gamenumT gnum = 0, n = GetNumGames(); gnum < n; ++gnum) {
+                values[gnum] = columnValue(entries_[gnum], col);
+            }
+        }
+        return values;
+    }
+
+    /**
+     * Returns the statistics of all the entries.
+     * The statistics are computed the first time they are requested and are
+     * then updated by addEntry() and replaceEntry().
+     * Can be requested concurrently, like GetColumn().
+     */
+    const IndexStats& GetStats() const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (!stats_) {
+            stats_ = std::make_unique<IndexStats>();
+            for (gamenumT gnum = 0, n = GetNumGames(); gnum < n; ++gnum) {
+                stats_->add(entries_[gnum]);
+            }
+        }
+        return *stats_;
+    }
+
 private:
     void Init() {
         nInvalidNameId_ = 0;
         entries_.resize(0);
+        postings_.clear();
+        for (auto& column : columns_) {
+            column = std::vector<uint32_t>();
+        }
+        stats_.reset();
+    }
+
+    static uint32_t columnValue(const IndexEntry& ie, ColumnT col) {
+        switch (col) {
+        case COL_DATE:         return ie.GetDate();
+        case COL_EVENTDATE:    return ie.GetEventDate();
+        case COL_WHITEELO:     return ie.GetWhiteElo();
+        case COL_BLACKELO:     return ie.GetBlackElo();
+        case COL_ECO:          return ie.GetEcoCode();
+        case COL_NUMHALFMOVES: return ie.GetNumHalfMoves();
+        case COL_RESULT:       return ie.GetResult();
+        case COL_FLAGS:        return ie.GetRawFlags();
+        }
+        ASSERT(false);
+        return 0;
     }
 };
 
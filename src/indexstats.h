@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/** @file
+ * Implements the IndexStats class.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "date.h"
+#include "indexentry.h"
+#include "misc.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Statistics of all the games of a database, computed from their IndexEntry.
+ * The counters are updated with add() and remove() when the games are added
+ * or replaced: the years and the ratings are stored as histograms so that
+ * the minimum and maximum values remain correct when a game is removed.
+ */
+class IndexStats {
+public:
+	struct Eco {
+		uint count = 0;
+		uint results[NUM_RESULT_TYPES] = {};
+	};
+
+	uint flagCount[IndexEntry::IDX_NUM_FLAGS] = {}; // Num of games with each
+	                                                // flag set.
+	uint64_t nYears = 0;
+	uint64_t sumYears = 0;
+	uint nResults[NUM_RESULT_TYPES] = {};
+	uint nRatings = 0;
+	uint64_t sumRatings = 0;
+
+private:
+	std::array<uint, YEAR_MAX + 1> years_ = {};
+	std::array<uint, 1 << 12> ratings_ = {};
+	Eco ecoEmpty_;
+	Eco ecoValid_;
+	Eco ecoStats_[(1 + (1 << 16) / 131) * 27];
+	Eco ecoGroup1_[(1 + (1 << 16) / 131) / 100];
+	Eco ecoGroup2_[(1 + (1 << 16) / 131) / 10];
+	Eco ecoGroup3_[(1 + (1 << 16) / 131)];
+
+public:
+	void add(IndexEntry const& ie) { update(ie, 1); }
+	void remove(IndexEntry const& ie) { update(ie, -1); }
+
+	/// Returns the lowest year of the games (0 if none has a valid date).
+	uint minYear() const { return firstNonZero(years_); }
+	/// Returns the highest year of the games (0 if none has a valid date).
+	uint maxYear() const { return lastNonZero(years_); }
+	/// Returns the lowest rating of the players (0 if none is rated).
+	uint minRating() const { return firstNonZero(ratings_); }
+	/// Returns the highest rating of the players (0 if none is rated).
+	uint maxRating() const { return lastNonZero(ratings_); }
+
+	/// Returns the statistics of an ECO code, or of a group of ECO codes if
+	/// @e ecoStr is a prefix ("", "A", "A0", "A00"), or nullptr if the code
+	/// is not valid.
+	const Eco* getEcoStats(const char* ecoStr) const {
+		ASSERT(ecoStr != 0);
+
+		if (*ecoStr == 0)
+			return &ecoValid_;
+
+		ecoT eco = eco_FromString(ecoStr);
+		if (eco == 0)
+			return 0;
+		eco = eco_Reduce(eco);
+
+		switch (std::strlen(ecoStr)) {
+		case 1:
+			return &(ecoGroup1_[eco / 2700]);
+		case 2:
+			return &(ecoGroup2_[eco / 270]);
+		case 3:
+			return &(ecoGroup3_[eco / 27]);
+		case 4:
+		case 5:
+			return &(ecoStats_[eco]);
+		}
+		return 0;
+	}
+
+private:
+	// The unsigned counters wrap around when @e delta is -1.
+	void update(IndexEntry const& ie, int delta) {
+		const resultT result = ie.GetResult();
+		nResults[result] += delta;
+
+		for (eloT elo : {ie.GetWhiteElo(), ie.GetBlackElo()}) {
+			if (elo > 0) {
+				nRatings += delta;
+				sumRatings += static_cast<int64_t>(elo) * delta;
+				ratings_[elo] += delta;
+			}
+		}
+
+		if (const auto year = date_GetYear(ie.GetDate()); year > 0) {
+			nYears += delta;
+			sumYears += static_cast<int64_t>(year) * delta;
+			years_[year] += delta;
+		}
+
+		for (uint flag = 0; flag < IndexEntry::IDX_NUM_FLAGS; flag++) {
+			if (ie.GetFlag(1 << flag))
+				flagCount[flag] += delta;
+		}
+
+		auto count = [&](Eco& stats) {
+			stats.count += delta;
+			stats.results[result] += delta;
+		};
+		ecoT eco = ie.GetEcoCode();
+		if (eco == 0) {
+			count(ecoEmpty_);
+		} else {
+			count(ecoValid_);
+			eco = eco_Reduce(eco);
+			count(ecoStats_[eco]);
+			eco /= 27;
+			count(ecoGroup3_[eco]);
+			eco /= 10;
+			count(ecoGroup2_[eco]);
+			eco /= 10;
+			count(ecoGroup1_[eco]);
+		}
+	}
+
+	// The histograms never count the value 0.
+	template <typename TCont>
+	static uint firstNonZero(TCont const& hist) {
+		auto it = std::find_if(hist.begin(), hist.end(),
+		                       [](uint n) { return n != 0; });
+		return it == hist.end() ? 0 : static_cast<uint>(it - hist.begin());
+	}
+
+	template <typename TCont>
+	static uint lastNonZero(TCont const& hist) {
+		auto it = std::find_if(hist.rbegin(), hist.rend(),
+		                       [](uint n) { return n != 0; });
+		return it == hist.rend() ? 0
+		                         : static_cast<uint>(hist.rend() - it - 1);
+	}
+};
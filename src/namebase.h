@@ -24,28 +24,50 @@
 #include "misc.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
-using nameT = unsigned;
-enum {
-	NAME_PLAYER,
-	NAME_EVENT,
-	NAME_SITE,
-	NAME_ROUND,
-	NUM_NAME_TYPES,
-	NAME_INVALID = 99
-};
-
 /**
  * This class stores the database's names (players, events, sites and rounds).
  * Assigns a idNumberT (which will be used as reference) to each name.
+ * The names are stored in large blocks of memory and retrieved by ID with a
+ * table of pointers. The sorted index, required to search the names, is
+ * created only when it is first used: opening a database and reading the
+ * names of its games do not need it.
+ * The const functions can be invoked concurrently (the creation of the index
+ * is synchronized), but not while names are added.
  */
 class NameBase {
-	std::vector<std::unique_ptr<const char[]>> names_[NUM_NAME_TYPES];
+	/// Stores null-terminated strings that are never moved or freed
+	/// individually.
+	class Arena {
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		char* next_ = nullptr;
+		size_t free_ = 0;
+
+	public:
+		const char* add(std::string_view str) {
+			const auto sz = str.size() + 1;
+			if (sz > free_) {
+				free_ = std::max<size_t>(sz, 64 * 1024);
+				next_ = blocks_.emplace_back(new char[free_]).get();
+			}
+			char* res = next_;
+			std::copy_n(str.data(), str.size(), res);
+			res[str.size()] = '\0';
+			next_ += sz;
+			free_ -= sz;
+			return res;
+		}
+	};
+
+	Arena arena_;
+	std::vector<const char*> names_[NUM_NAME_TYPES];
 	struct idxCmp {
 		bool operator()(const char* str1, const char* str2) const {
 			// *** Compatibility ***
@@ -65,7 +87,10 @@ class NameBase {
 			return static_cast<uint32_t>(*str1) < static_cast<uint32_t>(*str2);
 		}
 	};
-	std::map<const char*, idNumberT, idxCmp> idx_[NUM_NAME_TYPES];
+	mutable std::map<const char*, idNumberT, idxCmp> idx_[NUM_NAME_TYPES];
+	mutable std::array<std::atomic<bool>, NUM_NAME_TYPES> indexed_ = {};
+	mutable std::mutex indexMutex_; // Guards the creation of idx_
+	std::array<const char*, NUM_NAME_TYPES> lastInserted_ = {};
 
 public:
 	// Add a name (string) to the NameBase.
@@ -78,15 +103,13 @@ public:
 		ASSERT(IsValidNameType(nt));
 		ASSERT(names_[nt].size() <= std::numeric_limits<idNumberT>::max());
 
-		char* alloc = new char[name.size() + 1];
-		std::copy_n(name.data(), name.size(), alloc);
-		alloc[name.size()] = '\0';
+		const char* str = arena_.add(name);
 		idNumberT newID = static_cast<idNumberT>(names_[nt].size());
-		names_[nt].emplace_back(alloc);
+		names_[nt].push_back(str);
 		if (hint) {
-			idx_[nt].emplace_hint(*hint, alloc, newID);
-		} else {
-			idx_[nt].emplace(alloc, newID);
+			idx_[nt].emplace_hint(*hint, str, newID);
+		} else if (indexed_[nt]) {
+			idx_[nt].emplace(str, newID);
 		}
 		return newID;
 	}
@@ -97,7 +120,7 @@ public:
 	idNumberT namebase_find_or_add(nameT nt, const char* name) {
 		ASSERT(IsValidNameType(nt));
 
-		auto& nb = idx_[nt];
+		auto& nb = index(nt);
 		auto it = nb.lower_bound(name);
 		if (it != nb.end() && !nb.key_comp()(name, it->first))
 			return it->second;
@@ -119,6 +142,8 @@ public:
 	/// is then no longer valid and should be destroyed.
 	/// The caller should also ensure that before invoking any other object's
 	/// function none of names_[nt] == nullptr.
+	/// The names are expected in sorted order: while they are, each name is
+	/// only compared with the previous one and the index is not created.
 	bool insert(const char* name, size_t nameLen, nameT nt, idNumberT id) {
 		if (id >= names_[nt].size())
 			names_[nt].resize(id + size_t{1});
@@ -126,18 +151,33 @@ public:
 		if (names_[nt][id]) // A name with the same ID already exists
 			return false;
 
-		char* buf = new char[nameLen + 1];
-		std::copy_n(name, nameLen, buf);
-		buf[nameLen] = '\0';
-		names_[nt][id].reset(buf);
-		auto it = idx_[nt].emplace_hint(idx_[nt].end(), buf, id);
+		const char* str = arena_.add({name, nameLen});
+		if (!indexed_[nt]) {
+			if (lastInserted_[nt] == nullptr ||
+			    idxCmp()(lastInserted_[nt], str)) {
+				names_[nt][id] = str;
+				lastInserted_[nt] = str;
+				return true;
+			}
+			index(nt);
+		}
+		names_[nt][id] = str;
+		auto it = idx_[nt].emplace_hint(idx_[nt].end(), str, id);
 		return it->second == id; // Check that the name doesn't already exists
 	}
 
 	/**
 	 * Frees memory, leaving the object empty.
 	 */
-	void Clear() { *this = NameBase(); }
+	void Clear() {
+		arena_ = Arena();
+		for (nameT nt = NAME_PLAYER; nt < NUM_NAME_TYPES; nt++) {
+			names_[nt] = std::vector<const char*>();
+			idx_[nt].clear();
+			indexed_[nt] = false;
+			lastInserted_[nt] = nullptr;
+		}
+	}
 
 	/**
 	 * Get the first few matches of a name prefix.
@@ -152,8 +192,9 @@ public:
 
 		std::vector<idNumberT> res;
 		size_t len = strlen(str);
-		for (auto it = idx_[nt].lower_bound(str);
-		     it != idx_[nt].end() && res.size() < maxMatches; ++it) {
+		auto const& nb = index(nt);
+		for (auto it = nb.lower_bound(str);
+		     it != nb.end() && res.size() < maxMatches; ++it) {
 			const char* s = it->first;
 			if (strlen(s) < len || !std::equal(str, str + len, s))
 				break;
@@ -170,14 +211,19 @@ public:
 	 */
 	const char* GetName(nameT nt, idNumberT id) const {
 		ASSERT(IsValidNameType(nt) && id < GetNumNames(nt));
-		return names_[nt][id].get();
+		return names_[nt][id];
 	}
 
 	/**
 	 * @returns a reference to a container with all the names and IDs (given as
 	 * std::pair<const char*, idNumberT>).
 	 */
-	const decltype(idx_)& getNames() const { return idx_; }
+	const decltype(idx_)& getNames() const {
+		for (nameT nt = NAME_PLAYER; nt < NUM_NAME_TYPES; nt++) {
+			index(nt);
+		}
+		return idx_;
+	}
 
 	/**
 	 * @param nt: a valid @e nameT type.
@@ -199,8 +245,9 @@ public:
 	errorT FindExactName(nameT nt, const char* str, idNumberT* idPtr) const {
 		ASSERT(IsValidNameType(nt) && str != NULL && idPtr != NULL);
 
-		auto it = idx_[nt].find(str);
-		if (it != idx_[nt].end()) {
+		auto const& nb = index(nt);
+		auto it = nb.find(str);
+		if (it != nb.end()) {
 			*idPtr = (*it).second;
 			return OK;
 		}
@@ -216,7 +263,7 @@ public:
 		std::vector<uint32_t> res(names_[nt].size());
 		std::transform(
 		    names_[nt].begin(), names_[nt].end(), res.begin(),
-		    [](auto const& name) { return strStartHash(name.get()); });
+		    [](const char* name) { return strStartHash(name); });
 		return res;
 	}
 
@@ -276,6 +323,25 @@ public:
 			return NAME_ROUND;
 		return NAME_INVALID;
 	}
+
+private:
+	/// Returns the sorted index of the names of type @e nt, creating it if
+	/// necessary.
+	std::map<const char*, idNumberT, idxCmp>& index(nameT nt) const {
+		auto& res = idx_[nt];
+		if (!indexed_[nt].load(std::memory_order_acquire)) {
+			std::lock_guard<std::mutex> lock(indexMutex_);
+			if (!indexed_[nt].load(std::memory_order_relaxed)) {
+				auto const& names = names_[nt];
+				for (size_t id = 0, n = names.size(); id < n; ++id) {
+					if (names[id])
+						res.emplace(names[id], static_cast<idNumberT>(id));
+				}
+				indexed_[nt].store(true, std::memory_order_release);
+			}
+		}
+		return res;
+	}
 };
 
 /// The Seven Tag Roster defined in the PGN standard is stored in the
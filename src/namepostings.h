@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the NamePostings class.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "indexentry.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+/// Inverted index of the players, events and sites of the games.
+/// For each name stores the sorted list of the games (gamenumT) where the
+/// name is used; a game is listed only once for a player, even if the player
+/// has both the white and black pieces.
+/// The lists of a type of name are stored contiguously, in a single array
+/// indexed by an array of offsets, and are created only when requested.
+/// New and replaced games are recorded as pending changes, which are merged
+/// into the lists by the next update().
+class NamePostings {
+	struct Change {
+		idNumberT id;
+		gamenumT gnum;
+		int delta; // +1 if the game is added to the list, -1 if removed
+
+		bool operator<(Change const& b) const {
+			return id < b.id || (id == b.id && gnum < b.gnum);
+		}
+	};
+	struct Postings {
+		std::vector<size_t> offsets; // The lists of name id: [id, id + 1)
+		std::vector<gamenumT> games;
+		std::vector<Change> pending;
+	};
+	// NAME_PLAYER, NAME_EVENT, NAME_SITE
+	std::array<Postings, 3> postings_;
+
+public:
+	/// A sorted list of games.
+	class Games {
+		const gamenumT* begin_ = nullptr;
+		const gamenumT* end_ = nullptr;
+
+	public:
+		Games() = default;
+		Games(const gamenumT* begin, const gamenumT* end)
+		    : begin_(begin), end_(end) {}
+
+		const gamenumT* begin() const { return begin_; }
+		const gamenumT* end() const { return end_; }
+		size_t size() const { return end_ - begin_; }
+		bool empty() const { return begin_ == end_; }
+		gamenumT back() const { return *(end_ - 1); }
+	};
+
+	static bool isIndexed(nameT nt) {
+		return nt == NAME_PLAYER || nt == NAME_EVENT || nt == NAME_SITE;
+	}
+
+	void clear() {
+		for (auto& postings : postings_) {
+			postings = Postings();
+		}
+	}
+
+	/// Returns false if the lists of @e nt must be created or modified with
+	/// update().
+	bool valid(nameT nt) const {
+		return isIndexed(nt) && !postings_[nt].offsets.empty() &&
+		       postings_[nt].pending.empty();
+	}
+
+	/// Returns the sorted list of the games that contain the name @e id.
+	/// @param nt: NAME_PLAYER, NAME_EVENT or NAME_SITE.
+	/// The lists of @e nt must be valid(); the result stays valid until the
+	/// next call to update() or clear().
+	Games games(nameT nt, idNumberT id) const {
+		if (!valid(nt))
+			return {};
+
+		auto const& postings = postings_[nt];
+		if (id + size_t(1) >= postings.offsets.size())
+			return {};
+
+		const auto games = postings.games.data();
+		return {games + postings.offsets[id], games + postings.offsets[id + 1]};
+	}
+
+	/// Creates the lists of the name type @e nt, or merges the pending
+	/// changes into the existing lists.
+	/// @param nGames:   the number of games.
+	/// @param getEntry: function that returns the IndexEntry of a game (not
+	///                  used if the lists already exist).
+	template <typename TFunc>
+	void update(nameT nt, gamenumT nGames, TFunc getEntry) {
+		ASSERT(isIndexed(nt));
+
+		if (postings_[nt].offsets.empty())
+			build(postings_[nt], nt, nGames, getEntry);
+		else
+			merge(postings_[nt]);
+	}
+
+	/// Updates the postings for a new game (which must have the greatest
+	/// game number).
+	void add(IndexEntry const& ie, gamenumT gnum) {
+		for (nameT nt : {NAME_PLAYER, NAME_EVENT, NAME_SITE}) {
+			auto& postings = postings_[nt];
+			if (postings.offsets.empty())
+				continue;
+
+			forEachName(ie, nt, [&](idNumberT id) {
+				postings.pending.push_back({id, gnum, 1});
+			});
+		}
+	}
+
+	/// Updates the postings of a replaced game.
+	void replace(IndexEntry const& oldIE, IndexEntry const& newIE,
+	             gamenumT gnum) {
+		for (nameT nt : {NAME_PLAYER, NAME_EVENT, NAME_SITE}) {
+			auto& postings = postings_[nt];
+			if (postings.offsets.empty())
+				continue;
+
+			forEachName(oldIE, nt, [&](idNumberT id) {
+				postings.pending.push_back({id, gnum, -1});
+			});
+			forEachName(newIE, nt, [&](idNumberT id) {
+				postings.pending.push_back({id, gnum, 1});
+			});
+		}
+	}
+
+private:
+	template <typename TFunc>
+	static void build(Postings& postings, nameT nt, gamenumT nGames,
+	                  TFunc getEntry) {
+		// Count the games of each name, then store the games of each name
+		// starting from the offset computed from the counts.
+		std::vector<size_t> offsets(1);
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			forEachName(getEntry(gnum), nt, [&](idNumberT id) {
+				if (id + size_t(2) > offsets.size())
+					offsets.resize(id + size_t(2));
+				++offsets[id + 1];
+			});
+		}
+		for (size_t i = 1; i < offsets.size(); ++i) {
+			offsets[i] += offsets[i - 1];
+		}
+		postings.games.resize(offsets.back());
+		postings.games.shrink_to_fit();
+		std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+		for (gamenumT gnum = 0; gnum < nGames; ++gnum) {
+			forEachName(getEntry(gnum), nt, [&](idNumberT id) {
+				postings.games[next[id]++] = gnum;
+			});
+		}
+		postings.offsets = std::move(offsets);
+		postings.pending = std::vector<Change>();
+	}
+
+	/// Merges the pending changes into the lists, with a single pass over the
+	/// existing games.
+	static void merge(Postings& postings) {
+		// Sum the changes of the same game and name: a replaced game may
+		// remove and add again the same name.
+		auto& changes = postings.pending;
+		std::stable_sort(changes.begin(), changes.end());
+		size_t nChanges = 0;
+		for (auto const& change : changes) {
+			if (nChanges != 0 && !(changes[nChanges - 1] < change))
+				changes[nChanges - 1].delta += change.delta;
+			else
+				changes[nChanges++] = change;
+		}
+		changes.resize(nChanges);
+
+		auto const& offsets = postings.offsets;
+		size_t nIds = offsets.size() - 1;
+		if (!changes.empty())
+			nIds = std::max<size_t>(nIds, changes.back().id + size_t(1));
+
+		std::vector<size_t> newOffsets(nIds + 1);
+		std::vector<gamenumT> games;
+		games.reserve(postings.games.size() + changes.size());
+		auto change = changes.cbegin();
+		for (size_t id = 0; id < nIds; ++id) {
+			auto it = postings.games.cbegin();
+			auto end = it;
+			if (id + 1 < offsets.size()) {
+				it += offsets[id];
+				end += offsets[id + 1];
+			}
+			for (; change != changes.cend() && change->id == id; ++change) {
+				for (; it != end && *it < change->gnum; ++it) {
+					games.push_back(*it);
+				}
+				const bool listed = it != end && *it == change->gnum;
+				if (listed)
+					++it;
+				if (listed ? change->delta >= 0 : change->delta > 0)
+					games.push_back(change->gnum);
+			}
+			games.insert(games.end(), it, end);
+			newOffsets[id + 1] = games.size();
+		}
+		postings.offsets = std::move(newOffsets);
+		postings.games = std::move(games);
+		postings.pending = std::vector<Change>();
+	}
+
+	template <typename TFunc>
+	static void forEachName(IndexEntry const& ie, nameT nt, TFunc fn) {
+		switch (nt) {
+		case NAME_PLAYER:
+			fn(ie.GetWhite());
+			if (ie.GetBlack() != ie.GetWhite())
+				fn(ie.GetBlack());
+			break;
+		case NAME_EVENT:
+			fn(ie.GetEvent());
+			break;
+		default:
+			ASSERT(nt == NAME_SITE);
+			fn(ie.GetSite());
+		}
+	}
+};
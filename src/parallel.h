@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/** @file
+ * Helpers for executing CPU bound tasks with multiple threads.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// Returns the number of threads that should be used for CPU bound tasks.
+inline unsigned hardwareThreads() {
+	const auto n = std::thread::hardware_concurrency();
+	return n ? n : 1;
+}
+
+/**
+ * Splits the range [0, n) into contiguous parts and invokes fn(begin, end)
+ * for each part, with a different thread. The calling thread processes the
+ * first part and the function returns when all the parts are done.
+ * @param n:       the number of elements.
+ * @param minPart: the minimum number of elements of a part; small ranges are
+ *                 processed by fewer threads (or only by the calling thread).
+ * @param fn:      the function, which must be safe to be invoked concurrently
+ *                 on different parts.
+ */
+template <typename TFunc>
+void parallelFor(size_t n, size_t minPart, TFunc fn) {
+	const auto nParts = std::clamp<size_t>(n / std::max<size_t>(minPart, 1),
+	                                       1, hardwareThreads());
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < nParts; ++i) {
+		workers.emplace_back(fn, n * i / nParts, n * (i + 1) / nParts);
+	}
+	fn(size_t(0), n / nParts);
+	for (auto& th : workers) {
+		th.join();
+	}
+}
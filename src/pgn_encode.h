@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace pgn {
 
@@ -185,6 +186,69 @@ static void encode_comment(std::string_view comment, TCont& dest) {
 	dest.push_back('\0');
 }
 
+// Append the movetext section to a container, according to the PGN standard.
+// The moves, NAGs, comments and variations must be added in the PGN order.
+template <typename TCont, int hard_len = 0> class MovetextWriter {
+	TCont& dest_;
+	std::vector<long long> ply_;
+	typename TCont::size_type move_end_;
+
+public:
+	// @param initial_ply: the ply of the initial position.
+	//                     Should be even if it is white turn to move.
+	// @param dest: the container where movetext section will be appended.
+	MovetextWriter(long long initial_ply, TCont& dest)
+	    : dest_(dest), ply_{initial_ply}, move_end_(dest.size()) {
+		dest_.push_back('\n');
+	}
+
+	void comment(std::string_view comment) {
+		if (!comment.empty())
+			encode_comment<hard_len>(comment, dest_);
+	}
+
+	void move(std::string_view san) {
+		auto white_to_move = (ply_.back() % 2) == 0;
+		if (white_to_move || move_end_ != dest_.size()) {
+			auto move_number = std::to_string(ply_.back() / 2 + 1);
+			move_number.append(white_to_move ? 1 : 3, '.');
+			dest_.insert(dest_.end(), move_number.begin(), move_number.end());
+		}
+		dest_.insert(dest_.end(), san.begin(), san.end());
+		dest_.push_back('\0');
+		move_end_ = dest_.size();
+		ply_.back()++;
+	}
+
+	void nag(int nag) {
+		dest_.push_back('$');
+		auto nag_str = std::to_string(nag);
+		dest_.insert(dest_.end(), nag_str.begin(), nag_str.end());
+		dest_.push_back('\0');
+	}
+
+	// Start a variation that replaces the last move.
+	void startVariation() {
+		ply_.push_back(ply_.back() - 1);
+		dest_.push_back('(');
+	}
+
+	void endVariation() {
+		ply_.pop_back();
+		if (dest_.back() == '\0') {
+			dest_.back() = ')';
+		} else {
+			dest_.push_back(')');
+		}
+		dest_.push_back('\0');
+	}
+
+	void finish() {
+		if (dest_.back() == '\0')
+			dest_.back() = '\n';
+	}
+};
+
 // Encode the movetext section according to the PGN standard.
 // @param m: iterator to the list of moves.
 // @param initial_ply: the ply of the initial position.
@@ -192,58 +256,29 @@ static void encode_comment(std::string_view comment, TCont& dest) {
 // @param dest: the container where movetext section will be appended.
 template <int hard_len = 0, typename Iter, typename TCont>
 void encode_movetext(Iter m, long long initial_ply, TCont& dest) {
-	std::vector<long long> ply = {initial_ply};
-	auto move_end = dest.size();
-	dest.push_back('\n');
+	MovetextWriter<TCont, hard_len> writer(initial_ply, dest);
 
 	// Check if there is a pre-game comment
-	if (!m->comment.empty())
-		encode_comment<hard_len>(m->comment, dest);
+	writer.comment(m->comment);
 
 	while ((m = m->nextMoveInPGN())) {
 		if (m->startMarker()) {
-			ply.push_back(ply.back() - 1);
-			dest.push_back('(');
-			if (!m->comment.empty())
-				encode_comment<hard_len>(m->comment, dest);
+			writer.startVariation();
+			writer.comment(m->comment);
 
 		} else if (m->endMarker()) {
-			if (m->nextMoveInPGN()) {
-				ply.pop_back();
-				if (dest.back() == '\0') {
-					dest.back() = ')';
-				} else {
-					dest.push_back(')');
-				}
-				dest.push_back('\0');
-			}
+			if (m->nextMoveInPGN())
+				writer.endVariation();
 
 		} else {
-			auto white_to_move = (ply.back() % 2) == 0;
-			if (white_to_move || move_end != dest.size()) {
-				auto move_number = std::to_string(ply.back() / 2 + 1);
-				move_number.append(white_to_move ? 1 : 3, '.');
-				dest.insert(dest.end(), move_number.begin(), move_number.end());
-			}
-			std::string_view san = m->san;
-			dest.insert(dest.end(), san.begin(), san.end());
-			dest.push_back('\0');
-			move_end = dest.size();
-			ply.back()++;
-
+			writer.move(m->san);
 			for (int i = 0, n = m->nagCount; i < n; ++i) {
-				dest.push_back('$');
-				auto nag_str = std::to_string(m->nags[i]);
-				dest.insert(dest.end(), nag_str.begin(), nag_str.end());
-				dest.push_back('\0');
+				writer.nag(m->nags[i]);
 			}
-			if (!m->comment.empty())
-				encode_comment<hard_len>(m->comment, dest);
+			writer.comment(m->comment);
 		}
 	}
-
-	if (dest.back() == '\0')
-		dest.back() = '\n';
+	writer.finish();
 }
 
 // Encode a game according to the PGN standard.
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the MultiPatternMatcher and PgnTextFilter classes.
+ */
+
+#pragma once
+
+#include "bytebuf.h"
+#include "common.h"
+#include "game.h"
+#include "indexentry.h"
+#include "misc.h"
+#include "namebase.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Aho-Corasick automaton that finds all the occurrences of a set of patterns
+/// with a single pass over the text.
+class MultiPatternMatcher {
+	std::vector<std::array<uint32_t, 256>> next_;
+	std::vector<std::vector<size_t>> out_;
+
+public:
+	/// @param patterns: the (not empty) strings to search.
+	explicit MultiPatternMatcher(std::vector<std::string_view> const& patterns) {
+		constexpr auto NONE = UINT32_MAX;
+		next_.emplace_back().fill(NONE);
+		out_.emplace_back();
+		for (size_t i = 0; i < patterns.size(); ++i) {
+			ASSERT(!patterns[i].empty());
+			uint32_t state = 0;
+			for (unsigned char ch : patterns[i]) {
+				if (next_[state][ch] == NONE) {
+					next_[state][ch] = static_cast<uint32_t>(next_.size());
+					next_.emplace_back().fill(NONE);
+					out_.emplace_back();
+				}
+				state = next_[state][ch];
+			}
+			out_[state].push_back(i);
+		}
+
+		// Breadth-first visit: the failure links point to shallower states
+		// whose transitions are already complete.
+		std::vector<uint32_t> fail(next_.size(), 0);
+		std::vector<uint32_t> queue;
+		for (auto& state : next_[0]) {
+			if (state == NONE) {
+				state = 0;
+			} else {
+				queue.push_back(state);
+			}
+		}
+		for (size_t i = 0; i < queue.size(); ++i) {
+			const auto state = queue[i];
+			for (size_t ch = 0; ch < 256; ++ch) {
+				const auto fallback = next_[fail[state]][ch];
+				auto& dest = next_[state][ch];
+				if (dest == NONE) {
+					dest = fallback;
+				} else {
+					fail[dest] = fallback;
+					auto const& inherited = out_[fallback];
+					out_[dest].insert(out_[dest].end(), inherited.begin(),
+					                  inherited.end());
+					queue.push_back(dest);
+				}
+			}
+		}
+	}
+
+	/// Invokes @e fn with the index of the pattern for each occurrence found
+	/// in @e text. The search stops if @e fn returns false.
+	/// @returns false if the search was stopped.
+	template <typename TFunc>
+	bool find(std::string_view text, TFunc fn) const {
+		uint32_t state = 0;
+		for (unsigned char ch : text) {
+			state = next_[state][ch];
+			for (auto idx : out_[state]) {
+				if (!fn(idx))
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Search text in the PGN representation of the games, without creating it.
+// -----------------------------------------------------------------------------
+//
+// The games are searched in PGN_FORMAT_Plain with the tags, comments,
+// variations and NAG symbols styles, and a game matches if its PGN contains
+// all the terms (case-sensitive).
+// In that PGN text a term without spaces, newlines and the delimiters
+// { } [ ] " can only occur inside a single:
+// - comment
+// - tag name or tag value
+// - move number, SAN move, NAG symbol, parenthesis or result.
+// The comments and the non-standard tags are stored in the game's data, and
+// the values of the standard tags in the IndexEntry and the NameBase: the
+// terms that cannot be part of the tag names and of the movetext can
+// be searched in place, with a single pass over those strings.
+// If one of those terms is not found, the PGN does not contain it and the
+// game can be rejected; otherwise the game should be verified with match().
+class PgnTextFilter {
+	std::vector<std::string> terms_;
+	std::vector<std::string_view> searchable_;
+	MultiPatternMatcher matcher_;
+
+public:
+	explicit PgnTextFilter(std::vector<std::string> terms)
+	    : terms_(std::move(terms)), searchable_(searchable(terms_)),
+	      matcher_(searchable_) {}
+	PgnTextFilter(PgnTextFilter const&) = delete;
+	PgnTextFilter& operator=(PgnTextFilter const&) = delete;
+
+	/// Returns false if the PGN of the game cannot contain all the terms.
+	/// @param data: the data of the game (encoded in native format).
+	/// @param ie:   the IndexEntry of the game.
+	/// @param nb:   the NameBase with the names of the game.
+	bool mayMatch(ByteBuffer data, IndexEntry const& ie,
+	              NameBase const& nb) const {
+		const auto nTerms = searchable_.size();
+		if (nTerms == 0)
+			return true;
+
+		std::vector<bool> found(nTerms, false);
+		size_t nFound = 0;
+		auto scan = [&](std::string_view text) {
+			return matcher_.find(text, [&](size_t idx) {
+				if (!found[idx]) {
+					found[idx] = true;
+					++nFound;
+				}
+				return nFound != nTerms;
+			});
+		};
+
+		ecoStringT eco;
+		eco_ToExtendedString(ie.GetEcoCode(), eco);
+		if (!scan(nb.GetName(NAME_EVENT, ie.GetEvent())) ||
+		    !scan(nb.GetName(NAME_SITE, ie.GetSite())) ||
+		    !scan(nb.GetName(NAME_ROUND, ie.GetRound())) ||
+		    !scan(nb.GetName(NAME_PLAYER, ie.GetWhite())) ||
+		    !scan(nb.GetName(NAME_PLAYER, ie.GetBlack())) || !scan(eco))
+			return true;
+
+		// If the data is corrupted, leave the decision to match()
+		auto err = data.decodeTags([&](auto const& tag, auto const& value) {
+			if (nFound != nTerms && scan(tag))
+				scan(value);
+		});
+		if (err || nFound == nTerms)
+			return true;
+
+		// The FEN of a non-standard start position is not searched
+		if (auto [errBoard, fen] = data.decodeStartBoard(); errBoard || fen)
+			return true;
+
+		err = data.skipMoves([](auto) {});
+		if (!err) {
+			err = data.decodeComments([&](std::string_view comment) {
+				if (nFound != nTerms)
+					scan(comment);
+			});
+		}
+		return err || nFound == nTerms;
+	}
+
+	/// Returns true if @e pgn contains all the terms.
+	bool match(std::string_view pgn) const {
+		return std::all_of(terms_.begin(), terms_.end(), [&](auto const& term) {
+			return pgn.find(term) != pgn.npos;
+		});
+	}
+
+private:
+	/// Returns the terms that can be searched in place.
+	static std::vector<std::string_view>
+	searchable(std::vector<std::string> const& terms) {
+		// The chars used for the move numbers, the SAN moves, the dates, the
+		// Elo ratings, the results and the "$N" NAGs.
+		std::string movetext = "0123456789.?!()/*$-=+#xOabcdefgh";
+		for (char piece : {'K', 'Q', 'R', 'B', 'N', 'P'}) {
+			movetext.push_back(piece);
+			movetext.push_back(transPiecesChar(piece));
+		}
+
+		// Tag names and values, and NAG symbols, that are not searched.
+		std::vector<std::string> words = {
+		    "Event", "Site",    "Date",     "Round",     "White",
+		    "Black", "Result",  "ECO",      "EventDate", "FEN",
+		    "Variant", "Chess960"};
+		for (auto rType = ratingTypeNames; *rType; ++rType) {
+			words.emplace_back(std::string("White") + *rType);
+			words.emplace_back(std::string("Black") + *rType);
+		}
+		for (unsigned nag = 1; nag < 256; ++nag) {
+			char buf[32];
+			game_printNag(static_cast<byte>(nag), buf, true, PGN_FORMAT_Plain);
+			if (*buf == '!' || *buf == '?') {
+				// Printed next to the move
+				movetext.append(buf);
+			} else {
+				std::string_view symbol = buf;
+				while (!symbol.empty()) {
+					const auto space = std::min(symbol.find(' '), symbol.size());
+					words.emplace_back(symbol.substr(0, space));
+					symbol.remove_prefix(std::min(space + 1, symbol.size()));
+				}
+			}
+		}
+
+		std::vector<std::string_view> res;
+		for (auto const& term : terms) {
+			if (term.empty() ||
+			    term.find_first_of(" \n{}[]\"") != term.npos ||
+			    term.find_first_not_of(movetext) == term.npos ||
+			    std::any_of(words.begin(), words.end(), [&](auto const& word) {
+				    return word.find(term) != word.npos;
+			    }))
+				continue;
+
+			res.emplace_back(term);
+		}
+		return res;
+	}
+};
@@ -13,7 +13,6 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "position.h"
-#include "attacks.h"
 #include "common.h"
 #include "dstring.h"
 #include "hash.h"
@@ -69,11 +68,8 @@ Position::AddToBoard (pieceT p, squareT sq)
 {
     ASSERT (Board[sq] == EMPTY);
     Board[sq] = p;
-    NumOnRank[p][square_Rank(sq)]++;
-    NumOnFyle[p][square_Fyle(sq)]++;
-    NumOnLeftDiag[p][square_LeftDiag(sq)]++;
-    NumOnRightDiag[p][square_RightDiag(sq)]++;
-    NumOnSquareColor[p][square_Color(sq)]++;
+    pieceBB_[p] |= bitboard::square_bb(sq);
+    colorBB_[piece_Color_NotEmpty(p)] |= bitboard::square_bb(sq);
     AddHash (p, sq);
 }
 
@@ -82,11 +78,8 @@ Position::RemoveFromBoard (pieceT p, squareT sq)
 {
     ASSERT (Board[sq] == p);
     Board[sq] = EMPTY;
-    NumOnRank[p][square_Rank(sq)]--;
-    NumOnFyle[p][square_Fyle(sq)]--;
-    NumOnLeftDiag[p][square_LeftDiag(sq)]--;
-    NumOnRightDiag[p][square_RightDiag(sq)]--;
-    NumOnSquareColor[p][square_Color(sq)]--;
+    pieceBB_[p] &= ~bitboard::square_bb(sq);
+    colorBB_[piece_Color_NotEmpty(p)] &= ~bitboard::square_bb(sq);
     UnHash (p, sq);
 }
 
@@ -127,51 +120,48 @@ struct sqDir_Init
 //  PRIVATE FUNCTIONS -- small ones are inline for speed
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::CalcPinsDir():
-//      Look for a pinned piece in the direction 'dir' relative to
-//      the position of the king to move.
+// Position::attackers():
+//      Return the pieces of both sides that attack the square sq,
+//      when the occupied squares are the ones specified.
+//      The pieces that are not in occupied are not excluded.
 //
-inline void
-Position::CalcPinsDir (directionT dir, pieceT attacker)
+bitboard::Bitboard
+Position::attackers (squareT sq, bitboard::Bitboard occupied) const
 {
-    // Two pieces can pin along any path. A queen is always one,
-    // the other is a bishop or rook. To save calculating it here, the
-    // appropriate piece (BISHOP) or (ROOK) is passed along with the
-    // direction.
-
-    squareT king = GetKingSquare (ToMove);
-    squareT friendly = NULL_SQUARE;
-    squareT x = king;
-    squareT last = square_Last (king, dir);
-    int delta = direction_Delta (dir);
-
-    while (x != last) {
-        x += delta;
-        pieceT p = Board[x];
-        if (p == EMPTY) {
-            // Empty square, so keep searching.
-        } else if (piece_Color_NotEmpty(p) == ToMove) {
-            // Found a friendly piece.
-            if (friendly == NULL_SQUARE) {
-                // Found first friendly in this direction
-                friendly = x;
-            } else {
-                // Found second friendly in this direction, so stop.
-                return;
-            }
-        } else {
-            // Found an enemy piece
-            if (friendly != NULL_SQUARE) {
-                // Potential pin:
-                pieceT ptype = piece_Type(p);
-                if (ptype == QUEEN  ||  ptype == attacker) {
-                    Pinned[ListPos[friendly]] = dir;
-                }
-            }
-            return;     // found an enemy piece, so end search
+    const auto& tbl = bitboard::tables();
+    const auto queens = pieceBB_[WQ] | pieceBB_[BQ];
+    return (tbl.pawn(BLACK, sq) & pieceBB_[WP])
+         | (tbl.pawn(WHITE, sq) & pieceBB_[BP])
+         | (tbl.knight(sq) & (pieceBB_[WN] | pieceBB_[BN]))
+         | (tbl.king(sq) & (pieceBB_[WK] | pieceBB_[BK]))
+         | (tbl.rook(sq, occupied) & (pieceBB_[WR] | pieceBB_[BR] | queens))
+         | (tbl.bishop(sq, occupied) & (pieceBB_[WB] | pieceBB_[BB] | queens));
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Position::pinned():
+//      Return the pieces of the side to move that are pinned to
+//      their king, on square kingSq, by an enemy queen, rook or bishop.
+//
+bitboard::Bitboard
+Position::pinned (squareT kingSq) const
+{
+    const auto& tbl = bitboard::tables();
+    const colorT enemy = color_Flip(ToMove);
+    const auto queens = pieceBB_[piece_Make(enemy, QUEEN)];
+    auto snipers =
+        (tbl.rook(kingSq, 0) & (pieceBB_[piece_Make(enemy, ROOK)] | queens))
+      | (tbl.bishop(kingSq, 0) & (pieceBB_[piece_Make(enemy, BISHOP)] | queens));
+    const auto occupied = occupiedBB();
+    bitboard::Bitboard res = 0;
+    while (snipers) {
+        const auto sq = bitboard::pop_lsb(snipers);
+        const auto blockers = tbl.between(kingSq, sq) & occupied;
+        if (blockers && !bitboard::more_than_one(blockers)) {
+            res |= blockers & colorBB_[ToMove];
         }
     }
-    return;
+    return res;
 }
 
 
@@ -188,99 +178,20 @@ Position::AddLegalMove (MoveList * mlist, squareT from, squareT to, pieceT promo
 }
 
 
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::GenSliderMoves():
-//      Generate slider moves along a direction, for a sliding
-//      piece of the specified color from the specified square.
-//      If sqset != NULL, moves must be to a square in sqset.
-inline void
-Position::GenSliderMoves (MoveList * mlist, colorT color, squareT fromSq,
-                          directionT dir, SquareSet * sqset, bool capturesOnly)
-{
-    squareT dest = fromSq;
-    squareT last = square_Last (fromSq, dir);
-    int delta = direction_Delta (dir);
-
-    while (dest != last) {
-        dest += delta;
-        pieceT p = Board[dest];
-        if (p == EMPTY) {
-            if (! capturesOnly) {
-                if (sqset == NULL  ||  sqset->Contains(dest)) {
-                    AddLegalMove (mlist, fromSq, dest, EMPTY);
-                }
-            }
-            continue;
-        }
-        // We have reached a piece. Add the capture if it is an enemy.
-        if (piece_Color_NotEmpty(p) != color) {
-            if (sqset == NULL  ||  sqset->Contains(dest)) {
-                AddLegalMove (mlist, fromSq, dest, EMPTY);
-            }
-        }
-        break;
-    }
-}
-
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::GenKnightMoves():
-//      Generate knight moves.
-//      If sqset != NULL, moves must be to a square in sqset.
-inline void
-Position::GenKnightMoves (MoveList * mlist, colorT c, squareT fromSq,
-                          SquareSet * sqset, bool capturesOnly)
-{
-    const squareT * destPtr = knightAttacks[fromSq];
-    while (true) {
-        squareT dest = *destPtr;
-        if (dest == NULL_SQUARE) { break; }
-        destPtr++;
-        pieceT p = Board[dest];
-        if (capturesOnly  &&  p == EMPTY) { continue; }
-        if (piece_Color(p) != c) {
-            if (sqset == NULL  ||  sqset->Contains(dest)) {
-                AddLegalMove (mlist, fromSq, dest, EMPTY);
-            }
-        }
-    }
-}
-
-template <typename TFunc>
+// Return true if the square target_sq is attacked by the enemy, when the
+// occupied squares are the ones specified. The piece on captured_sq, if any,
+// is ignored.
 bool Position::under_attack(squareT target_sq, squareT captured_sq,
-                            TFunc not_empty) const {
-	const auto enemy = color_Flip(GetToMove());
-	const auto lpawn_atk = square_Move(target_sq,
-	                                   enemy == WHITE ? DOWN_LEFT : UP_LEFT);
-	const auto rpawn_atk = square_Move(target_sq,
-	                                   enemy == WHITE ? DOWN_RIGHT : UP_RIGHT);
-	const auto enemy_pieces = GetList(enemy);
-	for (size_t i = 1, n = GetCount(enemy); i < n; ++i) {
-		const auto piece_sq = enemy_pieces[i];
-		if (piece_sq == captured_sq)
-			continue;
-
-		const auto piece_type = piece_Type(GetPiece(piece_sq));
-		if (piece_type == KNIGHT) {
-			if (movegen::valid_knight(piece_sq, target_sq))
-				return true; // Knight check
-
-		} else if (piece_type == PAWN) {
-			if (piece_sq == lpawn_atk || piece_sq == rpawn_atk)
-				return true; // Pawn check
-
-		} else {
-			if (movegen::attack_slider(piece_sq, target_sq, piece_type,
-			                           not_empty))
-				return true; // Slider check
-		}
-	}
-	assert(GetCount(enemy) >= 1);
-	return movegen::valid_king(enemy_pieces[0], target_sq);
+                            bitboard::Bitboard occupied) const {
+	const auto enemy = colorBB_[color_Flip(GetToMove())];
+	auto atk = attackers(target_sq, occupied) & enemy;
+	if (captured_sq < 64)
+		atk &= ~bitboard::square_bb(captured_sq);
+	return atk != 0;
 }
 
 bool Position::under_attack(squareT target_sq) const {
-	return under_attack(target_sq, target_sq,
-	                    [&](auto sq) { return GetPiece(sq) != EMPTY; });
+	return under_attack(target_sq, target_sq, occupiedBB());
 }
 
 // Sanity checks for castling flags.
@@ -359,44 +270,19 @@ void Position::GenCastling(MoveList* mlist) {
 void
 Position::GenKingMoves (MoveList * mlist, genMovesT genType)
 {
-    squareT kingSq = GetKingSquare();
-    squareT enemyKingSq = GetEnemyKingSquare();
-    colorT enemy = color_Flip(ToMove);
-    const squareT * destPtr;
-    pieceT king = piece_Make (ToMove, KING);
-    bool genNonCaptures = (genType & GEN_NON_CAPS);
-
-    ASSERT (Board[kingSq] == king);
-
-    destPtr = kingAttacks[kingSq];
-    while (*destPtr != NULL_SQUARE) {
-        // Try this move and see if it legal:
-
-        squareT destSq = *destPtr;
-        bool addThisMove = false;
-
-        // Only try this move if the target square has an enemy piece,
-        // or if it is empty and noncaptures are to be generated:
-        if ( (genNonCaptures  &&  Board[destSq] == EMPTY)
-             ||  piece_Color (Board[destSq]) == enemy) {
-
-            // Empty or enemy piece there, so try the move:
-            pieceT captured = Board[destSq];
-            Board[destSq] = king;
-            Board[kingSq] = EMPTY;
-
-            // It is legal if the two kings will not be adjacent and the
-            // moving king will not be in check on its new square:
-            if (! square_Adjacent (destSq, enemyKingSq)) {
-                if (CalcNumChecks (destSq) == 0) {
-                    addThisMove = true;
-                }
-            }
-            Board[kingSq] = king;
-            Board[destSq] = captured;
+    const squareT kingSq = GetKingSquare();
+    const colorT enemy = color_Flip(ToMove);
+    auto dests = bitboard::tables().king(kingSq) & ~colorBB_[ToMove];
+    if (! (genType & GEN_NON_CAPS)) { dests &= colorBB_[enemy]; }
+
+    // The king must not be considered when looking for slider attacks,
+    // otherwise the squares behind it would appear to be safe:
+    const auto occupied = occupiedBB() & ~bitboard::square_bb(kingSq);
+    while (dests) {
+        const squareT destSq = bitboard::pop_lsb(dests);
+        if (! (attackers(destSq, occupied) & colorBB_[enemy])) {
+            AddLegalMove (mlist, kingSq, destSq, EMPTY);
         }
-        if (addThisMove) { AddLegalMove (mlist, kingSq, destSq, EMPTY); }
-        destPtr++;
     }
 }
 
@@ -424,106 +310,42 @@ Position::AddPromotions (MoveList * mlist, squareT from, squareT dest)
 //   legal according to calculations of pinned pieces. For example,
 //   consider WK d5, WP e5, BP f5 (just moved there), BR h5 and
 //   the en passant capture exf6 would be illegal.
+//   It also verifies that the capture gets the king out of check.
 inline bool
-Position::IsValidEnPassant (squareT from, squareT to)
+Position::IsValidEnPassant (squareT from, squareT to) const
 {
     ASSERT (from <= H8  &&  to <= H8);
     ASSERT (to == EPTarget);
 
-    // Check that this en passant capture is legal:
-    pieceT ownPawn = piece_Make(ToMove, PAWN);
-    pieceT enemyPawn = piece_Make (color_Flip(ToMove), PAWN);
-    squareT enemyPawnSq = (ToMove == WHITE) ? to - 8 : to + 8;
-    ASSERT (Board[from] == ownPawn);
-    ASSERT (Board[enemyPawnSq] == enemyPawn);
-    Board[from] = EMPTY;
-
-    // PG
-    Board[to] = ownPawn;
-
-    Board[enemyPawnSq] = EMPTY;
-    bool isValid = ! IsKingInCheck();
-
-    //PG
-    Board[to] = EMPTY;
-
-    Board[from] = ownPawn;
-    Board[enemyPawnSq] = enemyPawn;
-    return isValid;
+    const squareT enemyPawnSq = (ToMove == WHITE) ? to - 8 : to + 8;
+    if (Board[enemyPawnSq] != piece_Make(color_Flip(ToMove), PAWN)) {
+        return false;
+    }
+    const auto occupied = (occupiedBB() ^ bitboard::square_bb(from)
+                           ^ bitboard::square_bb(enemyPawnSq))
+                        | bitboard::square_bb(to);
+    return ! under_attack(GetKingSquare(), enemyPawnSq, occupied);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Position::GenPawnMoves():
-//      Generate legal pawn moves.
-//      If dir != NULL_DIR, pawn MUST move in direction dir or its opposite.
-//      If sqset != NULL, pawn MUST move to a square in sqset.
-//      The dir and sq parameters are for pinned pawns and check evasions.
-void
-Position::GenPawnMoves (MoveList * mlist, squareT from,
-                        directionT dir, SquareSet * sqset, genMovesT genType)
+//      Return the destination squares of the pawn on square from,
+//      excluding the en passant capture.
+//      Checks and pinned pawns must be handled by the caller.
+bitboard::Bitboard
+Position::GenPawnMoves (squareT from, genMovesT genType) const
 {
-    bool genNonCaptures = (genType & GEN_NON_CAPS);
-    directionT oppdir = direction_Opposite(dir);
-    directionT forward;
-    rankT promoRank;
-    rankT secondRank;
-    if (ToMove == WHITE) {
-        forward = UP;    promoRank = RANK_8;  secondRank = RANK_2;
-    } else  {
-        forward = DOWN;  promoRank = RANK_1;  secondRank = RANK_7;
-    }
-    squareT dest;
-
-    ASSERT (Board[from] == piece_Make (ToMove, PAWN));
-
-    if (genNonCaptures
-          &&  (dir == NULL_DIR  ||  dir == forward  ||  oppdir == forward)) {
-        dest = square_Move (from, forward);
-        if (Board[dest]==EMPTY && (sqset==NULL || sqset->Contains(dest))) {
-            if (square_Rank(dest) == promoRank) {
-                AddPromotions (mlist, from, dest);
-            } else {
-                AddLegalMove (mlist, from, dest, EMPTY);
-            }
-        }
-        if (square_Rank(from) == secondRank  &&  Board[dest] == EMPTY) {
-            dest = square_Move (dest, forward);
-            if (Board[dest]==EMPTY  &&  (sqset==NULL || sqset->Contains(dest))) {
-                AddLegalMove (mlist, from, dest, EMPTY);
-            }
+    const auto& tbl = bitboard::tables();
+    auto dests = tbl.pawn(ToMove, from) & colorBB_[color_Flip(ToMove)];
+    if (genType & GEN_NON_CAPS) {
+        const auto empty = ~occupiedBB();
+        auto push = bitboard::pawn_push(ToMove, bitboard::square_bb(from)) & empty;
+        dests |= push;
+        if (square_Rank(from) == rank_Relative(ToMove, RANK_2)) {
+            dests |= bitboard::pawn_push(ToMove, push) & empty;
         }
     }
-
-    // Now do captures: left, then right
-    // To be a possible capture, dest square must be EPTarget or hold
-    // an enemy piece.
-#define POSSIBLE_CAPTURE(d) ((d != NULL_SQUARE)   \
-            &&  ((piece_Color (Board[d]) == (color_Flip(ToMove)))  \
-                    ||  (d == EPTarget  &&  IsValidEnPassant(from,d))))
-
-    directionT capdir = forward | LEFT;
-    if (dir == NULL_DIR  ||  dir == capdir  ||  oppdir == capdir) {
-        dest = square_Move (from, capdir);
-        if (POSSIBLE_CAPTURE(dest)  &&  (sqset==NULL || sqset->Contains(dest))) {
-            if (square_Rank(dest) == promoRank) {
-                AddPromotions (mlist, from, dest);
-            } else {
-                AddLegalMove (mlist, from, dest, EMPTY);
-            }
-        }
-    }
-    capdir = forward | RIGHT;
-    if (dir == NULL_DIR  ||  dir == capdir  ||  oppdir == capdir) {
-        dest = square_Move (from, capdir);
-        if (POSSIBLE_CAPTURE(dest)  &&  (sqset==NULL || sqset->Contains(dest))) {
-            if (square_Rank(dest) == promoRank) {
-                AddPromotions (mlist, from, dest);
-            } else {
-                AddLegalMove (mlist, from, dest, EMPTY);
-            }
-        }
-    }
-    return;
+    return dests;
 }
 
 
@@ -578,14 +400,9 @@ Position::Clear (void)
     for (i=A1; i <= H8; i++) { Board[i] = EMPTY; }
     for (i=WK; i <= BP; i++) {
         Material[i] = 0;
-        for (uint j=0; j < 8; j++) {
-            NumOnRank[i][j] = NumOnFyle[i][j] = 0;
-        }
-        for (uint d=0; d < 15; d++) {
-            NumOnLeftDiag[i][d] = NumOnRightDiag[i][d] = 0;
-        }
-        NumOnSquareColor[i][WHITE] = NumOnSquareColor[i][BLACK] = 0;
     }
+    std::fill_n(pieceBB_, 16, 0);
+    colorBB_[WHITE] = colorBB_[BLACK] = 0;
     Count[WHITE] = Count[BLACK] = 0;
     EPTarget = NULL_SQUARE;
     Castling = 0;
@@ -634,16 +451,13 @@ void Position::setCastling(colorT col, squareT rsq) {
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Position::StdStart():
 //      Set up the standard chess starting position. For performance the data is copied from a 
-//      template.
+//      template, which is initialized in a thread-safe way on first use.
 //
 const Position& Position::getStdStart()
 {
-    static Position startPositionTemplate;
-    static bool init = true;
-
-    if (init){
-        init = false;
-        Position* p = &startPositionTemplate;
+    static const Position startPositionTemplate = [] {
+        Position stdStart;
+        Position* p = &stdStart;
         p->Clear();
         p->Material[WK] = p->Material[BK] = 1;
         p->Material[WQ] = p->Material[BQ] = 1;
@@ -686,7 +500,8 @@ const Position& Position::getStdStart()
         p->Board [NULL_SQUARE] = END_OF_BOARD;
         p->Hash = stdStartHash;
         p->PawnHash = stdStartPawnHash;
-    }
+        return stdStart;
+    }();
     return startPositionTemplate;
 }
 
@@ -744,171 +559,78 @@ Position::AddPiece (pieceT p, squareT sq)
 }
 
 
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::CalcPins():
-//      Calculate the pieces for the side to move that are
-//      pinned to their king. The array Pinned[] stores, for
-//      each piece, the direction in which it is pinned.
-//
-//      For example WK on e1, WQ on e2, BQ on e7 on the e-fyle
-//      means the WQ is Pinned in the direction UP.
-//
-void
-Position::CalcPins (void)
-{
-    Pinned[ 0] = Pinned[ 1] = Pinned[ 2] = Pinned[ 3] = Pinned[ 4] =
-    Pinned[ 5] = Pinned[ 6] = Pinned[ 7] = Pinned[ 8] = Pinned[ 9] =
-    Pinned[10] = Pinned[11] = Pinned[12] = Pinned[13] = Pinned[14] =
-    Pinned[15] = NULL_DIR;
-
-    squareT kingSq = GetKingSquare (ToMove);
-    colorT enemy = color_Flip (ToMove);
-    pieceT enemyQueen  = piece_Make (enemy, QUEEN);
-    pieceT enemyRook   = piece_Make (enemy, ROOK);
-    pieceT enemyBishop = piece_Make (enemy, BISHOP);
-
-    // Pins and checks from Bishops/Queens/Rooks:
-    fyleT fyle = square_Fyle (kingSq);
-    if (FyleCount(enemyQueen,fyle) + FyleCount(enemyRook,fyle) > 0) {
-        CalcPinsDir (UP, ROOK);
-        CalcPinsDir (DOWN, ROOK);
-    }
-    rankT rank = square_Rank (kingSq);
-    if (RankCount(enemyQueen,rank) + RankCount(enemyRook,rank) > 0) {
-        CalcPinsDir (LEFT, ROOK);
-        CalcPinsDir (RIGHT, ROOK);
-    }
-    leftDiagT ld = square_LeftDiag (kingSq);
-    if (LeftDiagCount(enemyQueen,ld) + LeftDiagCount(enemyBishop,ld) > 0) {
-        CalcPinsDir (UP_LEFT, BISHOP);
-        CalcPinsDir (DOWN_RIGHT, BISHOP);
-    }
-    rightDiagT rd = square_RightDiag (kingSq);
-    if (RightDiagCount(enemyQueen,rd) + RightDiagCount(enemyBishop,rd) > 0) {
-        CalcPinsDir (UP_RIGHT, BISHOP);
-        CalcPinsDir (DOWN_LEFT, BISHOP);
-    }
-}
-
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::GenPieceMoves():
-//      Generates moves for a nonpawn, nonking piece.
-//      If sqset != NULL, moves must be to a square in sqset.<
-void
-Position::GenPieceMoves (MoveList * mlist, squareT fromSq,
-                         SquareSet * sqset, bool capturesOnly)
-{
-    colorT c = ToMove;
-    pieceT p = Board[fromSq];
-    pieceT ptype = piece_Type(p);
-    ASSERT (p != EMPTY  &&  ptype != KING  &&  ptype != PAWN);
-
-    if (ptype == KNIGHT) {
-        GenKnightMoves (mlist, c, fromSq, sqset, capturesOnly);
-        return;
-    }
-    if (ptype != BISHOP) {
-        GenSliderMoves (mlist, c, fromSq, UP, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, DOWN, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, LEFT, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, RIGHT, sqset, capturesOnly);
-    }
-    if (ptype != ROOK) {
-        GenSliderMoves (mlist, c, fromSq, UP_LEFT, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, DOWN_LEFT, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, UP_RIGHT, sqset, capturesOnly);
-        GenSliderMoves (mlist, c, fromSq, DOWN_RIGHT, sqset, capturesOnly);
-    }
-}
-
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Position::GenerateMoves
 //    Generate the legal moves list.
 //    If the specified pieceType is not EMPTY, then only legal
 //    moves for that type of piece are generated.
+//    The pieces are processed in the order of List[], and the
+//    King moves are generated last of all.
 void
 Position::GenerateMoves (MoveList* mlist, pieceT pieceType,
                          genMovesT genType, bool maybeInCheck)
 {
     ASSERT(mlist != NULL);
-
-    bool genNonCaptures = (genType & GEN_NON_CAPS);
-    bool capturesOnly = !genNonCaptures;
-
-    uint mask = 0;
-    if (pieceType != EMPTY) {
-        mask = 1 << pieceType;
-    } else {
-        mask = (1 << KING) | (1 << QUEEN) | (1 << ROOK)
-             | (1 << BISHOP) | (1 << KNIGHT) | (1 << PAWN);
-    }
-
-    // Use the objects own move list if none was provided:
     mlist->Clear();
 
-    // Compute which pieces of the side to move are pinned to the king:
-    CalcPins();
+    const auto& tbl = bitboard::tables();
+    const colorT enemy = color_Flip(ToMove);
+    const squareT kingSq = GetKingSquare();
+    const auto occupied = occupiedBB();
 
     // Determine if the side to move is in check and find where the
     // checking pieces are, unless the caller has passed maybeInCheck=false
     // indicating it is CERTAIN the side to move is not in check here.
-
-    uint numChecks = 0;
-    if (maybeInCheck) {
-        SquareList checkSquares;
-        numChecks = CalcNumChecks (GetKingSquare(ToMove), &checkSquares);
-        if (numChecks > 0) {
-            // The side to move IS in check:
-            GenCheckEvasions (mlist, pieceType, genType, &checkSquares);
-            return;
-        }
-    }
-
-    // The side to move is NOT in check. Iterate over each non-king
-    // piece, and then generate King moves last of all:
-
-    uint npieces = Count[ToMove];
-    for (uint x = 1; x < npieces; x++) {
-        squareT sq = List[ToMove][x];
-        pieceT p = Board[sq];
-        pieceT ptype = piece_Type(p);
-        if (! (mask & (1 << ptype))) { continue; }
-        directionT pinned = Pinned[x];
-
-        // If Pinned[x] == dir (not NULL_DIR), x can ONLY move along
-        // that direction or its opposite.
-
-        if (pinned != NULL_DIR) {  // piece x is pinned to king
-            if (ptype == PAWN) {
-                GenPawnMoves (mlist, sq, pinned, NULL, genType);
-            } else if (ptype == KNIGHT) {
-                // do nothing -- pinned knights cannot move
-            } else {
-                // Piece is a pinned Queen/Rook/Bishop. Only generate
-                // moves along the pinned direction and its opposite:
-                if (ptype == QUEEN
-                      || (ptype == ROOK && !direction_IsDiagonal(pinned))
-                      || (ptype == BISHOP && direction_IsDiagonal(pinned))) {
-                    GenSliderMoves (mlist, ToMove, sq, pinned, NULL, capturesOnly);
-                    GenSliderMoves (mlist, ToMove, sq, dirOpposite[pinned],
-                                    NULL, capturesOnly);
+    const auto checkers =
+        maybeInCheck ? attackers(kingSq, occupied) & colorBB_[enemy] : 0;
+
+    // The destination squares of the non-king pieces: when in check they
+    // must capture the attacker or block it. If it's double check, we can
+    // ONLY move the king.
+    auto targets = ~colorBB_[ToMove];
+    if (! (genType & GEN_NON_CAPS)) { targets &= colorBB_[enemy]; }
+    if (checkers) {
+        targets &= bitboard::more_than_one(checkers)
+                       ? 0
+                       : checkers | tbl.between(kingSq, bitboard::lsb(checkers));
+    }
+
+    if (targets) {
+        const auto pinnedPieces = pinned(kingSq);
+        for (uint x = 1, npieces = Count[ToMove]; x < npieces; x++) {
+            const squareT sq = List[ToMove][x];
+            const pieceT ptype = piece_Type(Board[sq]);
+            if (pieceType != EMPTY  &&  ptype != pieceType) { continue; }
+
+            auto dests = (ptype == PAWN) ? GenPawnMoves(sq, genType)
+                                         : tbl.attacks(ptype, sq, occupied);
+            dests &= targets;
+            // A pinned piece can ONLY move along the direction of the pin:
+            if (pinnedPieces & bitboard::square_bb(sq)) {
+                dests &= tbl.line(kingSq, sq);
+            }
+            while (dests) {
+                const squareT dest = bitboard::pop_lsb(dests);
+                if (ptype == PAWN
+                      && (square_Rank(dest) == RANK_1
+                          || square_Rank(dest) == RANK_8)) {
+                    AddPromotions (mlist, sq, dest);
+                } else {
+                    AddLegalMove (mlist, sq, dest, EMPTY);
                 }
             }
-        } else {
-            // This piece is free to move anywhere
-            if (ptype == PAWN) {
-                GenPawnMoves (mlist, sq, NULL_DIR, NULL, genType);
-            } else {
-                // Knight/Queen/Bishop/Rook:
-                GenPieceMoves (mlist, sq, NULL, capturesOnly);
+            if (ptype == PAWN  &&  EPTarget != NULL_SQUARE
+                  &&  (tbl.pawn(ToMove, sq) & bitboard::square_bb(EPTarget))
+                  &&  IsValidEnPassant (sq, EPTarget)) {
+                AddLegalMove (mlist, sq, EPTarget, EMPTY);
             }
         }
     }
 
     // Lastly, king moves...
-    if (mask & (1 << KING)) {
+    if (pieceType == EMPTY  ||  pieceType == KING) {
         GenKingMoves (mlist, genType);
-        if (!numChecks && genNonCaptures) {
+        if (!checkers && (genType & GEN_NON_CAPS)) {
             GenCastling(mlist);
         }
     }
@@ -1025,89 +747,10 @@ int Position::IsLegalMove(squareT from, squareT to, pieceT promo) const {
 	}
 
 	const auto target_sq = (from == king_sq) ? to : king_sq;
-	auto not_empty = [&](auto sq) {
-		return sq == to ||
-		       (sq != from && sq != captured_sq && GetPiece(sq) != EMPTY);
-	};
-	return under_attack(target_sq, captured_sq, not_empty) ? 0 : 1;
-}
-
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Position::GenCheckEvasions():
-//      Generate legal moves for the side to move when the
-//      King is in check.
-//
-void
-Position::GenCheckEvasions (MoveList * mlist, pieceT mask, genMovesT genType,
-                            SquareList * checkSquares)
-{
-    ASSERT(mlist != NULL);
-    uint numChecks = checkSquares->Size();
-    
-    // Assert that king IS actually in check:    
-    ASSERT (numChecks > 0);
-
-    bool genNonCaptures = (genType & GEN_NON_CAPS);
-    bool capturesOnly = !genNonCaptures;
-    mlist->Clear();
-
-    squareT king = GetKingSquare (ToMove);
-
-    // if it's double check, we can ONLY move the king
-    if (numChecks == 1) {
-        // OK, it is NOT a double check
-        // Try to block piece/capture piece. Remember en passant!
-        // First, generate a list of targets: squares between the king
-        // and attacker to block, and the attacker's square.
-
-        squareT attackSq = checkSquares->Get(0);
-        directionT dir = sqDir[king][attackSq];
-        SquareSet targets;  // Set of blocking/capturing squares.
-        targets.Add(attackSq);
-
-        // Now add squares we can might be able to block on.
-        if (dir != NULL_DIR) {
-            squareT sq = square_Move (king, dir);
-            while (sq != attackSq) {
-                if (Board[sq] == EMPTY) { targets.Add(sq); }
-                sq = square_Move (sq, dir);
-            }
-        }
-
-        // Try each non-King piece in turn. If a piece is pinned to
-        // the king, don't bother since it cannot possibly block or
-        // capture the piece that is giving check!
-
-        uint numPieces = Count[ToMove];
-        for (uint p2 = 1; p2 < numPieces; p2++) {
-            squareT from = List[ToMove][p2];
-            pieceT p2piece = Board[from];
-            if (Pinned[p2] != NULL_DIR) { continue; }
-            if (mask == EMPTY  ||  mask == piece_Type(p2piece)) {
-                if (piece_Type(p2piece) == PAWN) {
-                    GenPawnMoves (mlist, from, NULL_DIR, &targets, genType);
-                    // Capturing a pawn en passant will only get out
-                    // of check if the pawn that moved two squares
-                    // is doing the checking. If it is not, that means
-                    // a discovered check with the last pawn move so
-                    // taking en passant cannot get out of check.
-                    if (EPTarget != NULL_SQUARE) {
-                        squareT pawnSq = (ToMove == WHITE ? EPTarget - 8 : EPTarget + 8);
-                        if (pawnSq == attackSq) {
-                            SquareSet epset;
-                            epset.Add(EPTarget);
-                            GenPawnMoves (mlist, from, NULL_DIR, &epset, genType);
-                        }
-                    }
-                } else {
-                    GenPieceMoves (mlist, from, &targets, capturesOnly);
-                }
-            }
-        }  // end of search for captures/blocks
-    }
-
-    // Now king moves -- just compute them normally:
-    if (mask == EMPTY  ||  mask == KING) { GenKingMoves(mlist, genType); }
+	const auto occupied = (occupiedBB() & ~bitboard::square_bb(from) &
+	                       ~bitboard::square_bb(captured_sq)) |
+	                      bitboard::square_bb(to);
+	return under_attack(target_sq, captured_sq, occupied) ? 0 : 1;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1145,152 +788,15 @@ Position::TreeCalcAttacks(colorT side, squareT target)
 //      This function also puts a list of the attacking piece squares
 //      in the fromSqs parameter if it is non-NULL.
 //
-//      It ONLY uses the Board[] and Material[] lists of the Position, and
-//      ASSUMES they are correct with respect to each other, but it does
-//      NOT use the List[] or ListPos[] information.
-//      This allows us to move pieces quickly (altering only Board[] and
-//      Material[]) and detect whether they leave the king in check,
-//      without having to update other information.
 uint
 Position::CalcAttacks (colorT side, squareT target, SquareList * fromSquares) const
 {
-    // If squares is NULL, caller doesn't want a list of the squares of
-    // attacking pieces. To avoid comparing fromSquares with NULL every time
-    // we find a check, we set up a local array to use instead if fromSquares
-    // is NULL.
-    SquareList fromSqs;
-    if (fromSquares == NULL) { fromSquares = &fromSqs; }
-
-    fromSquares->Clear();
-    squareT sq;
-
-    // Bishop/Queen/Rook attacks: look at each of the 8 directions
-    pieceT king, queen, rook, bishop, knight;
-    if (side == WHITE) {
-        king = WK; queen = WQ; rook = WR; bishop = WB; knight = WN;
-    } else {
-        king = BK; queen = BQ; rook = BR; bishop = BB; knight = BN;
-    }
-
-    uint numQueensRooks = Material[queen] + Material[rook];
-    uint numQueensBishops = Material[queen] + Material[bishop];
-
-    // We only bother if there are any sliding pieces of each type:
-    if (numQueensRooks > 0) {
-        fyleT fyle = square_Fyle (target);
-        rankT rank = square_Rank (target);
-        directionT dirs[4];
-        uint ndirs = 0;
-        if (FyleCount(queen,fyle) + FyleCount(rook,fyle) > 0) {
-            dirs[ndirs++] = UP;  dirs[ndirs++] = DOWN;
-        }
-        if (RankCount(queen,rank) + RankCount(rook,rank) > 0) {
-            dirs[ndirs++] = LEFT; dirs[ndirs++] = RIGHT;
-        }
-        for (uint i = 0; i < ndirs; i++) {
-            directionT dir = dirs[i];
-            int delta = direction_Delta (dir);
-            squareT dest = target;
-            squareT last = square_Last (target, dir);
-
-            while (dest != last) {
-                dest += delta;
-                pieceT p = Board[dest];
-                if (p == EMPTY) {
-                    // empty square: keep searching
-                } else if (p == queen  ||  p == rook) {
-                    // Found an attacking piece
-                    fromSquares->Add(dest);
-                    break;
-                } else {
-                    // Found a piece, but not a queen or rook
-                    break;
-                }
-            }
-        }
+    auto atk = attackers(target, occupiedBB()) & colorBB_[side];
+    if (fromSquares != NULL) {
+        fromSquares->Clear();
+        for (auto b = atk; b; ) { fromSquares->Add(bitboard::pop_lsb(b)); }
     }
-
-    // Now diagonal sliders: Queens/Bishops:
-    if (numQueensBishops > 0) {
-        leftDiagT left = square_LeftDiag (target);
-        rightDiagT right = square_RightDiag (target);
-        directionT dirs[4];
-        uint ndirs = 0;
-        if (LeftDiagCount(queen,left) + LeftDiagCount(bishop,left) > 0) {
-            dirs[ndirs++] = UP_LEFT;  dirs[ndirs++] = DOWN_RIGHT;
-        }
-        if (RightDiagCount(queen,right) + RightDiagCount(bishop,right) > 0) {
-            dirs[ndirs++] = UP_RIGHT;  dirs[ndirs++] = DOWN_LEFT;
-        }
-        for (uint i = 0; i < ndirs; i++) {
-            directionT dir = dirs[i];
-            int delta = direction_Delta (dir);
-            squareT dest = target;
-            squareT last = square_Last (target, dir);
-
-            while (dest != last) {
-                dest += delta;
-                pieceT p = Board[dest];
-                if (p == EMPTY) {
-                    // empty square: keep searching
-                } else if (p == queen  ||  p == bishop) {
-                    // Found an attacking piece
-                    fromSquares->Add(dest);
-                    break;
-                } else {
-                    // Found a piece, but not an enemy queen or bishop
-                    break;
-                }
-            }
-        }
-    }
-
-    // Now knight checks: we only bother if there is a knight on the
-    // opposite square color of the target square color.
-    if (Material[knight] > 0
-         &&  SquareColorCount(knight, color_Flip(square_Color(target))) > 0) {
-        const squareT * destPtr = knightAttacks[target];
-        while (true) {
-            squareT dest = *destPtr;
-            if (dest == NULL_SQUARE) { break; }
-            if (Board[dest] == knight) {
-                fromSquares->Add(dest);
-            }
-            destPtr++;
-        }
-    }
-
-    // Now pawn attacks:
-    if (side == WHITE) {
-        if (square_Rank(target) != RANK_1) {  //if (Material[WP] > 0) {
-            sq = square_Move (target, DOWN_LEFT);
-            if (Board[sq] == WP)  {
-                fromSquares->Add(sq);
-            }
-            sq = square_Move (target, DOWN_RIGHT);
-            if (Board[sq] == WP)  {
-                fromSquares->Add(sq);
-            }
-        }
-    } else {
-        if (square_Rank(target) != RANK_8) {  //if (Material[BP] > 0) {
-            sq = square_Move (target, UP_LEFT);
-            if (Board[sq] == BP)  {
-                fromSquares->Add(sq);
-            }
-            sq = square_Move (target, UP_RIGHT);
-            if (Board[sq] == BP)  {
-                fromSquares->Add(sq);
-            }
-        }
-    }
-
-    // King attacks:
-    const squareT *destPtr = kingAttacks[target];
-    do if (Board[*destPtr] == king) fromSquares->Add(*destPtr);
-    while (*++destPtr != NULL_SQUARE);
-
-    return fromSquares->Size();
+    return bitboard::popcount(atk);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1335,32 +841,8 @@ uint
 Position::Mobility (pieceT p, colorT color, squareT from)
 {
     ASSERT (p == ROOK  ||  p == BISHOP);
-    uint mobility = 0;
-    directionT rookDirs[4] = { UP, DOWN, LEFT, RIGHT };
-    directionT bishopDirs[4]
-        = { UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT };
-    directionT * dirPtr = (p == ROOK ? rookDirs : bishopDirs);
-
-    for (uint i=0; i < 4; i++) {
-        directionT dir = dirPtr[i];
-        int delta = direction_Delta (dir);
-        squareT dest = from;
-        squareT last = square_Last (from, dir);
-
-        while (dest != last) {
-            dest += delta;
-            pieceT p = Board[dest];
-            if (p == EMPTY) {  // Empty square
-                mobility++;
-            } else if (piece_Color(p) == color) {  // Friendly piece
-                break;  // Finished with this direction.
-            } else {  // Enemy piece
-                mobility++;
-                break;  // Finished with this direction.
-            }
-        }
-    }
-    return mobility;
+    const auto atk = bitboard::tables().attacks(p, from, occupiedBB());
+    return bitboard::popcount(atk & ~colorBB_[color]);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1370,14 +852,10 @@ Position::Mobility (pieceT p, colorT color, squareT from)
 bool
 Position::IsKingInMate (void)
 {
-    SquareList checkSquares;
-    uint numChecks = CalcNumChecks (GetKingSquare(ToMove), &checkSquares);
-    if (numChecks == 0) { return false; }
-    CalcPins ();
+    if (CalcNumChecks() == 0) { return false; }
     MoveList mlist;
-    GenCheckEvasions (&mlist, EMPTY, GEN_ALL_MOVES, &checkSquares);
-    if (mlist.Size() == 0) { return true; }
-    return false;
+    GenerateMoves (&mlist);
+    return mlist.Size() == 0;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1961,7 +1439,6 @@ errorT Position::ReadMovePawn(simpleMoveT* sm, const char* str, size_t slen,
 		return ReadCoordMove(sm, str, slen, false);
 	}
 
-	MoveList mlist;
 	pieceT promo = EMPTY;
 	auto last_ch = static_cast<unsigned char>(str[slen - 1]);
 	if (!is_digit(last_ch)) {
@@ -1980,27 +1457,43 @@ errorT Position::ReadMovePawn(simpleMoveT* sm, const char* str, size_t slen,
 	if (slen < 2)
 		return ERROR_InvalidMove;
 
+	// The origin is found looking backwards from the destination square, then
+	// the move is verified with a single test of the king's safety.
+	const auto pawn = piece_Make(ToMove, PAWN);
+	const auto backward = (ToMove == WHITE) ? -8 : +8;
 	auto isLegal = [&](fyleT toFyle, rankT toRank) {
 		static_assert(NO_RANK > 8 && (NO_RANK - 1) > 8 && (NO_RANK + 1) > 8);
 		const auto fromRank = (ToMove == WHITE) ? toRank - 1 : toRank + 1;
-		if (toFyle > 8 || fromRank <= 0 || fromRank >= 8)
+		if (toFyle > H_FYLE || fromRank <= 0 || fromRank >= 8)
 			return false;
 
-		auto from = square_Make(frFyle, fromRank);
 		const auto to = square_Make(toFyle, toRank);
-		const auto pawn = piece_Make(ToMove, PAWN);
-		if (GetPiece(from) == pawn && IsLegalMove(from, to, promo)) {
-			makeMove(from, to, promo, *sm);
-			return true;
-		}
-		if (frFyle == toFyle) {
-			from += (ToMove == WHITE) ? -8 : +8;
-			if (GetPiece(from) == pawn && IsLegalMove(from, to, promo)) {
-				makeMove(from, to, promo, *sm);
-				return true;
-			}
+		if ((promo != EMPTY) != (toRank == rank_Relative(ToMove, RANK_8)))
+			return false; // Wrong promotion rank
+
+		auto from = square_Make(frFyle, fromRank);
+		if (frFyle == toFyle && Board[from] != pawn)
+			from += backward; // Double push
+		if (Board[from] != pawn)
+			return false;
+
+		const auto to_bb = bitboard::square_bb(to);
+		if (GenPawnMoves(from, GEN_ALL_MOVES) & to_bb) {
+			if (piece_Type(Board[to]) == KING)
+				return false;
+
+			const auto occupied =
+			    (occupiedBB() & ~bitboard::square_bb(from)) | to_bb;
+			if (under_attack(GetKingSquare(), to, occupied))
+				return false; // Leaves the King in check
+
+		} else if (to != EPTarget ||
+		           !(bitboard::tables().pawn(ToMove, from) & to_bb) ||
+		           !IsValidEnPassant(from, to)) {
+			return false;
 		}
-		return false;
+		makeMove(from, to, promo, *sm);
+		return true;
 	};
 
 	const auto toFile = fyle_FromChar(str[slen - 2]);
@@ -2040,10 +1533,7 @@ errorT Position::ReadMoveKing(simpleMoveT* sm, const char* str,
 		return ERROR_InvalidMove;
 
 	// leaves the King in check:
-	auto not_empty = [&](auto sq) {
-		return sq != from && GetPiece(sq) != EMPTY;
-	};
-	if (under_attack(to, to, not_empty))
+	if (under_attack(to, to, occupiedBB() & ~bitboard::square_bb(from)))
 		return ERROR_InvalidMove;
 
 	makeMove(from, to, INVALID_PIECE, *sm);
@@ -2081,30 +1571,42 @@ errorT Position::ReadMove(simpleMoveT* sm, const char* str, size_t slen,
 		}
 	}
 
-	// Loop through looking for pieces of the corresponding type. We start at 1
-	// since the King is always the piece at position 0 in the list.
-	int matchCount = 0;
-	auto movingPiece = piece_Make(ToMove, piece);
-	int nPieces = Material[movingPiece];
-	for (unsigned i = 1, n = Count[ToMove]; i < n && nPieces; i++) {
-		auto from = List[ToMove][i];
-		if (Board[from] != movingPiece)
-			continue;
-
-		--nPieces;
-		if ((frFyle != NO_FYLE && frFyle != square_Fyle(from)) ||
-		    (frRank != NO_RANK && frRank != square_Rank(from)))
-			continue;
-
-		if (!IsLegalMove(from, to, EMPTY))
-			continue;
-
-		++matchCount;
-		makeMove(from, to, INVALID_PIECE, *sm);
+	// The candidates are the pieces that attack the destination square.
+	const auto& tbl = bitboard::tables();
+	const auto occupied = occupiedBB();
+	auto candidates = tbl.attacks(piece, to, occupied) &
+	                  pieceBB_[piece_Make(ToMove, piece)];
+	if (frFyle != NO_FYLE)
+		candidates &= bitboard::fyle_bb(frFyle);
+	if (frRank != NO_RANK)
+		candidates &= bitboard::rank_bb(frRank);
+
+	const auto captured = GetPiece(to);
+	if (!candidates || piece_Color(captured) == ToMove ||
+	    piece_Type(captured) == KING)
+		return ERROR_InvalidMove;
+
+	// The SAN omits the disambiguation of pinned pieces.
+	const auto king_sq = GetKingSquare();
+	if (bitboard::more_than_one(candidates)) {
+		auto pin = pinned(king_sq) & candidates;
+		while (pin) {
+			const auto from = bitboard::pop_lsb(pin);
+			if (!(tbl.line(king_sq, from) & bitboard::square_bb(to)))
+				candidates &= ~bitboard::square_bb(from);
+		}
+		if (!candidates || bitboard::more_than_one(candidates))
+			return ERROR_InvalidMove; // No legal move, or ambiguous
 	}
-	return (matchCount == 1) ? OK                 // ok.
-	                         : ERROR_InvalidMove; // No match, or too many
-	                                              // (ambiguous) moves match.
+
+	const auto from = bitboard::lsb(candidates);
+	if (under_attack(king_sq, to,
+	                 (occupied & ~bitboard::square_bb(from)) |
+	                     bitboard::square_bb(to)))
+		return ERROR_InvalidMove; // Leaves the King in check
+
+	makeMove(from, to, INVALID_PIECE, *sm);
+	return OK;
 }
 
 errorT Position::ReadMoveCastle(simpleMoveT* sm, std::string_view str) const {
@@ -16,6 +16,7 @@
 #ifndef SCID_POSITION_H
 #define SCID_POSITION_H
 
+#include "bitboard.h"
 #include "common.h"
 #include "movelist.h"
 #include <stdio.h>
@@ -23,7 +24,6 @@
 #include <string_view>
 
 class DString;
-class SquareSet;
 class SquareList;
 
 
@@ -80,15 +80,8 @@ private:
                                         // List[][] for the piece on
                                         // square x.
     squareT         List[2][16];    // list of piece squares for each side
-    byte            NumOnRank[16][8];
-    byte            NumOnFyle[16][8];
-    byte            NumOnLeftDiag[16][16];  // Num Queens/Bishops
-    byte            NumOnRightDiag[16][16];
-    byte            NumOnSquareColor[16][2];
-
-    directionT      Pinned[16];     // For each List[ToMove][x], stores
-                                        // whether piece is pinned to its
-                                        // own king and dir from king.
+    bitboard::Bitboard pieceBB_[16]; // squares of each piece
+    bitboard::Bitboard colorBB_[2];  // squares of the pieces of each side
 
     squareT         EPTarget;       // square pawns can EP capture to
     colorT          ToMove;
@@ -111,33 +104,26 @@ private:
     inline void AddToBoard (pieceT p, squareT sq);
     inline void RemoveFromBoard (pieceT p, squareT sq);
 
-    void  CalcPinsDir (directionT dir, pieceT attacker);
-
-    void  GenSliderMoves (MoveList * mlist, colorT c, squareT sq,
-                          directionT dir, SquareSet * sqset,
-                          bool capturesOnly);
-    void  GenKnightMoves (MoveList * mlist, colorT c, squareT sq,
-                          SquareSet * sqset, bool capturesOnly);
+    bitboard::Bitboard occupiedBB() const {
+        return colorBB_[WHITE] | colorBB_[BLACK];
+    }
+    bitboard::Bitboard attackers(squareT sq, bitboard::Bitboard occupied) const;
+    bitboard::Bitboard pinned(squareT kingSq) const;
 
     void  AddLegalMove (MoveList * mlist, squareT from, squareT to, pieceT promo);
     void  GenCastling (MoveList * mlist);
     void  GenKingMoves (MoveList * mlist, genMovesT genType);
     void  AddPromotions (MoveList * mlist, squareT from, squareT dest);
-    bool  IsValidEnPassant (squareT from, squareT to);
-    void  GenPawnMoves (MoveList * mlist, squareT from, directionT dir,
-                        SquareSet * sqset, genMovesT genType);
-
-    void GenCheckEvasions(MoveList* mlist, pieceT mask, genMovesT genType,
-                          SquareList* checkSquares);
+    bool  IsValidEnPassant (squareT from, squareT to) const;
+    bitboard::Bitboard GenPawnMoves(squareT from, genMovesT genType) const;
 
     errorT ReadMove(simpleMoveT* sm, const char* str, size_t slen, pieceT p) const;
     errorT ReadMoveCastle(simpleMoveT* sm, std::string_view str) const;
     errorT ReadMovePawn(simpleMoveT* sm, const char* str, size_t slen, fyleT from);
     errorT ReadMoveKing(simpleMoveT* sm, const char* str, size_t slen) const;
 
-    template <typename TFunc>
     bool under_attack(squareT target_sq, squareT captured_sq,
-                      TFunc not_empty) const;
+                      bitboard::Bitboard occupied) const;
     bool under_attack(squareT target_sq) const;
 
     static constexpr unsigned castlingIdx(colorT color, castleDirT side) {
@@ -186,20 +172,25 @@ public:
     }
     uint        MaterialValue (colorT c);
     inline uint FyleCount (pieceT p, fyleT f) const {
-        return NumOnFyle[p][f];
+        return bitboard::popcount(pieceBB_[p] & bitboard::fyle_bb(f));
     }
     inline uint RankCount (pieceT p, rankT r) const {
-        return NumOnRank[p][r];
+        return bitboard::popcount(pieceBB_[p] & bitboard::rank_bb(r));
     }
     inline uint LeftDiagCount (pieceT p, leftDiagT diag) const {
-        return NumOnLeftDiag[p][diag];
+        return bitboard::popcount(pieceBB_[p] &
+                                  bitboard::tables().leftDiag(diag));
     }
     inline uint RightDiagCount (pieceT p, rightDiagT diag) const {
-        return NumOnRightDiag[p][diag];
+        return bitboard::popcount(pieceBB_[p] &
+                                  bitboard::tables().rightDiag(diag));
     }
     inline uint SquareColorCount (pieceT p, colorT sqColor)  const {
-        return NumOnSquareColor[p][sqColor];
+        return bitboard::popcount(pieceBB_[p] &
+                                  bitboard::square_color_bb(sqColor));
     }
+    /// Returns the squares occupied by the piece @e p (for example WN).
+    bitboard::Bitboard GetPieceSquares(pieceT p) const { return pieceBB_[p]; }
 
     const pieceT* GetBoard() const {
         const_cast<Position*>(this)->Board[COLOR_SQUARE] = COLOR_CHAR[ToMove];
@@ -224,15 +215,11 @@ public:
     bool validCastlingFlag(colorT color, bool king_side) const;
 
     // Hashing
-    inline uint HashValue (void) { return Hash; }
-    inline uint PawnHashValue (void) { return PawnHash; }
+    inline uint HashValue (void) const { return Hash; }
+    inline uint PawnHashValue (void) const { return PawnHash; }
     uint        GetHPSig ();
 
     // Move generation and execution
-    void        CalcPins();
-    void        GenPieceMoves (MoveList * mlist, squareT sq,
-                               SquareSet * sqset, bool capturesOnly);
-
     // Generate all legal moves:
     void  GenerateMoves (MoveList* mlist, pieceT mask, genMovesT genType, bool maybeInCheck);
     void  GenerateMoves (MoveList * mlist) { GenerateMoves (mlist, EMPTY, GEN_ALL_MOVES, true); }
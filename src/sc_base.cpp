@@ -18,11 +18,14 @@
 
 #include "common.h"
 #include "dbasepool.h"
+#include "enginefarm.h"
 #include "misc.h"
+#include "parallel.h"
 #include "scidbase.h"
 #include "searchtournaments.h"
 #include "ui.h"
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <map>
 #include <string>
@@ -654,8 +657,8 @@ UI_res_t sc_base_stats(const scidBaseT* dbase, UI_handle_t ti, int argc, const c
 	const char * options[] = { "dates", "eco", "flag", "flags", "ratings", "results", NULL };
 	switch (strExactMatch(subcmd, options)) {
 	case OPT_DATE:
-		res.push_back(date_GetYear(stats.minDate));
-		res.push_back(date_GetYear(stats.maxDate));
+		res.push_back(stats.minYear());
+		res.push_back(stats.maxYear());
 		res.push_back(stats.nYears == 0 ? 0 : size_t(stats.sumYears / stats.nYears));
 		break;
 	case OPT_ECO: {
@@ -684,8 +687,8 @@ UI_res_t sc_base_stats(const scidBaseT* dbase, UI_handle_t ti, int argc, const c
 		res.push_back(stats.flagCount[IndexEntry::CharToFlag('B')]);
 		break;
 	case OPT_RATINGS:
-		res.push_back(stats.minRating);
-		res.push_back(stats.maxRating);
+		res.push_back(stats.minRating());
+		res.push_back(stats.maxRating());
 		res.push_back(stats.nRatings == 0 ? 0 : size_t(stats.sumRatings / stats.nRatings));
 		break;
 	case OPT_RESULTS:
@@ -718,6 +721,76 @@ UI_res_t sc_base_switch(scidBaseT* dbase, UI_handle_t ti)
 	return UI_Result(ti, OK, res);
 }
 
+/**
+ * sc_base_annotate() - annotate games with a pool of UCI engines
+ *
+ * Analyzes the positions of the main line of the games with the same "go"
+ * command and adds [%eval] comments, NAGs to the errors and variations with
+ * the best lines. The annotated games get the annotator text in their
+ * Annotator tag, and the games that already have it are skipped: an
+ * interrupted run can be resumed by running it again.
+ * Options:
+ * -engines n:          the number of engine processes (default: one for each
+ *                      hardware thread). Each engine should use one thread.
+ * -go limits:          the parameters of the "go" command (default: nodes 200000)
+ * -blunder pawns:      the loss that makes a move an error (default: 1.0)
+ * -setoption nameval:  "name X value Y" options sent to the engines.
+ * -annotator text:     the text added to the Annotator tag (default: Scid
+ *                      annotate). If empty, no game is skipped.
+ * @returns the number of annotated games.
+ */
+UI_res_t sc_base_annotate(scidBaseT& dbase, UI_handle_t ti, int argc,
+                          const char** argv) {
+	const char* usage = "Usage: sc_base annotate baseId filterName [-engines n] "
+	                    "[-go limits] [-blunder pawns] [-setoption nameval] "
+	                    "[-annotator text] engine [args]";
+	if (argc < 5)
+		return UI_Result(ti, ERROR_BadArg, usage);
+
+	const HFilter filter = dbase.getFilter(argv[3]);
+	if (filter == 0)
+		return UI_Result(ti, ERROR_BadArg, usage);
+
+	static const char* options[] = {"-engines",   "-go",        "-blunder",
+	                                "-setoption", "-annotator", NULL};
+	enum { OPT_ENGINES, OPT_GO, OPT_BLUNDER, OPT_SETOPTION, OPT_ANNOTATOR };
+	AnnotateOptions opt;
+	unsigned nEngines = hardwareThreads();
+	int i = 4;
+	for (; i + 1 < argc && *argv[i] == '-'; i += 2) {
+		const char* value = argv[i + 1];
+		switch (strUniqueMatch(argv[i], options)) {
+		case OPT_ENGINES:
+			nEngines = strGetUnsigned(value);
+			break;
+		case OPT_GO:
+			opt.go = std::string("go ") + value;
+			break;
+		case OPT_BLUNDER:
+			opt.blunder = std::strtod(value, nullptr);
+			break;
+		case OPT_SETOPTION:
+			opt.setoption.emplace_back(value);
+			break;
+		case OPT_ANNOTATOR:
+			opt.annotator = value;
+			break;
+		default:
+			return UI_Result(ti, ERROR_BadArg, usage);
+		}
+	}
+	if (i >= argc || nEngines == 0)
+		return UI_Result(ti, ERROR_BadArg, usage);
+
+	EngineFarm farm(opt);
+	if (auto err = farm.open({argv + i, argv + argc}, nEngines))
+		return UI_Result(ti, err);
+
+	auto progress = UI_CreateProgress(ti);
+	const auto res = farm.annotate(dbase, filter, progress);
+	return UI_Result(ti, res.first, res.second);
+}
+
 /// Remove all occurrences of the specified tags from the database.
 /// @returns the number of changed games.
 UI_res_t sc_base_strip(scidBaseT& dbase, UI_handle_t ti, int argc,
@@ -956,7 +1029,7 @@ UI_res_t sc_base_gamesummary (const scidBaseT& dbase, UI_handle_t, int, const ch
 UI_res_t sc_base (UI_extra_t cd, UI_handle_t ti, int argc, const char ** argv)
 {
 	static const char * options [] = {
-	    "close",           "compact",         "copygames",
+	    "annotate",        "close",           "compact",         "copygames",
 	    "create",          "current",         "duplicates",
 	    "export",          "extra",           "filename",        "gameflag",
 	    "gamelocation",    "gameslist",       "getGame",         "import",
@@ -967,7 +1040,7 @@ UI_res_t sc_base (UI_extra_t cd, UI_handle_t ti, int argc, const char ** argv)
 	    NULL
 	};
 	enum {
-	    BASE_CLOSE,        BASE_COMPACT,      BASE_COPYGAMES,
+	    BASE_ANNOTATE,     BASE_CLOSE,        BASE_COMPACT,      BASE_COPYGAMES,
 	    BASE_CREATE,       BASE_CURRENT,      BASE_DUPLICATES,
 	    BASE_EXPORT,       BASE_EXTRA,        BASE_FILENAME,     BASE_GAMEFLAG,
 	    BASE_GAMELOCATION, BASE_GAMESLIST,    BASE_GETGAME,      BASE_IMPORT,
@@ -1012,6 +1085,9 @@ UI_res_t sc_base (UI_extra_t cd, UI_handle_t ti, int argc, const char ** argv)
 	if (dbase == 0) return UI_Result(ti, ERROR_FileNotOpen);
 
 	switch (index) {
+	case BASE_ANNOTATE:
+		return sc_base_annotate(*dbase, ti, argc, argv);
+
 	case BASE_CLOSE:
 		return sc_base_close(dbase, ti, argc, argv);
 
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2026 Fulvio Benini
+ *
+ * This file is part of Scid (Shane's Chess Information Database).
+ *
+ * Scid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation.
+ *
+ * Scid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scid. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uciengine.h"
+#include "ui.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// The UI is notified of new PVs at most every 100ms.
+constexpr int PV_INTERVAL_MS = 100;
+
+struct Connection {
+	std::shared_ptr<EngineOutput> output =
+	    std::make_shared<EngineOutput>(PV_INTERVAL_MS);
+	UI_Callback callback;
+	// Must be the last: the reader uses the output
+	std::unique_ptr<EngineProcess> process = std::make_unique<EngineProcess>();
+
+	Connection(UI_handle_t ti, const char* cmd) : callback(ti, cmd) {}
+
+	~Connection() {
+		// The engine may need some time to terminate: do not block the UI.
+		if (process) {
+			std::thread([process = std::move(process)]() {
+				process->close();
+			}).detach();
+		}
+	}
+};
+
+// Never destroyed: at exit the UI may be already finalized when the reader
+// threads post their events, and the engines receive EOF anyway.
+auto& connections = *new std::map<std::string, std::shared_ptr<Connection>>;
+
+// Returns a task that passes the output of the engine to the UI callback.
+// The output is a list of triples: "line", the text of the line and an empty
+// value; "InfoPV", the text of the line and the values of the UCI info line;
+// "eof" and two empty values.
+auto makeDeliverTask(std::weak_ptr<Connection> weak) {
+	return [weak = std::move(weak)]() {
+		auto conn = weak.lock(); // keep it alive if the callback closes it
+		if (!conn)
+			return;
+
+		auto [lines, eof] = conn->output->take();
+		if (lines.empty() && !eof)
+			return;
+
+		UI_List res(lines.size() * 3 + 3);
+		for (auto const& line : lines) {
+			UCIInfoPV info;
+			if (line.multipv == 0 || !info.parse(line.line)) {
+				res.push_back("line");
+				res.push_back(line.line);
+				res.push_back("");
+				continue;
+			}
+			UI_List wdl(3);
+			for (auto value : info.wdl) {
+				if (!value.empty())
+					wdl.push_back(value);
+			}
+			UI_List infoPV(13);
+			for (auto value :
+			     {info.multipv, info.depth, info.seldepth, info.nodes, info.nps,
+			      info.hashfull, info.tbhits, info.time, info.score,
+			      info.score_type}) {
+				infoPV.push_back(value);
+			}
+			infoPV.push_back(wdl);
+			infoPV.push_back(info.pv);
+			infoPV.push_back(line.san);
+			res.push_back("InfoPV");
+			res.push_back(line.line);
+			res.push_back(infoPV);
+		}
+		if (eof) {
+			res.push_back("eof");
+			res.push_back("");
+			res.push_back("");
+		}
+		conn->callback(res);
+	};
+}
+
+UI_res_t sc_engine_open(UI_handle_t ti, int argc, const char** argv) {
+	if (argc < 5)
+		return UI_Result(ti, ERROR_BadArg,
+		                 "Usage: sc_engine open id callback executable ?args?");
+
+	auto conn = std::make_shared<Connection>(ti, argv[3]);
+	UI_EventQueue queue;
+	auto onLine = [output = conn->output, queue,
+	               weak = std::weak_ptr(conn)](std::string_view line) {
+		const int delay = output->push(line);
+		if (delay >= 0)
+			queue.post(makeDeliverTask(weak), delay);
+	};
+	auto onEOF = [output = conn->output, queue, weak = std::weak_ptr(conn)]() {
+		const int delay = output->pushEOF();
+		if (delay >= 0)
+			queue.post(makeDeliverTask(weak), delay);
+	};
+	if (conn->process->open({argv + 4, argv + argc}, onLine, onEOF) != OK)
+		return UI_Result(ti, ERROR_FileOpen,
+		                 std::string("couldn't execute \"") + argv[4] + '"');
+
+	connections[argv[2]] = std::move(conn);
+	return UI_Result(ti, OK);
+}
+
+UI_res_t sc_engine_parseinfo(UI_handle_t ti, int argc, const char** argv) {
+	if (argc != 3 && argc != 4)
+		return UI_Result(ti, ERROR_BadArg,
+		                 "Usage: sc_engine parseinfo line ?position?");
+
+	Position pos;
+	const bool toSAN = argc == 4 && pos.ReadFromFENorUCI(argv[3]) == OK;
+	constexpr size_t MAX_SIZE = 64;
+	size_t size = 0;
+	UI_List res(MAX_SIZE);
+	parseUCIInfo(argv[2], [&](std::string_view token, std::string_view value) {
+		if (size + 4 > MAX_SIZE)
+			return;
+
+		size += (toSAN && (token == "pv" || token == "currmove")) ? 4 : 2;
+		res.push_back(token);
+		res.push_back(value);
+		if (toSAN && (token == "pv" || token == "currmove")) {
+			res.push_back(token == "pv" ? "sanpv" : "sancurrmove");
+			res.push_back(coordToSAN(pos, value, false));
+		}
+	});
+	return UI_Result(ti, OK, res);
+}
+
+} // namespace
+
+/**
+ * sc_engine() - manage the processes of the chess engines.
+ *
+ * The output of an engine is read by a background thread, that passes it to
+ * the callback (in the UI thread).
+ * open:  starts a new engine process.
+ * send:  sends a line to the engine; if the line is an UCI "position" command,
+ *        the PVs received after it will be converted to SAN.
+ * close: closes the input of the engine and returns immediately (after 1s
+ *        the process is killed by a background thread).
+ * pid:   returns the process id of the engine.
+ * parseinfo: parses an UCI "info" line and returns a list of token-value
+ *        pairs; if a position is given, the "pv" and "currmove" values are
+ *        followed by their SAN conversion ("sanpv" and "sancurrmove").
+ */
+UI_res_t sc_engine(UI_extra_t, UI_handle_t ti, int argc, const char** argv) {
+	const char* options[] = {"open", "send", "close", "pid", "parseinfo", NULL};
+	enum { OPT_OPEN, OPT_SEND, OPT_CLOSE, OPT_PID, OPT_PARSEINFO };
+	const int index = (argc > 1) ? strUniqueMatch(argv[1], options) : -1;
+	if (index == OPT_OPEN)
+		return sc_engine_open(ti, argc, argv);
+
+	if (index == OPT_PARSEINFO)
+		return sc_engine_parseinfo(ti, argc, argv);
+
+	if (index < 0 || argc < 3)
+		return UI_Result(ti, ERROR_BadArg,
+		                 "Usage: sc_engine open|send|close|pid id ?args?");
+
+	auto it = connections.find(argv[2]);
+	if (it == connections.end())
+		return UI_Result(ti, ERROR_FileNotOpen, "The engine is not open");
+
+	auto& conn = *it->second;
+	switch (index) {
+	case OPT_SEND:
+		if (argc != 4)
+			return UI_Result(ti, ERROR_BadArg, "Usage: sc_engine send id line");
+
+		if (std::string_view(argv[3]).substr(0, 9) == "position ")
+			conn.output->setPosition(argv[3]);
+
+		if (!conn.process->write(argv[3]))
+			return UI_Result(ti, ERROR_FileWrite, "Error writing to the engine");
+		break;
+
+	case OPT_CLOSE:
+		connections.erase(it);
+		break;
+
+	case OPT_PID:
+		return UI_Result(ti, OK, static_cast<int>(conn.process->pid()));
+	}
+	return UI_Result(ti, OK);
+}
@@ -22,6 +22,9 @@
 #include "codec_scid4.h"
 #include "codec_scid5.h"
 #include "common.h"
+#include "filebuf.h"
+#include "parallel.h"
+#include "sidecar.h"
 #include "sortcache.h"
 #include "stored.h"
 #include <algorithm>
@@ -63,7 +66,6 @@ scidBaseT::scidBaseT() {
 	fileMode_ = FMODE_None;
 	dbFilter = new Filter(0);
 	treeFilter = new Filter(0);
-	stats_ = NULL;
 }
 
 scidBaseT::~scidBaseT() {
@@ -73,7 +75,6 @@ scidBaseT::~scidBaseT() {
 	delete idx;
 	delete nb_;
 	delete game;
-	delete stats_;
 	delete dbFilter;
 	delete treeFilter;
 }
@@ -102,6 +103,21 @@ errorT scidBaseT::openHelper(ICodecDatabase::Codec dbtype, fileModeT fMode,
 
 		// Default treeCache size: 250
 		treeCache.CacheResize(250);
+
+		const auto type = codec_->getType();
+		if (type == ICodecDatabase::SCID4 || type == ICodecDatabase::SCID5) {
+			// The sidecar files are optional: an invalid file is removed.
+			auto load = [&](auto& sidecarData, const char* ext) {
+				const auto filename = fileName_ + ext;
+				if (fMode == FMODE_Create)
+					std::remove(filename.c_str());
+				else if (auto err = sidecarData.load(filename, numGames()))
+					if (err != ERROR_FileOpen)
+						std::remove(filename.c_str());
+			};
+			load(fingerprints_, ".sfp");
+			load(textIndex_, ".stx");
+		}
 	} else {
 		idx->Close();
 		nb_->Clear();
@@ -121,6 +137,8 @@ void scidBaseT::Close() {
 	idx->Close();
 	nb_->Clear();
 	codec_ = nullptr;
+	fingerprints_.clear();
+	textIndex_.clear();
 
 	clear();
 	game->Clear();
@@ -138,10 +156,6 @@ void scidBaseT::Close() {
 }
 
 void scidBaseT::clear() {
-	if (stats_ != NULL) {
-		delete stats_;
-		stats_ = NULL;
-	}
 	duplicates_.reset();
 	treeCache.Clear();
 	for (nameT nt = NAME_PLAYER; nt < NUM_NAME_TYPES; nt++) {
@@ -189,10 +203,15 @@ errorT scidBaseT::saveGame(Game* game, gamenumT replacedGameId) {
 	auto [ie, tags] = game->Encode(buf);
 	auto gamedata = ByteBuffer(buf.data(), buf.size());
 
-	errorT err = (replacedGameId < numGames())
+	const bool replace = replacedGameId < numGames();
+	errorT err = replace
 	                 ? codec_->saveGame(ie, tags, gamedata, replacedGameId)
 	                 : codec_->addGame(ie, tags, gamedata);
 	errorT errClear = endTransaction(replacedGameId);
+	if (err == OK) {
+		const auto gnum = replace ? replacedGameId : numGames() - 1;
+		updateSidecars(gnum, gnum + 1);
+	}
 	return (err != OK) ? err : errClear;
 }
 
@@ -206,11 +225,13 @@ errorT scidBaseT::importGames(const scidBaseT* srcBase, const HFilter& filter,
 	if (auto errModify = beginTransaction())
 		return errModify;
 
+	const auto first = numGames();
 	errorT err = OK;
 	size_t iProgress = 0;
 	size_t totGames = filter->size();
+	NameIDMap nameIDs;
 	for (const auto gNum : filter) {
-		err = importGameHelper(srcBase, gNum);
+		err = importGameHelper(srcBase, gNum, nameIDs);
 		if (err != OK)
 			break;
 
@@ -220,16 +241,133 @@ errorT scidBaseT::importGames(const scidBaseT* srcBase, const HFilter& filter,
 		}
 	}
 	errorT errClear = endTransaction();
+	updateSidecars(first, numGames(), progress);
 	return (err == OK) ? errClear : err;
 }
 
-errorT scidBaseT::importGameHelper(const scidBaseT* srcBase, gamenumT gNum) {
-	const auto ie = srcBase->getIndexEntry(gNum);
-	if (const auto data = srcBase->codec_->getGameData(ie->GetOffset(),
-	                                                   ie->GetLength()))
-		return codec_->addGame(*ie, srcBase->tagRoster(*ie), data);
+errorT scidBaseT::importGameHelper(const scidBaseT* srcBase, gamenumT gNum,
+                                   NameIDMap& nameIDs) {
+	IndexEntry ie = *srcBase->getIndexEntry(gNum);
+	const auto data = srcBase->codec_->getGameData(ie.GetOffset(),
+	                                               ie.GetLength());
+	if (!data)
+		return ERROR_FileRead;
+
+	const auto tags = srcBase->tagRoster(ie);
+	if (codec_->getType() == ICodecDatabase::PGN) // Do not support addName()
+		return codec_->addGame(ie, tags, data);
+
+	const auto& srcNames = *srcBase->getNameBase();
+	auto mapName = [&](nameT nt, idNumberT srcID, auto setID) -> errorT {
+		auto& ids = nameIDs[nt];
+		if (ids.size() <= srcID)
+			ids.resize(srcNames.GetNumNames(nt), NAMEID_UNMAPPED);
+
+		if (ids[srcID] == NAMEID_UNMAPPED) {
+			auto [err, id] = codec_->addName(nt, srcNames.GetName(nt, srcID));
+			if (err)
+				return err;
+
+			ids[srcID] = id;
+		}
+		(ie.*setID)(ids[srcID]);
+		return OK;
+	};
+	errorT err = mapName(NAME_EVENT, ie.GetEvent(), &IndexEntry::SetEvent);
+	if (!err)
+		err = mapName(NAME_SITE, ie.GetSite(), &IndexEntry::SetSite);
+	if (!err)
+		err = mapName(NAME_ROUND, ie.GetRound(), &IndexEntry::SetRound);
+	if (!err)
+		err = mapName(NAME_PLAYER, ie.GetWhite(), &IndexEntry::SetWhite);
+	if (!err)
+		err = mapName(NAME_PLAYER, ie.GetBlack(), &IndexEntry::SetBlack);
+	if (err)
+		return err;
+
+	return codec_->addGameMapped(ie, tags, data);
+}
+
+void scidBaseT::updateSidecars(gamenumT first, gamenumT end,
+                               const Progress& progress) {
+	const auto type = codec_->getType();
+	if (type != ICodecDatabase::SCID4 && type != ICodecDatabase::SCID5)
+		return;
+
+	const bool recreate = (first == 0 && end == numGames());
+	if (recreate) {
+		fingerprints_.clear();
+		textIndex_.clear();
+	}
+	FilebufAppend fpFile;
+	FilebufAppend textFile;
+	bool fpOk = OK == sidecar::openAppend(fpFile, fileName_ + ".sfp",
+	                                      GameFingerprints::fileHeader(),
+	                                      recreate);
+	bool textOk = OK == sidecar::openAppend(textFile, fileName_ + ".stx",
+	                                        GameTextIndex::fileHeader(),
+	                                        recreate);
+
+	// The data of a block of games is read sequentially (the codecs are not
+	// thread safe), the fingerprints and the text hashes are created with
+	// multiple threads and then stored in game order.
+	constexpr gamenumT BLOCK_GAMES = 4096;
+	std::vector<byte> data;
+	std::vector<std::pair<size_t, size_t>> spans;
+	std::vector<std::vector<byte>> fps(BLOCK_GAMES);
+	std::vector<std::vector<uint32_t>> hashes(BLOCK_GAMES);
+	std::vector<errorT> errFps(BLOCK_GAMES);
+	std::vector<errorT> errHashes(BLOCK_GAMES);
+	std::vector<byte> record;
+	for (gamenumT block = first; block < end && (fpOk || textOk);
+	     block += BLOCK_GAMES) {
+		if (!progress.report(block - first, end - first))
+			break;
+
+		const auto n = std::min(BLOCK_GAMES, end - block);
+		data.clear();
+		spans.clear();
+		for (gamenumT i = 0; i < n; ++i) {
+			const auto buf = getGame(*getIndexEntry(block + i));
+			spans.emplace_back(data.size(), buf.size());
+			data.insert(data.end(), buf.data(), buf.data() + buf.size());
+		}
+		parallelFor(n, 256, [&](size_t begin, size_t end) {
+			Game game;
+			for (auto i = begin; i < end; ++i) {
+				const ByteBuffer buf(data.data() + spans[i].first,
+				                     spans[i].second);
+				fps[i].clear();
+				errFps[i] = buf ? GameFingerprints::make(game, buf, fps[i])
+				                : ERROR_FileRead;
+				errHashes[i] = buf ? GameTextIndex::make(buf, hashes[i])
+				                   : ERROR_FileRead;
+			}
+		});
 
-	return ERROR_FileRead;
+		for (gamenumT i = 0; i < n; ++i) {
+			const auto gnum = block + i;
+			const IndexEntry& ie = *getIndexEntry(gnum);
+			if (fpOk && errFps[i] == OK) {
+				fpOk = fingerprints_.set(gnum, ie, fps[i]) == OK;
+				record.clear();
+				GameFingerprints::encodeRecord(gnum, ie, fps[i], record);
+				fpOk = fpOk && OK == fpFile.append(reinterpret_cast<const char*>(
+				                                       record.data()),
+				                                   record.size());
+			}
+			if (textOk && errHashes[i] == OK) {
+				textIndex_.set(gnum, ie, hashes[i]);
+				record.clear();
+				GameTextIndex::encodeRecord(gnum, ie, hashes[i], record);
+				textOk = OK == textFile.append(
+				                   reinterpret_cast<const char*>(record.data()),
+				                   record.size());
+			}
+		}
+	}
+	fpFile.pubsync();
+	textFile.pubsync();
 }
 
 errorT scidBaseT::importGames(ICodecDatabase::Codec dbtype,
@@ -240,6 +378,7 @@ errorT scidBaseT::importGames(ICodecDatabase::Codec dbtype,
 	if (auto errModify = beginTransaction())
 		return errModify;
 
+	const auto first = numGames();
 	CodecPgn pgn;
 	auto res = pgn.open(filename, FMODE_ReadOnly);
 	if (res == OK) {
@@ -264,6 +403,7 @@ errorT scidBaseT::importGames(ICodecDatabase::Codec dbtype,
 	}
 
 	auto res_endTrans = endTransaction();
+	updateSidecars(first, numGames(), progress);
 	return (res != OK) ? res : res_endTrans;
 }
 
@@ -404,138 +544,6 @@ scidBaseT::getFilterComponents(std::string_view filterID) const {
 	        std::string(filterID.substr(maskName + 1))};
 }
 
-/**
- * Statistics
- */
-const scidBaseT::Stats& scidBaseT::getStats() const {
-	if (stats_ == NULL)
-		stats_ = new scidBaseT::Stats(this);
-	return *stats_;
-}
-
-scidBaseT::Stats::Eco::Eco() : count(0) {
-	std::fill_n(results, NUM_RESULT_TYPES, 0);
-}
-
-scidBaseT::Stats::Stats(const scidBaseT* dbase) {
-	std::fill(flagCount, flagCount + IndexEntry::IDX_NUM_FLAGS, 0);
-	minDate = ZERO_DATE;
-	maxDate = ZERO_DATE;
-	nYears = 0;
-	sumYears = 0;
-	std::fill_n(nResults, NUM_RESULT_TYPES, 0);
-	nRatings = 0;
-	sumRatings = 0;
-	minRating = 0;
-	maxRating = 0;
-
-	// Read stats from index entry of each game:
-	for (gamenumT gnum = 0, n = dbase->numGames(); gnum < n; gnum++) {
-		const IndexEntry* ie = dbase->getIndexEntry(gnum);
-		nResults[ie->GetResult()]++;
-		eloT elo = ie->GetWhiteElo();
-		if (elo > 0) {
-			nRatings++;
-			sumRatings += elo;
-			if (minRating == 0) {
-				minRating = elo;
-			}
-			if (elo < minRating) {
-				minRating = elo;
-			}
-			if (elo > maxRating) {
-				maxRating = elo;
-			}
-		}
-		elo = ie->GetBlackElo();
-		if (elo > 0) {
-			nRatings++;
-			sumRatings += elo;
-			if (minRating == 0) {
-				minRating = elo;
-			}
-			if (elo < minRating) {
-				minRating = elo;
-			}
-			if (elo > maxRating) {
-				maxRating = elo;
-			}
-		}
-		dateT date = ie->GetDate();
-		if (gnum == 0) {
-			maxDate = minDate = date;
-		}
-		if (date_GetYear(date) > 0) {
-			if (date < minDate) {
-				minDate = date;
-			}
-			if (date > maxDate) {
-				maxDate = date;
-			}
-			nYears++;
-			sumYears += date_GetYear(date);
-		}
-
-		for (uint flag = 0; flag < IndexEntry::IDX_NUM_FLAGS; flag++) {
-			bool value = ie->GetFlag(1 << flag);
-			if (value) {
-				flagCount[flag]++;
-			}
-		}
-
-		resultT result = ie->GetResult();
-		ecoT eco = ie->GetEcoCode();
-		if (eco == 0) {
-			ecoEmpty_.count++;
-			ecoEmpty_.results[result]++;
-		} else {
-			ecoValid_.count++;
-			ecoValid_.results[result]++;
-			eco = eco_Reduce(eco);
-			ecoStats_[eco].count++;
-			ecoStats_[eco].results[result]++;
-			eco /= 27;
-			ecoGroup3_[eco].count++;
-			ecoGroup3_[eco].results[result]++;
-			eco /= 10;
-			ecoGroup2_[eco].count++;
-			ecoGroup2_[eco].results[result]++;
-			eco /= 10;
-			ecoGroup1_[eco].count++;
-			ecoGroup1_[eco].results[result]++;
-		}
-	}
-}
-
-const scidBaseT::Stats::Eco*
-scidBaseT::Stats::getEcoStats(const char* ecoStr) const {
-	ASSERT(ecoStr != 0);
-
-	if (*ecoStr == 0)
-		return &ecoValid_;
-
-	ecoT eco = eco_FromString(ecoStr);
-	if (eco == 0)
-		return 0;
-	eco = eco_Reduce(eco);
-
-	switch (strlen(ecoStr)) {
-	case 0:
-		return &ecoValid_;
-	case 1:
-		return &(ecoGroup1_[eco / 2700]);
-	case 2:
-		return &(ecoGroup2_[eco / 270]);
-	case 3:
-		return &(ecoGroup3_[eco / 27]);
-	case 4:
-	case 5:
-		return &(ecoStats_[eco]);
-	}
-
-	return 0;
-}
-
 std::vector<TreeNode> scidBaseT::getTreeStat(const HFilter& filter) const {
 	std::vector<TreeNode> res;
 	for (gamenumT gnum = 0, n = numGames(); gnum < n; gnum++) {
@@ -664,8 +672,9 @@ errorT scidBaseT::compact(const Progress& progress) {
 	uint iProgress = 0;
 	bool err_UserCancel = false;
 	errorT err_AddGame = OK;
+	NameIDMap nameIDs;
 	for (auto it = sort.cbegin(); it != sort.cend(); ++it) {
-		err_AddGame = tmp.importGameHelper(this, it->second);
+		err_AddGame = tmp.importGameHelper(this, it->second, nameIDs);
 		if (err_AddGame != OK)
 			break;
 
@@ -731,6 +740,9 @@ errorT scidBaseT::compact(const Progress& progress) {
 		std::rename(s1, s2);
 	}
 	errorT res = openHelper(dbtype, FMODE_Both, filename.c_str());
+	if (res == OK || res == ERROR_NameDataLoss) {
+		updateSidecars(0, numGames(), progress);
+	}
 
 	// 10) Re-create filters and SortCaches
 	if (res == OK || res == ERROR_NameDataLoss) {
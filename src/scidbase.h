@@ -22,14 +22,17 @@
 #include "bytebuf.h"
 #include "codec.h"
 #include "containers.h"
+#include "fingerprint.h"
 #include "game.h"
 #include "gameview.h"
 #include "index.h"
 #include "namebase.h"
+#include "textindex.h"
 #include "tree.h"
 #include <array>
 #include <cassert>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -38,37 +41,7 @@ class SortCache;
 const gamenumT INVALID_GAMEID = 0xffffffff;
 
 struct scidBaseT {
-	struct Stats {
-		uint flagCount[IndexEntry::IDX_NUM_FLAGS]; // Num of games with each
-		                                           // flag set.
-		dateT minDate;
-		dateT maxDate;
-		uint64_t nYears;
-		uint64_t sumYears;
-		uint nResults[NUM_RESULT_TYPES];
-		uint nRatings;
-		uint64_t sumRatings;
-		uint minRating;
-		uint maxRating;
-
-		Stats(const scidBaseT* dbase);
-
-		struct Eco {
-			uint count;
-			uint results[NUM_RESULT_TYPES];
-
-			Eco();
-		};
-		const Eco* getEcoStats(const char* ecoStr) const;
-
-	private:
-		Eco ecoEmpty_;
-		Eco ecoValid_;
-		Eco ecoStats_[(1 + (1 << 16) / 131) * 27];
-		Eco ecoGroup1_[(1 + (1 << 16) / 131) / 100];
-		Eco ecoGroup2_[(1 + (1 << 16) / 131) / 10];
-		Eco ecoGroup3_[(1 + (1 << 16) / 131)];
-	};
+	using Stats = IndexStats;
 
 	scidBaseT();
 	~scidBaseT();
@@ -117,6 +90,10 @@ struct scidBaseT {
 		static_assert(std::is_unsigned_v<gamenumT>);
 		return g < numGames() ? getIndexEntry(g) : nullptr;
 	}
+	/// Returns the values of a field of the IndexEntry of all the games.
+	const std::vector<uint32_t>& getIndexColumn(Index::ColumnT col) const {
+		return idx->GetColumn(col);
+	}
 	TagRoster tagRoster(gamenumT gnum) const {
 		return tagRoster(*getIndexEntry(gnum));
 	}
@@ -126,6 +103,12 @@ struct scidBaseT {
 
 	const NameBase* getNameBase() const { return nb_; }
 
+	/// Returns the sorted list of the games that contain the name @e id.
+	/// @param nt: NAME_PLAYER, NAME_EVENT or NAME_SITE.
+	NamePostings::Games getNameGames(nameT nt, idNumberT id) const {
+		return idx->GetNameGames(nt, id);
+	}
+
 	/// Return the highest elo of the player (in the database's games)
 	eloT peakElo(idNumberT playerID) const {
 		if (peakEloCache_.empty()) {
@@ -177,6 +160,29 @@ struct scidBaseT {
 	errorT getGame(const IndexEntry& ie, Game& dest) const {
 		return dest.Decode(ie, tagRoster(ie), getGame(ie));
 	}
+	/// Appends the PGN text of a game to @e dest (see encodePGN()).
+	errorT getGamePGN(const IndexEntry& ie, std::vector<char>& dest) const {
+		return encodePGN(ie, tagRoster(ie), getGame(ie), dest);
+	}
+
+	/// Returns the fingerprint of the positions of a game (see
+	/// GameFingerprints) or nullptr if it is not available.
+	const byte* getFingerprint(gamenumT gnum) const {
+		return fingerprints_.find(gnum, *getIndexEntry(gnum));
+	}
+
+	/// Returns, for each game, false if the text index proves that the game
+	/// does not contain all the @e words (see GameTextIndex). The games that
+	/// are not indexed are included and all the matches should be verified
+	/// with GameTextIndex::findWords().
+	std::vector<bool> textCandidates(std::vector<std::string> const& words) const {
+		return textIndex_.candidates(
+		    numGames(),
+		    [&](gamenumT gnum) -> const IndexEntry& {
+			    return *getIndexEntry(gnum);
+		    },
+		    words);
+	}
 
 	errorT importGames(const scidBaseT* srcBase, const HFilter& filter,
 	                   const Progress& progress);
@@ -225,7 +231,7 @@ struct scidBaseT {
 	std::pair<std::string, std::string>
 	getFilterComponents(std::string_view filterId) const;
 
-	const Stats& getStats() const;
+	const Stats& getStats() const { return idx->GetStats(); }
 	std::vector<TreeNode> getTreeStat(const HFilter& filter) const;
 	uint getNameFreq(nameT nt, idNumberT id) {
 		if (nameFreq_[nt].size() == 0)
@@ -398,6 +404,46 @@ struct scidBaseT {
 		return {err, nCorrections};
 	}
 
+	/**
+	 * Replace multiple games in a single transaction.
+	 * @param nextGame: function that is invoked repeatedly until it returns
+	 *                  nullptr; must return a pointer to the new Game and
+	 *                  store into its gamenumT& parameter the id of the game
+	 *                  to be replaced.
+	 * @returns a std::pair containing OK (or an error code) and the number of
+	 * games replaced.
+	 */
+	template <typename TFunc>
+	std::pair<errorT, size_t> replaceGames(TFunc nextGame) {
+		if (auto errModify = beginTransaction())
+			return {errModify, 0};
+
+		std::vector<gamenumT> replaced;
+		std::vector<byte> buf;
+		errorT err = OK;
+		gamenumT gnum = 0;
+		while (Game* game = nextGame(gnum)) {
+			if (gnum >= numGames()) {
+				err = ERROR_BadArg;
+				break;
+			}
+			buf.clear();
+			auto [ie, tags] = game->Encode(buf);
+			err = codec_->saveGame(ie, tags, {buf.data(), buf.size()}, gnum);
+			if (err != OK)
+				break;
+
+			replaced.push_back(gnum);
+		}
+		const auto err_trans = endTransaction();
+		for (auto id : replaced) {
+			updateSidecars(id, id + 1);
+		}
+		if (err == OK)
+			err = err_trans;
+		return {err, replaced.size()};
+	}
+
 	std::unique_ptr<gamenumT[]> extractDuplicates() {
 		return std::move(duplicates_);
 	}
@@ -429,12 +475,13 @@ private:
 	fileModeT fileMode_;   // Read-only, write-only, or both.
 	std::vector<std::pair<std::string, Filter*>> filters_;
 	mutable Filter all_filter_{0};
-	mutable Stats* stats_;
 	std::array<std::vector<int>, NUM_NAME_TYPES> nameFreq_;
 	// For each game: idx of duplicate game + 1 (0 if there is no duplicate).
 	std::unique_ptr<gamenumT[]> duplicates_;
 	std::vector<std::pair<std::string, SortCache*>> sortCaches_;
 	mutable std::vector<eloT> peakEloCache_;
+	GameFingerprints fingerprints_;
+	GameTextIndex textIndex_;
 
 private:
 	errorT openHelper(ICodecDatabase::Codec dbtype, fileModeT mode,
@@ -454,7 +501,24 @@ private:
 	/// @returns OK if successful or an error code.
 	errorT endTransaction(gamenumT gameId = INVALID_GAMEID);
 
-	errorT importGameHelper(const scidBaseT* sourceBase, uint gNum);
+	/// The IDs of the names of this database, indexed by the IDs of the same
+	/// names in a source database (NAMEID_UNMAPPED if not yet known).
+	using NameIDMap = std::array<std::vector<idNumberT>, NUM_NAME_TYPES>;
+	static constexpr idNumberT NAMEID_UNMAPPED = ~idNumberT(0);
+
+	/// Copies a game from another database. Every name is searched and added
+	/// only the first time it is used: then its ID is stored in @e nameIDs,
+	/// which should be reused for all the games copied from @e sourceBase.
+	errorT importGameHelper(const scidBaseT* sourceBase, gamenumT gNum,
+	                        NameIDMap& nameIDs);
+
+	/// Adds the games in the range [first, end) to the fingerprints and to
+	/// the text index and appends them to the sidecar files. The files are
+	/// re-created if the range includes all the games. The sidecar files are
+	/// optional and are created only for SCID4 and SCID5 databases: errors
+	/// are ignored.
+	void updateSidecars(gamenumT first, gamenumT end,
+	                    const Progress& progress = Progress());
 
 	SortCache* getSortCache(const char* criteria);
 
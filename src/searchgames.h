@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements a multi-threaded search of the games' data.
+ */
+
+#pragma once
+
+#include "bytebuf.h"
+#include "common.h"
+#include "game.h"
+#include "hfilter.h"
+#include "misc.h"
+#include "parallel.h"
+#include "scidbase.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Search the games of a database, decoding them with multiple threads.
+ * The games to be searched are selected according to @e filterOp and are
+ * first tested by @e prefilter, using only the data of the IndexEntry.
+ * The codecs are not thread safe: the data of the possible matches is read
+ * sequentially by the calling thread and stored into a batch, which is then
+ * dispatched to a pool of worker threads, each one with its own Game object.
+ * The workers are created once and wait for the batches: while they decode a
+ * batch the calling thread reads the next one.
+ * The results are merged into @e filter in game order.
+ * @param base:      the database to search.
+ * @param filter:    the filter to update.
+ * @param filterOp:  FILTEROP_AND to search the games included in @e filter,
+ *                   FILTEROP_OR to search the excluded games.
+ * @param progress:  a Progress object used for GUI communications.
+ * @param prefilter: invoked by the calling thread with the parameters
+ *                   (gamenumT, const IndexEntry&).
+ *                   Must return 0 if the game cannot match, otherwise a
+ *                   non-zero hint which is forwarded to @e match.
+ * @param match:     invoked by the worker threads with the parameters
+ *                   (Game&, const IndexEntry&, ByteBuffer&, unsigned hint).
+ *                   Must return the new filter value (0 if the game does not
+ *                   match).
+ * @param skipUnreadable: if true, the games whose data cannot be read are
+ *                        skipped, otherwise the search stops.
+ * @returns OK if successful, ERROR_UserCancel if the search was interrupted
+ * or ERROR_FileRead. Games not searched keep their previous filter value.
+ */
+template <typename TPrefilter, typename TMatch>
+errorT searchGames(scidBaseT const& base, HFilter& filter, filterOpT filterOp,
+                   Progress const& progress, TPrefilter prefilter,
+                   TMatch match, bool skipUnreadable = false) {
+	ASSERT(filterOp == FILTEROP_AND || filterOp == FILTEROP_OR);
+
+	struct Job {
+		gamenumT gnum;
+		unsigned hint;
+		size_t offset;
+		uint32_t length;
+		byte result;
+	};
+	struct Batch {
+		std::vector<Job> jobs;
+		std::vector<byte> data;
+	};
+	constexpr size_t BATCH_GAMES = 4096;
+	constexpr size_t BATCH_BYTES = 8 << 20;
+
+	// The pool of workers: each dispatched batch is decoded by all the
+	// workers and join() waits until all of them have finished.
+	const auto nThreads = hardwareThreads();
+	std::mutex mtx;
+	std::condition_variable cvWork;
+	std::condition_variable cvDone;
+	Batch* work = nullptr;
+	unsigned generation = 0;
+	unsigned nBusy = 0;
+	bool stop = false;
+	std::atomic<size_t> nextJob;
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < nThreads; ++i) {
+		workers.emplace_back([&]() {
+			Game game;
+			for (unsigned done = 0;;) {
+				Batch* batch;
+				{
+					std::unique_lock lock(mtx);
+					cvWork.wait(lock,
+					            [&] { return stop || generation != done; });
+					if (stop)
+						return;
+					done = generation;
+					batch = work;
+				}
+				const auto n = batch->jobs.size();
+				for (size_t j; (j = nextJob.fetch_add(1)) < n;) {
+					Job& job = batch->jobs[j];
+					ByteBuffer data(batch->data.data() + job.offset, job.length);
+					job.result = match(game, *base.getIndexEntry(job.gnum),
+					                   data, job.hint);
+				}
+				std::lock_guard lock(mtx);
+				if (--nBusy == 0)
+					cvDone.notify_one();
+			}
+		});
+	}
+	auto dispatch = [&](Batch& batch) {
+		{
+			std::lock_guard lock(mtx);
+			work = &batch;
+			nextJob.store(0, std::memory_order_relaxed);
+			nBusy = nThreads;
+			++generation;
+		}
+		cvWork.notify_all();
+	};
+	auto join = [&]() {
+		std::unique_lock lock(mtx);
+		cvDone.wait(lock, [&] { return nBusy == 0; });
+	};
+
+	errorT err = OK;
+	Batch batches[2];
+	Batch* running = nullptr;
+	const bool included = (filterOp == FILTEROP_AND);
+	for (gamenumT gnum = 0, n = base.numGames();; ) {
+		Batch& batch = (running == &batches[0]) ? batches[1] : batches[0];
+		batch.jobs.clear();
+		batch.data.clear();
+		for (; gnum < n; ++gnum) {
+			if (batch.jobs.size() >= BATCH_GAMES ||
+			    batch.data.size() >= BATCH_BYTES)
+				break;
+
+			if ((gnum % 1024) == 0 && !progress.report(gnum, n)) {
+				err = ERROR_UserCancel;
+				break;
+			}
+
+			if ((filter.get(gnum) != 0) != included)
+				continue;
+
+			IndexEntry const& ie = *base.getIndexEntry(gnum);
+			const unsigned hint = ie.GetLength() ? prefilter(gnum, ie) : 0;
+			if (hint == 0) {
+				filter.set(gnum, 0);
+				continue;
+			}
+
+			const auto data = base.getGame(ie);
+			if (!data) {
+				if (skipUnreadable)
+					continue;
+
+				err = ERROR_FileRead;
+				break;
+			}
+			batch.jobs.push_back({gnum, hint, batch.data.size(),
+			                      static_cast<uint32_t>(data.size()), 0});
+			batch.data.insert(batch.data.end(), data.data(),
+			                  data.data() + data.size());
+		}
+
+		join();
+		if (running) {
+			for (auto const& job : running->jobs) {
+				filter.set(job.gnum, job.result);
+			}
+			running = nullptr;
+		}
+		if (err != OK || batch.jobs.empty())
+			break;
+
+		dispatch(batch);
+		running = &batch;
+	}
+
+	{
+		std::lock_guard lock(mtx);
+		stop = true;
+	}
+	cvWork.notify_all();
+	for (auto& th : workers) {
+		th.join();
+	}
+	return err;
+}
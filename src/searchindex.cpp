@@ -18,10 +18,15 @@
 
 #include "common.h"
 #include "misc.h"
+#include "parallel.h"
 #include "scidbase.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -31,6 +36,7 @@ class SearchName {
 	idNumberT (IndexEntry::* f1_) () const;
 	idNumberT (IndexEntry::* f2_) () const;
 	std::vector<bool> mask_;
+	std::vector<bool> games_; // The games that contain a matching name.
 
 public:
 	SearchName(const scidBaseT* base,
@@ -49,6 +55,19 @@ public:
 		} else {
 			Init_icase_ignoreSpaces(n, name_type, pattern.c_str());
 		}
+
+		// Use the lists of the games of each name to avoid reading the
+		// IndexEntry of the games that cannot match.
+		if (NamePostings::isIndexed(name_type)) {
+			games_.resize(base->numGames());
+			for (idNumberT i = 0; i < n; i++) {
+				if (!mask_[i])
+					continue;
+				for (gamenumT gnum : base->getNameGames(name_type, i)) {
+					games_[gnum] = true;
+				}
+			}
+		}
 	}
 
 	void Init_exact (idNumberT n, nameT name_type, std::string const& pattern) {
@@ -68,6 +87,9 @@ public:
 	}
 
 	bool operator() (gamenumT gnum) const {
+		if (!games_.empty() && !games_[gnum])
+			return false;
+
 		bool res = mask_[(base_->getIndexEntry(gnum)->*f1_)()];
 		if (!res && f2_ != 0) {
 			return mask_[(base_->getIndexEntry(gnum)->*f2_)()];
@@ -106,30 +128,30 @@ public:
 };
 
 class SearchFlag {
-	const scidBaseT* base_;
+	const uint32_t* flags_;
 	uint32_t flagMask_;
 
 public:
 	SearchFlag(const scidBaseT* base,
 	           const char* flags)
-	: base_(base) {
+	: flags_(base->getIndexColumn(Index::COL_FLAGS).data()) {
 		flagMask_ = IndexEntry::StrToFlagMask(flags);
 		ASSERT(flagMask_ != 0);
 	}
 
 	bool operator() (gamenumT gnum) const {
-		return base_->getIndexEntry(gnum)->GetFlag(flagMask_);
+		return (flags_[gnum] & flagMask_) == flagMask_;
 	}
 };
 
 class SearchResult {
-	const scidBaseT* base_;
+	const uint32_t* results_;
 	bool result_[NUM_RESULT_TYPES];
 
 public:
 	SearchResult(const scidBaseT* base,
 	             const char* results)
-	: base_(base) {
+	: results_(base->getIndexColumn(Index::COL_RESULT).data()) {
 		std::fill_n(result_, NUM_RESULT_TYPES, false);
 		const char* end = RESULT_CHAR + NUM_RESULT_TYPES;
 		while (*results != 0) {
@@ -140,8 +162,7 @@ public:
 	}
 
 	bool operator() (gamenumT gnum) const {
-		resultT r = base_->getIndexEntry(gnum)->GetResult();
-		return result_[r];
+		return result_[results_[gnum]];
 	}
 };
 
@@ -181,12 +202,33 @@ public:
 	}
 };
 
-class SearchRangeDate : public SearchRange<dateT> {
+/// Searches the games with the value of a field in a range, scanning the
+/// Index column of the field instead of the IndexEntry of the games.
+class SearchColumn : public StrRange {
+protected:
+	const uint32_t* values_;
+
+protected:
+	SearchColumn(const scidBaseT* base, Index::ColumnT col)
+	: values_(base->getIndexColumn(col).data()) {}
+
+public:
+	SearchColumn(const scidBaseT* base,
+	             const char* range,
+	             Index::ColumnT col)
+	: StrRange(range), values_(base->getIndexColumn(col).data()) {}
+
+	bool operator() (gamenumT gnum) const {
+		return inRange(values_[gnum]);
+	}
+};
+
+class SearchRangeDate : public SearchColumn {
 public:
 	SearchRangeDate(const scidBaseT* base,
 	                const char* range,
-	                dateT (IndexEntry::* f) () const)
-	: SearchRange<dateT>(base, f) {
+	                Index::ColumnT col)
+	: SearchColumn(base, col) {
 		// Extract two whitespace-separated dates:
 		const char* v = strFirstWord(range);
 		min_ = date_EncodeFromString (v);
@@ -196,12 +238,11 @@ public:
 	}
 };
 
-class SearchRangeEco : public SearchRange<ecoT> {
+class SearchRangeEco : public SearchColumn {
 public:
 	SearchRangeEco(const scidBaseT* base,
-	               const char* range,
-	               ecoT (IndexEntry::* f) () const)
-	: SearchRange<ecoT>(base, f) {
+	               const char* range)
+	: SearchColumn(base, Index::COL_ECO) {
 		// Extract two whitespace-separated ECO codes:
 		const char* v = strFirstWord(range);
 		min_ = eco_FromString(v);
@@ -236,22 +277,27 @@ public:
 	}
 };
 
-class SearchRangeElo : public SearchRange<eloT> {
+class SearchRangeElo : public StrRange {
 protected:
-	eloT (IndexEntry::*fElo1_)() const;
-	eloT (IndexEntry::*fElo2_)() const;
+	const uint32_t* elo1_;
+	const uint32_t* elo2_;
 
 public:
 	SearchRangeElo(const scidBaseT* base, const char* range,
-	               eloT (IndexEntry::*f1)() const,
-	               eloT (IndexEntry::*f2)() const = 0)
-	    : SearchRange<eloT>(base, range, 0), fElo1_(f1), fElo2_(f2) {}
+	               Index::ColumnT col1)
+	    : StrRange(range), elo1_(base->getIndexColumn(col1).data()),
+	      elo2_(nullptr) {}
+
+	SearchRangeElo(const scidBaseT* base, const char* range,
+	               Index::ColumnT col1, Index::ColumnT col2)
+	    : StrRange(range), elo1_(base->getIndexColumn(col1).data()),
+	      elo2_(base->getIndexColumn(col2).data()) {}
 
 	bool operator()(gamenumT gnum) const {
-		long v1 = (base_->getIndexEntry(gnum)->*fElo1_)();
+		long v1 = elo1_[gnum];
 		long v2 = min_;
-		if (fElo2_ != 0)
-			v2 = (base_->getIndexEntry(gnum)->*fElo2_)();
+		if (elo2_ != nullptr)
+			v2 = elo2_[gnum];
 		if (v1 < min_ || v1 > max_ || v2 < min_ || v2 > max_)
 			return false;
 		return true;
@@ -261,13 +307,12 @@ public:
 class SearchRangeEloDiff : public SearchRangeElo {
 public:
 	SearchRangeEloDiff(const scidBaseT* base, const char* range,
-	                   eloT (IndexEntry::*f1)() const,
-	                   eloT (IndexEntry::*f2)() const)
-	    : SearchRangeElo(base, range, f1, f2) {}
+	                   Index::ColumnT col1, Index::ColumnT col2)
+	    : SearchRangeElo(base, range, col1, col2) {}
 
 	bool operator()(gamenumT gnum) const {
-		long v1 = (base_->getIndexEntry(gnum)->*fElo1_)();
-		long v2 = (base_->getIndexEntry(gnum)->*fElo2_)();
+		long v1 = elo1_[gnum];
+		long v2 = elo2_[gnum];
 		long v = v1 - v2;
 		if (v < min_ || v > max_)
 			return false;
@@ -312,12 +357,6 @@ public:
 		}
 	}
 
-	void invalidate() {
-		op_.clear();
-		opNot_ = false;
-		opOr_ = false;
-	}
-
 	bool operator!() const { return op_.empty(); }
 	bool operator==(const char* s) const {
 		// Compares @s with op_ (op_ do not contain the starting '-' char
@@ -352,123 +391,211 @@ std::vector<SearchParam> parseParams(int argc, const char ** argv, filterOpT& fi
 	return res;
 }
 
-/**
- * gamesToSearch() - create the vector of games to be searched
- * @base:      the scidBaseT to search
- * @filter:    games to be searched
- * @filterOp:  FILTEROP_RESET -> reset @filter to include all games
- *             FILTEROP_AND   -> search only games in @filter
- *             FILTEROP_OR    -> search only games not in @filter
- *
- * Return: a vector containing the games (game number) to be searched.
- * If @filterOp == FILTEROP_RESET then
- *         @filter is reset to include all games
- *         @filterOp is changed to FILTEROP_AND
- */
-std::vector<gamenumT> collectGames(HFilter& filter, filterOpT& filterOp) {
-	ASSERT(filter != 0);
-
-	std::vector<gamenumT> res;
-	switch (filterOp) {
-	case FILTEROP_RESET:
-		filter->includeAll();
-		filterOp = FILTEROP_AND;
-		/* FALLTHRU */
-	case FILTEROP_AND:
-		res.resize(filter->size());
-		std::copy(filter->begin(), filter->end(), res.begin());
-		break;
-	case FILTEROP_OR:
-		HFilterInverted excluded(filter);
-		res.resize(excluded.size());
-		std::copy(excluded.begin(), excluded.end(), res.begin());
-		break;
-	}
-	return res;
+/// The games are searched in chunks, and the games of a chunk are stored as
+/// offsets from the first game of the chunk.
+constexpr size_t CHUNK_SIZE = 4096;
+using chunkOffsetT = uint16_t;
+
+/// Partitions the @e n @e games of the chunk that starts with the game
+/// @e begin: the matching games are stored into @e match and the other games
+/// into @e nomatch (each one can be the same array as @e games).
+/// Returns the number of matching games.
+using SearchTerm =
+    std::function<size_t(gamenumT begin, const chunkOffsetT* games, size_t n,
+                         chunkOffsetT* match, chunkOffsetT* nomatch)>;
+
+template <typename TPred>
+SearchTerm makeTerm(TPred pred, bool negate) {
+	return [pred = std::move(pred), negate](
+	           gamenumT begin, const chunkOffsetT* games, size_t n,
+	           chunkOffsetT* match, chunkOffsetT* nomatch) {
+		size_t nMatch = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const auto game = games[i];
+			const bool res = pred(begin + game) != negate;
+			match[nMatch] = game;
+			nomatch[i - nMatch] = game;
+			nMatch += res;
+		}
+		return nMatch;
+	};
 }
 
 /**
- * doSearch() - partition the input range
- * @itB:    begin of the range
- * @itR:    previous partition point
- * @itE:    end of the range
+ * makeTerm() - create the evaluator of a SearchParam
  * @base:   the scidBaseT to search
  * @param:  parameters for the search
  *
- * Return: the new partition point so that the range [itB, result) contains the matching games
- * If @param is not found, invalidate it and return the previous partition point (@itR)
+ * Return: the SearchTerm, or an empty function if @param is not valid.
  */
-template<typename I>
-I doSearch(I itB, I itR, I itE, const scidBaseT* base, SearchParam& param) {
-	if (param == "player") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_PLAYER, &IndexEntry::GetWhite, &IndexEntry::GetBlack)
+SearchTerm makeTerm(const scidBaseT* base, SearchParam const& param) {
+	const char* value = param.getValue();
+	const bool negate = param.isNot();
+	if (param == "player") return makeTerm(
+		SearchName(base, value, NAME_PLAYER, &IndexEntry::GetWhite, &IndexEntry::GetBlack), negate
 	);
-	if (param == "white") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_PLAYER, &IndexEntry::GetWhite)
+	if (param == "white") return makeTerm(
+		SearchName(base, value, NAME_PLAYER, &IndexEntry::GetWhite), negate
 	);
-	if (param == "black") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_PLAYER, &IndexEntry::GetBlack)
+	if (param == "black") return makeTerm(
+		SearchName(base, value, NAME_PLAYER, &IndexEntry::GetBlack), negate
 	);
-	if (param == "event") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_EVENT, &IndexEntry::GetEvent)
+	if (param == "event") return makeTerm(
+		SearchName(base, value, NAME_EVENT, &IndexEntry::GetEvent), negate
 	);
-	if (param == "site") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_SITE, &IndexEntry::GetSite)
+	if (param == "site") return makeTerm(
+		SearchName(base, value, NAME_SITE, &IndexEntry::GetSite), negate
 	);
-	if (param == "sitecountry") return std::stable_partition(itB, itE,
-		SearchSiteCountry(base, param.getValue())
+	if (param == "sitecountry") return makeTerm(
+		SearchSiteCountry(base, value), negate
 	);
-	if (param == "round") return std::stable_partition(itB, itE,
-		SearchName(base, param.getValue(), NAME_ROUND, &IndexEntry::GetRound)
+	if (param == "round") return makeTerm(
+		SearchName(base, value, NAME_ROUND, &IndexEntry::GetRound), negate
 	);
-	if (param == "date") return std::stable_partition(itB, itE,
-		SearchRangeDate(base, param.getValue(), &IndexEntry::GetDate)
+	if (param == "date") return makeTerm(
+		SearchRangeDate(base, value, Index::COL_DATE), negate
 	);
-	if (param == "eventdate") return std::stable_partition(itB, itE,
-		SearchRangeDate(base, param.getValue(), &IndexEntry::GetEventDate)
+	if (param == "eventdate") return makeTerm(
+		SearchRangeDate(base, value, Index::COL_EVENTDATE), negate
 	);
-	if (param == "elo") return std::stable_partition(itB, itE,
-		SearchRangeElo(base, param.getValue(), &IndexEntry::GetWhiteElo, &IndexEntry::GetBlackElo)
+	if (param == "elo") return makeTerm(
+		SearchRangeElo(base, value, Index::COL_WHITEELO, Index::COL_BLACKELO), negate
 	);
-	if (param == "welo") return std::stable_partition(itB, itE,
-		SearchRangeElo(base, param.getValue(), &IndexEntry::GetWhiteElo)
+	if (param == "welo") return makeTerm(
+		SearchRangeElo(base, value, Index::COL_WHITEELO), negate
 	);
-	if (param == "belo") return std::stable_partition(itB, itE,
-		SearchRangeElo(base, param.getValue(), &IndexEntry::GetBlackElo)
+	if (param == "belo") return makeTerm(
+		SearchRangeElo(base, value, Index::COL_BLACKELO), negate
 	);
-	if (param == "delo") return std::stable_partition(itB, itE,
-		SearchRangeEloDiff(base, param.getValue(), &IndexEntry::GetWhiteElo, &IndexEntry::GetBlackElo)
+	if (param == "delo") return makeTerm(
+		SearchRangeEloDiff(base, value, Index::COL_WHITEELO, Index::COL_BLACKELO), negate
 	);
-	if (param == "eco") return std::stable_partition(itB, itE,
-		SearchRangeEco(base, param.getValue(), &IndexEntry::GetEcoCode)
+	if (param == "eco") return makeTerm(
+		SearchRangeEco(base, value), negate
 	);
-	if (param == "gnum") return std::stable_partition(itB, itE,
-		SearchRangeGamenum(base, param.getValue())
+	if (param == "gnum") return makeTerm(
+		SearchRangeGamenum(base, value), negate
 	);
-	if (param == "length") return std::stable_partition(itB, itE,
-		SearchRange<ushort>(base, param.getValue(), &IndexEntry::GetNumHalfMoves)
+	if (param == "length") return makeTerm(
+		SearchColumn(base, value, Index::COL_NUMHALFMOVES), negate
 	);
-	if (param == "n_variations") return std::stable_partition(itB, itE,
-		SearchRange<uint>(base, param.getValue(), &IndexEntry::GetVariationCount)
+	if (param == "n_variations") return makeTerm(
+		SearchRange<uint>(base, value, &IndexEntry::GetVariationCount), negate
 	);
-	if (param == "n_comments") return std::stable_partition(itB, itE,
-		SearchRange<uint>(base, param.getValue(), &IndexEntry::GetCommentCount)
+	if (param == "n_comments") return makeTerm(
+		SearchRange<uint>(base, value, &IndexEntry::GetCommentCount), negate
 	);
-	if (param == "n_nags") return std::stable_partition(itB, itE,
-		SearchRange<uint>(base, param.getValue(), &IndexEntry::GetNagCount)
+	if (param == "n_nags") return makeTerm(
+		SearchRange<uint>(base, value, &IndexEntry::GetNagCount), negate
 	);
-	if (param == "flag") return std::stable_partition(itB, itE,
-		SearchFlag(base, param.getValue())
+	if (param == "flag") return makeTerm(
+		SearchFlag(base, value), negate
 	);
-	if (param == "result") return std::stable_partition(itB, itE,
-		SearchResult(base, param.getValue())
+	if (param == "result") return makeTerm(
+		SearchResult(base, value), negate
 	);
-	if (param == "variant")
-		return std::stable_partition(itB, itE,
-		                             SearchVariant(base, param.getValue()));
+	if (param == "variant") return makeTerm(
+		SearchVariant(base, value), negate
+	);
+
+	return {};
+}
+
+/**
+ * class SearchGroup - a criteria and the following '|' criteria
+ *
+ * A game matches the group if it matches at least one of the criteria, and
+ * the games must match all the groups.
+ */
+class SearchGroup {
+	std::vector<SearchTerm> terms_;
+	double selectivity_ = 1.0;
+
+public:
+	explicit SearchGroup(SearchTerm term) { terms_.push_back(std::move(term)); }
+
+	void addOr(SearchTerm term) { terms_.push_back(std::move(term)); }
+
+	/// Returns the estimated ratio of matching games.
+	double selectivity() const { return selectivity_; }
+
+	/// Estimates the ratio of matching games, evaluating a sample of games
+	/// evenly distributed over the database.
+	void estimateSelectivity(gamenumT nGames) {
+		constexpr size_t N_SAMPLES = 16;
+		constexpr size_t SAMPLE_SIZE = 256;
+		chunkOffsetT games[SAMPLE_SIZE], rejected[SAMPLE_SIZE];
+		size_t nMatches = 0, nSamples = 0;
+		for (size_t i = 0; i < N_SAMPLES; ++i) {
+			const auto begin = static_cast<gamenumT>(nGames * i / N_SAMPLES);
+			const auto n = std::min<size_t>(SAMPLE_SIZE, nGames - begin);
+			for (size_t j = 0; j < n; ++j) {
+				games[j] = static_cast<chunkOffsetT>(j);
+			}
+			size_t nRejected;
+			nMatches += eval(begin, games, n, rejected, nRejected);
+			nSamples += n;
+		}
+		if (nSamples)
+			selectivity_ = double(nMatches) / nSamples;
+	}
+
+	/// Evaluates the group for the @e n @e games of a chunk (see SearchTerm).
+	/// The matching games are kept in @e games and the other are moved into
+	/// @e rejected.
+	/// Returns the number of matching games.
+	size_t eval(gamenumT begin, chunkOffsetT* games, size_t n,
+	            chunkOffsetT* rejected, size_t& nRejected) const {
+		size_t nMatch = terms_.front()(begin, games, n, games, rejected);
+		nRejected = n - nMatch;
+		for (auto it = terms_.begin() + 1; it != terms_.end(); ++it) {
+			// Search the games that did not match the previous criteria
+			const auto nOr = (*it)(begin, rejected, nRejected, games + nMatch,
+			                       rejected);
+			nMatch += nOr;
+			nRejected -= nOr;
+		}
+		return nMatch;
+	}
+};
+
+/**
+ * makeGroups() - group the SearchParams
+ * @base:   the scidBaseT to search
+ * @params: the SearchParams
+ *
+ * Return: the groups of criteria, sorted from the most selective.
+ * The invalid criteria are ignored: the '|' criteria that follow an invalid
+ * criteria, or that are not preceded by another criteria, are also ignored.
+ */
+std::vector<SearchGroup> makeGroups(const scidBaseT* base,
+                                    std::vector<SearchParam> const& params) {
+	std::vector<SearchGroup> res;
+	bool validGroup = false;
+	for (auto const& param : params) {
+		if (param.isOr() && !validGroup)
+			continue;
+
+		SearchTerm term = makeTerm(base, param);
+		if (param.isOr()) {
+			if (term)
+				res.back().addOr(std::move(term));
+		} else {
+			validGroup = static_cast<bool>(term);
+			if (validGroup)
+				res.emplace_back(std::move(term));
+		}
+	}
 
-	param.invalidate();
-	return itR;
+	if (res.size() > 1) {
+		for (auto& group : res) {
+			group.estimateSelectivity(base->numGames());
+		}
+		std::stable_sort(res.begin(), res.end(), [](auto const& a, auto const& b) {
+			return a.selectivity() < b.selectivity();
+		});
+	}
+	return res;
 }
 
 } // End of anonymous namespace
@@ -482,8 +609,11 @@ I doSearch(I itB, I itR, I itE, const scidBaseT* base, SearchParam& param) {
  * @param argc:     number of argv elements
  * @param argv:     an array of string pairs <criteria,value>
  * @param progress: report search progress to UI
+ * @param nThreads: the number of threads to use (0: hardwareThreads())
  *
  * This function perform a fast games search using the IndexEntry info.
+ * If the search is interrupted (ERROR_UserCancel) the games not yet searched
+ * keep their previous filter value.
  * Criteria should start with the char '-' and can include the optional trailing chars
  *     '!': meaning that we want the games that do _not_ match the <criteria,value> pair
  *     '|': that allows to search for games that match at least one <criteria,value> in
@@ -514,59 +644,83 @@ I doSearch(I itB, I itR, I itE, const scidBaseT* base, SearchParam& param) {
  * means (white elo > 2700 && white elo < 4000) || (belo is not in the range 0-2700) && ((welo - belo) > -200 && (welo - belo) < 200)
  */
 errorT search_index(const scidBaseT* base, HFilter& filter, int argc,
-                    const char** argv, const Progress& progress) {
+                    const char** argv, const Progress& progress,
+                    unsigned nThreads) {
 	ASSERT(base != 0);
 	ASSERT(filter != 0);
 
 	filterOpT filterOp = FILTEROP_RESET;
 	std::vector<SearchParam> params = parseParams(argc, argv, filterOp);
-	std::vector<gamenumT> glist = collectGames(filter, filterOp);
-
-	// Partition glist so that the range [glist.begin(), it_res)
-	// contains the matching games
-	typedef std::vector<gamenumT>::iterator iter;
-	iter it_begin = glist.begin();
-	iter it_end = glist.end();
-	iter it_res = glist.end();
-	for (size_t i = 0, n = params.size(); i < n; i++) {
-		if (!progress.report(i, n)) return ERROR_UserCancel;
-
-		if (params[i].isOr()) {
-			it_begin = it_res;
-			// Now the range [it_begin, it_end) include the games
-			// that did not matched the previous AND criteria
-		} else {
-			it_end = it_res;
-			it_begin = glist.begin();
-			// Now the range [glist.begin(), it_res) include the games
-			// that matched all the criteria until now.
-			// Nonmatching games are in the range [it_end, glist.end())
-			// and excluded from subsequent searches
+	if (filterOp == FILTEROP_RESET) {
+		filter->includeAll();
+		filterOp = FILTEROP_AND;
+	}
+	// The predicates are created by the calling thread, and then only read.
+	const std::vector<SearchGroup> groups = makeGroups(base, params);
+
+	// The chunks are evaluated by multiple threads, and each thread writes
+	// the results of its chunks directly into the filter.
+	// The games to search are:
+	// FILTEROP_AND -> the games in @filter (the nonmatching are excluded)
+	// FILTEROP_OR  -> the games not in @filter (the matching are included)
+	const bool searchIncluded = (filterOp == FILTEROP_AND);
+	const gamenumT nGames = base->numGames();
+	byte* values = filter->mainValues();
+	auto searchChunk = [&](gamenumT begin) {
+		chunkOffsetT games[CHUNK_SIZE], rejected[CHUNK_SIZE];
+		const auto end = static_cast<gamenumT>(
+		    std::min<size_t>(begin + CHUNK_SIZE, nGames));
+		size_t n = 0;
+		for (gamenumT gnum = begin; gnum < end; ++gnum) {
+			games[n] = static_cast<chunkOffsetT>(gnum - begin);
+			n += (filter->get(gnum) != 0) == searchIncluded;
 		}
-
-		it_res = doSearch(it_begin, it_res, it_end, base, params[i]);
-
-		if (params[i].isNot()) {
-			// The nonmatching games are in the range [it_res, it_end)
-			// Rotate glist so that nonmatching games are in
-			// the range [it_begin, it_res)
-			std::rotate(it_begin, it_res, it_end);
-			it_res = it_begin + (it_end - it_res);
+		for (auto it = groups.begin(); n != 0 && it != groups.end(); ++it) {
+			size_t nRejected;
+			n = it->eval(begin, games, n, rejected, nRejected);
+			if (searchIncluded) {
+				for (size_t i = 0; i < nRejected; ++i) {
+					values[begin + rejected[i]] = 0;
+				}
+			}
 		}
+		if (!searchIncluded) {
+			for (size_t i = 0; i < n; ++i) {
+				values[begin + games[i]] = 1;
+			}
+		}
+	};
+
+	const size_t nChunks = (nGames + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	std::atomic<size_t> nextChunk(0);
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> workers;
+	if (nThreads == 0)
+		nThreads = hardwareThreads();
+	for (size_t i = 1, n = std::min<size_t>(nThreads, nChunks); i < n; ++i) {
+		workers.emplace_back([&]() {
+			for (size_t chunk; !stop.load(std::memory_order_relaxed) &&
+			                   (chunk = nextChunk.fetch_add(1)) < nChunks;) {
+				searchChunk(static_cast<gamenumT>(chunk * CHUNK_SIZE));
+			}
+		});
 	}
-
-	if (filterOp == FILTEROP_AND) {
-		// Remove nonmatching games from @filter
-		for (iter it = it_res; it != glist.end(); ++it)
-			filter->erase(*it);
-	} else {
-		// filterOp == FILTEROP_OR
-		// Add matching games to @filter
-		for (iter it = glist.begin(); it != it_res; ++it)
-			filter->set(*it, 1);
+	// The calling thread also reports the progress to the UI.
+	errorT err = OK;
+	for (size_t chunk; (chunk = nextChunk.fetch_add(1)) < nChunks;) {
+		if ((chunk % 16) == 0 && !progress.report(chunk, nChunks)) {
+			stop = true;
+			err = ERROR_UserCancel;
+			break;
+		}
+		searchChunk(static_cast<gamenumT>(chunk * CHUNK_SIZE));
 	}
-	progress.report(1,1);
+	for (auto& th : workers) {
+		th.join();
+	}
+	filter->updateCount();
+	if (err == OK)
+		progress.report(1, 1);
 
-	return OK;
+	return err;
 }
-
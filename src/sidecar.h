@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/** @file
+ * Implements the common format of the optional sidecar files of a database.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "filebuf.h"
+#include "indexentry.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Sidecar files
+// -----------------------------------------------------------------------------
+//
+// A sidecar file stores data that can be recomputed from the games, like the
+// fingerprints (.sfp, see GameFingerprints) and the text index (.stx, see
+// GameTextIndex). It starts with an 8 bytes magic and contains for each game:
+//   varint: game number
+//   varint: offset of the game's data
+//   varint: length of the game's data
+//   the payload, whose format depends on the type of the file.
+// The file is append only and later records override the previous ones.
+// A record is valid only while the offset and the length of the game's data
+// match the IndexEntry: replaced games are automatically ignored.
+namespace sidecar {
+
+inline void writeVarint(std::vector<byte>& dest, uint64_t val) {
+	while (val >= 128) {
+		dest.push_back(static_cast<byte>(val | 128));
+		val >>= 7;
+	}
+	dest.push_back(static_cast<byte>(val));
+}
+
+/// Reads a varint, without reading past @e end.
+/// @returns false if the varint is not valid.
+inline bool readVarint(const byte*& src, const byte* end, uint64_t& res) {
+	res = 0;
+	for (int shift = 0; shift < 64 && src != end; shift += 7) {
+		const byte val = *src++;
+		res |= static_cast<uint64_t>(val & 127) << shift;
+		if (val < 128)
+			return true;
+	}
+	return false;
+}
+
+/// Encodes the header of the record of a game, which should be followed by
+/// the payload.
+inline void encodeRecordHeader(gamenumT gnum, IndexEntry const& ie,
+                               std::vector<byte>& dest) {
+	writeVarint(dest, gnum);
+	writeVarint(dest, ie.GetOffset());
+	writeVarint(dest, ie.GetLength());
+}
+
+/**
+ * Reads all the records of a sidecar file.
+ * @param filename: the path of the file.
+ * @param magic:    the 8 bytes magic of the type of the file.
+ * @param numGames: the number of games in the database; a record with a
+ *                  greater game number is not valid.
+ * @param readPayload: function invoked for each record with the parameters
+ *                  (gamenumT, uint64_t gameOffset, uint32_t gameLength,
+ *                  const byte*& it, const byte* end). It should read the
+ *                  payload, advancing @e it, and return false if it is not
+ *                  valid.
+ * @returns OK, ERROR_FileOpen if the file does not exist, ERROR_BadMagic or
+ * ERROR_Corrupt.
+ */
+template <typename TFunc>
+errorT load(std::string const& filename, std::string_view magic,
+            gamenumT numGames, TFunc readPayload) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+		return ERROR_FileOpen;
+
+	std::vector<byte> buf{std::istreambuf_iterator<char>(file),
+	                      std::istreambuf_iterator<char>()};
+	if (buf.size() < magic.size() ||
+	    !std::equal(magic.begin(), magic.end(), buf.begin()))
+		return ERROR_BadMagic;
+
+	const byte* it = buf.data() + magic.size();
+	const byte* const end = buf.data() + buf.size();
+	while (it != end) {
+		uint64_t header[3];
+		for (auto& val : header) {
+			if (!readVarint(it, end, val))
+				return ERROR_Corrupt;
+		}
+		if (header[0] >= numGames ||
+		    header[2] == 0 || header[2] > std::numeric_limits<uint32_t>::max())
+			return ERROR_Corrupt;
+
+		if (!readPayload(static_cast<gamenumT>(header[0]), header[1],
+		                 static_cast<uint32_t>(header[2]), it, end))
+			return ERROR_Corrupt;
+	}
+	return OK;
+}
+
+/// Opens a sidecar file for appending new records.
+/// @param recreate: if true, or if the file cannot be opened, a new file is
+///                  created.
+inline errorT openAppend(FilebufAppend& file, std::string const& filename,
+                         std::string_view magic, bool recreate) {
+	if (recreate || file.open(filename, FMODE_Both) != OK) {
+		if (auto err = file.open(filename, FMODE_Create))
+			return err;
+	}
+	if (file.size() == 0)
+		return file.append(magic.data(), magic.size());
+
+	return OK;
+}
+
+} // namespace sidecar
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the GameTextIndex class.
+ */
+
+#pragma once
+
+#include "bytebuf.h"
+#include "common.h"
+#include "game.h"
+#include "indexentry.h"
+#include "sidecar.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Full-text index of the annotations of the games.
+// -----------------------------------------------------------------------------
+//
+// The text of a game is composed by:
+// - the value of the Annotator tag
+// - the NAGs, both as "$N" and as symbols ("N", "forced", etc.)
+// - the comments (including the comments in the variations).
+// The text is split into words: sequences of ASCII letters and digits, '$'
+// and non-ASCII chars. ASCII letters are converted to lowercase.
+// For each game the index stores the sorted set of the 32-bit hashes of its
+// words, and for each hash the sorted list of the games that contain it.
+// The hashes may collide and a replaced game is not removed from the lists of
+// its old words: the index returns the games that may contain the searched
+// words and the matches should be verified with findWords().
+//
+// The index is stored in an optional sidecar file (see sidecar.h) with
+// extension .stx and magic "SCIDTX01". The payload of a record is:
+//   varint: number of hashes
+//   varint: first hash, followed by the difference from the previous one.
+class GameTextIndex {
+	struct Entry {
+		uint64_t gameOffset = 0;
+		uint32_t gameLength = 0; // 0 = not indexed
+	};
+	std::vector<Entry> entries_;
+	std::unordered_map<uint32_t, std::vector<gamenumT>> postings_;
+
+	static constexpr char MAGIC[8] = {'S', 'C', 'I', 'D', 'T', 'X', '0', '1'};
+
+public:
+	void clear() {
+		entries_.clear();
+		postings_.clear();
+	}
+
+	/// Invokes @e fn for each lowercase word in @e text.
+	template <typename TFunc>
+	static void forEachWord(std::string_view text, TFunc fn) {
+		std::string word;
+		auto flush = [&]() {
+			if (!word.empty()) {
+				fn(std::string_view(word));
+				word.clear();
+			}
+		};
+		for (unsigned char ch : text) {
+			if (ch >= 'A' && ch <= 'Z') {
+				word.push_back(static_cast<char>(ch - 'A' + 'a'));
+			} else if ((ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') ||
+			           ch == '$' || ch >= 0x80) {
+				word.push_back(static_cast<char>(ch));
+			} else {
+				flush();
+			}
+		}
+		flush();
+	}
+
+	static uint32_t hash(std::string_view word) {
+		uint32_t res = 2166136261U;
+		for (unsigned char ch : word) {
+			res = (res ^ ch) * 16777619U;
+		}
+		return res;
+	}
+
+	/// Invokes @e fn for each word of the text of a game.
+	/// @param data: the data of the game (encoded in native format).
+	/// @returns OK or an error code if the data is corrupted.
+	template <typename TFunc>
+	static errorT forEachGameWord(ByteBuffer data, TFunc fn) {
+		errorT err = data.decodeTags([&](auto const& tag, auto const& value) {
+			if (tag == "Annotator")
+				forEachWord(value, fn);
+		});
+		if (err)
+			return err;
+
+		if (auto [errStartBoard, fen] = data.decodeStartBoard(); errStartBoard)
+			return errStartBoard;
+
+		err = data.skipMoves([&](auto nag) {
+			char buf[16];
+			game_printNag(nag, buf, false, PGN_FORMAT_Plain);
+			forEachWord(buf, fn);
+			game_printNag(nag, buf, true, PGN_FORMAT_Plain);
+			forEachWord(buf, fn);
+		});
+		if (err)
+			return err;
+
+		return data.decodeComments(
+		    [&](std::string_view comment) { forEachWord(comment, fn); });
+	}
+
+	/// Returns true if the text of a game contains all the @e words.
+	/// @param data:  the data of the game (encoded in native format).
+	/// @param words: the lowercase words to search.
+	static bool findWords(ByteBuffer data,
+	                      std::vector<std::string> const& words) {
+		std::vector<bool> found(words.size(), false);
+		auto nFound = words.size();
+		forEachGameWord(data, [&](std::string_view word) {
+			for (size_t i = 0; i < words.size(); ++i) {
+				if (!found[i] && words[i] == word) {
+					found[i] = true;
+					--nFound;
+				}
+			}
+		});
+		return nFound == 0;
+	}
+
+	/// Creates the sorted set of the hashes of the words of a game.
+	static errorT make(ByteBuffer data, std::vector<uint32_t>& dest) {
+		dest.clear();
+		auto err = forEachGameWord(
+		    data, [&](std::string_view word) { dest.push_back(hash(word)); });
+		std::sort(dest.begin(), dest.end());
+		dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+		return err;
+	}
+
+	/// Stores the hashes of the words of a game.
+	/// @param gnum:   the game number.
+	/// @param ie:     the IndexEntry of the game.
+	/// @param hashes: the hashes created with make().
+	void set(gamenumT gnum, IndexEntry const& ie,
+	         std::vector<uint32_t> const& hashes) {
+		if (gnum >= entries_.size())
+			entries_.resize(gnum + 1);
+
+		entries_[gnum].gameOffset = ie.GetOffset();
+		entries_[gnum].gameLength = ie.GetLength();
+		for (auto hash : hashes) {
+			addPosting(hash, gnum);
+		}
+	}
+
+	/// Returns, for each game, false if the game is indexed and does not
+	/// contain all the @e words; the games that are not indexed are included.
+	/// @param nGames:   the number of games.
+	/// @param getEntry: function that returns the IndexEntry of a game.
+	/// @param words:    the lowercase words to search.
+	template <typename TFunc>
+	std::vector<bool> candidates(gamenumT nGames, TFunc getEntry,
+	                             std::vector<std::string> const& words) const {
+		std::vector<bool> res(nGames, true);
+		std::vector<gamenumT> games;
+		for (size_t i = 0; i < words.size(); ++i) {
+			auto it = postings_.find(hash(words[i]));
+			if (it == postings_.end()) {
+				games.clear();
+				break;
+			}
+			if (i == 0) {
+				games = it->second;
+			} else {
+				auto end = std::set_intersection(games.begin(), games.end(),
+				                                 it->second.begin(),
+				                                 it->second.end(), games.begin());
+				games.erase(end, games.end());
+			}
+		}
+		auto match = games.begin();
+		const auto n = std::min<size_t>(nGames, entries_.size());
+		for (gamenumT gnum = 0; gnum < n; ++gnum) {
+			while (match != games.end() && *match < gnum)
+				++match;
+			if (match != games.end() && *match == gnum)
+				continue;
+
+			auto const& entry = entries_[gnum];
+			IndexEntry const& ie = getEntry(gnum);
+			if (entry.gameLength != 0 && entry.gameLength == ie.GetLength() &&
+			    entry.gameOffset == ie.GetOffset())
+				res[gnum] = false;
+		}
+		return res;
+	}
+
+	/// Encodes a sidecar file record.
+	static void encodeRecord(gamenumT gnum, IndexEntry const& ie,
+	                         std::vector<uint32_t> const& hashes,
+	                         std::vector<byte>& dest) {
+		sidecar::encodeRecordHeader(gnum, ie, dest);
+		sidecar::writeVarint(dest, hashes.size());
+		uint32_t prev = 0;
+		for (auto hash : hashes) {
+			sidecar::writeVarint(dest, hash - prev);
+			prev = hash;
+		}
+	}
+
+	/// Returns the header of a new sidecar file.
+	static std::string_view fileHeader() { return {MAGIC, sizeof MAGIC}; }
+
+	/// Reads the sidecar file of a database with @e numGames games.
+	/// Returns OK, ERROR_FileOpen if the file does not exists or
+	/// ERROR_BadMagic/ERROR_Corrupt (all the records are discarded).
+	errorT load(std::string const& filename, gamenumT numGames) {
+		clear();
+		std::vector<uint32_t> hashes;
+		auto err = sidecar::load(
+		    filename, fileHeader(), numGames,
+		    [&](gamenumT gnum, uint64_t gameOffset, uint32_t gameLength,
+		        const byte*& it, const byte* end) {
+			    uint64_t n;
+			    if (!sidecar::readVarint(it, end, n) ||
+			        n > static_cast<uint64_t>(end - it))
+				    return false;
+
+			    hashes.clear();
+			    uint64_t hash = 0;
+			    for (; n > 0; --n) {
+				    uint64_t val;
+				    if (!sidecar::readVarint(it, end, val))
+					    return false;
+				    hash += val;
+				    if (hash > std::numeric_limits<uint32_t>::max())
+					    return false;
+				    hashes.push_back(static_cast<uint32_t>(hash));
+			    }
+
+			    if (gnum >= entries_.size())
+				    entries_.resize(gnum + 1);
+			    entries_[gnum].gameOffset = gameOffset;
+			    entries_[gnum].gameLength = gameLength;
+			    for (auto h : hashes) {
+				    addPosting(h, gnum);
+			    }
+			    return true;
+		    });
+		if (err)
+			clear();
+		return err;
+	}
+
+private:
+	void addPosting(uint32_t hash, gamenumT gnum) {
+		auto& games = postings_[hash];
+		if (games.empty() || games.back() < gnum) {
+			games.push_back(gnum);
+		} else {
+			auto it = std::lower_bound(games.begin(), games.end(), gnum);
+			if (it == games.end() || *it != gnum)
+				games.insert(it, gnum);
+		}
+	}
+};
@@ -28,13 +28,16 @@
 #include "crosstab.h"
 #include "dstring.h"
 #include "engine.h"
+#include "filterhistogram.h"
 #include "game.h"
 #include "optable.h"
 #include "pbook.h"
 #include "pgnparse.h"
+#include "pgntextfilter.h"
 #include "polyglot.h"
 #include "position.h"
 #include "scidbase.h"
+#include "searchgames.h"
 #include "searchpos.h"
 #include "spellchk.h"
 #include "stored.h"
@@ -1506,6 +1509,113 @@ sc_filter_freq (scidBaseT* dbase, const HFilter& filter, Tcl_Interp * ti, int ar
     return TCL_OK;
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sc_filter_histogram:
+//    Like sc_filter freq, but computes all the ranges with a single pass
+//    over the games. For each range returns a list with the number of
+//    filter games and of total database games in the range, followed by
+//    the number of 1-0, =-=, 0-1 and * results of the filter games.
+//    Usage:
+//        sc_filter histogram baseId filterName date|elo|move <ranges> [GuessElo]
+//    where <ranges> is a list of pairs of values with the same meaning of
+//    the <start> and <end> values of sc_filter freq.
+int
+sc_filter_histogram (scidBaseT* dbase, const HFilter& filter, Tcl_Interp * ti, int argc, const char ** argv)
+{
+    const char * usage =
+        "Usage: sc_filter histogram baseId filterName date|elo|move <ranges> [GuessElo]";
+
+    const char * options[] = { "date", "elo", "move", NULL };
+    enum { OPT_DATE, OPT_ELO, OPT_MOVE };
+    int option = -1;
+    int nValues = 0;
+    const char ** values = NULL;
+    if (argc == 6  ||  argc == 7) {
+        option = strUniqueMatch (argv[4], options);
+        if (Tcl_SplitList (ti, argv[5], &nValues, &values) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (option < 0  ||  nValues % 2 != 0) {
+        Tcl_Free ((char *) values);
+        return errorResult (ti, usage);
+    }
+    const bool guessElo = (argc == 7) ? strGetUnsigned (argv[6]) : true;
+
+    // Convert the ranges to the inclusive ranges of the histogram values.
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    for (int i = 0; i < nValues; i += 2) {
+        if (option == OPT_DATE) {
+            ranges.emplace_back(date_EncodeFromString (values[i]),
+                                date_EncodeFromString (values[i + 1]));
+            continue;
+        }
+        uint32_t min = strGetUnsigned (values[i]);
+        uint32_t max = strGetUnsigned (values[i + 1]);
+        if (option == OPT_ELO) {
+            if (guessElo) {
+                // The sum of the two ratings
+                min = min + min;
+                max = max + max + 1;
+            } else if (max == 0) {
+                // The lowest rating must be < max: empty range
+                min = 1;
+            } else {
+                max--;
+            }
+        }
+        ranges.emplace_back(min, max);
+    }
+    Tcl_Free ((char *) values);
+
+    const uint32_t* dates = dbase->getIndexColumn(Index::COL_DATE).data();
+    const uint32_t* wElos = dbase->getIndexColumn(Index::COL_WHITEELO).data();
+    const uint32_t* bElos = dbase->getIndexColumn(Index::COL_BLACKELO).data();
+    const uint32_t* plies = dbase->getIndexColumn(Index::COL_NUMHALFMOVES).data();
+    std::vector<HistogramBucket> buckets;
+    switch (option) {
+    case OPT_DATE:
+        buckets = filterHistogram(*dbase, filter, ranges, [&](gamenumT gnum) {
+            return dates[gnum];
+        });
+        break;
+    case OPT_MOVE:
+        buckets = filterHistogram(*dbase, filter, ranges, [&](gamenumT gnum) {
+            return plies[gnum];
+        });
+        break;
+    default:
+        buckets = filterHistogram(*dbase, filter, ranges, [&](gamenumT gnum) {
+            const uint32_t wElo = wElos[gnum];
+            const uint32_t bElo = bElos[gnum];
+            if (!guessElo)
+                return std::min(wElo, bElo);
+
+            uint32_t bothElo = wElo + bElo;
+            if (wElo == 0  &&  bElo != 0) {
+                bothElo += std::min<uint32_t>(bElo, 2200);
+            } else if (bElo == 0  &&  wElo != 0) {
+                bothElo += std::min<uint32_t>(wElo, 2200);
+            }
+            return bothElo;
+        });
+    }
+
+    UI_List res (buckets.size());
+    UI_List bucket (6);
+    for (auto const& b : buckets) {
+        bucket.clear();
+        bucket.push_back(b.filtered);
+        bucket.push_back(b.all);
+        bucket.push_back(b.results[RESULT_White]);
+        bucket.push_back(b.results[RESULT_Draw]);
+        bucket.push_back(b.results[RESULT_Black]);
+        bucket.push_back(b.results[RESULT_None]);
+        res.push_back(bucket);
+    }
+    return UI_Result(ti, OK, res);
+}
+
 //TODO:
 //This functions do not works because they do not specify the base, the filter and the sort criteria
 //So for the moment we assume base=db, filter=dbFilter and sort=N+
@@ -1577,6 +1687,93 @@ sc_filter_prev(ClientData, Tcl_Interp * ti, int, const char**)
 
 //END TODO
 
+// Formats the number of games and results of the filter statistics.
+std::string
+filterStatsLine (uint total, const uint results[NUM_RESULT_TYPES])
+{
+    char temp[80];
+    uint percentScore = results[RESULT_White] * 2 + results[RESULT_Draw] +
+        results[RESULT_None];
+    percentScore = total ? percentScore * 500 / total : 0;
+    sprintf (temp, "%7u %7u %7u %7u   %3u%c%u%%",
+             total,
+             results[RESULT_White],
+             results[RESULT_Draw],
+             results[RESULT_Black],
+             percentScore / 10, decimalPointChar, percentScore % 10);
+    return temp;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sc_filter_stats_histogram:
+//    Like sc_filter stats, but computes the statistics of all the ranges
+//    with a single pass over the games. Returns a list with the
+//    statistics of each range.
+//    Usage:
+//        sc_filter stats histogram elo|maxelo|year <ranges>
+//    where <ranges> is a list of pairs <min> <max>: a game is counted if
+//    the lowest rating (elo), the highest rating (maxelo) or the year is
+//    >= <min> and < <max>, or >= <min> if <max> is 0.
+int
+sc_filter_stats_histogram (Tcl_Interp * ti, int argc, const char ** argv)
+{
+    const char * usage =
+        "Usage: sc_filter stats histogram elo|maxelo|year <ranges>";
+
+    const char * options[] = { "elo", "maxelo", "year", NULL };
+    enum { OPT_ELO, OPT_MAXELO, OPT_YEAR };
+    int option = -1;
+    int nValues = 0;
+    const char ** values = NULL;
+    if (argc == 5) {
+        option = strExactMatch (argv[3], options);
+        if (Tcl_SplitList (ti, argv[4], &nValues, &values) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (option < 0  ||  nValues % 2 != 0) {
+        Tcl_Free ((char *) values);
+        return errorResult (ti, usage);
+    }
+
+    // Convert the ranges to the inclusive ranges of the histogram values.
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    for (int i = 0; i < nValues; i += 2) {
+        const uint32_t min = strGetUnsigned (values[i]);
+        const uint32_t max = strGetUnsigned (values[i + 1]);
+        if (max == 0) {
+            ranges.emplace_back(min, UINT32_MAX);
+        } else if (max <= min) {
+            ranges.emplace_back(1, 0); // empty range
+        } else {
+            ranges.emplace_back(min, max - 1);
+        }
+    }
+    Tcl_Free ((char *) values);
+
+    const HFilter filter = db->getFilter("dbfilter");
+    const uint32_t* dates = db->getIndexColumn(Index::COL_DATE).data();
+    const uint32_t* wElos = db->getIndexColumn(Index::COL_WHITEELO).data();
+    const uint32_t* bElos = db->getIndexColumn(Index::COL_BLACKELO).data();
+    auto buckets = filterHistogram(*db, filter, ranges, [&](gamenumT gnum) {
+        switch (option) {
+        case OPT_ELO:
+            return std::min(wElos[gnum], bElos[gnum]);
+        case OPT_MAXELO:
+            return std::max(wElos[gnum], bElos[gnum]);
+        }
+        return date_GetYear(dates[gnum]);
+    });
+
+    UI_List res (buckets.size());
+    for (auto const& b : buckets) {
+        uint results[NUM_RESULT_TYPES];
+        std::copy_n(b.results, NUM_RESULT_TYPES, results);
+        res.push_back(filterStatsLine(static_cast<uint>(b.filtered), results));
+    }
+    return UI_Result(ti, OK, res);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // sc_filter_stats:
 //    Returns statistics about the filter.
@@ -1585,6 +1782,9 @@ sc_filter_stats (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
 {
     enum {STATS_ALL, STATS_ELO, STATS_YEAR};
 
+    if (argc > 2  &&  strEqual (argv[2], "histogram")) {
+        return sc_filter_stats_histogram (ti, argc, argv);
+    }
     if (argc < 2 || argc > 5) {
         return errorResult (ti, "Usage: sc_filter stats [all | elo <xx> | year <xx>]");
     }
@@ -1649,17 +1849,7 @@ sc_filter_stats (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
             total++;
         }
     }
-    char temp[80];
-    uint percentScore = results[RESULT_White] * 2 + results[RESULT_Draw] +
-        results[RESULT_None];
-    percentScore = total ? percentScore * 500 / total : 0;
-    sprintf (temp, "%7u %7u %7u %7u   %3u%c%u%%",
-             total,
-             results[RESULT_White],
-             results[RESULT_Draw],
-             results[RESULT_Black],
-             percentScore / 10, decimalPointChar, percentScore % 10);
-    Tcl_AppendResult (ti, temp, NULL);
+    Tcl_AppendResult (ti, filterStatsLine(total, results).c_str(), NULL);
     return TCL_OK;
 }
 
@@ -1676,14 +1866,14 @@ sc_filter_old(ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
 {
     int index = -1;
     static const char * options [] = {
-        "count", "first", "frequency",
+        "count", "first", "frequency", "histogram",
         "last", "negate", "next",
         "previous", "stats",
         "search", "release",
         "treestats", "export", "copy", "and", "or", "new", NULL
     };
     enum {
-        FILTER_COUNT, FILTER_FIRST, FILTER_FREQ,
+        FILTER_COUNT, FILTER_FIRST, FILTER_FREQ, FILTER_HISTOGRAM,
         FILTER_LAST, FILTER_NEGATE, FILTER_NEXT,
         FILTER_PREV, FILTER_STATS,
         FILTER_SEARCH, FILTER_RELEASE,
@@ -1771,6 +1961,9 @@ sc_filter_old(ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
     case FILTER_FREQ:
         return sc_filter_freq (dbase, filter, ti, argc, argv);
 
+    case FILTER_HISTOGRAM:
+        return sc_filter_histogram (dbase, filter, ti, argc, argv);
+
     case FILTER_NEGATE:
         for (uint i=0, n = dbase->numGames(); i < n; i++) {
             filter.set(i, ! filter.get(i) );
@@ -1845,7 +2038,8 @@ sc_filter_old(ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
             if (exportFile == NULL) return errorResult (ti, "Error opening file for exporting games.");
             auto old_language = language;
             Game g;
-            if (strCompare("LaTeX", argv[6]) == 0) {
+            const bool latex = strCompare("LaTeX", argv[6]) == 0;
+            if (latex) {
                 g.SetPgnFormat (PGN_FORMAT_LaTeX);
                 g.ResetPgnStyle (PGN_STYLE_TAGS | PGN_STYLE_COMMENTS | PGN_STYLE_VARS | PGN_STYLE_SHORT_HEADER | PGN_STYLE_SYMBOLS | PGN_STYLE_INDENT_VARS);
             } else { //Default to PGN
@@ -1859,12 +2053,24 @@ sc_filter_old(ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
             gamenumT* idxList = new gamenumT[count];
             count = dbase->listGames(argv[4], 0, count, filter, idxList);
             errorT err = OK;
+            std::vector<char> pgnBuf;
                 for (size_t i = 0; i < count; ++i) {
                     const IndexEntry* ie = dbase->getIndexEntry(idxList[i]);
-                    // Skip any corrupt games:
-                    if (dbase->getGame(*ie, g) != OK) continue;
+                    std::pair<const char*, size_t> pgn;
+                    if (latex) {
+                        // Skip any corrupt games:
+                        if (dbase->getGame(*ie, g) != OK) continue;
+
+                        pgn = g.WriteToPGN(75, true);
+                    } else {
+                        // The PGN text is written directly from the encoded
+                        // game, without decoding it into a Game object.
+                        pgnBuf.clear();
+                        if (dbase->getGamePGN(*ie, pgnBuf) != OK) continue;
 
-                    std::pair<const char*, unsigned> pgn = g.WriteToPGN(75, true);
+                        pgnBuf.push_back('\n');
+                        pgn = {pgnBuf.data(), pgnBuf.size()};
+                    }
                     if (pgn.second != fwrite(pgn.first, 1, pgn.second, exportFile)) {
                         err = ERROR_FileWrite;
                         break;
@@ -2027,8 +2233,7 @@ sc_game (ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
         if (argc > 2 && strCompare("size", argv[2]) == 0) {
             return UI_Result(ti, OK, (uint) db->gameAlterations.undoSize());
         }
-        db->game = db->gameAlterations.undo(db->game);
-        return UI_Result(ti, OK);
+        return UI_Result(ti, db->gameAlterations.undo(db->game));
 
     case GAME_UNDO_ALL:
         db->gameAltered = false;
@@ -2051,8 +2256,7 @@ sc_game (ClientData cd, Tcl_Interp * ti, int argc, const char ** argv)
         if (argc > 2 && strCompare("size", argv[2]) == 0) {
             return UI_Result(ti, OK, (uint) db->gameAlterations.redoSize());
         }
-        db->game = db->gameAlterations.redo(db->game);
-        return UI_Result(ti, OK);
+        return UI_Result(ti, db->gameAlterations.redo(db->game));
 
     default:
         return InvalidCommand (ti, "sc_game", options);
@@ -2267,7 +2471,12 @@ sc_game_crosstable (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
     // Find all games that should be listed in the crosstable:
     const SpellChecker* spell = spellChk;
     bool tableFullMessage = false;
-    for (uint i=0, n = db->numGames(); i < n; i++) {
+    const auto eventGames = db->getNameGames(NAME_EVENT, eventId);
+    const auto siteGames = db->getNameGames(NAME_SITE, siteId);
+    const auto candidates = (eventGames.size() < siteGames.size())
+                                ? eventGames
+                                : siteGames;
+    for (gamenumT i : candidates) {
         const IndexEntry* ie = db->getIndexEntry(i);
         if (ie->GetDeleteFlag()  &&  !useDeletedGames) { continue; }
         if (! isCrosstableGame (ie, siteId, eventId, eventDate)) {
@@ -2420,33 +2629,28 @@ sc_game_find (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
 
     // We give each game a "score" which is 1 for each matching field.
     // So the best possible score is 6.
-
-    // First, check if the specified game number matches all fields:
-    if (db->numGames() > gnum) {
+    auto getScore = [&](gamenumT i) {
         uint score = 0;
-        const IndexEntry* ie = db->getIndexEntry(gnum);
+        const IndexEntry* ie = db->getIndexEntry(i);
         if (ie->GetWhite() == white) { score++; }
         if (ie->GetBlack() == black) { score++; }
         if (ie->GetSite() == site) { score++; }
         if (ie->GetRound() == round) { score++; }
         if (ie->GetYear() == year) { score++; }
         if (ie->GetResult() == result) { score++; }
-        if (score == 6) { return setUintResult (ti, gnum+1); }
+        return score;
+    };
+
+    // First, check if the specified game number matches all fields:
+    if (db->numGames() > gnum) {
+        if (getScore(gnum) == 6) { return setUintResult (ti, gnum+1); }
     }
 
     // Now look for the best matching game:
     uint bestNum = 0;
     uint bestScore = 0;
-
-    for (uint i=0, n = db->numGames(); i < n; i++) {
-        uint score = 0;
-        const IndexEntry* ie = db->getIndexEntry(i);
-        if (ie->GetWhite() == white) { score++; }
-        if (ie->GetBlack() == black) { score++; }
-        if (ie->GetSite() == site) { score++; }
-        if (ie->GetRound() == round) { score++; }
-        if (ie->GetYear() == year) { score++; }
-        if (ie->GetResult() == result) { score++; }
+    auto update = [&](gamenumT i) {
+        uint score = getScore(i);
         // Update if the best score, favouring the specified game number
         // in the case of a tie:
         if (score > bestScore  ||  (score == bestScore  &&  gnum == i)) {
@@ -2454,7 +2658,30 @@ sc_game_find (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
             bestNum = i;
         }
         // Stop now if the best possible match is found:
-        if (score == 6) { break; }
+        return score == 6;
+    };
+
+    // The games that do not contain the white player, the black player or
+    // the site have at most a score of 3: try the other games first.
+    std::vector<gamenumT> candidates;
+    for (auto [nt, id] : {std::pair(NAME_PLAYER, white),
+                          std::pair(NAME_PLAYER, black),
+                          std::pair(NAME_SITE, site)}) {
+        const auto games = db->getNameGames(nt, id);
+        candidates.insert(candidates.end(), games.begin(), games.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+    for (gamenumT i : candidates) {
+        if (update(i)) { break; }
+    }
+    if (bestScore <= 3) {
+        bestNum = 0;
+        bestScore = 0;
+        for (gamenumT i = 0, n = db->numGames(); i < n; i++) {
+            if (update(i)) { break; }
+        }
     }
     return setUintResult (ti, bestNum + 1);
 }
@@ -5725,7 +5952,7 @@ sc_name_info (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
 
     if (setFilter || setOpponent) db->dbFilter->Fill(0);
 
-    for (uint i=0, n = db->numGames(); i < n; i++) {
+    for (gamenumT i : db->getNameGames(NAME_PLAYER, id)) {
         const IndexEntry* ie = db->getIndexEntry(i);
         ecoT ecoCode = ie->GetEcoCode();
         int ecoClass = -1;
@@ -6346,12 +6573,12 @@ sc_name_plist (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
     }
 
     std::vector<PlayerActivity> activity(nPlayers);
-    for (gamenumT gnum=0, n = dbase->numGames(); gnum < n; gnum++) {
-        const IndexEntry* ie = dbase->getIndexEntry(gnum);
-        dateT date = ie->GetDate();
-        if (date_GetYear(date) > 0) {
-            activity[ie->GetWhite()].addDate(date);
-            activity[ie->GetBlack()].addDate(date);
+    for (idNumberT id : plist) {
+        for (gamenumT gnum : dbase->getNameGames(NAME_PLAYER, id)) {
+            dateT date = dbase->getIndexEntry(gnum)->GetDate();
+            if (date_GetYear(date) > 0) {
+                activity[id].addDate(date);
+            }
         }
     }
 
@@ -7450,14 +7677,14 @@ int sc_search_board(Tcl_Interp* ti, const scidBaseT* dbase, HFilter filter,
 
     Progress progress = UI_CreateProgress(ti);
     Timer timer;  // Start timing this search.
-    Position * posFlip =  NULL;
+    std::unique_ptr<Position> posFlip;
     matSigT msig = matsig_Make (pos->GetMaterial());
     matSigT msigFlip = 0;
     uint hpSig = pos->GetHPSig();
     uint hpSigFlip = 0;
 
     if (flip) {
-        posFlip = new Position;
+        posFlip = std::make_unique<Position>();
         posFlip->Clear();
         for (auto sq = A1; sq <= H8; ++sq) {
             const auto piece = pos->GetPiece(sq);
@@ -7480,49 +7707,33 @@ int sc_search_board(Tcl_Interp* ti, const scidBaseT* dbase, HFilter filter,
     }
     size_t startFilterCount = filter->size();
 
-    // Here is the loop that searches on each game:
-    Game tmpGame;
-    Game* g = &tmpGame;
-    gamenumT gameNum = 0;
-    for (gamenumT n = dbase->numGames(); gameNum < n; gameNum++) {
-        if ((gameNum % 5000) == 0) {  // Update the percentage done bar:
-            if (!progress.report(gameNum, n)) break;
-        }
-        // First, apply the filter operation:
-        if (filterOp == FILTEROP_AND) {  // Skip any games not in the filter:
-            if (filter.get(gameNum) == 0) {
-                continue;
-            }
-        } else /* filterOp==FILTEROP_OR*/ { // Skip any games in the filter:
-            if (filter.get(gameNum) != 0) {
-                continue;
-            } else {
-                // OK, this game is NOT in the filter.
-                // Add it so filterCounts are kept up to date:
-                filter.set (gameNum, 1);
-            }
-        }
-
-        const IndexEntry* ie = dbase->getIndexEntry(gameNum);
-        if (ie->GetLength() == 0) {
-            // Skip games with no gamefile record:
-            filter.set (gameNum, 0);
-            continue;
-        }
+    // The fingerprint of a game contains the material signatures and the
+    // pawn hashes of all the positions of the main line:
+    const bool checkPawnHash = (searchType == GAME_EXACT_MATCH_Exact ||
+                                searchType == GAME_EXACT_MATCH_Pawns);
+    auto fingerprintMatch = [&](const byte* fp, matSigT ms,
+                                const Position* p) {
+        if (checkPawnHash &&
+            !GameFingerprints::hasPawnHash(fp, p->PawnHashValue()))
+            return false;
+        return GameFingerprints::hasMatSig(fp, ms);
+    };
 
+    enum { MATCH_NORMAL = 1, MATCH_FLIPPED = 2 };
+    auto prefilter = [&](gamenumT gnum, const IndexEntry& ie) {
         // Set "useVars" to true only if the search specified searching
         // in variations, AND this game has variations:
-        bool useVars = searchInVars && ie->GetVariationsFlag();
+        bool useVars = searchInVars && ie.GetVariationsFlag();
 
         bool possibleMatch = true;
         bool possibleFlippedMatch = flip;
 
         // Apply speedups if we are not searching in variations:
         if (! useVars) {
-            if (! ie->GetStartFlag()) {
+            if (! ie.GetStartFlag()) {
                 // Speedups that only apply to standard start games:
                 if (useHpSigSpeedup  &&  hpSig != 0xFFFF) {
-                    const byte * hpData = ie->GetHomePawnData();
+                    const byte * hpData = ie.GetHomePawnData();
                     if (! hpSig_PossibleMatch (hpSig, hpData)) {
                         possibleMatch = false;
                     }
@@ -7537,83 +7748,100 @@ int sc_search_board(Tcl_Interp* ti, const scidBaseT* dbase, HFilter filter,
             // If this game has no promotions, check the material of its final
             // position, since the searched position might be unreachable:
             if (possibleMatch) {
-                if (!matsig_isReachable (msig, ie->GetFinalMatSig(),
-                                         ie->GetPromotionsFlag(),
-                                         ie->GetUnderPromoFlag())) {
+                if (!matsig_isReachable (msig, ie.GetFinalMatSig(),
+                                         ie.GetPromotionsFlag(),
+                                         ie.GetUnderPromoFlag())) {
                         possibleMatch = false;
                     }
             }
             if (possibleFlippedMatch) {
-                if (!matsig_isReachable (msigFlip, ie->GetFinalMatSig(),
-                                         ie->GetPromotionsFlag(),
-                                         ie->GetUnderPromoFlag())) {
+                if (!matsig_isReachable (msigFlip, ie.GetFinalMatSig(),
+                                         ie.GetPromotionsFlag(),
+                                         ie.GetUnderPromoFlag())) {
                         possibleFlippedMatch = false;
                     }
             }
-        }
 
-        if (!possibleMatch  &&  !possibleFlippedMatch) {
-            filter.set (gameNum, 0);
-            continue;
+            // Use the fingerprint, if available, to skip the games that
+            // never reach the material and the pawn structure searched:
+            if (const byte* fp = dbase->getFingerprint(gnum)) {
+                if (possibleMatch && !fingerprintMatch(fp, msig, pos)) {
+                    possibleMatch = false;
+                }
+                if (possibleFlippedMatch &&
+                    !fingerprintMatch(fp, msigFlip, posFlip.get())) {
+                    possibleFlippedMatch = false;
+                }
+            }
         }
 
-        // At this point, the game needs to be loaded:
-        auto bbuf = dbase->getGame(*ie);
-        if (!bbuf) {
-            return errorResult (ti, "Error reading game file.");
-        }
+        return (possibleMatch ? static_cast<unsigned>(MATCH_NORMAL) : 0u) |
+               (possibleFlippedMatch ? static_cast<unsigned>(MATCH_FLIPPED)
+                                     : 0u);
+    };
+
+    // At this point, the game needs to be loaded (by a worker thread):
+    auto match = [&](Game& g, const IndexEntry& ie, ByteBuffer& bbuf,
+                     unsigned hint) -> byte {
+        const bool possibleMatch = hint & MATCH_NORMAL;
+        const bool possibleFlippedMatch = hint & MATCH_FLIPPED;
         uint ply = 0;
-        if (useVars) {
-            g->DecodeMovesOnly(bbuf);
+        if (searchInVars && ie.GetVariationsFlag()) {
+            g.DecodeMovesOnly(bbuf);
             // Try matching the game without variations first:
             if (ply == 0  &&  possibleMatch) {
-                if (g->ExactMatch (pos, NULL, searchType)) {
-                    ply = g->GetCurrentPly() + 1;
+                if (g.ExactMatch (pos, NULL, searchType)) {
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
             if (ply == 0  &&  possibleFlippedMatch) {
-                if (g->ExactMatch (posFlip, NULL, searchType)) {
-                    ply = g->GetCurrentPly() + 1;
+                if (g.ExactMatch (posFlip.get(), NULL, searchType)) {
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
             if (ply == 0  &&  possibleMatch) {
-                g->MoveToStart();
-                if (g->VarExactMatch (pos, searchType)) {
-                    ply = g->GetCurrentPly() + 1;
+                g.MoveToStart();
+                if (g.VarExactMatch (pos, searchType)) {
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
             if (ply == 0  &&  possibleFlippedMatch) {
-                g->MoveToStart();
-                if (g->VarExactMatch (posFlip, searchType)) {
-                    ply = g->GetCurrentPly() + 1;
+                g.MoveToStart();
+                if (g.VarExactMatch (posFlip.get(), searchType)) {
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
         } else {
             // No searching in variations:
             if (possibleMatch) {
                 auto bbuf_clone = bbuf;
-                if (g->ExactMatch(pos, &bbuf_clone, searchType)) {
+                if (g.ExactMatch(pos, &bbuf_clone, searchType)) {
                     // Set its auto-load move number to the matching move:
-                    ply = g->GetCurrentPly() + 1;
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
             if (ply == 0  &&  possibleFlippedMatch) {
-                if (g->ExactMatch (posFlip, &bbuf, searchType)) {
-                    ply = g->GetCurrentPly() + 1;
+                if (g.ExactMatch (posFlip.get(), &bbuf, searchType)) {
+                    ply = g.GetCurrentPly() + 1;
                 }
             }
         }
         if (ply > 255) { ply = 255; }
-        filter.set (gameNum, ply);
-    }
+        return static_cast<byte>(ply);
+    };
+
+    errorT err = searchGames(*dbase, filter, filterOp, progress, prefilter,
+                             match);
 
     progress.report(1,1);
-    if (flip) { delete posFlip; }
+    if (err == ERROR_FileRead) {
+        return errorResult (ti, "Error reading game file.");
+    }
 
     // Now print statistics and time for the search:
     char temp[200];
     int centisecs = timer.CentiSecs();
-    if (gameNum != dbase->numGames()) {
+    if (err != OK) {
         Tcl_AppendResult (ti, errMsgSearchInterrupted(ti), "  ", NULL);
     }
     sprintf (temp, "%lu / %lu  (%d%c%02d s)",
@@ -7897,7 +8125,6 @@ sc_search_material (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
     Timer timer;  // Start timing this search.
 
     char temp [250];
-    Game * g = scratchGame;
     HFilter filter = db->getFilter("dbfilter");
 
     // If filter operation is to reset the filter, reset it:
@@ -7907,37 +8134,34 @@ sc_search_material (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
     }
     size_t startFilterCount = filter->size();
 
-    // Here is the loop that searches on each game:
-    gamenumT gameNum = 0, n = db->numGames();
-    for (; gameNum < n; gameNum++) {
-        if ((gameNum % 1000) == 0) {  // Update the percentage done bar:
-            if (!progress.report(gameNum, n)) break;
-        }
-        // First, apply the filter operation:
-        if (filterOp == FILTEROP_AND) {  // Skip any games not in the filter:
-            if (filter.get(gameNum) == 0) {
-                continue;
-            }
-        } else /* filterOp == FILTEROP_OR*/ { // Skip any games in the filter:
-            if (filter.get(gameNum) != 0) {
-                continue;
-            }
-            // OK, this game is NOT in the filter.
-            // Add it so filterCounts are kept up to date:
-            filter.set (gameNum, 1);
-        }
-
-        const IndexEntry* ie = db->getIndexEntry(gameNum);
-        if (ie->GetLength() == 0) {  // Skip games with no gamefile record
-            filter.set (gameNum, 0);
-            continue;
+    // Check if a material signature of the fingerprint of a game can match
+    // the piece counts ranges. The signatures store at most 3 non-pawn
+    // pieces of each type: a count of 3 means "3 or more".
+    auto matsigInRange = [](matSigT m, const byte* lo, const byte* hi) {
+        for (pieceT p : {WP, BP}) {
+            const uint n = matsig_getCount (m, p);
+            if (n < lo[p]  ||  n > hi[p]) { return false; }
+        }
+        for (pieceT p : {WQ, BQ, WR, BR, WB, BB, WN, BN}) {
+            const uint n = matsig_getCount (m, p);
+            if (n > hi[p]  ||  (n < 3  &&  n < lo[p])) { return false; }
+        }
+        for (colorT c : {WHITE, BLACK}) {
+            const uint nB = matsig_getCount (m, piece_Make (c, BISHOP));
+            const uint nN = matsig_getCount (m, piece_Make (c, KNIGHT));
+            const pieceT minor = (c == WHITE) ? WM : BM;
+            if (nB + nN > hi[minor]) { return false; }
+            if (nB < 3  &&  nN < 3  &&  nB + nN < lo[minor]) { return false; }
         }
+        return true;
+    };
 
-        if (ie->GetNumHalfMoves() < minMoves  &&  ! ie->GetStartFlag()) {
+    enum { MATCH_NORMAL = 1, MATCH_FLIPPED = 2 };
+    auto prefilter = [&](gamenumT gnum, const IndexEntry& ie) {
+        if (ie.GetNumHalfMoves() < minMoves  &&  ! ie.GetStartFlag()) {
             // Skip games without enough moves to match, if they
             // have the standard starting position:
-            filter.set (gameNum, 0);
-            continue;
+            return 0u;
         }
 
         bool possibleMatch = true;
@@ -7945,16 +8169,16 @@ sc_search_material (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
 
         // First, eliminate games that cannot match from their final
         // material signature:
-        if (checkMsig  &&  !matsig_isReachable (msig, ie->GetFinalMatSig(),
-                                                ie->GetPromotionsFlag(),
-                                                ie->GetUnderPromoFlag()))
+        if (checkMsig  &&  !matsig_isReachable (msig, ie.GetFinalMatSig(),
+                                                ie.GetPromotionsFlag(),
+                                                ie.GetUnderPromoFlag()))
         {
             possibleMatch = false;
         }
         if (flip  &&  checkMsig
-                &&  !matsig_isReachable (msigFlipped, ie->GetFinalMatSig(),
-                                         ie->GetPromotionsFlag(),
-                                         ie->GetUnderPromoFlag()))
+                &&  !matsig_isReachable (msigFlipped, ie.GetFinalMatSig(),
+                                         ie.GetPromotionsFlag(),
+                                         ie.GetUnderPromoFlag()))
         {
             possibleFlippedMatch = false;
         }
@@ -7965,65 +8189,82 @@ sc_search_material (ClientData, Tcl_Interp * ti, int argc, const char ** argv)
         // at home need not be loaded:
 
         if (possibleMatch  &&  hpExcludeMask != HPSIG_Empty) {
-            uint gameFinalHP = hpSig_Final (ie->GetHomePawnData());
+            uint gameFinalHP = hpSig_Final (ie.GetHomePawnData());
             // If any bit is set in both, this game cannot match:
             if ((gameFinalHP & hpExcludeMask) != 0) {
                 possibleMatch = false;
             }
         }
         if (possibleFlippedMatch  &&  hpExMaskFlip != HPSIG_Empty) {
-            uint gameFinalHP = hpSig_Final (ie->GetHomePawnData());
+            uint gameFinalHP = hpSig_Final (ie.GetHomePawnData());
             // If any bit is set in both, this game cannot match:
             if ((gameFinalHP & hpExMaskFlip) != 0) {
                 possibleFlippedMatch = false;
             }
         }
 
-        if (!possibleMatch  &&  !possibleFlippedMatch) {
-            filter.set (gameNum, 0);
-            continue;
+        // Use the fingerprint, if available, to skip the games that never
+        // reach the searched material:
+        if (const byte* fp = db->getFingerprint(gnum)) {
+            if (possibleMatch  &&  !GameFingerprints::anyMatSig(fp,
+                    [&](matSigT m) { return matsigInRange(m, min, max); })) {
+                possibleMatch = false;
+            }
+            if (possibleFlippedMatch  &&  !GameFingerprints::anyMatSig(fp,
+                    [&](matSigT m) {
+                        return matsigInRange(m, minFlipped, maxFlipped);
+                    })) {
+                possibleFlippedMatch = false;
+            }
         }
 
-        // Now, the game must be loaded and searched:
-        auto bbuf = db->getGame(*ie);
-        if (!bbuf) {
-            continue;
-        }
+        return (possibleMatch ? static_cast<unsigned>(MATCH_NORMAL) : 0u) |
+               (possibleFlippedMatch ? static_cast<unsigned>(MATCH_FLIPPED)
+                                     : 0u);
+    };
 
+    // Now, the game must be decoded and searched (by a worker thread):
+    auto match = [&](Game& g, const IndexEntry& ie, ByteBuffer& bbuf,
+                     unsigned hint) -> byte {
+        bool hasPromo = ie.GetPromotionsFlag() || ie.GetUnderPromoFlag();
         bool result = false;
-        if (possibleMatch) {
+        if (hint & MATCH_NORMAL) {
             auto bbuf_clone = bbuf;
-            bool hasPromo = ie->GetPromotionsFlag() || ie->GetUnderPromoFlag();
-            result = g->MaterialMatch (hasPromo, bbuf_clone, min, max, patt.data(), patt.size(),
-                                       minPly, maxPly, matchLength,
-                                       oppBishops, sameBishops,
-                                       matDiff[0], matDiff[1]);
-        }
-        if (result == 0  &&  possibleFlippedMatch) {
-            bool hasPromo = ie->GetPromotionsFlag() || ie->GetUnderPromoFlag();
-            result = g->MaterialMatch (hasPromo, bbuf, minFlipped, maxFlipped,
-                                       flippedPatt.data(), flippedPatt.size(), minPly, maxPly,
-                                       matchLength, oppBishops, sameBishops,
-                                       matDiff[0], matDiff[1]);
-        }
-
-        if (result) {
-            // update the filter value to the current ply:
-            uint plyOfMatch = g->GetCurrentPly() + 1 - matchLength;
-            byte b = (byte) (plyOfMatch + 1);
-            if (b == 0) { b = 1; }
-            filter.set (gameNum, b);
-        } else {
+            result = g.MaterialMatch (hasPromo, bbuf_clone, min, max, patt.data(), patt.size(),
+                                      minPly, maxPly, matchLength,
+                                      oppBishops, sameBishops,
+                                      matDiff[0], matDiff[1]);
+        }
+        if (!result  &&  (hint & MATCH_FLIPPED)) {
+            result = g.MaterialMatch (hasPromo, bbuf, minFlipped, maxFlipped,
+                                      flippedPatt.data(), flippedPatt.size(), minPly, maxPly,
+                                      matchLength, oppBishops, sameBishops,
+                                      matDiff[0], matDiff[1]);
+        }
+        if (!result) {
             // This game did NOT match:
-            filter.set (gameNum, 0);
+            return 0;
         }
-    }
+
+        // update the filter value to the current ply:
+        uint plyOfMatch = g.GetCurrentPly() + 1 - matchLength;
+        byte b = (byte) (plyOfMatch + 1);
+        if (b == 0) { b = 1; }
+        return b;
+    };
+
+    // Like the older versions, the games that cannot be read are skipped.
+    errorT err = searchGames(*db, filter, filterOp, progress, prefilter, match,
+                             true);
 
     progress.report(1,1);
 
     int centisecs = timer.CentiSecs();
 
-    if (gameNum != n) {
+    if (err == ERROR_FileRead) {
+        return errorResult (ti, "Error reading game file.");
+    }
+    if (err != OK) {
         Tcl_AppendResult (ti, errMsgSearchInterrupted(ti), "  ", NULL);
     }
     sprintf (temp, "%lu / %lu  (%d%c%02d s)",
@@ -8101,15 +8342,17 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
     int pgnTextCount = 0;
     char ** sPgnText = NULL;
 
+    std::vector<std::string> textWords;
+
     const char * options[] = {
         "annotator", "annotated",
         "wtitles", "btitles", "toMove",
-        "pgn", NULL
+        "pgn", "text", NULL
     };
     enum {
         OPT_ANNOTATOR, OPT_ANNOTATED,
         OPT_WTITLES, OPT_BTITLES, OPT_TOMOVE,
-        OPT_PGN
+        OPT_PGN, OPT_TEXT
     };
 
     int arg = 2;
@@ -8161,6 +8404,12 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
             }
             break;
 
+        case OPT_TEXT:
+            // Games whose comments, NAGs and Annotator contain all the words
+            GameTextIndex::forEachWord(value, [&](std::string_view word) {
+                textWords.emplace_back(word);
+            });
+            break;
         }
     }
 
@@ -8231,10 +8480,20 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
     bool skipSearch = false;
     if (sAnnotator.empty() && mWhite.empty() && mBlack.empty() &&
         bAnnotated == false && wToMove == true && bToMove == true &&
-        pgnTextCount == 0) {
+        pgnTextCount == 0 && textWords.empty()) {
         skipSearch = true;
     }
 
+    // Use the text index to exclude the games that cannot match
+    std::vector<bool> textCandidates;
+    if (!skipSearch && !textWords.empty()) {
+        textCandidates = base->textCandidates(textWords);
+    }
+
+    // Use the tags and the comments in the games' data to exclude the games
+    // whose PGN cannot contain the text
+    const PgnTextFilter pgnTextFilter({sPgnText, sPgnText + pgnTextCount});
+
     // Here is the loop that searches on each game:
     errorT result = OK;
     if (!skipSearch)
@@ -8284,12 +8543,6 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
 		};
 		bool match = matchGameHeader();
 
-        // Now try to match the comment text if applicable:
-        // Note that it is not worth using a faster staring search
-        // algorithm like Boyer-Moore or Knuth-Morris-Pratt since
-        // profiling showed most that most of the time is spent
-        // generating the PGN representation of each game.
-
 		if (match && !sAnnotator.empty()) {
 			match = false;
 			base->getGame(*ie).decodeTags(
@@ -8301,6 +8554,18 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
 				});
 		}
 
+		if (match && !textWords.empty()) {
+			match = textCandidates[i] &&
+			        GameTextIndex::findWords(base->getGame(*ie), textWords);
+		}
+
+		if (match && pgnTextCount > 0) {
+			match = pgnTextFilter.mayMatch(base->getGame(*ie), *ie,
+			                               *base->getNameBase());
+		}
+
+		// Generating the PGN representation is slow: only for the games
+		// that were not excluded
 		if (match && pgnTextCount > 0) {
 			if (base->getGame(*ie, *scratchGame) != OK) {
 				match = false;
@@ -8311,12 +8576,8 @@ sc_search_header (ClientData, Tcl_Interp * ti, scidBaseT* base, HFilter& filter,
 				scratchGame->AddPgnStyle(PGN_STYLE_VARS);
 				scratchGame->AddPgnStyle(PGN_STYLE_SYMBOLS);
 				scratchGame->SetPgnFormat(PGN_FORMAT_Plain);
-				const char* buf = scratchGame->WriteToPGN().first;
-				for (int m = 0; m < pgnTextCount; m++) {
-					if (match) {
-						match = strContains(buf, sPgnText[m]);
-					}
-				}
+				auto [buf, len] = scratchGame->WriteToPGN();
+				match = pgnTextFilter.match({buf, len});
 			}
 		}
 
@@ -89,7 +89,7 @@ int sc_var_enter      (TCL_ARGS);
 int sc_var_first      (TCL_ARGS);
 int sc_var_list       (TCL_ARGS);
 
-errorT search_index(const scidBaseT* base, HFilter& filter, int argc, const char ** argv, const Progress& progress);
+errorT search_index(const scidBaseT* base, HFilter& filter, int argc, const char ** argv, const Progress& progress, unsigned nThreads = 0);
 int sc_search_board   (Tcl_Interp* ti, const scidBaseT* dbase, HFilter filter, int argc, const char** argv);
 int sc_search_material (TCL_ARGS);
 int sc_search_header  (ClientData cd, Tcl_Interp * ti, scidBaseT* base, HFilter& filter, int argc, const char ** argv);
@@ -0,0 +1,652 @@
+/*
+ * Copyright (C) 2026  Fulvio Benini.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file
+ * Implements the UCIInfoPV, EngineOutput and EngineProcess classes.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "position.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#undef NOMINMAX
+#undef ERROR
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+/// Removes the first word (and the spaces before it) from @e str.
+/// @returns the removed word.
+inline std::string_view nextUCIWord(std::string_view& str) {
+	str.remove_prefix(std::min(str.find_first_not_of(' '), str.size()));
+	auto word = str.substr(0, str.find(' '));
+	str.remove_prefix(word.size());
+	return word;
+}
+
+/// Parses all the values of a UCI "info" line and invokes fn(token, value) for
+/// each of them. The value of "score" contains the type, the score and the
+/// optional bound (e.g. "cp -35" or "mate 3 lowerbound"), the value of "wdl"
+/// the 3 numbers, the values of "pv", "refutation" and "currline" the moves,
+/// and the value of "string" the rest of the line.
+/// @returns false if the line is not an "info" line.
+template <typename TFunc> bool parseUCIInfo(std::string_view line, TFunc fn) {
+	if (line.substr(0, 5) != "info ")
+		return false;
+
+	constexpr std::string_view singleValue[] = {
+	    "depth",    "seldepth", "time",   "nodes",  "multipv", "currmove",
+	    "currmovenumber", "hashfull", "nps", "tbhits", "sbhits", "cpuload"};
+	constexpr std::string_view moveList[] = {"pv", "refutation", "currline"};
+	constexpr std::string_view others[] = {
+	    "score", "cp", "mate", "lowerbound", "upperbound", "wdl", "string"};
+	auto isIn = [](auto const& tokens, std::string_view word) {
+		return std::find(std::begin(tokens), std::end(tokens), word) !=
+		       std::end(tokens);
+	};
+	auto isToken = [&](std::string_view word) {
+		return isIn(singleValue, word) || isIn(moveList, word) ||
+		       isIn(others, word);
+	};
+	line.remove_prefix(5);
+	// The words from @e first to the end of @e last.
+	auto span = [](std::string_view first, std::string_view last) {
+		return std::string_view(first.data(),
+		                        last.data() + last.size() - first.data());
+	};
+
+	for (auto word = nextUCIWord(line); !word.empty(); word = nextUCIWord(line)) {
+		if (isIn(singleValue, word)) {
+			auto value = nextUCIWord(line);
+			if (!value.empty())
+				fn(word, value);
+
+		} else if (isIn(moveList, word)) {
+			auto rest = line;
+			auto first = nextUCIWord(rest);
+			auto last = first;
+			for (auto move = first; !move.empty() && !isToken(move);
+			     move = nextUCIWord(rest)) {
+				last = move;
+				line = rest;
+			}
+			if (!isToken(first) && !first.empty())
+				fn(word, span(first, last));
+
+		} else if (word == "score" || word == "wdl") {
+			const int nWords = (word == "score") ? 2 : 3;
+			auto first = nextUCIWord(line);
+			auto last = first;
+			for (int i = 1; i < nWords && !last.empty(); ++i) {
+				last = nextUCIWord(line);
+			}
+			auto rest = line;
+			auto bound = nextUCIWord(rest);
+			if (bound == "lowerbound" || bound == "upperbound") {
+				last = bound;
+				line = rest;
+			}
+			if (!last.empty())
+				fn(word, span(first, last));
+
+		} else if (word == "string") {
+			line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+			fn(word, line);
+			break;
+		}
+	}
+	return true;
+}
+
+/// The values of a UCI "info" line that contains a principal variation.
+/// The values are views of the parsed line and are empty if not present.
+struct UCIInfoPV {
+	std::string_view multipv;
+	std::string_view depth;
+	std::string_view seldepth;
+	std::string_view nodes;
+	std::string_view nps;
+	std::string_view hashfull;
+	std::string_view tbhits;
+	std::string_view time;
+	std::string_view score;
+	std::string_view score_type; // cp, mate, lowerbound or upperbound
+	std::string_view wdl[3];
+	std::string_view pv; // the moves in coordinate notation
+
+	/// Parses an "info" line.
+	/// @returns false if the line is not an "info" line with a "pv".
+	bool parse(std::string_view line) {
+		*this = UCIInfoPV();
+		std::pair<std::string_view, std::string_view*> values[] = {
+		    {"multipv", &multipv}, {"depth", &depth},       {"seldepth", &seldepth},
+		    {"nodes", &nodes},     {"nps", &nps},           {"hashfull", &hashfull},
+		    {"tbhits", &tbhits},   {"time", &time},         {"pv", &pv}};
+		parseUCIInfo(line, [&](std::string_view token, std::string_view value) {
+			if (token == "score" || token == "wdl") {
+				std::string_view words[3];
+				for (auto& word : words) {
+					word = nextUCIWord(value);
+				}
+				if (token == "wdl") {
+					std::copy(std::begin(words), std::end(words), wdl);
+				} else if (isInteger(words[1])) {
+					score = words[1];
+					score_type = words[2].empty() ? words[0] : words[2];
+				}
+				return;
+			}
+			for (auto [name, dest] : values) {
+				if (token == name && (token == "pv" || isInteger(value)))
+					*dest = value;
+			}
+		});
+		if (pv.empty())
+			return false;
+
+		if (multipv.empty())
+			multipv = "1";
+		return true;
+	}
+
+	/// Returns true if @e str is an integer (with an optional sign).
+	static bool isInteger(std::string_view str) {
+		if (!str.empty() && (str[0] == '-' || str[0] == '+'))
+			str.remove_prefix(1);
+		return !str.empty() &&
+		       std::all_of(str.begin(), str.end(),
+		                   [](char ch) { return ch >= '0' && ch <= '9'; });
+	}
+};
+
+/// Plays the moves @e coordMoves (UCI coordinate notation) from @e pos and
+/// invokes fn(pos, sm, last) for each legal move, before it is made (fn may
+/// use the position but must leave it unchanged); @e last is true if no other move
+/// follows. Stops at the first illegal move.
+/// @returns true if all the moves are legal.
+template <typename TFunc>
+bool playCoordMoves(Position& pos, std::string_view coordMoves, TFunc fn) {
+	for (auto move = nextUCIWord(coordMoves); !move.empty();) {
+		simpleMoveT sm;
+		if (pos.ReadCoordMove(&sm, move.data(), move.size(), false) != OK)
+			return false;
+
+		const auto next = nextUCIWord(coordMoves);
+		fn(pos, sm, next.empty());
+		pos.DoSimpleMove(sm);
+		move = next;
+	}
+	return true;
+}
+
+/// Converts the moves @e coordMoves, in coordinate notation, to SAN (e.g.
+/// "1...e5 2.Nf3" or, without move numbers, "e5 Nf3"). The conversion stops
+/// at the first illegal move.
+inline std::string coordToSAN(Position pos, std::string_view coordMoves,
+                              bool moveNumbers) {
+	std::string res;
+	playCoordMoves(pos, coordMoves,
+	               [&](Position& before, simpleMoveT& sm, bool last) {
+		               if (!res.empty())
+			               res.push_back(' ');
+		               const auto moveNum = before.GetFullMoveCount();
+		               if (moveNumbers && before.WhiteToMove())
+			               res.append(std::to_string(moveNum)).append(".");
+		               else if (moveNumbers && res.empty())
+			               res.append(std::to_string(moveNum)).append("...");
+
+		               char san[16];
+		               before.MakeSANString(&sm, san,
+		                                    last ? SAN_MATETEST : SAN_CHECKTEST);
+		               res.append(san);
+	               });
+	return res;
+}
+
+// -----------------------------------------------------------------------------
+// Thread-safe queue of the lines received from a chess engine.
+// -----------------------------------------------------------------------------
+//
+// The lines are pushed by the thread that reads the engine's output and are
+// taken by the UI thread, which is notified when there are new lines.
+// After the engine replies "uciok", the "info" lines with a PV are parsed and
+// their PV is converted to SAN, using the position of the last "position"
+// command sent to the engine.
+// Engines may send thousands of PVs per second: a PV replaces the previous one
+// with the same multipv, if it was not taken yet and no other line was
+// received after it, and the UI is notified at most once every @e interval.
+// The other lines are never discarded and the UI is notified immediately.
+class EngineOutput {
+public:
+	struct Line {
+		std::string line;
+		std::string san; // the PV in SAN notation (empty if not available)
+		int multipv = 0; // 0 if it is not an "info" line with a PV
+	};
+
+private:
+	using clock = std::chrono::steady_clock;
+	const clock::duration interval_;
+	std::mutex mtx_;
+	std::vector<Line> lines_;
+	size_t infoBegin_ = 0; // the PVs after this index can be replaced
+	std::shared_ptr<const Position> pos_;
+	clock::time_point lastTake_;
+	bool uci_ = false;
+	bool eof_ = false;
+	bool notified_ = false;
+	bool notifiedNow_ = false;
+
+public:
+	explicit EngineOutput(int interval_ms)
+	    : interval_(std::chrono::milliseconds(interval_ms)) {}
+
+	/// Sets the position used to convert the PVs to SAN.
+	/// @param cmd: the UCI "position" command sent to the engine.
+	void setPosition(std::string_view cmd) {
+		auto pos = std::make_shared<Position>();
+		if (pos->ReadFromFENorUCI(cmd) != OK)
+			pos.reset();
+
+		std::lock_guard lock(mtx_);
+		pos_ = std::move(pos);
+	}
+
+	/// Stores a line received from the engine (must be invoked by a single
+	/// thread).
+	/// @returns -1 if the UI was already notified, or the delay in
+	/// milliseconds after which the UI should be notified.
+	int push(std::string_view line) {
+		UCIInfoPV info;
+		const bool isPV = uci_ && info.parse(line);
+		std::string san;
+		if (isPV) {
+			std::unique_lock lock(mtx_);
+			auto pos = pos_;
+			lock.unlock();
+			if (pos)
+				san = coordToSAN(*pos, info.pv, true);
+		}
+
+		std::lock_guard lock(mtx_);
+		if (!isPV) {
+			if (line == "uciok")
+				uci_ = true;
+			lines_.push_back({std::string(line), {}, 0});
+			infoBegin_ = lines_.size();
+			return notify(true);
+		}
+
+		int multipv = 1;
+		std::from_chars(info.multipv.data(),
+		                info.multipv.data() + info.multipv.size(), multipv);
+		multipv = std::max(1, multipv);
+		auto it = std::find_if(
+		    lines_.begin() + infoBegin_, lines_.end(),
+		    [&](auto const& elem) { return elem.multipv == multipv; });
+		if (it == lines_.end()) {
+			lines_.push_back({std::string(line), std::move(san), multipv});
+		} else {
+			it->line.assign(line);
+			it->san = std::move(san);
+		}
+		return notify(false);
+	}
+
+	/// Signals that the engine closed its output.
+	/// @returns the same as push().
+	int pushEOF() {
+		std::lock_guard lock(mtx_);
+		eof_ = true;
+		return notify(true);
+	}
+
+	/// Returns the lines received and whether the engine closed its output.
+	std::pair<std::vector<Line>, bool> take() {
+		std::lock_guard lock(mtx_);
+		notified_ = false;
+		notifiedNow_ = false;
+		lastTake_ = clock::now();
+		infoBegin_ = 0;
+		return {std::exchange(lines_, {}), eof_};
+	}
+
+private:
+	int notify(bool now) {
+		if (now) {
+			if (notifiedNow_)
+				return -1;
+			notified_ = notifiedNow_ = true;
+			return 0;
+		}
+		if (notified_)
+			return -1;
+		notified_ = true;
+		auto elapsed = clock::now() - lastTake_;
+		if (elapsed >= interval_)
+			return 0;
+		return static_cast<int>(
+		    std::chrono::ceil<std::chrono::milliseconds>(interval_ - elapsed)
+		        .count());
+	}
+};
+
+// -----------------------------------------------------------------------------
+// A child process (a chess engine) that communicates through pipes.
+// -----------------------------------------------------------------------------
+//
+// The output of the process is read by a background thread, which invokes a
+// function for each line and another when the output is closed.
+// The lines are passed without the line terminators (LF or CRLF); when
+// possible they are views of the read buffer, without copying.
+class EngineProcess {
+#if defined(_WIN32)
+	HANDLE process_ = NULL;
+	HANDLE stdin_ = NULL;
+	HANDLE stdout_ = NULL;
+	DWORD pid_ = 0;
+#else
+	pid_t pid_ = -1;
+	int stdin_ = -1;
+	int stdout_ = -1;
+#endif
+	std::thread reader_;
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	bool eof_ = false;
+
+public:
+	EngineProcess() = default;
+	EngineProcess(EngineProcess const&) = delete;
+	EngineProcess& operator=(EngineProcess const&) = delete;
+	~EngineProcess() { close(); }
+
+	/// Starts the process and the thread that reads its output.
+	/// @param args:   the executable (searched in the PATH) and its arguments.
+	/// @param onLine: invoked (by the reader thread) for each line.
+	/// @param onEOF:  invoked (by the reader thread) at the end of the output.
+	/// @returns OK or ERROR_FileOpen if the process cannot be started.
+	errorT open(std::vector<std::string> const& args,
+	            std::function<void(std::string_view)> onLine,
+	            std::function<void()> onEOF) {
+		if (args.empty() || isOpen())
+			return ERROR_BadArg;
+
+		if (!spawn(args))
+			return ERROR_FileOpen;
+
+		eof_ = false;
+		reader_ = std::thread([this, onLine = std::move(onLine),
+		                       onEOF = std::move(onEOF)]() {
+			readLines(onLine);
+			onEOF();
+			std::lock_guard lock(mtx_);
+			eof_ = true;
+			cond_.notify_all();
+		});
+		return OK;
+	}
+
+	bool isOpen() const { return reader_.joinable(); }
+
+	long pid() const { return static_cast<long>(pid_); }
+
+	/// Sends a line to the process.
+	/// @returns false if the process closed its input.
+	bool write(std::string_view line) {
+		std::string buf;
+		buf.reserve(line.size() + 1);
+		buf.append(line).push_back('\n');
+		const char* data = buf.data();
+		size_t len = buf.size();
+		while (len > 0) {
+#if defined(_WIN32)
+			DWORD n = 0;
+			if (!WriteFile(stdin_, data, static_cast<DWORD>(len), &n, NULL))
+				return false;
+#else
+			auto n = ::write(stdin_, data, len);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				return false;
+#endif
+			data += n;
+			len -= static_cast<size_t>(n);
+		}
+		return true;
+	}
+
+	/// Closes the input of the process and waits for it to terminate.
+	/// The process is killed if it does not terminate within @e timeout_ms.
+	void close(int timeout_ms = 1000) {
+		if (!isOpen())
+			return;
+
+#if defined(_WIN32)
+		CloseHandle(stdin_);
+		stdin_ = NULL;
+#else
+		::close(stdin_);
+		stdin_ = -1;
+#endif
+		std::unique_lock lock(mtx_);
+		if (!cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+		                    [&] { return eof_; })) {
+#if defined(_WIN32)
+			TerminateProcess(process_, 1);
+#else
+			kill(pid_, SIGKILL);
+#endif
+		}
+		lock.unlock();
+		reader_.join();
+
+#if defined(_WIN32)
+		WaitForSingleObject(process_, INFINITE);
+		CloseHandle(process_);
+		CloseHandle(stdout_);
+		process_ = NULL;
+		stdout_ = NULL;
+#else
+		while (waitpid(pid_, nullptr, 0) < 0 && errno == EINTR) {
+		}
+		::close(stdout_);
+		stdout_ = -1;
+		pid_ = -1;
+#endif
+	}
+
+private:
+	template <typename TFunc> void readLines(TFunc const& onLine) {
+		std::vector<char> chunk(64 * 1024);
+		std::string partial;
+		for (;;) {
+#if defined(_WIN32)
+			DWORD n = 0;
+			if (!ReadFile(stdout_, chunk.data(),
+			              static_cast<DWORD>(chunk.size()), &n, NULL) ||
+			    n == 0)
+				break;
+#else
+			auto n = ::read(stdout_, chunk.data(), chunk.size());
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+#endif
+			const char* it = chunk.data();
+			const char* end = it + n;
+			while (auto eol = static_cast<const char*>(
+			           std::memchr(it, '\n', end - it))) {
+				std::string_view line(it, eol - it);
+				if (!partial.empty()) {
+					partial.append(line);
+					line = partial;
+				}
+				if (!line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+				onLine(line);
+				partial.clear();
+				it = eol + 1;
+			}
+			partial.append(it, end);
+		}
+		if (!partial.empty())
+			onLine(partial);
+	}
+
+#if defined(_WIN32)
+	bool spawn(std::vector<std::string> const& args) {
+		std::string cmdLine;
+		for (auto const& arg : args) {
+			if (!cmdLine.empty())
+				cmdLine.push_back(' ');
+			if (!arg.empty() && arg.find_first_of(" \t\"") == arg.npos) {
+				cmdLine.append(arg);
+				continue;
+			}
+			cmdLine.push_back('"');
+			size_t backslashes = 0;
+			for (char ch : arg) {
+				if (ch == '\\') {
+					++backslashes;
+				} else if (ch == '"') {
+					cmdLine.append(backslashes + 1, '\\');
+					backslashes = 0;
+				} else {
+					backslashes = 0;
+				}
+				cmdLine.push_back(ch);
+			}
+			cmdLine.append(backslashes, '\\');
+			cmdLine.push_back('"');
+		}
+
+		SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+		HANDLE childIn = NULL;
+		HANDLE childOut = NULL;
+		if (!CreatePipe(&childIn, &stdin_, &sa, 0))
+			return false;
+		if (!CreatePipe(&stdout_, &childOut, &sa, 0)) {
+			CloseHandle(childIn);
+			CloseHandle(stdin_);
+			return false;
+		}
+		SetHandleInformation(stdin_, HANDLE_FLAG_INHERIT, 0);
+		SetHandleInformation(stdout_, HANDLE_FLAG_INHERIT, 0);
+
+		STARTUPINFOA si = {};
+		si.cb = sizeof(si);
+		si.dwFlags = STARTF_USESTDHANDLES;
+		si.hStdInput = childIn;
+		si.hStdOutput = childOut;
+		si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+		PROCESS_INFORMATION pi = {};
+		const bool res =
+		    CreateProcessA(NULL, cmdLine.data(), NULL, NULL, TRUE,
+		                   CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+		CloseHandle(childIn);
+		CloseHandle(childOut);
+		if (!res) {
+			CloseHandle(stdin_);
+			CloseHandle(stdout_);
+			stdin_ = stdout_ = NULL;
+			return false;
+		}
+		CloseHandle(pi.hThread);
+		process_ = pi.hProcess;
+		pid_ = pi.dwProcessId;
+		return true;
+	}
+#else
+	bool spawn(std::vector<std::string> const& args) {
+		// Writing to an engine that terminated must return EPIPE
+		std::signal(SIGPIPE, SIG_IGN);
+
+		int in[2];
+		int out[2];
+		if (pipe(in) != 0)
+			return false;
+		if (pipe(out) != 0) {
+			::close(in[0]);
+			::close(in[1]);
+			return false;
+		}
+
+		// The pipes must not be inherited by other processes: an engine would
+		// not receive the EOF when the input of another engine is closed.
+		for (int fd : {in[0], in[1], out[0], out[1]}) {
+			fcntl(fd, F_SETFD, FD_CLOEXEC);
+		}
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+		std::vector<char*> argv;
+		for (auto const& arg : args) {
+			argv.push_back(const_cast<char*>(arg.c_str()));
+		}
+		argv.push_back(nullptr);
+
+		const int err = posix_spawnp(&pid_, argv[0], &actions, nullptr,
+		                             argv.data(), environ);
+		posix_spawn_file_actions_destroy(&actions);
+		::close(in[0]);
+		::close(out[1]);
+		if (err != 0) {
+			::close(in[1]);
+			::close(out[0]);
+			pid_ = -1;
+			return false;
+		}
+		stdin_ = in[1];
+		stdout_ = out[0];
+		return true;
+	}
+#endif
+};
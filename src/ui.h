@@ -49,6 +49,15 @@ template <typename T>
 inline UI_res_t Result(UI_handle_t, errorT, const T&) {
 	return 0;
 }
+class EventQueue {
+public:
+	template <typename TFunc> void post(TFunc, int) const {}
+};
+class Callback {
+public:
+	Callback(UI_handle_t, const char*) {}
+	bool operator()(const List&) const { return true; }
+};
 
 }
 #endif
@@ -64,6 +73,9 @@ inline UI_res_t Result(UI_handle_t, errorT, const T&) {
  * The only server-side event generated by c++ code is for long operations:
  * it will repeatedly report to UI the amount of work done until completion.
  * UI should respond to this events with true (continue) or false (interrupt).
+ * The exception are the background threads (for example the threads reading
+ * the output of the chess engines), that post their results to the UI thread
+ * with an UI_EventQueue.
  */
 
 
@@ -82,6 +94,7 @@ UI_res_t sc_base        (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_book        (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_clipbase    (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_eco         (UI_extra_t, UI_handle_t, int argc, const char ** argv);
+UI_res_t sc_engine      (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_filter      (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_game        (UI_extra_t, UI_handle_t, int argc, const char ** argv);
 UI_res_t sc_info        (UI_extra_t, UI_handle_t, int argc, const char ** argv);
@@ -139,6 +152,30 @@ inline UI_res_t UI_Result(UI_handle_t ti, errorT res, const T& value) {
 }
 
 
+/**
+ * UI_EventQueue - schedules tasks to be executed in the UI thread.
+ *
+ * It must be created in the UI thread; then any thread can call:
+ * void post(std::function<void()> task, int delay_ms);
+ * The task will be executed in the UI thread, when the UI processes its
+ * events, after at least @e delay_ms milliseconds.
+ */
+using UI_EventQueue = UI_impl::EventQueue;
+
+/**
+ * UI_Callback - a command of the UI (for example a Tcl command prefix)
+ * that c++ code can invoke asynchronously, with a list of values appended as
+ * last argument. Must be used only in the UI thread.
+ *
+ * Typical usage:
+ * UI_Callback callback(ti, argv[2]);
+ * ...
+ * UI_List values(2);
+ * values.push_back("value");
+ * callback(values);
+ */
+using UI_Callback = UI_impl::Callback;
+
 /**
  * An heterogeneous container used to pass a list of values from c++ to UI.
  * @param max_size: currently there is no automatic reallocation in push_back()
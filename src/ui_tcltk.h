@@ -20,8 +20,10 @@
 #define SCID_UI_TCLTK_H
 
 #include <chrono>
+#include <functional>
 #include <tcl.h>
 #include <sstream>
+#include <string_view>
 #include <limits>
 
 namespace UI_impl {
@@ -173,6 +175,10 @@ inline Tcl_Obj* ObjMaker(const std::string& s) {
 	ASSERT(s.size() <= static_cast<size_t>(std::numeric_limits<int>::max()));
 	return Tcl_NewStringObj(s.c_str(), static_cast<int>(s.size()));
 }
+inline Tcl_Obj* ObjMaker(std::string_view s) {
+	ASSERT(s.size() <= static_cast<size_t>(std::numeric_limits<int>::max()));
+	return Tcl_NewStringObj(s.data(), static_cast<int>(s.size()));
+}
 inline Tcl_Obj* ObjMaker(const List& v) {
 	Tcl_Obj* res = Tcl_NewListObj(v.i_, v.list_);
 	v.i_ = 0;
@@ -202,6 +208,71 @@ inline UI_res_t Result(UI_handle_t ti, errorT res, const T& value) {
 	return UI_impl::ResultHelper(ti, res);
 }
 
+class EventQueue {
+	struct Event {
+		Tcl_Event header;
+		std::function<void()>* task;
+		int delay_ms;
+	};
+	Tcl_ThreadId thread_ = Tcl_GetCurrentThread();
+
+public:
+	void post(std::function<void()> task, int delay_ms) const {
+		auto ev = reinterpret_cast<Event*>(ckalloc(sizeof(Event)));
+		ev->header.proc = eventProc;
+		ev->header.nextPtr = nullptr;
+		ev->task = new std::function<void()>(std::move(task));
+		ev->delay_ms = delay_ms;
+		Tcl_ThreadQueueEvent(thread_, &ev->header, TCL_QUEUE_TAIL);
+		Tcl_ThreadAlert(thread_);
+	}
+
+private:
+	static int eventProc(Tcl_Event* header, int flags) {
+		if (!(flags & TCL_FILE_EVENTS))
+			return 0;
+
+		auto ev = reinterpret_cast<Event*>(header);
+		if (ev->delay_ms > 0) {
+			Tcl_CreateTimerHandler(ev->delay_ms, run, ev->task);
+		} else {
+			run(ev->task);
+		}
+		return 1;
+	}
+
+	static void run(ClientData task) {
+		auto fn = static_cast<std::function<void()>*>(task);
+		(*fn)();
+		delete fn;
+	}
+};
+
+class Callback {
+	UI_handle_t ti_;
+	Tcl_Obj* cmd_;
+
+public:
+	Callback(UI_handle_t ti, const char* cmd)
+	    : ti_(ti), cmd_(Tcl_NewStringObj(cmd, -1)) {
+		Tcl_IncrRefCount(cmd_);
+	}
+	~Callback() { Tcl_DecrRefCount(cmd_); }
+	Callback(const Callback&) = delete;
+	Callback& operator=(const Callback&) = delete;
+
+	bool operator()(const List& value) const {
+		Tcl_Obj* cmd = Tcl_DuplicateObj(cmd_);
+		Tcl_IncrRefCount(cmd);
+		Tcl_ListObjAppendElement(ti_, cmd, ObjMaker(value));
+		auto res = Tcl_EvalObjEx(ti_, cmd, TCL_EVAL_GLOBAL);
+		Tcl_DecrRefCount(cmd);
+		if (res != TCL_OK)
+			Tcl_BackgroundException(ti_, res);
+		return res == TCL_OK;
+	}
+};
+
 } //End of UI_impl namespace
 
 
@@ -213,6 +284,7 @@ UI_impl::UI_res_t sc_base        (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int
 UI_impl::UI_res_t sc_book        (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
 UI_impl::UI_res_t sc_clipbase    (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
 UI_impl::UI_res_t sc_eco         (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
+UI_impl::UI_res_t sc_engine      (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
 UI_impl::UI_res_t sc_filter      (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
 UI_impl::UI_res_t sc_game        (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
 UI_impl::UI_res_t sc_info        (UI_impl::UI_extra_t, UI_impl::UI_handle_t, int argc, const char ** argv);
@@ -234,6 +306,7 @@ inline int UI_impl::initTclTk (UI_handle_t ti)
 	Tcl_CreateCommand(ti, "sc_book"     , sc_book       , 0, NULL);
 	Tcl_CreateCommand(ti, "sc_clipbase" , sc_clipbase   , 0, NULL);
 	Tcl_CreateCommand(ti, "sc_eco"      , sc_eco        , 0, NULL);
+	Tcl_CreateCommand(ti, "sc_engine"   , sc_engine     , 0, NULL);
 	Tcl_CreateCommand(ti, "sc_filter"   , sc_filter     , 0, NULL);
 	Tcl_CreateCommand(ti, "sc_game"     , sc_game       , 0, NULL);
 	Tcl_CreateCommand(ti, "sc_info"     , sc_info       , 0, NULL);
@@ -93,6 +93,7 @@
 #   }
 #   ScoreWDL score_wdl = 11;
 #   string pv = 12;
+#   string pv_san = 13; // the pv in SAN notation (if available)
 # }
 #
 # Sent to the engine to change the value of one or more options.
@@ -155,6 +156,7 @@ proc ::engine::setLogCmd {id {recv ""} {send ""}} {
 # Starts a new engine process or connects to a remote engine.
 # If protocols is not provided uses "uci" first and after 3s "xboard".
 # If protocols is "network" opens a socket (indicated as host:port).
+# The output of local engines is read by sc_engine in a background thread.
 # Messages from the engine will be sent to @p callback.
 # An exception is raised in case of error.
 proc ::engine::connect {id callback exe_or_host args {protocols {uci xboard}}} {
@@ -164,13 +166,16 @@ proc ::engine::connect {id callback exe_or_host args {protocols {uci xboard}}} {
     ::engine::close $id
     if {$protocols eq "network"} {
         set channel [socket {*}[split $exe_or_host :]]
+        chan configure $channel -buffering line -blocking 0
     } else {
-        set channel [open "| [list $exe_or_host] $args" "r+"]
+        sc_engine open $id [list ::engine::onOutput_ $id] $exe_or_host {*}$args
+        set channel ""
     }
     ::engine::init_ $id $channel $callback
-    chan configure $channel -buffering line -blocking 0
     ::engine::handshake_ $id $protocols
-    chan event $channel readable "::engine::onMessages_ $id $channel"
+    if {$channel ne ""} {
+        chan event $channel readable "::engine::onMessages_ $id $channel"
+    }
 }
 
 # If @p port is empty stops accepting network connection. Otherwise accept network
@@ -192,7 +197,9 @@ proc ::engine::netserver {id {port ""}} {
 # Close the engine
 proc ::engine::close {id} {
     if {[info exists ::engconn(channel_$id)]} {
-        chan event $::engconn(channel_$id) readable {}
+        if {$::engconn(channel_$id) ne ""} {
+            chan event $::engconn(channel_$id) readable {}
+        }
         if {$::engconn(protocol_$id) ne "network"} {
             if {$::engconn(waitReply_$id) eq "Go"} {
                 {*}$::engconn(StopGo$id)
@@ -207,6 +214,9 @@ proc ::engine::pid {id} {
     if {![info exists ::engconn(channel_$id)]} {
         error "The engine is not open"
     }
+    if {$::engconn(channel_$id) eq ""} {
+        return [sc_engine pid $id]
+    }
     return [::pid $::engconn(channel_$id)]
 }
 
@@ -259,7 +269,11 @@ proc ::engine::destroy_ {id {localReply ""}} {
         after cancel $::engconn(nextHandshake_$id)
     }
 
-    chan close $::engconn(channel_$id)
+    if {$::engconn(channel_$id) eq ""} {
+        sc_engine close $id
+    } else {
+        chan close $::engconn(channel_$id)
+    }
     ::engine::closeServer_ $id
 
     unset ::engconn(protocol_$id)
@@ -370,8 +384,7 @@ proc ::engine::forwardNetMsg_ {id channel} {
     chan event $channel readable "::engine::forwardNetMsg_ $id $channel"
 }
 
-# Reads a line from the local engine or a reply message from a network engine.
-# Parse local input accordingly to the engine protocol and sends the replies.
+# Reads the reply messages from a network engine.
 proc ::engine::onMessages_ {id channel} {
     chan event $channel readable {}
 
@@ -381,22 +394,60 @@ proc ::engine::onMessages_ {id channel} {
         return
     }
     while {[set line [chan gets $channel]] != ""} {
-        if {$::engconn(logRecv_$id) != ""} {
-            {*}$::engconn(logRecv_$id) $line
-        }
-        if {$::engconn(protocol_$id) eq "network"} {
-            ::engine::reply $id $line
-        } elseif {[$::engconn(parseline$id) $id $line]} {
-            ::engine::done_ $id
+        ::engine::processLine_ $id $line
+    }
+    chan event $channel readable "::engine::onMessages_ $id $channel"
+}
+
+# Receives the output of a local engine from sc_engine, as a list of triples:
+# "line" and a line of text (to be parsed accordingly to the engine protocol)
+# "InfoPV", the original line and the values of an UCI info line with a pv
+# "eof" (the engine terminated).
+# The UCI info lines are parsed after the engine replies "uciok"; when an
+# engine sends the PVs faster than the UI can show them, only the most recent
+# PV of each multipv is received.
+proc ::engine::onOutput_ {id output} {
+    foreach {type line infoPV} $output {
+        # The engine may be closed by the callbacks
+        if {![info exists ::engconn(channel_$id)]} {
+            return
         }
-        if {[info exists ::engconn(InfoPV_$id)]} {
-            if {$::engconn(waitReply_$id) ne "StopGo"} {
-                ::engine::reply $id [list InfoPV $::engconn(InfoPV_$id)]
+        switch $type {
+          "line" {
+            ::engine::processLine_ $id $line
+          }
+          "InfoPV" {
+            if {$::engconn(logRecv_$id) != ""} {
+                {*}$::engconn(logRecv_$id) $line
             }
-            unset ::engconn(InfoPV_$id)
+            if {$::engconn(protocol_$id) eq "uci" && $::engconn(waitReply_$id) ne "StopGo"} {
+                ::engine::reply $id [list InfoPV $infoPV]
+            }
+          }
+          "eof" {
+            ::engine::destroy_ $id [list InfoDisconnected ""]
+            return
+          }
         }
     }
-    chan event $channel readable "::engine::onMessages_ $id $channel"
+}
+
+# Parse a line accordingly to the engine protocol and sends the replies.
+proc ::engine::processLine_ {id line} {
+    if {$::engconn(logRecv_$id) != ""} {
+        {*}$::engconn(logRecv_$id) $line
+    }
+    if {$::engconn(protocol_$id) eq "network"} {
+        ::engine::reply $id $line
+    } elseif {[$::engconn(parseline$id) $id $line]} {
+        ::engine::done_ $id
+    }
+    if {[info exists ::engconn(InfoPV_$id)]} {
+        if {$::engconn(waitReply_$id) ne "StopGo"} {
+            ::engine::reply $id [list InfoPV $::engconn(InfoPV_$id)]
+        }
+        unset ::engconn(InfoPV_$id)
+    }
 }
 
 proc ::engine::done_ {id} {
@@ -472,7 +523,11 @@ proc ::engine::updateOption {id name value} {
 }
 
 proc ::engine::rawsend {n msg} {
-    chan puts $::engconn(channel_$n) $msg
+    if {$::engconn(channel_$n) eq ""} {
+        sc_engine send $n $msg
+    } else {
+        chan puts $::engconn(channel_$n) $msg
+    }
     if {$::engconn(logSend_$n) != ""} {
         {*}$::engconn(logSend_$n) $msg
     }
@@ -304,7 +304,9 @@ proc ::file::finder::backup { f } {
       tk_messageBox -title Scid -icon error -type ok -message "File copy error $err"
       return
     }
-    catch { file copy "$r.stc" "$r$d.stc" }
+    foreach ext {.stc .sfp .stx} {
+      catch { file copy "$r$ext" "$r$d$ext" }
+    }
   }
   
   if { [catch { file copy "$r[file extension $f]" "$r$d[file extension $f]" } err ] } {
@@ -330,7 +332,9 @@ proc ::file::finder::copy { f } {
         return
       }
       
-      catch { file copy "[file rootname $f].stc" $dir }
+      foreach ext {.stc .sfp .stx} {
+        catch { file copy "[file rootname $f]$ext" $dir }
+      }
     }
     
     if { [catch { file copy $f $dir } err ] } {
@@ -356,7 +360,9 @@ proc ::file::finder::move { f } {
         tk_messageBox -title Scid -icon error -type ok -message "File rename error $err"
         return
       }
-      catch { file rename "[file rootname $f].stc" $dir }
+      foreach ext {.stc .sfp .stx} {
+        catch { file rename "[file rootname $f]$ext" $dir }
+      }
     }
     
     if { [catch { file rename $f $dir } err ] } {
@@ -378,6 +384,9 @@ proc ::file::finder::delete { f } {
   if {$answer == "yes"} {
     if { [string tolower [file extension $f]] == ".si4" } {
       file delete "[file rootname $f].sg4" "[file rootname $f].sn4" "[file rootname $f].stc"
+      foreach ext {.sfp .stx} {
+        catch { file delete "[file rootname $f]$ext" }
+      }
     }
     file delete $f
   }
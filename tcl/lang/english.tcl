@@ -811,6 +811,7 @@ translate E BrilliancyFlag {Brilliancy}
 translate E BlunderFlag {Blunder}
 translate E UserFlag {User}
 translate E PgnContains {PGN contains text}
+translate E CommentsContain {Comments contain words}
 translate E Annotator {Annotator}
 translate E Cmnts {Annotated games only}
 
@@ -1478,6 +1479,7 @@ translate E MoveOutOfBook {Move out of book}
 translate E LastBookMove {Last book move}
 translate E AnnotateSeveralGames {From actual game to game:}
 translate E FindOpeningErrors {Find opening errors}
+translate E AnnotateFilterEngines {Annotate the filter with one engine per CPU}
 translate E MarkTacticalExercises {Mark tactical exercises}
 translate E UseBook {Use book}
 translate E MultiPV {Multiple variations}
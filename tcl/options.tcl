@@ -135,6 +135,7 @@ proc InitDefaultAnnotate {} {
   set ::isBatchOpening 0
   set ::isBatchOpeningMoves 12
   set ::isBatch 0
+  set ::isAnnotateFilter 0
   set ::markTacticalExercises 0
   set ::isAnnotateVar 0
   set ::isShortAnnotation 0
@@ -43,6 +43,7 @@ proc checkDates {} {
 proc ::search::header::defaults {} {
   set ::sWhite "";  set ::sBlack ""
   set ::sEvent ""; set ::sSite "";  set ::sRound ""; set ::sAnnotator ""; set ::sAnnotated 0
+  set ::sCommentText ""
   set ::sWhiteEloMin ""; set ::sWhiteEloMax ""
   set ::sBlackEloMin ""; set ::sBlackEloMax ""
   set ::sEloDiffMin ""; set ::sEloDiffMax ""
@@ -327,6 +328,12 @@ proc search::headerCreateFrame { w } {
   ttk::entry $f.e3 -textvariable sPgntext(3) -width 15
   pack $f.l1 $f.e1 $f.l2 $f.e2 $f.l3 $f.e3 -side left -pady "0 5"
 
+  set f [ttk::frame $w.commenttext]
+  pack $f -side top -fill x
+  ttk::label $f.l1 -textvar ::tr(CommentsContain:)
+  ttk::entry $f.e1 -textvariable sCommentText -width 30
+  pack $f.l1 $f.e1 -side left -pady "0 5"
+
   addHorizontalRule $w
 
   ttk::button $w.flagslabel -textvar ::tr(FindGamesWith:) -style Pad0.Small.TButton -image tb_menu -compound left -command "
@@ -484,6 +491,8 @@ proc ::search::getSearchOptions {dest_list} {
 
 	if {$::sAnnotator ne ""} { lappend search "-annotator" $::sAnnotator }
 
+	if {[string trim $::sCommentText] ne ""} { lappend search "-text" $::sCommentText }
+
     if {! $::sVariantStd} { lappend search "-variant!" "std"}
     if {! $::sVariant960} { lappend search "-variant!" "960"}
 
@@ -538,7 +547,7 @@ proc ::search::getSearchOptions {dest_list} {
 }
 
 proc ::search::header::save {} {
-  global sWhite sBlack sEvent sSite sRound sAnnotator sAnnotated sDateMin sDateMax sIgnoreCol
+  global sWhite sBlack sEvent sSite sRound sAnnotator sAnnotated sCommentText sDateMin sDateMax sIgnoreCol
   global sWhiteEloMin sWhiteEloMax sBlackEloMin sBlackEloMax
   global sEloDiffMin sEloDiffMax sGlMin sGlMax
   global sEco sEcoMin sEcoMax sHeaderFlags sSideToMoveW sSideToMoveB
@@ -562,7 +571,7 @@ proc ::search::header::save {} {
   getSearchEntries
 
   # First write the regular variables:
-  foreach i {sWhite sBlack sEvent sSite sRound sAnnotator sAnnotated sDateMin sDateMax sResWin
+  foreach i {sWhite sBlack sEvent sSite sRound sAnnotator sAnnotated sCommentText sDateMin sDateMax sResWin
     sResLoss sResDraw sResOther sWhiteEloMin sWhiteEloMax sBlackEloMin
     sBlackEloMax sEcoMin sEcoMax sEloDiffMin sEloDiffMax
     sIgnoreCol sSideToMoveW sSideToMoveB sGlMin sGlMax ::search::filter::operation} {
@@ -90,6 +90,8 @@ proc resetEngine {n} {
     set analysis(multiPVCount$n) 1      ;# number of N-best lines
     set analysis(uciok$n) 0             ;# uciok sent by engine in response to uci command
     set analysis(name$n) ""             ;# engine name
+    set analysis(engineCmd$n) {}        ;# engine executable and arguments
+    set analysis(engineDir$n) "."       ;# engine working directory
     set analysis(processInput$n) 0      ;# the time of the last processed event
     set analysis(waitForBestMove$n) 0
     set analysis(waitForReadyOk$n) 0
@@ -888,6 +890,12 @@ proc configAnnotation {} {
     ttk::spinbox $f.batch.spBatchOpening -width 2 -textvariable ::isBatchOpeningMoves \
             -from 10 -to 20 -increment 1 -validate all -validatecommand { regexp {^[0-9]+$} %P }
     ttk::label $f.batch.lBatchOpening -text $::tr(moves)
+    ttk::checkbutton $f.batch.cbFilter -text $::tr(AnnotateFilterEngines) -variable ::isAnnotateFilter
+    if {! $::analysis(uci1)} {
+        set ::isAnnotateFilter 0
+        $f.batch.cbFilter configure -state disabled
+    }
+    pack $f.batch.cbFilter -side bottom -anchor w -pady { 4 0 }
     pack $f.batch.cbBatch -side top -anchor w -pady { 0 0 }
     pack $f.batch.spBatchEnd -side top -padx 20 -anchor w
     pack $f.batch.cbBatchOpening -side top -anchor w
@@ -915,6 +923,10 @@ proc configAnnotation {} {
         if {$tempdelay < 0.1} { set tempdelay 0.1 }
         set autoplayDelay [expr {int($tempdelay * 1000)}]
         destroy .configAnnotation
+        if {$::isAnnotateFilter} {
+            annotateFilter 1
+            return
+        }
         .analysisWin1.b1.annotate state pressed
         # Tell the analysis mode that we want an initial assessment of the
         # position. So: no comments yet, please!
@@ -927,6 +939,32 @@ proc configAnnotation {} {
     bind $w <Destroy> { focus . }
 }
 ################################################################################
+# Annotates all the games of the filter of the current database with a pool of
+# instances of the UCI engine of the analysis window n (see sc_base annotate).
+# Every position is analyzed for autoplayDelay milliseconds.
+################################################################################
+proc annotateFilter { {n 1} } {
+    global analysis
+
+    set oldpwd ""
+    if {$analysis(engineDir$n) != "."} {
+        set oldpwd [pwd]
+        catch {cd $analysis(engineDir$n)}
+    }
+    progressWindow "Scid" "$::tr(Annotate)..." $::tr(Cancel)
+    set err [catch {sc_base annotate $::curr_db dbfilter \
+        -go "movetime $::autoplayDelay" -blunder $::blunderThreshold \
+        -setoption "name Threads value 1" {*}$analysis(engineCmd$n)} result]
+    closeProgressWindow
+    if {$oldpwd != ""} { catch {cd $oldpwd} }
+
+    if {$err && $::errorCode != $::ERROR::UserCancel} {
+        ERROR::MessageBox
+    }
+    ::notify::GameChanged
+    ::notify::DatabaseModified $::curr_db
+}
+################################################################################
 # Part of annotation process : will check the moves if they are in te book, and add a comment
 # when going out of it
 ################################################################################
@@ -1746,6 +1784,8 @@ proc makeAnalysisWin { {n 1} {index -1} {autostart 1}} {
     set analysisArgs [lindex $engineData 2]
     set analysisDir [ toAbsPath [lindex $engineData 3] ]
     set analysis(uci$n) [ lindex $engineData 7 ]
+    set analysis(engineCmd$n) [list $analysisCommand {*}$analysisArgs]
+    set analysis(engineDir$n) $analysisDir
     
     # If the analysis directory is not current dir, cd to it:
     set oldpwd ""
@@ -416,9 +416,13 @@ proc ::tools::graphs::filter::Refresh {} {
     }
   }
   
+  set ranges {}
   foreach {start end label} $rlist {
     if {$ftype == "date"} { append end ".12.31" }
-    set r [sc_filter freq [sc_base current] dbfilter $ftype $start $end $FilterGuessELO]
+    lappend ranges $start $end
+  }
+  set histogram [sc_filter histogram [sc_base current] dbfilter $ftype $ranges $FilterGuessELO]
+  foreach {start end label} $rlist r $histogram {
     set filter [lindex $r 0]
     set all [lindex $r 1]
     if {$all == 0} {
@@ -1088,9 +1092,13 @@ proc ::tools::graphs::absfilter::Refresh {} {
   }
   
   set mean 0
+  set ranges {}
   foreach {start end label} $rlist {
     if {$ftype == "date"} { append end ".12.31" }
-    set r [sc_filter freq [sc_base current] dbfilter $ftype $start $end $FilterGuessELO]
+    lappend ranges $start $end
+  }
+  set histogram [sc_filter histogram [sc_base current] dbfilter $ftype $ranges $FilterGuessELO]
+  foreach {start end label} $rlist r $histogram {
     set absfilter [lindex $r 0]
     set all [lindex $r 1]
     set freq $absfilter
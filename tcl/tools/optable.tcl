@@ -566,16 +566,31 @@ proc ::optable::latexifyTree {} {
 }
 
 proc ::optable::setupRatios {} {
-  set r [sc_filter freq [sc_base current] tree date 0000.00.00]
+  # All the date ranges are counted with a single pass over the games
+  set decades {1800 1899  1900 1949  1950 1969  1970 1979
+    1980 1989 1990 1999 2000 2009}
+  set ranges [list 0000.00.00 2047.12.31]
+  foreach {start end} $decades {
+    lappend ranges $start.00.00 $end.12.31
+  }
+  foreach y {1 5 10} {
+    set year "[expr [::utils::date::today year]-$y]"
+    append year ".[::utils::date::today month].[::utils::date::today day]"
+    lappend ranges $year 2047.12.31
+  }
+  set histogram [sc_filter histogram [sc_base current] tree date $ranges]
+
+  set r [lindex $histogram 0]
   if {[lindex $r 0] == 0} {
     set ::optable::_data(ratioAll) 0
   } else {
     set ::optable::_data(ratioAll) \
         [expr {int(double([lindex $r 1]) / double([lindex $r 0]))} ]
   }
-  foreach {start end} {1800 1899  1900 1949  1950 1969  1970 1979
-    1980 1989 1990 1999 2000 2009} {
-    set r [sc_filter freq [sc_base current] tree date $start.00.00 $end.12.31]
+  set i 1
+  foreach {start end} $decades {
+    set r [lindex $histogram $i]
+    incr i
     set filter [lindex $r 0]
     set all [lindex $r 1]
     if {$filter == 0} {
@@ -586,9 +601,8 @@ proc ::optable::setupRatios {} {
     }
   }
   foreach y {1 5 10} {
-    set year "[expr [::utils::date::today year]-$y]"
-    append year ".[::utils::date::today month].[::utils::date::today day]"
-    set r [sc_filter freq [sc_base current] tree date $year]
+    set r [lindex $histogram $i]
+    incr i
     set filter [lindex $r 0]
     set all [lindex $r 1]
     if {$filter == 0} {
@@ -15,9 +15,6 @@ namespace eval uci {
     set oldOptions ""
     array set check ""
 
-    # The list of token that comes with info
-    set infoToken { depth seldepth time nodes pv multipv score cp mate lowerbound upperbound \
-                currmove currmovenumber hashfull nps tbhits sbhits cpuload string refutation currline }
     set optionToken {name type default min max var }
     set optionImportant { MultiPV Hash OwnBook BookFile UCI_LimitStrength UCI_Elo }
     set optionToKeep { UCI_LimitStrength UCI_Elo UCI_ShredderbasesPath }
@@ -85,7 +82,7 @@ namespace eval uci {
     }
 
     proc processInput_ { {n} {analyze} } {
-        global analysis ::uci::uciInfo ::uci::infoToken ::uci::optionToken
+        global analysis ::uci::uciInfo ::uci::optionToken
         
         if {$analyze} {
             set pipe $analysis(pipe$n)
@@ -141,95 +138,62 @@ namespace eval uci {
             }
         }
         
-        set toBeFormatted 0
         # parse an info line
         if {[string first "info" $line ] == 0} {
             if {$analysis(waitForReadyOk$n)} { return }
             resetUciInfo $n
-            set data [split $line]
-            set length [llength $data]
-            for {set i 0} {$i < $length } {incr i} {
-                set t [lindex $data $i]
-                if { $t == "info" } { continue }
-                if { $t == "depth" } { incr i ; set uciInfo(depth$n) [ lindex $data $i ] ; continue }
-                if { $t == "seldepth" } { incr i ; set uciInfo(seldepth$n) [ lindex $data $i ] ; set analysis(seldepth$n) $uciInfo(seldepth$n) ; continue }
-                if { $t == "time" } { incr i ; set uciInfo(time$n) [ lindex $data $i ] ; continue }
-                if { $t == "nodes" } { incr i ; set uciInfo(nodes$n) [ lindex $data $i ] ; continue }
-                if { $t == "pv" } {
-                    incr i
-                    set uciInfo(pv$n) [ lindex $data $i ]
-                    incr i
-                    while { [ lsearch -exact $infoToken [ lindex $data $i ] ] == -1 && $i < $length } {
-                        append uciInfo(pv$n) " " [ lindex $data $i ]
-                        incr i
-                    }
-                    set toBeFormatted 1
-                    incr i -1
-                    continue
-                }
-                if { $t == "multipv" } { incr i ; set uciInfo(multipv$n) [ lindex $data $i ] ; continue }
-                if { $t == "score" } {
-                    incr i
-                    set next [ lindex $data $i ]
-                    # Needed for Prodeo, which is not UCI compliant
-                    if { $next != "cp" && $next != "mate" } {
-                        return
+            if { $analysis(fen$n) == "" } {
+                set fen [sc_pos fen]
+            } else {
+                set fen $analysis(fen$n)
+            }
+            set sanPv ""
+            foreach {t value} [sc_engine parseinfo $line $fen] {
+                switch -- $t {
+                    depth - time - nodes - pv - multipv {
+                        set uciInfo($t$n) $value
                     }
-                    if { $next == "cp" } {
-                        incr i
-                        set uciInfo(tmp_score$n) [ lindex $data $i ]
+                    seldepth - currmovenumber - hashfull - nps - tbhits - sbhits - cpuload {
+                        set uciInfo($t$n) $value
+                        set analysis($t$n) $value
                     }
-                    if { $next == "mate" } {
-                        incr i
-                        set next [ lindex $data $i ]
-                        set uciInfo(scoremate$n) $next
-                        if { $next < 0} {
-                            set uciInfo(tmp_score$n) [expr {-32767 - 2 * $next}]
-                        } else  {
-                            set uciInfo(tmp_score$n) [expr {32767 - 2 * $next}]
+                    currmove { set uciInfo(currmove$n) $value }
+                    sanpv { set sanPv $value }
+                    sancurrmove { set analysis(currmove$n) $value }
+                    string { set uciInfo(string$n) $value }
+                    score {
+                        lassign $value type score
+                        # Needed for Prodeo, which is not UCI compliant
+                        if { $type != "cp" && $type != "mate" } {
+                            return
                         }
-                    }
-                    # convert the score to white's perspective (not engine's one)
-                    if { $analysis(fen$n) == "" } {
-                        set side [string index [sc_pos side] 0]
-                    } else {
-                        set side [lindex [split $analysis(fen$n)] 1]
-                    }
-                    if { $side == "b"} {
-                        set uciInfo(tmp_score$n) [ expr 0.0 - $uciInfo(tmp_score$n) ]
-                        if { $uciInfo(scoremate$n) } {
-                            set uciInfo(scoremate$n) [ expr 0 - $uciInfo(scoremate$n) ]
-                            if { $uciInfo(tmp_score$n) < 0 } {
-                                set uciInfo(tmp_score$n) [ expr {$uciInfo(tmp_score$n) - 1.0} ]
+                        if { $type == "cp" } {
+                            set uciInfo(tmp_score$n) $score
+                        } else {
+                            set uciInfo(scoremate$n) $score
+                            if { $score < 0} {
+                                set uciInfo(tmp_score$n) [expr {-32767 - 2 * $score}]
+                            } else  {
+                                set uciInfo(tmp_score$n) [expr {32767 - 2 * $score}]
                             }
                         }
-                    } elseif { $uciInfo(scoremate$n) && $uciInfo(tmp_score$n) > 0 } {
-                        set uciInfo(tmp_score$n) [ expr {$uciInfo(tmp_score$n) + 1.0} ]
-                    }
-                    set uciInfo(tmp_score$n) [expr {double($uciInfo(tmp_score$n)) / 100.0} ]
-                    
-                    # don't consider lowerbound & upperbound score info
-                    continue
-                }
-                if { $t == "currmove" } { incr i ; set uciInfo(currmove$n) [ lindex $data $i ] ; set analysis(currmove$n) [formatPv $uciInfo(currmove$n) $analysis(fen$n)] ; continue}
-                if { $t == "currmovenumber" } { incr i ; set uciInfo(currmovenumber$n) [ lindex $data $i ] ; set analysis(currmovenumber$n) $uciInfo(currmovenumber$n) ; continue}
-                if { $t == "hashfull" } { incr i ; set uciInfo(hashfull$n) [ lindex $data $i ] ; set analysis(hashfull$n) $uciInfo(hashfull$n) ; continue}
-                if { $t == "nps" } { incr i ; set uciInfo(nps$n) [ lindex $data $i ] ; set analysis(nps$n) $uciInfo(nps$n) ; continue}
-                if { $t == "tbhits" } { incr i ; set uciInfo(tbhits$n) [ lindex $data $i ] ; set analysis(tbhits$n) $uciInfo(tbhits$n) ; continue}
-                if { $t == "sbhits" } { incr i ; set uciInfo(sbhits$n) [ lindex $data $i ] ; set analysis(sbhits$n) $uciInfo(sbhits$n) ; continue}
-                if { $t == "cpuload" } { incr i ; set uciInfo(cpuload$n) [ lindex $data $i ] ; set analysis(cpuload$n) $uciInfo(cpuload$n) ; continue}
-                if { $t == "string" } {
-                    incr i
-                    while { $i < $length } {
-                        append uciInfo(string$n) [ lindex $data $i ] " "
-                        incr i
+                        # convert the score to white's perspective (not engine's one)
+                        if { [lindex [split $fen] 1] == "b"} {
+                            set uciInfo(tmp_score$n) [ expr 0.0 - $uciInfo(tmp_score$n) ]
+                            if { $uciInfo(scoremate$n) } {
+                                set uciInfo(scoremate$n) [ expr 0 - $uciInfo(scoremate$n) ]
+                                if { $uciInfo(tmp_score$n) < 0 } {
+                                    set uciInfo(tmp_score$n) [ expr {$uciInfo(tmp_score$n) - 1.0} ]
+                                }
+                            }
+                        } elseif { $uciInfo(scoremate$n) && $uciInfo(tmp_score$n) > 0 } {
+                            set uciInfo(tmp_score$n) [ expr {$uciInfo(tmp_score$n) + 1.0} ]
+                        }
+                        set uciInfo(tmp_score$n) [expr {double($uciInfo(tmp_score$n)) / 100.0} ]
+                        # don't consider lowerbound & upperbound score info
                     }
-                    break
                 }
-                # TODO parse following tokens if necessary  : refutation currline
-                if { $t == "refutation" } { continue }
-                if { $t == "currline" } { continue }
-            };# end for data loop
+            }
             
             # return if no interesting info
             if { $uciInfo(tmp_score$n) == "" || $uciInfo(pv$n) == "" } {
@@ -260,10 +224,7 @@ namespace eval uci {
             set pvRaw $uciInfo(pv$n)
             
             # convert to something more readable
-            if ($toBeFormatted) {
-                set uciInfo(pv$n) [formatPv $uciInfo(pv$n) $analysis(fen$n)]
-                set toBeFormatted 0
-            }
+            set uciInfo(pv$n) $sanPv
             
             set idx [ expr $uciInfo(multipv$n) -1 ]
             
@@ -613,7 +613,7 @@ proc ::enginewin::updateOptions {id msgData} {
 }
 
 proc ::enginewin::updateDisplay {id msgData} {
-    lassign $msgData multipv depth seldepth nodes nps hashfull tbhits time score score_type score_wdl pv
+    lassign $msgData multipv depth seldepth nodes nps hashfull tbhits time score score_type score_wdl pv pv_san
     if {$time eq ""} { set time 0 }
     if {$nps eq ""} { set nps 0 }
     if {$hashfull eq ""} { set hashfull 0 }
@@ -645,7 +645,11 @@ proc ::enginewin::updateDisplay {id msgData} {
 
     set translated untranslated
     if {$notation > 0} {
-        set pv [sc_pos coordToSAN [set ::enginewin::position_$id] $pv]
+        if {$pv_san ne ""} {
+            set pv $pv_san
+        } else {
+            set pv [sc_pos coordToSAN [set ::enginewin::position_$id] $pv]
+        }
     }
     if {$notation == 1 || $notation == -1} {
         set pv [::trans $pv]
@@ -80,6 +80,27 @@ proc ::windows::stats::Refresh {} {
   ::notify::DatabaseModified $::curr_db dbfilter
 }
 
+# Appends to the variable textVar the statistics of each row of rows, which
+# is a list of labels followed by the min and max values of the range (an
+# empty label appends an empty line). All the ranges are counted with a
+# single pass over the games.
+proc ::windows::stats::appendRanges {textVar len type rows} {
+  upvar $textVar s
+  set ranges {}
+  foreach {stat min max} $rows {
+    if {$stat ne ""} { lappend ranges $min $max }
+  }
+  set lines [sc_filter stats histogram $type $ranges]
+  foreach {stat min max} $rows {
+    if {$stat eq ""} {
+      append s "\n"
+      continue
+    }
+    set lines [lassign $lines line]
+    append s "\n [::utils::string::Pad $stat $len]" $line
+  }
+}
+
 proc ::windows::stats::refresh_wnd {} {
   global FilterMaxMoves FilterMinMoves FilterStepMoves FilterMaxElo FilterMinElo FilterStepElo FilterMaxYear FilterMinYear FilterStepYear FilterGuessELO
   variable display
@@ -118,12 +139,14 @@ proc ::windows::stats::refresh_wnd {} {
   if {$years} { incr height }
 
   set s ""
-  set sm "\n"
   set stat ""
   append s " [::utils::string::Pad $stat [expr $len - 4]] [::utils::string::PadRight $games 10]"
   append s "     1-0     =-=     0-1 [::utils::string::PadRight $score 8]\n"
   append s "--------------------------------------------------------------"
   append s "\n [::utils::string::Pad $all $len]" [sc_filter stats all]
+  set minEloRows {}
+  set maxEloRows {}
+  set yearRows {}
 # New Statistic: Count the games in intervalls "start elo  - end elo"
 #         if elo is deselected in option menu, then enlarge the intervall to next selectet elo.
 # New Statistic: Count the games in intervalls
@@ -137,15 +160,12 @@ proc ::windows::stats::refresh_wnd {} {
 	    # shorten gap between 0 and "useful" ratings 1800
 	    set j $i
 	    if { $i < 100 } { set i [expr { 1800 - $FilterStepElo}] }
-	    set stat "min. Elo $i-$nelo"
-	    append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $i $nelo]
-	    set stat "max. Elo $i-$nelo"
-	    # +10000 workaround to trigger max elo in filter function
-	    append sm "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $i [expr {$nelo + 10000}]]
+	    lappend minEloRows "min. Elo $i-$nelo" $i $nelo
+	    lappend maxEloRows "max. Elo $i-$nelo" $i $nelo
 	}
     }
     if {$::windows::stats::statelo && $ratings} {
-	append s "\n"
+	lappend minEloRows "" 0 0
 	set j 0
 	set k [lindex $rlist $j]
 	while { $k!= "" && ! $display($k) } {
@@ -156,10 +176,8 @@ proc ::windows::stats::refresh_wnd {} {
 	set nelo [string range [lindex $rlist $j] 1 end]
 	incr height
 	#first line searches all games greater 2600 Elo
-	set stat "min. Elo $nelo-3500"
-	append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $nelo 9999]
-	set stat "max. Elo $nelo-3500"
-	append sm "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $nelo -9999]
+	lappend minEloRows "min. Elo $nelo-3500" $nelo 9999
+	lappend maxEloRows "max. Elo $nelo-3500" $nelo 0
 	set j 0
 	foreach i $rlist {
 	    incr j
@@ -176,16 +194,15 @@ proc ::windows::stats::refresh_wnd {} {
 		set nelo [string range [lindex $rlist $l] 1 end]
 		if { $nelo == "" } { set nelo 0 }
 		#count all games where player whith lowest Elo is in the specific range
-		set stat "min. Elo $nelo-$elo"
-		append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $nelo $elo]
-		set stat "max. Elo $nelo-$elo"
+		lappend minEloRows "min. Elo $nelo-$elo" $nelo $elo
 		#count all games where player whith highest Elo is in the specific range
-		# +10000 workaround to trigger max elo in filter function
-		append sm "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $nelo [expr {$elo + 10000}]]
+		lappend maxEloRows "max. Elo $nelo-$elo" $nelo $elo
 	    }
 	}
     }
-    append s $sm
+    ::windows::stats::appendRanges s $len elo $minEloRows
+    append s "\n"
+    ::windows::stats::appendRanges s $len maxelo $maxEloRows
     append s "\n"
 # New Statistic: Count the games in intervalls "from year - to year"
 # if year is deselected in option menu, then enlarge the intervall to next selectet year.
@@ -195,8 +212,7 @@ proc ::windows::stats::refresh_wnd {} {
 	for {set i $startYear} {$i <= $endYear} {set i [expr {$i + $FilterStepYear}]} {
 	    incr height
 	    set ie [expr {$i+$FilterStepYear}]
-	    set stat "$i - $ie"
-	    append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats year $i $ie]
+	    lappend yearRows "$i - $ie" $i $ie
 	}
     }
     if {$::windows::stats::stat_year && $years} {
@@ -216,11 +232,11 @@ proc ::windows::stats::refresh_wnd {} {
 		}
 		set nyear [string range $k 1 end]
 		if { $nyear == "" } { set nyear 2099 }
-		set stat "$year - $nyear"
-		append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats year $year $nyear]
+		lappend yearRows "$year - $nyear" $year $nyear
 	    }
 	}
     }
+    ::windows::stats::appendRanges s $len year $yearRows
 #Old statistic: count the games from specific value to maximum value
   set stat ""
   if { $::windows::stats::old_elo || $::windows::stats::old_year} {
@@ -231,27 +247,27 @@ proc ::windows::stats::refresh_wnd {} {
       append s "\n [::utils::string::Pad $all $len]" [sc_filter stats all]
   }
   if {$ratings && $::windows::stats::old_elo} {
-    append s "\n"
+    set rows [list "" 0 0]
     foreach i $rlist {
       if {$display($i)} {
         incr height
         set elo [string range $i 1 end]
-        set stat "$both $elo+"
-        append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats elo $elo 0]
+        lappend rows "$both $elo+" $elo 0
       }
     }
+    ::windows::stats::appendRanges s $len elo $rows
   }
 
   if {$years && $::windows::stats::old_year} {
-    append s "\n"
+    set rows [list "" 0 0]
     foreach i $ylist {
       if {$display($i)} {
         incr height
         set year [string range $i 1 end]
-        set stat "$since $year.01.01"
-        append s "\n [::utils::string::Pad $stat $len]"   [sc_filter stats year $year 0]
+        lappend rows "$since $year.01.01" $year 0
       }
     }
+    ::windows::stats::appendRanges s $len year $rows
   }
   append s "\n"
 